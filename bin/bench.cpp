@@ -0,0 +1,302 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#include <CabanaMD_config.hpp>
+
+#include <cabanamd.h>
+#include <device.h>
+#include <mdfactory.h>
+#include <profile.h>
+#include <types.h>
+
+#include <Kokkos_Core.hpp>
+
+#include "mpi.h"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Benchmark driver: runs the LAMMPS input for every combination of lattice
+// size, neighbor list type, half/full iteration and neighbor parallelism,
+// with warm-up and timed repeats, and writes the results as JSON. --layouts
+// sweeps AoSoA layouts and vector lengths among the compiled
+// CabanaMD_RUNTIME_SYSTEMS; combinations not compiled are skipped.
+
+std::vector<std::string> split_list( const std::string &list )
+{
+    std::vector<std::string> items;
+    std::stringstream stream( list );
+    std::string item;
+    while ( std::getline( stream, item, ',' ) )
+        items.push_back( item );
+    return items;
+}
+
+struct BenchResult
+{
+    double total, force, neigh, comm, integrate, other;
+};
+
+struct BenchCase
+{
+    std::string size, neigh, iteration, parallel, layout;
+};
+
+// LAYOUT or LAYOUT:VECTOR_LENGTH as --layout/--vector-length, "default"
+// for the configured ones
+std::vector<std::string> layout_args( const std::string &layout )
+{
+    if ( layout == "default" )
+        return {};
+    std::vector<std::string> args = {"--layout", layout};
+    std::size_t colon = layout.find( ':' );
+    if ( colon != std::string::npos )
+        args = {"--layout", layout.substr( 0, colon ), "--vector-length",
+                layout.substr( colon + 1 )};
+    return args;
+}
+
+// Parse one run's command line and run it; returns false if the
+// combination is not compiled
+bool run_case( std::vector<std::string> args, long &natoms, int &nsteps,
+               BenchResult &result )
+{
+    std::vector<char *> argv;
+    for ( auto &arg : args )
+        argv.push_back( &arg[0] );
+
+    InputCL commandline;
+    commandline.read_args( argv.size(), argv.data() );
+
+    CabanaMD *cabanamd = nullptr;
+    try
+    {
+        cabanamd = MDfactory::create( commandline );
+    }
+    catch ( std::runtime_error & )
+    {
+        // Device, layout or vector length not compiled
+    }
+    if ( cabanamd == nullptr )
+        return false;
+
+    // --timers reports only this run
+    profile_reset();
+    cabanamd->init( commandline );
+    cabanamd->run();
+
+    // Slowest rank per phase
+    auto &t = cabanamd->timings;
+    double local[6] = {t.total, t.force,     t.neigh,
+                       t.comm,  t.integrate, t.other};
+    double global[6];
+    MPI_Allreduce( local, global, 6, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD );
+    result = {global[0], global[1], global[2],
+              global[3], global[4], global[5]};
+    natoms = cabanamd->natoms;
+    nsteps = cabanamd->nsteps;
+
+    delete cabanamd;
+    return true;
+}
+
+int main( int argc, char *argv[] )
+{
+    MPI_Init( &argc, &argv );
+    {
+        // Spread the ranks of a node over its GPUs
+        std::vector<std::string> kokkos_args = device_args( argc, argv );
+        std::vector<char *> kokkos_argv;
+        for ( auto &arg : kokkos_args )
+            kokkos_argv.push_back( &arg[0] );
+        int kokkos_argc = kokkos_argv.size();
+        Kokkos::ScopeGuard scope_guard( kokkos_argc, kokkos_argv.data() );
+
+        int rank, num_ranks;
+        MPI_Comm_rank( MPI_COMM_WORLD, &rank );
+        MPI_Comm_size( MPI_COMM_WORLD, &num_ranks );
+
+        std::string input_file;
+        std::string json_file = "cbnmd-bench.json";
+        std::vector<std::string> sizes = {"20"};
+        std::vector<std::string> neigh_types = {"VERLET_2D"};
+        std::vector<std::string> iterations = {"NEIGH_FULL"};
+        std::vector<std::string> parallels = {"SERIAL"};
+        std::vector<std::string> layouts = {"default"};
+        int warmup = 1;
+        int repeats = 3;
+        bool weak = false;
+        // Options passed to every run (e.g. --device-type, --comm-type)
+        std::vector<std::string> common;
+
+        for ( int i = 1; i < argc; i++ )
+        {
+            if ( ( strcmp( argv[i], "-h" ) == 0 ) ||
+                 ( strcmp( argv[i], "--help" ) == 0 ) )
+            {
+                log( std::cout, "cbnmd-bench\n", "Options:" );
+                log( std::cout, "  -il [FILE]:               LAMMPS input "
+                                "file (required)" );
+                log( std::cout, "  --sizes [N,...]:          Lattice cells "
+                                "per dimension" );
+                log( std::cout, "  --weak:                   Sizes are per "
+                                "rank (weak scaling)" );
+                log( std::cout, "  --neigh-types [TYPE,...]: See cbnMD "
+                                "--neigh-type" );
+                log( std::cout, "  --iterations [TYPE,...]:  See cbnMD "
+                                "--force-iteration" );
+                log( std::cout, "  --parallel [TYPE,...]:    See cbnMD "
+                                "--neigh-parallel" );
+                log( std::cout, "  --layouts [L[:VL],...]:   AoSoA layouts "
+                                "(1, 2, 3, 6) and vector lengths, e.g. "
+                                "default,1:16,3:16" );
+                log( std::cout, "  --warmup [N]:             Untimed runs "
+                                "per case" );
+                log( std::cout, "  --repeats [N]:            Timed runs "
+                                "per case" );
+                log( std::cout, "  --json [FILE]:            Output file" );
+                log( std::cout, "  Other options are passed to every run" );
+                MPI_Finalize();
+                return 0;
+            }
+            else if ( strcmp( argv[i], "-il" ) == 0 )
+                input_file = argv[++i];
+            else if ( strcmp( argv[i], "--sizes" ) == 0 )
+                sizes = split_list( argv[++i] );
+            else if ( strcmp( argv[i], "--weak" ) == 0 )
+                weak = true;
+            else if ( strcmp( argv[i], "--neigh-types" ) == 0 )
+                neigh_types = split_list( argv[++i] );
+            else if ( strcmp( argv[i], "--iterations" ) == 0 )
+                iterations = split_list( argv[++i] );
+            else if ( strcmp( argv[i], "--parallel" ) == 0 )
+                parallels = split_list( argv[++i] );
+            else if ( strcmp( argv[i], "--layouts" ) == 0 )
+                layouts = split_list( argv[++i] );
+            else if ( strcmp( argv[i], "--warmup" ) == 0 )
+                warmup = atoi( argv[++i] );
+            else if ( strcmp( argv[i], "--repeats" ) == 0 )
+                repeats = atoi( argv[++i] );
+            else if ( strcmp( argv[i], "--json" ) == 0 )
+                json_file = argv[++i];
+            else
+                common.push_back( argv[i] );
+        }
+        if ( input_file.empty() )
+            log_err( std::cout, "cbnmd-bench requires -il [FILE]" );
+
+        // Weak scaling: the same decomposition as the Cajita partitioner
+        int dims[3] = {1, 1, 1};
+        if ( weak )
+        {
+            dims[0] = dims[1] = dims[2] = 0;
+            MPI_Dims_create( num_ranks, 3, dims );
+        }
+
+        std::ofstream json;
+        if ( rank == 0 )
+        {
+            json.open( json_file );
+            json << "{\n  \"ranks\": " << num_ranks
+                 << ",\n  \"default_layout\": " << CabanaMD_LAYOUT
+                 << ",\n  \"default_vector_length\": \""
+                 << CabanaMD_VECTORLENGTH << "\""
+                 << ",\n  \"weak\": " << ( weak ? "true" : "false" )
+                 << ",\n  \"options\": \"";
+            for ( std::size_t o = 0; o < common.size(); o++ )
+                json << ( o ? " " : "" ) << common[o];
+            json << "\",\n  \"cases\": [";
+        }
+
+        std::vector<BenchCase> cases;
+        for ( auto &size : sizes )
+            for ( auto &neigh : neigh_types )
+                for ( auto &iteration : iterations )
+                    for ( auto &parallel : parallels )
+                        for ( auto &layout : layouts )
+                            cases.push_back(
+                                {size, neigh, iteration, parallel, layout} );
+
+        bool first = true;
+        for ( auto &c : cases )
+        {
+            std::vector<std::string> args = {
+                "cbnmd-bench", "-il", input_file, "-o", "cbnmd-bench.out",
+                "-e", "cbnmd-bench.err", "--neigh-type", c.neigh,
+                "--force-iteration", c.iteration, "--neigh-parallel",
+                c.parallel, "--lattice-size"};
+            for ( int d = 0; d < 3; d++ )
+                args.push_back(
+                    std::to_string( std::stoi( c.size ) * dims[d] ) );
+            std::vector<std::string> layout = layout_args( c.layout );
+            args.insert( args.end(), layout.begin(), layout.end() );
+            args.insert( args.end(), common.begin(), common.end() );
+
+            long natoms = 0;
+            int nsteps = 0;
+            std::vector<BenchResult> results;
+            bool compiled = true;
+            for ( int r = 0; r < warmup + repeats && compiled; r++ )
+            {
+                BenchResult result;
+                compiled = run_case( args, natoms, nsteps, result );
+                if ( compiled && r >= warmup )
+                    results.push_back( result );
+            }
+            if ( !compiled )
+            {
+                log( std::cout, "Skipping ", c.neigh, " ", c.iteration, " ",
+                     c.parallel, " layout ", c.layout, ": not compiled" );
+                continue;
+            }
+            if ( rank != 0 )
+                continue;
+
+            // Best repeat by total time
+            BenchResult best = results.at( 0 );
+            for ( auto &result : results )
+                if ( result.total < best.total )
+                    best = result;
+
+            json << ( first ? "\n" : ",\n" ) << std::setprecision( 6 )
+                 << "    {\"size\": " << c.size << ", \"atoms\": " << natoms
+                 << ", \"steps\": " << nsteps << ", \"neigh_type\": \""
+                 << c.neigh << "\", \"force_iteration\": \"" << c.iteration
+                 << "\", \"neigh_parallel\": \"" << c.parallel
+                 << "\", \"layout\": \"" << c.layout
+                 << "\",\n     \"atomsteps_per_s\": "
+                 << 1.0 * natoms * nsteps / best.total
+                 << ", \"time\": " << best.total
+                 << ", \"force\": " << best.force
+                 << ", \"neigh\": " << best.neigh
+                 << ", \"comm\": " << best.comm
+                 << ", \"integrate\": " << best.integrate
+                 << ", \"other\": " << best.other
+                 << ",\n     \"repeat_times\": [";
+            for ( std::size_t r = 0; r < results.size(); r++ )
+                json << ( r ? ", " : "" ) << results[r].total;
+            json << "]}";
+            first = false;
+        }
+
+        if ( rank == 0 )
+        {
+            json << "\n  ]\n}\n";
+            json.close();
+        }
+    }
+    MPI_Finalize();
+}
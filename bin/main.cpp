@@ -47,6 +47,7 @@
 //************************************************************************
 
 #include <cabanamd.h>
+#include <device.h>
 #include <mdfactory.h>
 #include <types.h>
 
@@ -54,6 +55,9 @@
 
 #include "mpi.h"
 
+#include <string>
+#include <vector>
+
 // CabanaMD can be used as a library
 // This main file is simply a driver
 int main( int argc, char *argv[] )
@@ -61,10 +65,17 @@ int main( int argc, char *argv[] )
 
     MPI_Init( &argc, &argv );
 
-    Kokkos::ScopeGuard scope_guard( argc, argv );
+    // Spread the ranks of a node over its GPUs
+    std::vector<std::string> args = device_args( argc, argv );
+    std::vector<char *> kokkos_argv;
+    for ( auto &arg : args )
+        kokkos_argv.push_back( &arg[0] );
+    int kokkos_argc = kokkos_argv.size();
+    Kokkos::ScopeGuard scope_guard( kokkos_argc, kokkos_argv.data() );
 
+    // Kokkos removed its own options (including the device ones added above)
     InputCL commandline;
-    commandline.read_args( argc, argv );
+    commandline.read_args( kokkos_argc, kokkos_argv.data() );
 
     CabanaMD *cabanamd = MDfactory::create( commandline );
 
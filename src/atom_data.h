@@ -0,0 +1,136 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef ATOM_DATA_H
+#define ATOM_DATA_H
+
+#include <Cabana_Core.hpp>
+#include <Kokkos_Core.hpp>
+#include <Kokkos_UnorderedMap.hpp>
+
+#include <types.h>
+
+#include <vector>
+
+// Per atom values kept outside the system AoSoAs (e.g. analysis reference
+// positions). Entries are keyed by global id and live on the owner of their
+// atom: System::migrate sends them along with the atoms, so sorting the
+// atoms does not move them and no rank holds more than its own atoms.
+template <class t_device>
+class AtomDataBase
+{
+  public:
+    using memory_space = typename t_device::memory_space;
+    using t_ids = Kokkos::View<T_INT *, memory_space>;
+
+    virtual ~AtomDataBase() {}
+
+    // Called by System::migrate before the atoms move (ids of all atoms
+    // handed to the distributor)
+    virtual void migrate( const Cabana::Distributor<t_device> &distributor,
+                          const t_ids ids ) = 0;
+};
+
+template <class t_device, int num_values>
+class AtomData : public AtomDataBase<t_device>
+{
+  public:
+    using memory_space = typename t_device::memory_space;
+    using exe_space = typename t_device::execution_space;
+    using t_ids = typename AtomDataBase<t_device>::t_ids;
+    using t_map = Kokkos::UnorderedMap<T_INT, T_INT, t_device>;
+
+    // Atom id and its values
+    using t_entries =
+        Cabana::AoSoA<Cabana::MemberTypes<T_INT, T_FLOAT[num_values]>,
+                      t_device>;
+    t_entries entries;
+
+    AtomData()
+        : entries( "AtomData::entries", 0 )
+    {
+    }
+
+    std::size_t size() const { return entries.size(); }
+
+    // Hash the entry of every id; returns the map for local lookups
+    const t_map &map_entries()
+    {
+        if ( map.capacity() < entries.size() )
+            map.rehash( entries.size() );
+        map.clear();
+        auto id = Cabana::slice<0>( entries );
+        auto map_copy = map;
+        Kokkos::parallel_for(
+            "AtomData::map_entries",
+            Kokkos::RangePolicy<exe_space>( 0, entries.size() ),
+            KOKKOS_LAMBDA( const int e ) { map_copy.insert( id( e ), e ); } );
+        return map;
+    }
+
+    void migrate( const Cabana::Distributor<t_device> &distributor,
+                  const t_ids ids ) override
+    {
+        const T_INT n = distributor.exportSize();
+
+        // New rank of every atom from the export steering
+        Kokkos::View<int *, memory_space> atom_rank( "AtomData::atom_rank",
+                                                     n );
+        Kokkos::deep_copy( atom_rank, -1 );
+        auto steering = distributor.getExportSteering();
+        std::vector<int> neighbors( distributor.numNeighbor() );
+        std::size_t offset = 0;
+        for ( int k = 0; k < distributor.numNeighbor(); k++ )
+        {
+            const int rank = distributor.neighborRank( k );
+            neighbors[k] = rank;
+            Kokkos::parallel_for(
+                "AtomData::atom_rank",
+                Kokkos::RangePolicy<exe_space>(
+                    offset, offset + distributor.numExport( k ) ),
+                KOKKOS_LAMBDA( const int e ) {
+                    atom_rank( steering( e ) ) = rank;
+                } );
+            offset += distributor.numExport( k );
+        }
+
+        if ( map.capacity() < (std::size_t)n )
+            map.rehash( n );
+        map.clear();
+        auto map_copy = map;
+        Kokkos::parallel_for(
+            "AtomData::map_ids", Kokkos::RangePolicy<exe_space>( 0, n ),
+            KOKKOS_LAMBDA( const int i ) { map_copy.insert( ids( i ), i ); } );
+
+        // Entries of removed atoms are removed too
+        auto id = Cabana::slice<0>( entries );
+        Kokkos::View<int *, memory_space> export_rank( "AtomData::export_rank",
+                                                       entries.size() );
+        Kokkos::parallel_for(
+            "AtomData::export_rank",
+            Kokkos::RangePolicy<exe_space>( 0, entries.size() ),
+            KOKKOS_LAMBDA( const int e ) {
+                const auto m = map_copy.find( id( e ) );
+                export_rank( e ) =
+                    map_copy.valid_at( m ) ? atom_rank( map_copy.value_at( m ) )
+                                           : -1;
+            } );
+
+        Cabana::Distributor<t_device> entry_distributor(
+            distributor.comm(), export_rank, neighbors );
+        Cabana::migrate( entry_distributor, entries );
+    }
+
+  private:
+    t_map map;
+};
+
+#endif
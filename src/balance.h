@@ -0,0 +1,60 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef BALANCE_H
+#define BALANCE_H
+
+#include <Kokkos_Core.hpp>
+
+#include <comm_mpi.h>
+#include <types.h>
+
+#include <array>
+#include <vector>
+
+// Shift load balancer: moves the sub domain boundary planes of the
+// (unchanged) process grid so each slab along a dimension holds an equal
+// share of the atoms.
+template <class t_System>
+class Balance
+{
+  private:
+    using memory_space = typename t_System::memory_space;
+    using exe_space = typename t_System::execution_space;
+
+    Comm<t_System> *comm;
+
+    T_X_FLOAT min_width;
+    T_FLOAT thresh;
+    std::array<bool, 3> dims;
+    int bins_per_rank;
+
+    // Boundary planes per dimension: ranks_per_dim + 1 values each
+    std::array<std::vector<double>, 3> cuts;
+    Kokkos::View<T_INT *, memory_space> hist;
+
+    void init_cuts( t_System *system );
+    bool balance_dim( t_System *system, int d );
+
+  public:
+    T_FLOAT imbalance;
+
+    Balance( Comm<t_System> *comm_, T_X_FLOAT min_width_, T_FLOAT thresh_,
+             std::array<bool, 3> dims_ );
+
+    T_FLOAT compute_imbalance( t_System *system );
+    bool balance( t_System *system );
+
+    const char *name();
+};
+
+#include <balance_impl.h>
+#endif
@@ -0,0 +1,161 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#include <algorithm>
+
+template <class t_System>
+Balance<t_System>::Balance( Comm<t_System> *comm_, T_X_FLOAT min_width_,
+                            T_FLOAT thresh_, std::array<bool, 3> dims_ )
+    : comm( comm_ )
+    , min_width( min_width_ )
+    , thresh( thresh_ )
+    , dims( dims_ )
+    , bins_per_rank( 64 )
+    , imbalance( 1.0 )
+{
+}
+
+template <class t_System>
+void Balance<t_System>::init_cuts( t_System *system )
+{
+    // The domain starts as the uniform Cajita partition
+    const double lo[3] = {system->local_mesh_lo_x, system->local_mesh_lo_y,
+                          system->local_mesh_lo_z};
+    const double width[3] = {system->local_mesh_x, system->local_mesh_y,
+                             system->local_mesh_z};
+    for ( int d = 0; d < 3; d++ )
+    {
+        int nranks = system->ranks_per_dim[d];
+        double low = lo[d] - system->rank_dim_pos[d] * width[d];
+        cuts[d].resize( nranks + 1 );
+        for ( int k = 0; k <= nranks; k++ )
+            cuts[d][k] = low + k * width[d];
+    }
+}
+
+template <class t_System>
+T_FLOAT Balance<t_System>::compute_imbalance( t_System *system )
+{
+    T_INT N_max = system->N_local;
+    T_INT N_total = system->N_local;
+    comm->reduce_max_int( &N_max, 1 );
+    comm->reduce_int( &N_total, 1 );
+
+    T_FLOAT N_avg = 1.0 * N_total / comm->num_processes();
+    imbalance = N_avg > 0 ? N_max / N_avg : 1.0;
+    return imbalance;
+}
+
+template <class t_System>
+bool Balance<t_System>::balance_dim( t_System *system, int d )
+{
+    int nranks = system->ranks_per_dim[d];
+    int nbins = bins_per_rank * nranks;
+    double lo = cuts[d][0];
+    double bin_width = ( cuts[d][nranks] - lo ) / nbins;
+
+    // Global atom histogram along d
+    if ( hist.extent( 0 ) < (unsigned)nbins )
+        Kokkos::realloc( hist, nbins );
+    Kokkos::deep_copy( hist, 0 );
+
+    system->slice_x();
+    auto x = system->x;
+    auto hist_copy = hist;
+    Kokkos::parallel_for(
+        "Balance::histogram",
+        Kokkos::RangePolicy<exe_space>( 0, system->N_local ),
+        KOKKOS_LAMBDA( const int i ) {
+            int b = ( x( i, d ) - lo ) / bin_width;
+            b = MAX( 0, MIN( b, nbins - 1 ) );
+            Kokkos::atomic_increment( &hist_copy( b ) );
+        } );
+    auto hist_host =
+        Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(), hist );
+    comm->reduce_int( hist_host.data(), nbins );
+
+    T_INT N_total = 0;
+    for ( int b = 0; b < nbins; b++ )
+        N_total += hist_host( b );
+    if ( N_total == 0 )
+        return false;
+
+    // Place each interior plane at an equal share of the cumulative count
+    std::vector<double> new_cuts( cuts[d] );
+    T_INT sum = 0;
+    int b = 0;
+    for ( int k = 1; k < nranks; k++ )
+    {
+        T_FLOAT target = 1.0 * k * N_total / nranks;
+        while ( b < nbins && sum + hist_host( b ) < target )
+            sum += hist_host( b++ );
+        T_FLOAT frac =
+            b < nbins && hist_host( b ) > 0
+                ? ( target - sum ) / hist_host( b )
+                : 0.0;
+        new_cuts[k] = lo + ( b + frac ) * bin_width;
+
+        // Move at most half way into a neighbor slab so every atom migrates
+        // at most one rank per dimension in Comm::exchange
+        double lower = 0.5 * ( cuts[d][k - 1] + cuts[d][k] );
+        double upper = 0.5 * ( cuts[d][k] + cuts[d][k + 1] );
+        new_cuts[k] = MAX( lower, MIN( new_cuts[k], upper ) );
+    }
+
+    // Every slab must remain wider than the halo depth
+    for ( int k = 1; k < nranks; k++ )
+        new_cuts[k] = MAX( new_cuts[k], new_cuts[k - 1] + min_width );
+    for ( int k = nranks - 1; k > 0; k-- )
+        new_cuts[k] = MIN( new_cuts[k], new_cuts[k + 1] - min_width );
+    for ( int k = 1; k <= nranks; k++ )
+        if ( new_cuts[k] - new_cuts[k - 1] < min_width )
+            return false;
+
+    cuts[d] = new_cuts;
+    return true;
+}
+
+template <class t_System>
+bool Balance<t_System>::balance( t_System *system )
+{
+    profile_push( "Balance::balance" );
+
+    if ( cuts[0].empty() )
+        init_cuts( system );
+
+    bool changed = false;
+    if ( compute_imbalance( system ) > thresh )
+    {
+        for ( int d = 0; d < 3; d++ )
+            if ( dims[d] && system->ranks_per_dim[d] > 1 )
+                changed = balance_dim( system, d ) || changed;
+    }
+
+    if ( changed )
+    {
+        std::array<double, 3> low_corner, high_corner;
+        for ( int d = 0; d < 3; d++ )
+        {
+            low_corner[d] = cuts[d][system->rank_dim_pos[d]];
+            high_corner[d] = cuts[d][system->rank_dim_pos[d] + 1];
+        }
+        system->set_local_domain( low_corner, high_corner );
+    }
+
+    profile_pop();
+    return changed;
+}
+
+template <class t_System>
+const char *Balance<t_System>::name()
+{
+    return "Balance:Shift";
+}
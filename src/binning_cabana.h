@@ -49,18 +49,32 @@
 #ifndef BINNING_CABANA_H
 #define BINNING_CABANA_H
 
+#include <Cabana_Core.hpp>
+
+#include <profile.h>
 #include <types.h>
 
 template <class t_System>
 class Binning
 {
+    using device_type = typename t_System::device_type;
+
     t_System *system;
+    int binning_type;
+
+    void sort_morton( int begin, int end, T_X_FLOAT dx, T_X_FLOAT dy,
+                      T_X_FLOAT dz );
 
   public:
     T_INT nbinx, nbiny, nbinz, nhalo;
     T_X_FLOAT minx, maxx, miny, maxy, minz, maxz;
 
-    Binning( t_System *s );
+    // Bins of the last local and ghost-only binnings, kept for neighbor
+    // construction. After a sort the local atoms are stored in bin order.
+    Cabana::LinkedCellList<device_type> cell_list, ghost_cell_list;
+    bool sorted = false;
+
+    Binning( t_System *s, int binning_type_ = BINNING_LINKEDCELL );
     void create_binning( T_X_FLOAT dx, T_X_FLOAT dy, T_X_FLOAT dz,
                          int halo_depth, bool do_local, bool do_ghost,
                          bool sort );
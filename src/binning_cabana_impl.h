@@ -48,12 +48,58 @@
 
 #include <Cabana_Core.hpp>
 
+#include <cstdint>
+
+// Interleave the low 16 bits of each cell index (Z-order curve)
+KOKKOS_INLINE_FUNCTION
+uint64_t morton_spread( uint64_t v )
+{
+    v &= 0xffff;
+    v = ( v | v << 16 ) & 0x0000ff0000ffULL;
+    v = ( v | v << 8 ) & 0x00f00f00f00fULL;
+    v = ( v | v << 4 ) & 0x0c30c30c30c3ULL;
+    v = ( v | v << 2 ) & 0x249249249249ULL;
+    return v;
+}
+
 template <class t_System>
-Binning<t_System>::Binning( t_System *s )
+Binning<t_System>::Binning( t_System *s, int binning_type_ )
     : system( s )
+    , binning_type( binning_type_ )
 {
 }
 
+// Sort [begin,end) along a Morton curve over cells of the given size
+template <class t_System>
+void Binning<t_System>::sort_morton( int begin, int end, T_X_FLOAT dx,
+                                     T_X_FLOAT dy, T_X_FLOAT dz )
+{
+    using exe_space = typename t_System::execution_space;
+
+    system->slice_x();
+    auto x = system->x;
+    T_X_FLOAT lo_x = minx, lo_y = miny, lo_z = minz;
+
+    Kokkos::View<uint64_t *, device_type> keys( "Binning::morton_keys", end );
+    Kokkos::parallel_for(
+        "Binning::morton_keys", Kokkos::RangePolicy<exe_space>( begin, end ),
+        KOKKOS_LAMBDA( const int i ) {
+            T_X_FLOAT c[3] = {( x( i, 0 ) - lo_x ) / dx,
+                              ( x( i, 1 ) - lo_y ) / dy,
+                              ( x( i, 2 ) - lo_z ) / dz};
+            uint64_t key = 0;
+            for ( int d = 0; d < 3; d++ )
+            {
+                uint64_t cell = c[d] > 0.0 ? uint64_t( c[d] ) : 0;
+                key |= morton_spread( cell < 0xffff ? cell : 0xffff ) << d;
+            }
+            keys( i ) = key;
+        } );
+
+    auto bin_data = Cabana::sortByKey( keys, begin, end );
+    system->permute( bin_data );
+}
+
 template <class t_System>
 void Binning<t_System>::create_binning( T_X_FLOAT dx_in, T_X_FLOAT dy_in,
                                         T_X_FLOAT dz_in, int halo_depth,
@@ -62,6 +108,7 @@ void Binning<t_System>::create_binning( T_X_FLOAT dx_in, T_X_FLOAT dy_in,
 {
     if ( do_local || do_ghost )
     {
+        ProfileRegion region( "Binning::create" );
         nhalo = halo_depth;
         int begin = do_local ? 0 : system->N_local;
         int end =
@@ -101,13 +148,34 @@ void Binning<t_System>::create_binning( T_X_FLOAT dx_in, T_X_FLOAT dy_in,
         system->slice_x();
         auto x = system->x;
 
-        using device_type = typename t_System::device_type;
-        Cabana::LinkedCellList<device_type> cell_list( x, begin, end, delta,
-                                                       min, max );
+        // Curve order over half size cells; no cell list is kept, so
+        // lists built from the Binning cells are not available
+        if ( sort && binning_type == BINNING_MORTON )
+        {
+            ProfileRegion sort_region( "sort" );
+            sort_morton( begin, end, dx / 2, dy / 2, dz / 2 );
+            if ( do_local )
+                sorted = false;
+            return;
+        }
+
+        Cabana::LinkedCellList<device_type> bins( x, begin, end, delta, min,
+                                                  max );
 
         if ( sort )
         {
-            system->permute( cell_list );
+            ProfileRegion sort_region( "sort" );
+            system->permute( bins );
+        }
+
+        if ( do_local )
+        {
+            cell_list = bins;
+            sorted = sort;
+        }
+        else
+        {
+            ghost_cell_list = bins;
         }
     }
 }
@@ -115,5 +183,7 @@ void Binning<t_System>::create_binning( T_X_FLOAT dx_in, T_X_FLOAT dy_in,
 template <class t_System>
 const char *Binning<t_System>::name()
 {
+    if ( binning_type == BINNING_MORTON )
+        return "Binning:CabanaMorton";
     return "Binning:CabanaLinkedCell";
 }
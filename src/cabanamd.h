@@ -49,20 +49,52 @@
 #ifndef CABANAMD_H
 #define CABANAMD_H
 
+#include <balance.h>
 #include <binning_cabana.h>
 #include <comm_mpi.h>
+#include <correctness.h>
+#include <dump_binary.h>
 #include <force.h>
+#include <force_angle_harmonic.h>
+#include <force_bond_harmonic.h>
 #include <inputCL.h>
 #include <inputFile.h>
 #include <integrator_nve.h>
+#include <integrator_nvt.h>
+#include <integrator_respa.h>
+#include <memory_usage.h>
+#include <monitor.h>
+#include <property_count_type.h>
+#include <property_msd.h>
+#include <property_rdf.h>
+#include <property_replica.h>
+#include <restart.h>
 #include <types.h>
 
+#ifdef Cabana_ENABLE_HEFFTE
+#include <kspace_pppm.h>
+#endif
+
 class CabanaMD
 {
   public:
     bool _print_lammps = false;
     int nsteps;
 
+    // Timings (rank local, seconds) and atom count of the last run
+    struct Timings
+    {
+        double total = 0.0;
+        double force = 0.0;
+        double neigh = 0.0;
+        double comm = 0.0;
+        double integrate = 0.0;
+        double other = 0.0;
+    } timings;
+    long natoms = 0;
+
+    virtual ~CabanaMD() {}
+
     virtual void init( InputCL cl ) = 0;
     virtual void run() = 0;
 
@@ -74,19 +106,59 @@ template <class t_System, class t_Neighbor>
 class CbnMD : public CabanaMD
 {
   public:
-    t_System *system;
-    t_Neighbor *neighbor;
-    Force<t_System, t_Neighbor> *force;
-    Integrator<t_System> *integrator;
-    Comm<t_System> *comm;
-    Binning<t_System> *binning;
-    InputFile<t_System> *input;
+    t_System *system = nullptr;
+    t_Neighbor *neighbor = nullptr;
+    Force<t_System, t_Neighbor> *force = nullptr;
+    Integrator<t_System> *integrator = nullptr;
+    // r-RESPA: short cutoff LJ inner force and the outer force kicks
+    Force<t_System, t_Neighbor> *force_inner = nullptr;
+    IntegratorRESPA<t_System> *respa = nullptr;
+    ThermostatNoseHoover<t_System> *nose_hoover = nullptr;
+    ThermostatLangevin<t_System> *langevin = nullptr;
+    Comm<t_System> *comm = nullptr;
+    Balance<t_System> *balance = nullptr;
+    Binning<t_System> *binning = nullptr;
+    DumpBinary<t_System> *dump = nullptr;
+    Correctness<t_System> *correctness = nullptr;
+    InputFile<t_System> *input = nullptr;
+#ifdef Cabana_ENABLE_HEFFTE
+    PPPM<t_System, t_Neighbor> *kspace = nullptr;
+#endif
+    ForceBondHarmonic<t_System> *bond = nullptr;
+    ForceAngleHarmonic<t_System> *angle = nullptr;
+    // Per replica thermo output (--replicas)
+    ReplicaThermo<t_System> *replica_thermo = nullptr;
+    std::string replica_file;
+    // In-situ analysis (compute commands), written at the end of the run
+    std::vector<Analysis<t_System, t_Neighbor> *> analyses;
+    // Steering socket of rank 0 (--monitor), polled on thermo steps
+    Monitor *monitor = nullptr;
+
+    ~CbnMD();
 
     void init( InputCL cl ) override;
     void run() override;
 
     void dump_binary( int ) override;
     void check_correctness( int ) override;
+
+    void compute_outer( bool thermo, bool update_force );
+    // Long range Coulomb forces (kspace_style), before ghost forces are
+    // scattered
+    void compute_kspace( bool thermo );
+    // Bonds and angles of owned atoms (no ghost forces)
+    void compute_bonded( bool thermo );
+    // Local and ghost indices of the bonded atoms after exchange_halo
+    void resolve_topology();
+    // Append the thermo line of every replica to replica_file
+    void write_replicas( int step );
+    // Analyses of the compute lines of the input file
+    void create_analyses();
+    // Apply the output rate changes and checkpoint requests of the monitor,
+    // logged to out (the buffered thermo lines)
+    void steer( int step, std::ostream &out );
+    // Thermostat state stored in restart files
+    RestartThermostat restart_thermostat();
 };
 
 #include <cabanamd_impl.h>
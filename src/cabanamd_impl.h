@@ -52,29 +52,68 @@
 #include <Kokkos_Core.hpp>
 
 #include <output.h>
-#include <property_kine.h>
-#include <property_pote.h>
+#include <profile.h>
 #include <property_temperature.h>
+#include <property_thermo.h>
 #include <read_data.h>
+#include <restart.h>
 
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
+#include <vector>
 
-#define MAXPATHLEN 1024
+template <class t_System, class t_Neighbor>
+CbnMD<t_System, t_Neighbor>::~CbnMD()
+{
+    delete dump;
+    delete correctness;
+    delete nose_hoover;
+    delete langevin;
+    delete respa;
+    delete force_inner;
+    delete force;
+    delete integrator;
+    delete neighbor;
+    delete binning;
+    delete balance;
+    delete bond;
+    delete angle;
+    delete replica_thermo;
+    for ( auto analysis : analyses )
+        delete analysis;
+    delete monitor;
+#ifdef Cabana_ENABLE_HEFFTE
+    delete kspace;
+#endif
+    if ( comm )
+        comm->free_halo_plan();
+    delete comm;
+    delete input;
+    delete system;
+}
 
 template <class t_System, class t_Neighbor>
 void CbnMD<t_System, t_Neighbor>::init( InputCL commandline )
 {
+    // Count allocations from the first one on
+    if ( commandline.memory_report )
+        memory_enable();
+
     // Create the System class: atom properties (AoSoA) and simulation box
     system = new t_System;
     system->init();
+    system->decomposition = commandline.decomposition_type;
 
     // Create the Input class: Command line and LAMMPS input file
     input = new InputFile<t_System>( commandline, system );
     // Read input file
     input->read_file();
     nsteps = input->nsteps;
+    profile_enable( commandline.timers );
+    if ( !commandline.timers_csv.empty() )
+        profile_csv( commandline.timers_csv );
     std::ofstream out( input->output_file, std::ofstream::app );
     std::ofstream err( input->error_file, std::ofstream::app );
     log( out, "Read input file." );
@@ -94,17 +133,47 @@ void CbnMD<t_System, t_Neighbor>::init( InputCL commandline )
     bool half_neigh = input->force_iteration_type == FORCE_ITER_NEIGH_HALF;
 
     // Create Communication class: MPI
-    comm = new Comm<t_System>( system, neigh_cutoff );
-
-    // Create Integrator class: NVE ensemble
-    integrator = new Integrator<t_System>( system );
+    comm = new Comm<t_System>( system, neigh_cutoff, input->comm_type,
+                               commandline.gpu_aware_mpi );
+
+    // Create Balance class: shift sub domain boundaries (fix balance)
+    if ( input->balance_rate > 0 )
+        balance = new Balance<t_System>( comm, neigh_cutoff,
+                                         input->balance_thresh,
+                                         input->balance_dims );
+
+    // Create Integrator class: NVE ensemble, optionally with r-RESPA outer
+    // force kicks around the inner velocity Verlet steps
+    if ( input->integrator_type == INTEGRATOR_RESPA )
+    {
+        respa = new IntegratorRESPA<t_System>(
+            system, input->respa_loop, input->force_type == FORCE_LJ );
+        integrator =
+            new Integrator<t_System>( system, respa->inner_timestep( system ) );
+    }
+    else
+        integrator = new Integrator<t_System>( system );
+
+    // Create Thermostat class: fix nvt or fix langevin
+    if ( input->thermostat_type != THERMOSTAT_NONE && respa )
+        log_err( err, "Thermostats are not supported with r-RESPA" );
+    if ( input->thermostat_type == THERMOSTAT_NOSE_HOOVER )
+        nose_hoover = new ThermostatNoseHoover<t_System>(
+            system, input->thermostat_t_start, input->thermostat_t_stop,
+            input->thermostat_t_damp );
+    else if ( input->thermostat_type == THERMOSTAT_LANGEVIN )
+        langevin = new ThermostatLangevin<t_System>(
+            system, input->thermostat_t_start, input->thermostat_t_stop,
+            input->thermostat_t_damp, input->thermostat_seed );
 
     // Create Binning class: linked cell bin sort
-    binning = new Binning<t_System>( system );
+    binning = new Binning<t_System>( system, input->binning_type );
 
     // Create Neighbor class: create neighbor list
     neighbor =
         new t_Neighbor( neigh_cutoff, half_neigh, input->max_neigh_guess );
+    neighbor->split_interior = input->overlap_comm;
+    neighbor->binning = binning;
 
     // Create Force class: potential options in force_types/ folder
     bool serial_neigh =
@@ -119,6 +188,44 @@ void CbnMD<t_System, t_Neighbor>::init( InputCL commandline )
         else if ( team_neigh )
             force =
                 new ForceLJ<t_System, t_Neighbor, Cabana::TeamOpTag>( system );
+        else
+            force = new ForceLJ<t_System, t_Neighbor, Cabana::TeamVectorOpTag>(
+                system );
+    }
+    else if ( input->force_type == FORCE_TABLE )
+    {
+        if ( input->table_style == TABLE_SPLINE )
+        {
+            if ( serial_neigh )
+                force = new ForceTable<t_System, t_Neighbor,
+                                       Cabana::SerialOpTag, TableSplineTag>(
+                    system );
+            else if ( team_neigh )
+                force = new ForceTable<t_System, t_Neighbor, Cabana::TeamOpTag,
+                                       TableSplineTag>( system );
+        }
+        else
+        {
+            if ( serial_neigh )
+                force = new ForceTable<t_System, t_Neighbor,
+                                       Cabana::SerialOpTag, TableLinearTag>(
+                    system );
+            else if ( team_neigh )
+                force = new ForceTable<t_System, t_Neighbor, Cabana::TeamOpTag,
+                                       TableLinearTag>( system );
+        }
+    }
+    else if ( input->force_type == FORCE_EAM )
+    {
+        if ( half_neigh )
+            log_err( err, "Half neighbor list not implemented "
+                          "for the embedded atom method." );
+        else if ( serial_neigh )
+            force = new ForceEAM<t_System, t_Neighbor, Cabana::SerialOpTag>(
+                system, comm );
+        else if ( team_neigh )
+            force = new ForceEAM<t_System, t_Neighbor, Cabana::TeamOpTag>(
+                system, comm );
     }
 #ifdef CabanaMD_ENABLE_NNP
 #include <system_nnp.h>
@@ -126,46 +233,49 @@ void CbnMD<t_System, t_Neighbor>::init( InputCL commandline )
     {
         bool vector_angle =
             input->force_neigh_parallel_type == FORCE_PARALLEL_NEIGH_VECTOR;
-        if ( half_neigh )
-            log_err( err, "Half neighbor list not implemented "
-                          "for the neural network potential." );
-        else
-        {
-            using t_device = typename t_System::device_type;
-#if ( CabanaMD_LAYOUT_NNP == 1 )
-            if ( serial_neigh )
-                force =
-                    new ForceNNP<t_System, System_NNP<t_device, 1>, t_Neighbor,
+        // Half lists need the in-tree symmetry functions (checked by
+        // the force)
+        using t_device = typename t_System::device_type;
+#if defined( CabanaMD_NNP_COMPACT )
+        if ( serial_neigh )
+            force = new ForceNNP<t_System, System_NNP<t_device, 0>, t_Neighbor,
                                  Cabana::SerialOpTag, Cabana::SerialOpTag>(
-                        system );
-            if ( team_neigh )
-                force =
-                    new ForceNNP<t_System, System_NNP<t_device, 1>, t_Neighbor,
+                system );
+        if ( team_neigh )
+            force = new ForceNNP<t_System, System_NNP<t_device, 0>, t_Neighbor,
                                  Cabana::TeamOpTag, Cabana::TeamOpTag>(
-                        system );
-            if ( vector_angle )
-                force =
-                    new ForceNNP<t_System, System_NNP<t_device, 1>, t_Neighbor,
+                system );
+        if ( vector_angle )
+            force = new ForceNNP<t_System, System_NNP<t_device, 0>, t_Neighbor,
                                  Cabana::TeamOpTag, Cabana::TeamVectorOpTag>(
-                        system );
+                system );
+#elif ( CabanaMD_LAYOUT_NNP == 1 )
+        if ( serial_neigh )
+            force = new ForceNNP<t_System, System_NNP<t_device, 1>, t_Neighbor,
+                                 Cabana::SerialOpTag, Cabana::SerialOpTag>(
+                system );
+        if ( team_neigh )
+            force = new ForceNNP<t_System, System_NNP<t_device, 1>, t_Neighbor,
+                                 Cabana::TeamOpTag, Cabana::TeamOpTag>(
+                system );
+        if ( vector_angle )
+            force = new ForceNNP<t_System, System_NNP<t_device, 1>, t_Neighbor,
+                                 Cabana::TeamOpTag, Cabana::TeamVectorOpTag>(
+                system );
 #elif ( CabanaMD_LAYOUT_NNP == 3 )
-            if ( serial_neigh )
-                force =
-                    new ForceNNP<t_System, System_NNP<t_device, 3>, t_Neighbor,
+        if ( serial_neigh )
+            force = new ForceNNP<t_System, System_NNP<t_device, 3>, t_Neighbor,
                                  Cabana::SerialOpTag, Cabana::SerialOpTag>(
-                        system );
-            if ( team_neigh )
-                force =
-                    new ForceNNP<t_System, System_NNP<t_device, 3>, t_Neighbor,
+                system );
+        if ( team_neigh )
+            force = new ForceNNP<t_System, System_NNP<t_device, 3>, t_Neighbor,
                                  Cabana::TeamOpTag, Cabana::TeamOpTag>(
-                        system );
-            if ( vector_angle )
-                force =
-                    new ForceNNP<t_System, System_NNP<t_device, 3>, t_Neighbor,
+                system );
+        if ( vector_angle )
+            force = new ForceNNP<t_System, System_NNP<t_device, 3>, t_Neighbor,
                                  Cabana::TeamOpTag, Cabana::TeamVectorOpTag>(
-                        system );
+                system );
 #endif
-        }
     }
 #endif
     else
@@ -174,18 +284,147 @@ void CbnMD<t_System, t_Neighbor>::init( InputCL commandline )
     }
     force->init_coeff( input->force_coeff_lines );
 
-    log( out, "Using: SystemVectorLength: ", CabanaMD_VECTORLENGTH, " ",
-         system->name() );
+    // Create the r-RESPA inner force: LJ cut at the inner cutoff, from the
+    // lj/cut coefficients (subtracted from the full LJ outer force) or from
+    // lj/cut baseline coefficients (added to the outer force)
+    if ( respa )
+    {
+        auto inner_lines = input->respa_coeff_lines;
+        if ( input->force_type == FORCE_LJ )
+            inner_lines = input->force_coeff_lines;
+        if ( inner_lines.empty() )
+            log_err( err, "r-RESPA requires pair_style lj/cut or lj/cut "
+                          "baseline coefficients for the inner force" );
+        if ( input->respa_inner_cutoff <= 0.0 ||
+             input->respa_inner_cutoff > input->force_cutoff )
+            log_err( err, "r-RESPA inner cutoff must be positive and within "
+                          "the pair cutoff" );
+        for ( auto &line : inner_lines )
+        {
+            line.resize( 6 );
+            line.at( 5 ) = std::to_string( input->respa_inner_cutoff );
+        }
+
+        if ( serial_neigh )
+            force_inner =
+                new ForceLJ<t_System, t_Neighbor, Cabana::SerialOpTag>(
+                    system );
+        else
+            force_inner =
+                new ForceLJ<t_System, t_Neighbor, Cabana::TeamOpTag>( system );
+        force_inner->init_coeff( inner_lines );
+    }
+
+    // Long range electrostatics: the real space part runs on the pair
+    // neighbor list, the mesh part on its own Cajita grid (created with the
+    // atoms)
+    if ( input->kspace_type == KSPACE_PPPM )
+    {
+#ifndef Cabana_ENABLE_HEFFTE
+        log_err( err, "kspace_style pppm requested, but Cabana was not "
+                      "compiled with heFFTe!" );
+#endif
+        if ( respa || balance )
+            log_err( err, "kspace_style pppm is not supported with r-RESPA "
+                          "or fix balance" );
+        if ( input->coul_cutoff <= 0.0 || !system->has_charge() )
+            log_err( err, "kspace_style pppm requires pair_style "
+                          "lj/cut/coul/long and atom_style charge" );
+    }
+    else if ( input->coul_cutoff > 0.0 )
+        log_err( err, "pair_style lj/cut/coul/long requires kspace_style "
+                      "pppm" );
+    if ( system->has_topology() && respa )
+        log_err( err, "Bonds and angles are not supported with r-RESPA" );
+    if ( ( input->bond_style != BOND_NONE ||
+           input->angle_style != ANGLE_NONE ) &&
+         !system->has_topology() )
+        log_err( err, "bond_style and angle_style need a molecular "
+                      "atom_style" );
+    if ( input->write_restart_flag && system->has_topology() )
+        log_err( err, "write_restart does not store bonds and angles; use "
+                      "write_data" );
+
+    // Replicas are separate boxes of one lattice system along x, so nothing
+    // may couple them or move their boundaries
+    system->replicas = commandline.replicas;
+    if ( system->replicas > 1 )
+    {
+        if ( input->read_data_flag || input->read_restart_flag )
+            log_err( err, "--replicas requires a lattice created by "
+                          "create_atoms" );
+        if ( balance || nose_hoover || input->overlap_comm ||
+             input->kspace_type != KSPACE_NONE || system->has_topology() )
+            log_err( err, "--replicas is not supported with fix balance, "
+                          "fix nvt, --overlap-comm, kspace_style or "
+                          "molecular atom styles" );
+        replica_thermo =
+            new ReplicaThermo<t_System>( comm, system->replicas );
+        replica_file = commandline.replica_file;
+    }
+
+    if ( t_System::selected_vector_length() > 0 )
+        log( out, "Using: SystemVectorLength: ",
+             t_System::selected_vector_length(), " ", system->name() );
+    else
+        log( out, "Using: SystemVectorLength: ", CabanaMD_VECTORLENGTH, " ",
+             system->name() );
 #ifdef CabanaMD_ENABLE_NNP
     if ( input->force_type == FORCE_NNP )
+    {
         log( out, "Using: SystemNNPVectorLength: ", CabanaMD_VECTORLENGTH_NNP,
              " ", force->system_name() );
+#ifdef CabanaMD_ENABLE_NNP_FLOAT
+        log( out, "Using: NNPPrecision: float" );
+#endif
+    }
 #endif
     log( out, "Using: ", force->name(), " ", neighbor->name(), " ",
          comm->name(), " ", binning->name(), " ", integrator->name() );
+    if ( respa )
+        log( out, "Using: ", respa->name(), " ", respa->loop, " ",
+             force_inner->name() );
+    if ( nose_hoover )
+        log( out, "Using: ", nose_hoover->name() );
+    if ( langevin )
+        log( out, "Using: ", langevin->name() );
+    if ( balance )
+        log( out, "Using: ", balance->name() );
+    if ( system->decomposition == DECOMPOSITION_NODE )
+        log( out, "Using: Node blocked decomposition ",
+             system->ranks_per_dim[0], "x", system->ranks_per_dim[1], "x",
+             system->ranks_per_dim[2] );
+    if ( comm->staged_halo() )
+        log( out, "Using: Halo staged through host memory (no GPU-aware "
+                  "MPI)" );
+    if ( profile_enabled() )
+        log( out, "Using: Timers (regions fenced)" );
+    if ( !commandline.monitor_socket.empty() )
+    {
+        monitor = new Monitor( commandline.monitor_socket );
+        log( out, "Using: Monitor socket ", commandline.monitor_socket,
+             " (polled every thermo step)" );
+    }
 
-    // Create atoms - from LAMMPS data file or create FCC/SC lattice
-    if ( system->N == 0 && input->read_data_flag == true )
+    create_analyses();
+    for ( auto analysis : analyses )
+        log( out, "Using: ", analysis->name(), " ", analysis->id, " every ",
+             analysis->every, " steps to ", analysis->file );
+
+    // Create atoms - from restart or LAMMPS data file or create FCC/SC lattice
+    if ( system->N == 0 && input->read_restart_flag == true )
+    {
+        RestartThermostat thermostat;
+        input->initial_step = read_restart<t_System>(
+            system, input->input_restart_file, &thermostat );
+        log( out, "Read restart file at step ", input->initial_step );
+        if ( nose_hoover && thermostat.nose_hoover )
+            nose_hoover->restore( thermostat.eta_dot, thermostat.eta_dotdot );
+        else if ( nose_hoover )
+            log( out, "Restart file has no Nose-Hoover state; the thermostat "
+                      "starts from rest" );
+    }
+    else if ( system->N == 0 && input->read_data_flag == true )
     {
         read_lammps_data_file<t_System>( input, system, comm );
     }
@@ -194,6 +433,10 @@ void CbnMD<t_System, t_Neighbor>::init( InputCL commandline )
         input->create_lattice( comm );
     }
     log( out, "Created atoms." );
+    if ( replica_thermo )
+        log( out, "Using: ", system->replicas, " replicas of ",
+             system->N / system->replicas, " atoms, spaced ",
+             system->replica_width, " along x" );
 
     // Set MPI rank neighbors
     comm->create_domain_decomposition();
@@ -201,6 +444,10 @@ void CbnMD<t_System, t_Neighbor>::init( InputCL commandline )
     // Exchange atoms across MPI ranks
     comm->exchange();
 
+    // Move sub domain boundaries and exchange again
+    if ( balance && balance->balance( system ) )
+        comm->exchange();
+
     // Sort atoms
     binning->create_binning( neigh_cutoff, neigh_cutoff, neigh_cutoff, 1, true,
                              false, true );
@@ -209,43 +456,116 @@ void CbnMD<t_System, t_Neighbor>::init( InputCL commandline )
     comm->exchange_halo();
 
     // Compute atom neighbors
+    profile_push( "Neighbor::create" );
     neighbor->create( system );
+    if ( input->neighbor_check )
+        neighbor->store_positions( system );
+    profile_pop();
 
-    // Compute initial forces
+    // Bonded styles need the type counts of the data file
+    if ( system->topology )
+    {
+        auto topology = system->topology;
+        if ( topology->nbonds > 0 && input->bond_style == BOND_NONE )
+            log_err( err, "Bonds in data file, but no bond_style" );
+        if ( topology->nangles > 0 && input->angle_style == ANGLE_NONE )
+            log_err( err, "Angles in data file, but no angle_style" );
+        if ( input->bond_style == BOND_HARMONIC )
+        {
+            bond = new ForceBondHarmonic<t_System>( system );
+            bond->init_coeff( input->bond_coeff_lines );
+        }
+        if ( input->angle_style == ANGLE_HARMONIC )
+        {
+            angle = new ForceAngleHarmonic<t_System>( system );
+            angle->init_coeff( input->angle_coeff_lines );
+        }
+        resolve_topology();
+        if ( bond )
+            log( out, "Using: ", bond->name() );
+        if ( angle )
+            log( out, "Using: ", angle->name() );
+    }
+
+#ifdef Cabana_ENABLE_HEFFTE
+    // The splitting parameter and mesh depend on the charges
+    if ( input->kspace_type == KSPACE_PPPM )
+    {
+        kspace = new PPPM<t_System, t_Neighbor>(
+            system, comm, input->kspace_accuracy, input->coul_cutoff,
+            input->kspace_mesh, input->neighbor_skin );
+        log( out, "Using: ", kspace->name(), " mesh ", kspace->mesh[0], "x",
+             kspace->mesh[1], "x", kspace->mesh[2], " g_ewald ",
+             kspace->g_ewald, " estimated force error ",
+             kspace->estimated_error );
+    }
+#endif
+
+    // Compute initial forces (the inner force for r-RESPA)
+    //   (update force for pair_style nnp even if full neighbor list)
+    bool update_force = half_neigh or input->force_type == FORCE_NNP;
+    auto fast = respa ? force_inner : force;
     system->slice_f();
     auto f = system->f;
     Cabana::deep_copy( f, 0.0 );
-    force->compute( system, neighbor );
+    if ( input->thermo_rate > 0 )
+        fast->compute_thermo( system, neighbor );
+    else
+        fast->compute( system, neighbor );
+    compute_kspace( input->thermo_rate > 0 );
+    compute_bonded( input->thermo_rate > 0 );
 
     // Scatter ghost atom forces back to original MPI rank
-    //   (update force for pair_style nnp even if full neighbor list)
-    if ( half_neigh or input->force_type == FORCE_NNP )
+    if ( respa ? half_neigh : update_force )
     {
         comm->update_force();
     }
+    if ( respa )
+        compute_outer( input->thermo_rate > 0, update_force );
+    if ( input->thermo_rate > 0 && !force->thermo_valid )
+        log( err, "Warning: ", force->name(), " computes no virial; Press ",
+             "only includes the kinetic, kspace and bonded terms." );
+    if ( langevin )
+        langevin->post_force( system, input->initial_step, 0.0 );
+    if ( nose_hoover )
+    {
+        Temperature<t_System> temp( comm );
+        nose_hoover->setup( temp.compute( system ) );
+    }
 
     // Initial output
     int step = 0;
     if ( input->thermo_rate > 0 )
     {
-        Temperature<t_System> temp( comm );
-        PotE<t_System, t_Neighbor> pote( comm );
-        KinE<t_System> kine( comm );
-        auto T = temp.compute( system );
-        auto PE = pote.compute( system, force, neighbor ) / system->N;
-        auto KE = kine.compute( system ) / system->N;
+        Thermo<t_System, t_Neighbor> thermo( comm );
+        thermo.compute( system, force, neighbor );
+        auto T = thermo.temperature;
+        auto PE = thermo.potential_energy / system->N;
+        auto KE = thermo.kinetic_energy / system->N;
+        auto P = thermo.press;
         if ( !_print_lammps )
         {
             log( out, "\n", std::fixed, std::setprecision( 6 ),
-                 "#Timestep Temperature PotE ETot Time Atomsteps/s\n", step,
-                 " ", T, " ", PE, " ", PE + KE, " ", std::setprecision( 2 ),
-                 0.0, " ", std::scientific, 0.0 );
+                 "#Timestep Temperature PotE ETot Press Time Atomsteps/s\n",
+                 step, " ", T, " ", PE, " ", PE + KE, " ", P, " ",
+                 std::setprecision( 2 ), 0.0, " ", std::scientific, 0.0 );
         }
         else
         {
-            log( out, "\nStep Temp E_pair TotEng CPU\n", step, " ", T, " ", PE,
-                 " ", PE + KE, " ", 0.0 );
+            log( out, "\nStep Temp E_pair TotEng Press CPU\n", step, " ", T,
+                 " ", PE, " ", PE + KE, " ", P, " ", 0.0 );
+        }
+    }
+
+    if ( replica_thermo )
+    {
+        if ( print_rank() )
+        {
+            std::ofstream replica_out( replica_file );
+            replica_out << "#Timestep Replica Atoms Temperature KinE\n";
         }
+        if ( input->thermo_rate > 0 )
+            write_replicas( step );
     }
 
     if ( input->dumpbinaryflag )
@@ -256,6 +576,7 @@ void CbnMD<t_System, t_Neighbor>::init( InputCL commandline )
     {
         check_correctness( step );
     }
+    memory_report( out, "after setup", system->N_local );
     out.close();
     err.close();
 }
@@ -267,10 +588,12 @@ void CbnMD<t_System, t_Neighbor>::run()
 
     auto neigh_cutoff = input->force_cutoff + input->neighbor_skin;
     bool half_neigh = input->force_iteration_type == FORCE_ITER_NEIGH_HALF;
+    //   (update force for pair_style nnp even if full neighbor list)
+    bool update_force = half_neigh or input->force_type == FORCE_NNP;
+    using exe_space = typename t_System::execution_space;
 
     Temperature<t_System> temp( comm );
-    PotE<t_System, t_Neighbor> pote( comm );
-    KinE<t_System> kine( comm );
+    Thermo<t_System, t_Neighbor> thermo( comm );
 
     double force_time = 0;
     double comm_time = 0;
@@ -282,109 +605,360 @@ void CbnMD<t_System, t_Neighbor>::run()
     Kokkos::Timer timer, force_timer, comm_timer, neigh_timer, integrate_timer,
         other_timer;
 
-    // Main timestep loop
-    for ( int step = 1; step <= nsteps; step++ )
-    {
-        // Integrate atom positions - velocity Verlet first half
-        integrate_timer.reset();
-        integrator->initial_integrate( system );
-        integrate_time += integrate_timer.seconds();
+    // The thermo reduction of a step completes during the next step; rank 0
+    // buffers the lines and flushes them once a second (or every 4 KB), so
+    // frequent thermo output does not flush every line but a slow run still
+    // shows its progress
+    std::ostringstream thermo_lines;
+    double thermo_time = 0;
+    double flush_time = 0;
+    int thermo_at = 0;
+    int last_at = 0;
+    auto write_thermo = [&]() {
+        thermo.finish( system );
+        auto T = thermo.temperature;
+        auto PE = thermo.potential_energy / system->N;
+        auto KE = thermo.kinetic_energy / system->N;
+        auto P = thermo.press;
 
-        if ( step % input->comm_exchange_rate == 0 && step > 0 )
+        if ( !_print_lammps )
         {
-            // Exchange atoms across MPI ranks
-            comm_timer.reset();
-            comm->exchange();
-            comm_time += comm_timer.seconds();
-
-            // Sort atoms
-            other_timer.reset();
-            binning->create_binning( neigh_cutoff, neigh_cutoff, neigh_cutoff,
-                                     1, true, false, true );
-            other_time += other_timer.seconds();
-
-            // Update ghost atoms (gather)
-            comm_timer.reset();
-            comm->exchange_halo();
-            comm_time += comm_timer.seconds();
-
-            // Compute atom neighbors
-            neigh_timer.reset();
-            neighbor->create( system );
-            neigh_time += neigh_timer.seconds();
+            double rate = 1.0 * system->N * ( thermo_at - last_at ) /
+                          ( thermo_time - last_time );
+            thermo_lines << std::fixed << std::setprecision( 6 ) << thermo_at
+                         << " " << T << " " << PE << " " << PE + KE << " "
+                         << P << " " << std::setprecision( 2 ) << thermo_time
+                         << " " << std::scientific << rate << "\n";
         }
         else
         {
-            // Update ghost atom positions (scatter)
-            comm_timer.reset();
-            comm->update_halo();
-            comm_time += comm_timer.seconds();
+            thermo_lines << std::fixed << std::setprecision( 6 ) << "     "
+                         << thermo_at << " " << T << " " << PE << " "
+                         << PE + KE << " " << P << " " << thermo_time << "\n";
+        }
+        if ( monitor )
+        {
+            auto &status = monitor->status;
+            status.thermo_step = thermo_at;
+            status.nsteps = nsteps;
+            status.natoms = system->N;
+            status.time = thermo_time;
+            status.temperature = T;
+            status.potential_energy = PE;
+            status.total_energy = PE + KE;
+            status.pressure = P;
+            status.atomsteps_per_sec = 1.0 * system->N *
+                                       ( thermo_at - last_at ) /
+                                       ( thermo_time - last_time );
+            status.force_time = force_time;
+            status.neigh_time = neigh_time;
+            status.comm_time = comm_time;
+            status.integrate_time = integrate_time;
+            status.other_time = other_time;
+        }
+        last_time = thermo_time;
+        last_at = thermo_at;
+
+        if ( thermo_lines.tellp() > 4096 || thermo_time - flush_time >= 1.0 )
+        {
+            if ( print_rank() )
+                out << thermo_lines.str() << std::flush;
+            thermo_lines.str( "" );
+            flush_time = thermo_time;
         }
+    };
 
-        // Reset forces
-        force_timer.reset();
-        system->slice_f();
-        auto f = system->f;
-        Cabana::deep_copy( f, 0.0 );
+    // Rebuild only once any atom moves half the skin (neigh_modify check)
+    T_FLOAT max_disp = 0.5 * input->neighbor_skin;
+    int neigh_builds = 0;
 
-        // Compute short range force
-        force->compute( system, neighbor );
-        force_time += force_timer.seconds();
+    // Inner steps per outer step and their force (r-RESPA)
+    int n_inner = respa ? respa->loop : 1;
+    auto fast = respa ? force_inner : force;
+    bool update_fast = respa ? half_neigh : update_force;
 
-        // This is where Bonds, Angles, and KSpace should go eventually
+    // First half of the step already done with the previous second half
+    bool fused = false;
+    // Local m*v^2 from the last second half, for thermo output
+    T_V_FLOAT mv2 = 0.0;
 
-        // Scatter ghost atom forces back to original MPI rank
-        //   (update force for pair_style nnp even if full neighbor list)
-        if ( half_neigh or input->force_type == FORCE_NNP )
+    // Setup regions are the step 0 rows
+    profile_step( 0 );
+
+    // Main timestep loop
+    for ( int step = 1; step <= nsteps; step++ )
+    {
+        // Outer force half kick (r-RESPA)
+        if ( respa )
         {
-            comm_timer.reset();
-            comm->update_force();
-            comm_time += comm_timer.seconds();
+            integrate_timer.reset();
+            profile_push( "Integrate" );
+            respa->outer_kick( system );
+            profile_pop();
+            integrate_time += integrate_timer.seconds();
         }
 
-        // Integrate atom positions - velocity Verlet second half
-        integrate_timer.reset();
-        integrator->final_integrate( system );
-        integrate_time += integrate_timer.seconds();
+        bool thermo_step = step % input->thermo_rate == 0;
+        for ( int sub = 1; sub <= n_inner; sub++ )
+        {
+            // Atoms are only exchanged and sorted right before the outer
+            // force, since the stored outer force follows the atom order
+            bool last_sub = sub == n_inner;
+            bool thermo_sub = thermo_step && last_sub;
 
-        other_timer.reset();
+            // Integrate atom positions - velocity Verlet first half
+            if ( !fused )
+            {
+                integrate_timer.reset();
+                profile_push( "Integrate" );
+                if ( nose_hoover )
+                    integrator->vscale = nose_hoover->initial_integrate(
+                        1.0 * step / nsteps );
+                integrator->initial_integrate( system );
+                profile_pop();
+                integrate_time += integrate_timer.seconds();
+            }
+            fused = false;
 
-        // Print output
-        if ( step % input->thermo_rate == 0 )
-        {
-            auto T = temp.compute( system );
-            auto PE = pote.compute( system, force, neighbor ) / system->N;
-            auto KE = kine.compute( system ) / system->N;
+            bool rebuild = last_sub && step % input->comm_exchange_rate == 0 &&
+                           step > 0;
+            if ( rebuild && input->neighbor_check )
+            {
+                neigh_timer.reset();
+                profile_push( "Neighbor::check" );
+                T_FLOAT disp = neighbor->max_displacement( system );
+                comm->reduce_max_float( &disp, 1 );
+                rebuild = disp > max_disp;
+                profile_pop();
+                neigh_time += neigh_timer.seconds();
+            }
+
+            // Moved sub domain boundaries require a full rebuild
+            if ( balance && last_sub && step % input->balance_rate == 0 )
+            {
+                comm_timer.reset();
+                if ( balance->balance( system ) )
+                    rebuild = true;
+                comm_time += comm_timer.seconds();
+            }
+
+            if ( rebuild )
+            {
+                // Exchange atoms across MPI ranks
+                comm_timer.reset();
+                comm->exchange();
+                comm_time += comm_timer.seconds();
+
+                // Sort atoms
+                other_timer.reset();
+                binning->create_binning( neigh_cutoff, neigh_cutoff,
+                                         neigh_cutoff, 1, true, false, true );
+                other_time += other_timer.seconds();
+
+                // Update ghost atoms (gather)
+                comm_timer.reset();
+                comm->exchange_halo();
+                comm_time += comm_timer.seconds();
+                resolve_topology();
+
+                // Compute atom neighbors
+                neigh_timer.reset();
+                profile_push( "Neighbor::create" );
+                neighbor->create( system );
+                if ( input->neighbor_check )
+                    neighbor->store_positions( system );
+                profile_pop();
+                neigh_time += neigh_timer.seconds();
+                neigh_builds++;
+            }
+            else if ( input->overlap_comm && !thermo_sub )
+            {
+                // Start ghost atom position update, finished after interior
+                // force
+                comm_timer.reset();
+                comm->update_halo_start();
+                comm_time += comm_timer.seconds();
+            }
+            else
+            {
+                // Update ghost atom positions (scatter)
+                comm_timer.reset();
+                comm->update_halo();
+                comm_time += comm_timer.seconds();
+            }
 
-            if ( !_print_lammps )
+            // Reset forces, unless the force assigns all owned atoms. Ghost
+            // forces then only need zeroing if they are scattered back.
+            force_timer.reset();
+            system->slice_f();
+            auto f = system->f;
+            if ( thermo_sub || !fast->assigns_force( neighbor ) )
             {
-                double time = timer.seconds();
-                double rate =
-                    1.0 * system->N * input->thermo_rate / ( time - last_time );
-                log( out, std::fixed, std::setprecision( 6 ), step, " ", T, " ",
-                     PE, " ", PE + KE, " ", std::setprecision( 2 ), time, " ",
-                     std::scientific, rate );
-                last_time = time;
+                Cabana::deep_copy( f, 0.0 );
+            }
+            else if ( update_fast )
+            {
+                Kokkos::parallel_for(
+                    "CabanaMD::zero_ghost_force",
+                    Kokkos::RangePolicy<exe_space>(
+                        system->N_local, system->N_local + system->N_ghost ),
+                    KOKKOS_LAMBDA( const int i ) {
+                        for ( int d = 0; d < 3; d++ )
+                            f( i, d ) = 0.0;
+                    } );
+            }
+
+            // Compute short range force (with energy and virial on thermo
+            // steps)
+            if ( thermo_sub )
+            {
+                fast->compute_thermo( system, neighbor );
+            }
+            else if ( input->overlap_comm && !rebuild )
+            {
+                fast->compute_interior( system, neighbor );
+                force_time += force_timer.seconds();
+
+                comm_timer.reset();
+                comm->update_halo_finish();
+                comm_time += comm_timer.seconds();
+
+                force_timer.reset();
+                fast->compute_boundary( system, neighbor );
             }
             else
             {
-                double time = timer.seconds();
-                log( out, std::fixed, std::setprecision( 6 ), "     ", step,
-                     " ", T, " ", PE, " ", PE + KE, " ", time );
-                last_time = time;
+                fast->compute( system, neighbor );
             }
+            force_time += force_timer.seconds();
+
+            // Long range Coulomb on top of the short range force (Bonds and
+            // Angles should go here eventually)
+            force_timer.reset();
+            compute_kspace( thermo_sub );
+            compute_bonded( thermo_sub );
+            force_time += force_timer.seconds();
+
+            // Scatter ghost atom forces back to original MPI rank
+            if ( update_fast )
+            {
+                comm_timer.reset();
+                comm->update_force();
+                comm_time += comm_timer.seconds();
+            }
+
+            // Thermostat drag and random forces
+            if ( langevin )
+            {
+                force_timer.reset();
+                langevin->post_force( system, input->initial_step + step,
+                                      1.0 * step / nsteps );
+                force_time += force_timer.seconds();
+            }
+
+            // Expensive outer force once per outer step (r-RESPA)
+            if ( respa && last_sub )
+            {
+                force_timer.reset();
+                compute_outer( thermo_step, update_force );
+                force_time += force_timer.seconds();
+            }
+
+            // Integrate atom positions - velocity Verlet second half, fused
+            // with the next first half unless the velocities are output
+            bool output_step =
+                thermo_step ||
+                ( input->dumpbinaryflag &&
+                  step % input->dumpbinary_rate == 0 ) ||
+                ( input->correctnessflag &&
+                  step % input->correctness_rate == 0 );
+            for ( auto analysis : analyses )
+                if ( step % analysis->every == 0 )
+                    output_step = true;
+            integrate_timer.reset();
+            profile_push( "Integrate" );
+            if ( nose_hoover )
+            {
+                // The thermostat needs the temperature right away
+                mv2 = integrator->final_integrate_mv2( system );
+                T_V_FLOAT factor = nose_hoover->final_integrate(
+                    system, temp.compute( system, mv2 ) );
+                mv2 *= factor * factor;
+            }
+            else if ( !respa && !output_step && step < nsteps )
+            {
+                integrator->final_initial_integrate( system );
+                fused = true;
+            }
+            else if ( thermo_sub && !respa )
+                mv2 = integrator->final_integrate_mv2( system );
+            else
+                integrator->final_integrate( system );
+            profile_pop();
+            integrate_time += integrate_timer.seconds();
         }
 
+        // Outer force half kick (r-RESPA)
+        if ( respa )
+        {
+            integrate_timer.reset();
+            profile_push( "Integrate" );
+            respa->outer_kick( system );
+            profile_pop();
+            integrate_time += integrate_timer.seconds();
+        }
+
+        other_timer.reset();
+        profile_push( "Output" );
+
+        // Print output of the previous thermo step, then start this one
+        if ( thermo.pending() )
+            write_thermo();
+        if ( thermo_step )
+        {
+            // Velocities changed after the second half with r-RESPA
+            if ( respa )
+                thermo.start( system, force, neighbor );
+            else
+                thermo.start( system, force, neighbor, mv2 );
+            thermo_time = timer.seconds();
+            thermo_at = step;
+            if ( replica_thermo )
+                write_replicas( step );
+            if ( monitor )
+                steer( step, thermo_lines );
+        }
+
+        for ( auto analysis : analyses )
+            if ( step % analysis->every == 0 )
+                analysis->compute( system, neighbor, step );
+
         if ( input->dumpbinaryflag )
             dump_binary( step );
 
         if ( input->correctnessflag )
             check_correctness( step );
 
+        profile_pop();
         other_time += other_timer.seconds();
+        profile_step( step );
     }
 
+    if ( thermo.pending() )
+        write_thermo();
+    if ( print_rank() )
+        out << thermo_lines.str() << std::flush;
+    for ( auto analysis : analyses )
+        analysis->write( system );
+
     double time = timer.seconds();
+    timings.total = time;
+    timings.force = force_time;
+    timings.neigh = neigh_time;
+    timings.comm = comm_time;
+    timings.integrate = integrate_time;
+    timings.other = other_time;
+    natoms = system->N;
 
     // Final output and timings
     if ( !_print_lammps )
@@ -402,221 +976,301 @@ void CbnMD<t_System, t_Neighbor>::run()
              " | FRACTION\n\n", "#Steps/s Atomsteps/s Atomsteps/(proc*s)\n",
              std::scientific, steps_per_sec, " ", atom_steps_per_sec, " ",
              atom_steps_per_sec / comm->num_processes() );
+        if ( input->neighbor_check )
+            log( out, "#Neighbor list builds: ", neigh_builds );
+        log( out, "#Neighbors per atom (rank 0): ", neighbor->mean_neighbors,
+             " mean ", neighbor->max_neighbors, " max" );
+        if ( neighbor->dense_layout &&
+             neighbor->max_neighbors > 2 * neighbor->mean_neighbors )
+            log( out, "#Warning: the 2D neighbor list stores ",
+                 neighbor->max_neighbors, " entries per atom; a CSR layout ",
+                 "(--neigh-type VERLET_CSR) would use less memory" );
+        if ( balance )
+            log( out, "#Load imbalance (max/avg atoms): ",
+                 balance->compute_imbalance( system ) );
     }
     else
     {
         log( out, "Loop time of ", time, " on ", comm->num_processes(),
              " procs for ", nsteps, " steps with ", system->N, " atoms" );
     }
+    profile_report( out );
+    memory_report( out, "at the end", system->N_local );
     out.close();
 
+    // Complete the last background dump
+    if ( dump )
+        dump->finish();
+
+    // One host mirror for both files, only allocated on discrete GPUs
+    HostSystem<t_System> host;
     if ( input->write_data_flag )
-        write_data( system, input->output_data_file );
+        write_data( system, input->output_data_file, host );
+    if ( input->write_data_flag && system->topology )
+    {
+        std::ofstream err( input->error_file, std::ofstream::app );
+        log( err, "Warning: bonds and angles are not written to data "
+                  "files." );
+    }
+    if ( input->write_restart_flag )
+        write_restart( system, input->output_restart_file,
+                       input->initial_step + nsteps, host,
+                       restart_thermostat() );
 }
 
+// r-RESPA outer force at the current positions: the system force holds the
+// inner force before and after, the outer force is stored for the kicks
 template <class t_System, class t_Neighbor>
-void CbnMD<t_System, t_Neighbor>::dump_binary( int step )
+void CbnMD<t_System, t_Neighbor>::compute_outer( bool thermo,
+                                                 bool update_force )
 {
-    std::ofstream err( input->error_file, std::ofstream::app );
+    respa->save_fast( system );
 
-    // On dump steps print configuration
+    system->slice_f();
+    auto f = system->f;
+    Cabana::deep_copy( f, 0.0 );
+    if ( thermo )
+        force->compute_thermo( system, neighbor );
+    else
+        force->compute( system, neighbor );
+    if ( update_force )
+        comm->update_force();
 
-    if ( step % input->dumpbinary_rate )
+    respa->store_slow( system );
+    respa->restore_fast( system );
+
+    // Thermo output uses the outer force: add the inner energy and virial
+    // unless the outer force is already the full potential
+    if ( thermo && !respa->subtract )
+    {
+        force->thermo_energy += force_inner->thermo_energy;
+        for ( int v = 0; v < 6; v++ )
+            force->thermo_virial[v] += force_inner->thermo_virial[v];
+    }
+}
+
+template <class t_System, class t_Neighbor>
+void CbnMD<t_System, t_Neighbor>::compute_kspace( bool thermo )
+{
+#ifdef Cabana_ENABLE_HEFFTE
+    if ( kspace == nullptr )
+        return;
+
+    if ( !thermo )
+    {
+        kspace->compute( system, neighbor );
+        return;
+    }
+    kspace->compute_thermo( system, neighbor );
+    force->thermo_energy += kspace->energy;
+    for ( int v = 0; v < 6; v++ )
+        force->thermo_virial[v] += kspace->virial[v];
+#else
+    (void)thermo;
+#endif
+}
+
+template <class t_System, class t_Neighbor>
+void CbnMD<t_System, t_Neighbor>::compute_bonded( bool thermo )
+{
+    if ( !thermo )
+    {
+        if ( bond )
+            bond->compute( system );
+        if ( angle )
+            angle->compute( system );
         return;
+    }
+    if ( bond )
+    {
+        bond->compute_thermo( system );
+        force->thermo_energy += bond->energy;
+        for ( int v = 0; v < 6; v++ )
+            force->thermo_virial[v] += bond->virial[v];
+    }
+    if ( angle )
+    {
+        angle->compute_thermo( system );
+        force->thermo_energy += angle->energy;
+        for ( int v = 0; v < 6; v++ )
+            force->thermo_virial[v] += angle->virial[v];
+    }
+}
 
-    FILE *fp;
-    T_INT n = system->N_local;
+template <class t_System, class t_Neighbor>
+void CbnMD<t_System, t_Neighbor>::resolve_topology()
+{
+    if ( !system->topology )
+        return;
 
-    char *filename = new char[MAXPATHLEN];
-    sprintf( filename, "%s%s.%010d.%03d", input->dumpbinary_path, "/output",
-             step, comm->process_rank() );
-    fp = fopen( filename, "wb" );
-    if ( fp == NULL )
+    profile_push( "Topology::resolve" );
+    system->slice_id();
+    T_INT missing = system->topology->resolve( system->id, system->N_local,
+                                               system->N_ghost );
+    profile_pop();
+    if ( missing > 0 )
     {
-        log_err( err, "Cannot open dump file: ", filename );
+        std::ofstream err( input->error_file, std::ofstream::app );
+        log_err( err, "Bonded atoms missing from the ghost atoms: the "
+                      "neighbor cutoff must cover two bond lengths" );
     }
+}
 
-    system->slice_all();
-    t_System s = *system;
-    auto h_x = s.x;
-    auto h_v = s.v;
-    auto h_f = s.f;
-    auto h_id = s.id;
-    auto h_type = s.type;
-    auto h_q = s.q;
+template <class t_System, class t_Neighbor>
+void CbnMD<t_System, t_Neighbor>::create_analyses()
+{
+    std::ofstream err( input->error_file, std::ofstream::app );
+    for ( auto &line : input->compute_lines )
+    {
+        // Sampling and output keywords follow the style arguments
+        auto id = line.at( 1 );
+        auto style = line.at( 3 );
+        std::size_t num_args = style.compare( "msd" ) == 0 ? 4 : 5;
+        int every = input->thermo_rate > 0 ? input->thermo_rate : 100;
+        std::string file = id + ".dat";
+        for ( std::size_t w = num_args; w + 1 < line.size(); w += 2 )
+        {
+            if ( line.at( w ).compare( "every" ) == 0 )
+                every = std::stoi( line.at( w + 1 ) );
+            else if ( line.at( w ).compare( "file" ) == 0 )
+                file = line.at( w + 1 );
+            else
+                log_err( err, "LAMMPS-Command: 'compute' only supports the "
+                              "'every' and 'file' keywords in CabanaMD" );
+        }
+        if ( every < 1 )
+            log_err( err, "LAMMPS-Command: 'compute' every must be "
+                          "positive" );
+
+        if ( style.compare( "rdf" ) == 0 )
+        {
+            // Pairs come from the neighbor list, so at most its cutoff
+            auto rdf_cutoff = input->force_cutoff;
+            if ( rdf_cutoff > neighbor->neigh_cut )
+                log_err( err, "compute rdf needs the neighbor cutoff to "
+                              "cover the pair cutoff" );
+            analyses.push_back( new RDF<t_System, t_Neighbor>(
+                comm, id, file, every, std::stoi( line.at( 4 ) ),
+                rdf_cutoff ) );
+        }
+        else if ( style.compare( "msd" ) == 0 )
+            analyses.push_back(
+                new MSD<t_System, t_Neighbor>( comm, id, file, every ) );
+        else
+            analyses.push_back(
+                new CountType<t_System, t_Neighbor>( comm, id, file, every ) );
+    }
+}
 
-    fwrite( &n, sizeof( T_INT ), 1, fp );
-    fwrite( h_id.data(), sizeof( T_INT ), n, fp );
-    fwrite( h_type.data(), sizeof( T_INT ), n, fp );
-    fwrite( h_q.data(), sizeof( T_FLOAT ), n, fp );
-    fwrite( h_x.data(), sizeof( T_X_FLOAT ), 3 * n, fp );
-    fwrite( h_v.data(), sizeof( T_V_FLOAT ), 3 * n, fp );
-    fwrite( h_f.data(), sizeof( T_F_FLOAT ), 3 * n, fp );
+template <class t_System, class t_Neighbor>
+void CbnMD<t_System, t_Neighbor>::write_replicas( int step )
+{
+    profile_push( "ReplicaThermo" );
+    replica_thermo->compute( system );
+    profile_pop();
+    if ( !print_rank() )
+        return;
 
-    fclose( fp );
-    err.close();
+    std::ofstream replica_out( replica_file, std::ofstream::app );
+    replica_out << std::fixed << std::setprecision( 6 );
+    for ( int r = 0; r < system->replicas; r++ )
+    {
+        auto natoms_r = replica_thermo->natoms[r];
+        replica_out << step << " " << r << " " << natoms_r << " "
+                    << replica_thermo->temperature[r] << " "
+                    << replica_thermo->kinetic_energy[r] /
+                           ( natoms_r > 0 ? natoms_r : 1 )
+                    << "\n";
+    }
+}
+
+template <class t_System, class t_Neighbor>
+void CbnMD<t_System, t_Neighbor>::dump_binary( int step )
+{
+    // On dump steps print configuration
+
+    if ( step % input->dumpbinary_rate )
+        return;
+
+    // One shared file per dump, written by a helper thread
+    if ( dump == nullptr )
+        dump = new DumpBinary<t_System>( input->dumpbinary_path );
+    dump->write( system, step );
 }
 
 // TODO: 1. Add path to Reference [DONE]
 //     2. Add MPI Rank file ids in Reference [DONE]
-//     3. Move to separate class
-//     4. Add pressure to thermo output
+//     3. Move to separate class [DONE]
+//     4. Add pressure to thermo output [DONE]
 //     5. basis_offset [DONE]
 //     6. correctness output to file [DONE]
 
 template <class t_System, class t_Neighbor>
 void CbnMD<t_System, t_Neighbor>::check_correctness( int step )
 {
-    std::ofstream err( input->error_file, std::ofstream::app );
-
     if ( step % input->correctness_rate )
         return;
 
-    FILE *fpref;
-    T_INT n = system->N_local;
-    T_INT ntmp;
-
-    system->slice_all();
-    t_System s = *system;
-    auto x = s.x;
-    auto v = s.v;
-    auto f = s.f;
-    auto id = s.id;
-    auto type = s.type;
-    auto q = s.q;
-
-    char *filename = new char[MAXPATHLEN];
-    sprintf( filename, "%s%s.%010d.%03d", input->reference_path, "/output",
-             step, comm->process_rank() );
-    fpref = fopen( filename, "rb" );
-    if ( fpref == NULL )
-    {
-        log_err( err, "Cannot open input file: ", filename );
-    }
-
-    fread( &ntmp, sizeof( T_INT ), 1, fpref );
-    if ( ntmp != n )
-    {
-        log_err( err, "Mismatch in current and reference atom counts" );
-    }
-
-    Kokkos::View<T_INT *, Kokkos::LayoutRight> idref( "Correctness::id", n );
-    Kokkos::View<T_INT *, Kokkos::LayoutRight> typeref( "Correctness::type",
-                                                        n );
-    Kokkos::View<T_FLOAT *, Kokkos::LayoutRight> qref( "Correctness::q", n );
-    Kokkos::View<T_X_FLOAT **, Kokkos::LayoutRight> xref( "Correctness::x", 3,
-                                                          n );
-    Kokkos::View<T_V_FLOAT **, Kokkos::LayoutRight> vref( "Correctness::v", 3,
-                                                          n );
-    Kokkos::View<T_F_FLOAT **, Kokkos::LayoutRight> fref( "Correctness::f", 3,
-                                                          n );
-
-    fread( idref.data(), sizeof( T_INT ), n, fpref );
-    fread( typeref.data(), sizeof( T_INT ), n, fpref );
-    fread( qref.data(), sizeof( T_FLOAT ), n, fpref );
-    fread( xref.data(), sizeof( T_X_FLOAT ), 3 * n, fpref );
-    fread( vref.data(), sizeof( T_V_FLOAT ), 3 * n, fpref );
-    fread( fref.data(), sizeof( T_F_FLOAT ), 3 * n, fpref );
-
-    T_FLOAT sumdelrsq = 0.0;
-    T_FLOAT sumdelvsq = 0.0;
-    T_FLOAT sumdelfsq = 0.0;
-    T_FLOAT maxdelr = 0.0;
-    T_FLOAT maxdelv = 0.0;
-    T_FLOAT maxdelf = 0.0;
-    for ( int i = 0; i < n; i++ )
-    {
-        int ii = -1;
-        if ( id( i ) != idref( i ) )
-            for ( int j = 0; j < n; j++ )
-            {
-                if ( id( j ) == idref( i ) )
-                {
-                    ii = j;
-                    break;
-                }
-            }
-        else
-            ii = i;
+    // Reference data and id map stay on the device between checks
+    if ( correctness == nullptr )
+        correctness = new Correctness<t_System>(
+            input->reference_path, input->correctness_file,
+            input->error_file );
+    correctness->check( system, step );
+}
 
-        if ( ii == -1 )
-            log_err( err, "Unable to find current id matchinf reference id: ",
-                     idref( i ) );
-        else
+template <class t_System, class t_Neighbor>
+void CbnMD<t_System, t_Neighbor>::steer( int step, std::ostream &out )
+{
+    monitor->status.step = step;
+    monitor->status.thermo_rate = input->thermo_rate;
+    monitor->status.dumpbinary_rate =
+        input->dumpbinaryflag ? input->dumpbinary_rate : 0;
+    MonitorRequest request = monitor->poll();
+
+    if ( request.thermo_rate > 0 && request.thermo_rate != input->thermo_rate )
+    {
+        input->thermo_rate = request.thermo_rate;
+        log( out, "#Monitor: thermo every ", input->thermo_rate,
+             " steps from step ", step );
+    }
+    if ( request.dumpbinary_rate > 0 )
+    {
+        if ( input->dumpbinaryflag )
         {
-            T_FLOAT delx, dely, delz, delrsq;
-            delx = x( ii, 0 ) - xref( i, 0 );
-            dely = x( ii, 1 ) - xref( i, 1 );
-            delz = x( ii, 2 ) - xref( i, 2 );
-            delrsq = delx * delx + dely * dely + delz * delz;
-            sumdelrsq += delrsq;
-            maxdelr = MAX( fabs( delx ), maxdelr );
-            maxdelr = MAX( fabs( dely ), maxdelr );
-            maxdelr = MAX( fabs( delz ), maxdelr );
-
-            delx = v( ii, 0 ) - vref( i, 0 );
-            dely = v( ii, 1 ) - vref( i, 1 );
-            delz = v( ii, 2 ) - vref( i, 2 );
-            delrsq = delx * delx + dely * dely + delz * delz;
-            sumdelvsq += delrsq;
-            maxdelv = MAX( fabs( delx ), maxdelv );
-            maxdelv = MAX( fabs( dely ), maxdelv );
-            maxdelv = MAX( fabs( delz ), maxdelv );
-
-            delx = f( ii, 0 ) - fref( i, 0 );
-            dely = f( ii, 1 ) - fref( i, 1 );
-            delz = f( ii, 2 ) - fref( i, 2 );
-            delrsq = delx * delx + dely * dely + delz * delz;
-            sumdelfsq += delrsq;
-            maxdelf = MAX( fabs( delx ), maxdelf );
-            maxdelf = MAX( fabs( dely ), maxdelf );
-            maxdelf = MAX( fabs( delz ), maxdelf );
+            input->dumpbinary_rate = request.dumpbinary_rate;
+            log( out, "#Monitor: dumpbinary every ", input->dumpbinary_rate,
+                 " steps from step ", step );
         }
+        else
+            log( out, "#Monitor: dumpbinary rate ignored, no --dumpbinary "
+                      "output" );
     }
-
-    fclose( fpref );
-
-    // Can't use this with current CommMPI::reduce_float()
-    // T_FLOAT buf[3];
-    // buf[0] = sumdelrsq;
-    // buf[1] = sumdelvsq;
-    // buf[2] = sumdelfsq;
-    // comm->reduce_float(&buf[0],3);
-    // sumdelrsq = buf[0];
-    // sumdelrsq = buf[1];
-    // sumdelrsq = buf[2];
-    // buf[0] = maxdelr;
-    // buf[1] = maxdelv;
-    // buf[2] = maxdelf;
-    // comm->reduce_max_float(buf,3);
-    // maxdelr =   buf[0];
-    // maxdelv =   buf[1];
-    // maxdelf =   buf[2];
-
-    comm->reduce_float( &sumdelrsq, 1 );
-    comm->reduce_float( &sumdelvsq, 1 );
-    comm->reduce_float( &sumdelfsq, 1 );
-    comm->reduce_max_float( &maxdelr, 1 );
-    comm->reduce_max_float( &maxdelv, 1 );
-    comm->reduce_max_float( &maxdelf, 1 );
-
-    if ( step == 0 )
-    {
-        FILE *fpout = fopen( input->correctness_file, "w" );
-        fprintf( fpout, "# timestep deltarnorm maxdelr deltavnorm maxdelv "
-                        "deltafnorm maxdelf\n" );
-        fprintf( fpout, "%d %g %g %g %g %g %g\n", step, sqrt( sumdelrsq ),
-                 maxdelr, sqrt( sumdelvsq ), maxdelv, sqrt( sumdelfsq ),
-                 maxdelf );
-        fclose( fpout );
+    if ( request.checkpoint && system->has_topology() )
+        log( out, "#Monitor: checkpoint ignored, restart files do not store "
+                  "bonds and angles" );
+    else if ( request.checkpoint )
+    {
+        // Velocities are at the full step on thermo steps
+        std::string file = input->output_restart_file.empty()
+                               ? std::string( "cabanaMD.restart" )
+                               : input->output_restart_file;
+        HostSystem<t_System> host;
+        write_restart( system, file, input->initial_step + step, host,
+                       restart_thermostat() );
+        log( out, "#Monitor: wrote restart file ", file, " at step ",
+             input->initial_step + step );
     }
-    else
+}
+
+template <class t_System, class t_Neighbor>
+RestartThermostat CbnMD<t_System, t_Neighbor>::restart_thermostat()
+{
+    RestartThermostat thermostat;
+    if ( nose_hoover )
     {
-        FILE *fpout = fopen( input->correctness_file, "a" );
-        fprintf( fpout, "%d %g %g %g %g %g %g\n", step, sqrt( sumdelrsq ),
-                 maxdelr, sqrt( sumdelvsq ), maxdelv, sqrt( sumdelfsq ),
-                 maxdelf );
-        fclose( fpout );
+        thermostat.nose_hoover = 1;
+        nose_hoover->state( thermostat.eta_dot, thermostat.eta_dotdot );
     }
-    err.close();
+    return thermostat;
 }
@@ -0,0 +1,82 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef CAPACITY_H
+#define CAPACITY_H
+
+#include <algorithm>
+#include <cstddef>
+
+// Storage capacity for buffers whose size changes every step (owned and
+// ghost particles, Comm pack lists). Capacity grows geometrically so small
+// increases do not reallocate, a smaller size keeps the storage, and memory
+// is only given back once the largest size requested over a whole decay
+// window is well below the capacity.
+class CapacityPolicy
+{
+    std::size_t window_max; // Largest size requested in the current window
+    int window_requests;
+
+  public:
+    double growth;       // Capacity multiplier when a size outgrows it
+    int decay_window;    // Requests per high-water window, 0 never shrinks
+    double shrink_ratio; // Shrink once capacity > shrink_ratio * high-water
+
+    CapacityPolicy( double growth_ = 1.5, int decay_window_ = 1000,
+                    double shrink_ratio_ = 4.0 )
+        : window_max( 0 )
+        , window_requests( 0 )
+        , growth( growth_ )
+        , decay_window( decay_window_ )
+        , shrink_ratio( shrink_ratio_ )
+    {
+    }
+
+    // Capacity to hold n entries in storage of the current capacity
+    std::size_t capacity( std::size_t n, std::size_t current )
+    {
+        window_max = std::max( window_max, n );
+        window_requests++;
+        if ( n > current )
+            return std::max( n, std::size_t( growth * current ) );
+
+        if ( decay_window > 0 && window_requests >= decay_window )
+        {
+            const std::size_t high_water = window_max;
+            window_max = 0;
+            window_requests = 0;
+            if ( current > shrink_ratio * high_water )
+                return std::max( n, std::size_t( growth * high_water ) );
+        }
+        return current;
+    }
+};
+
+// Reserve an AoSoA for the capacity from a CapacityPolicy, keeping its size
+template <class t_aosoa>
+void set_capacity( t_aosoa &aosoa, std::size_t capacity )
+{
+    const std::size_t size = aosoa.size();
+    if ( capacity > aosoa.capacity() )
+    {
+        aosoa.reserve( capacity );
+    }
+    else if ( capacity >= size && capacity + t_aosoa::vector_length <=
+                                      aosoa.capacity() )
+    {
+        // Only shrinkToFit releases AoSoA storage
+        aosoa.resize( capacity );
+        aosoa.shrinkToFit();
+        aosoa.resize( size );
+    }
+}
+
+#endif
@@ -52,11 +52,25 @@
 #include <Cabana_Core.hpp>
 #include <Kokkos_Core.hpp>
 
+#include <capacity.h>
+#include <device.h>
+#include <output.h>
+#include <profile.h>
 #include <types.h>
 
+#include <mpi.h>
+
+#include <iostream>
 #include <memory>
 #include <vector>
 
+// MPI datatype of the configured T_INT and T_FLOAT types
+inline MPI_Datatype mpi_datatype( int ) { return MPI_INT; }
+inline MPI_Datatype mpi_datatype( long ) { return MPI_LONG; }
+inline MPI_Datatype mpi_datatype( long long ) { return MPI_LONG_LONG; }
+inline MPI_Datatype mpi_datatype( float ) { return MPI_FLOAT; }
+inline MPI_Datatype mpi_datatype( double ) { return MPI_DOUBLE; }
+
 template <class t_System>
 class Comm
 {
@@ -83,7 +97,17 @@ class Comm
     int proc_grid[3];           // Process Grid size
     int proc_rank;              // My Process rank
     int proc_size;              // Number of processes
-    int max_local;
+
+    // Grow-only pack lists and halo buffers (see CapacityPolicy); the lists
+    // of all six phases share one allocation
+    CapacityPolicy migrate_capacity, pack_capacity, buffer_capacity;
+
+    // Single round exchange with all 26 neighbors (COMM_MPI_26)
+    int comm_type;
+    bool comm_26;
+    int halo_phases;             // Number of halos in halo_all in use
+    int proc_neighbors_27[27];   // Neighbor for each offset (13 is self)
+    std::vector<int> neighbors_26, neighbors_27;
 
     Kokkos::View<int, Kokkos::LayoutRight, device_type,
                  Kokkos::MemoryTraits<Kokkos::Atomic>>
@@ -100,8 +124,62 @@ class Comm
 
     std::vector<std::shared_ptr<Cabana::Halo<device_type>>> halo_all;
 
+    // Persistent halo plan: buffers and MPI requests per phase, rebuilt in
+    // exchange_halo and reused by every update_halo/update_force
+    typedef Kokkos::View<T_X_FLOAT * [3], Kokkos::LayoutRight, device_type>
+        t_buf_x;
+    typedef Kokkos::View<T_F_FLOAT * [3], Kokkos::LayoutRight, device_type>
+        t_buf_f;
+    std::vector<t_buf_x> halo_send_x, halo_recv_x;
+    std::vector<t_buf_f> halo_send_f, halo_recv_f;
+    std::vector<std::vector<MPI_Request>> halo_requests_x, halo_requests_f;
+    // Phases that only exchange with this rank: the receive buffer matches
+    // the send buffer, so it is packed directly without MPI or host
+    // synchronization
+    std::vector<bool> halo_self;
+    bool halo_all_self;
+    // One value per ghost (update_halo_scalar), planned on first use
+    typedef Kokkos::View<T_FLOAT *, device_type> t_buf_s;
+    std::vector<t_buf_s> halo_send_s, halo_recv_s;
+    std::vector<std::vector<MPI_Request>> halo_requests_s;
+    bool halo_scalar;
+    // Periodic shift per exported ghost (COMM_MPI_26 only)
+    t_buf_x halo_shift;
+
+    // Without GPU-aware MPI, device halo buffers are copied through pinned
+    // host mirrors of the same size and MPI only sees host memory
+#ifdef KOKKOS_ENABLE_CUDA
+    using pinned_space = Kokkos::CudaHostPinnedSpace;
+#else
+    using pinned_space = Kokkos::HostSpace;
+#endif
+    typedef Kokkos::View<T_X_FLOAT * [3], Kokkos::LayoutRight, pinned_space>
+        t_host_x;
+    typedef Kokkos::View<T_F_FLOAT * [3], Kokkos::LayoutRight, pinned_space>
+        t_host_f;
+    typedef Kokkos::View<T_FLOAT *, pinned_space> t_host_s;
+    bool halo_staged;
+    std::vector<t_host_x> host_send_x, host_recv_x;
+    std::vector<t_host_f> host_send_f, host_recv_f;
+    std::vector<t_host_s> host_send_s, host_recv_s;
+
     using exe_space = typename t_System::execution_space;
 
+    void exchange_26();
+    void exchange_halo_26();
+
+    // Size the migrate ranks and the per phase pack lists for n particles
+    void reserve_migrate( std::size_t n );
+    void reserve_pack( std::size_t n );
+
+    void create_halo_plan_scalar();
+    void halo_pack_x( int p );
+    void halo_start_x( int p );
+    void halo_finish_x( int p );
+    // Copy the first n entries between device and staging buffers
+    template <class t_dst, class t_src>
+    void halo_stage( t_dst dst, t_src src, std::size_t n );
+
   protected:
     t_System *system;
 
@@ -122,16 +200,37 @@ class Comm
     {
     };
 
-    Comm( t_System *s, T_X_FLOAT comm_depth_ );
+    struct TagExchangePack26
+    {
+    };
+    struct TagHaloPack26
+    {
+    };
+
+    Comm( t_System *s, T_X_FLOAT comm_depth_, int comm_type_ = COMM_MPI,
+          int gpu_aware_mpi = GPU_AWARE_AUTO );
+    // Free the persistent halo requests (not a destructor: Comm is copied
+    // into its own kernels)
+    void free_halo_plan();
     void init();
     void create_domain_decomposition();
     void exchange();
     void exchange_halo();
+    void create_halo_plan();
     void update_halo();
+    void update_halo_start();
+    void update_halo_finish();
     void update_force();
+    template <class t_view>
+    void update_halo_scalar( t_view values );
     void scan_int( T_INT *vals, T_INT count );
     void reduce_int( T_INT *vals, T_INT count );
+    // Non-blocking sum; vals must stay valid until the request completes
+    void reduce_int_start( T_INT *vals, T_INT count, MPI_Request *request );
     void reduce_float( T_FLOAT *vals, T_INT count );
+    // Non-blocking sum; vals must stay valid until the request completes
+    void reduce_float_start( T_FLOAT *vals, T_INT count,
+                             MPI_Request *request );
     void reduce_max_int( T_INT *vals, T_INT count );
     void reduce_max_float( T_FLOAT *vals, T_INT count );
     void reduce_min_int( T_INT *vals, T_INT count );
@@ -143,11 +242,13 @@ class Comm
     {
         if ( proc_grid[0] == 1 )
         {
+            // Wrap within the replica box (the whole box without replicas)
             const T_X_FLOAT x1 = x( i, 0 );
-            if ( x1 > s.global_mesh_x )
-                x( i, 0 ) -= s.global_mesh_x;
-            if ( x1 < 0 )
-                x( i, 0 ) += s.global_mesh_x;
+            const T_X_FLOAT lo = s.replica_of( x1 ) * s.replica_width;
+            if ( x1 > lo + s.period_x() )
+                x( i, 0 ) -= s.period_x();
+            if ( x1 < lo )
+                x( i, 0 ) += s.period_x();
         }
         if ( proc_grid[1] == 1 )
         {
@@ -236,7 +337,38 @@ class Comm
         }
     }
 
-    // Add ghosts to Cabana-gather
+    // Own sub domain along dimension d (the replica box along x)
+    KOKKOS_INLINE_FUNCTION
+    void halo_bounds( const T_INT i, const int d, T_X_FLOAT &lo,
+                      T_X_FLOAT &hi ) const
+    {
+        if ( d == 0 )
+        {
+            lo = s.local_mesh_lo_x;
+            hi = s.local_mesh_hi_x;
+            if ( s.replicas > 1 )
+            {
+                lo = s.replica_of( x( i, 0 ) ) * s.replica_width;
+                hi = lo + s.replica_lx;
+            }
+        }
+        else if ( d == 1 )
+        {
+            lo = s.local_mesh_lo_y;
+            hi = s.local_mesh_hi_y;
+        }
+        else
+        {
+            lo = s.local_mesh_lo_z;
+            hi = s.local_mesh_hi_z;
+        }
+    }
+
+    // Add ghosts to Cabana-gather: atoms within comm_depth of the
+    // destination sub domain. Ghosts forwarded from earlier phases sit
+    // outside this sub domain along the earlier dimensions (where the
+    // destination has the same extent), so their full distance counts and
+    // edge and corner atoms only go where they are in range.
     KOKKOS_INLINE_FUNCTION
     void operator()( const TagHaloPack, const T_INT &i ) const
     {
@@ -244,75 +376,99 @@ class Comm
         if ( proc_send < 0 )
             proc_send = proc_rank;
 
-        if ( phase == 0 )
+        const int dim = phase / 2;
+        T_X_FLOAT rsq = 0.0;
+        T_X_FLOAT lo, hi;
+        for ( int d = 0; d < dim; d++ )
         {
-            if ( x( i, 0 ) >= s.local_mesh_hi_x - comm_depth )
-            {
-                const std::size_t pack_idx = pack_count()++;
-                if ( pack_idx < pack_indicies.extent( 0 ) )
-                {
-                    pack_indicies( pack_idx ) = i;
-                    pack_ranks( pack_idx ) = proc_send;
-                }
-            }
+            halo_bounds( i, d, lo, hi );
+            T_X_FLOAT out = 0.0;
+            if ( x( i, d ) < lo )
+                out = lo - x( i, d );
+            else if ( x( i, d ) > hi )
+                out = x( i, d ) - hi;
+            rsq += out * out;
         }
-        if ( phase == 1 )
+        halo_bounds( i, dim, lo, hi );
+        T_X_FLOAT gap = ( phase % 2 == 0 ) ? hi - x( i, dim )
+                                           : x( i, dim ) - lo;
+        if ( gap < 0.0 )
+            gap = 0.0;
+
+        if ( gap <= comm_depth && rsq + gap * gap <= comm_depth * comm_depth )
         {
-            if ( x( i, 0 ) <= s.local_mesh_lo_x + comm_depth )
+            const std::size_t pack_idx = pack_count()++;
+            if ( pack_idx < pack_indicies.extent( 0 ) )
             {
-                const std::size_t pack_idx = pack_count()++;
-                if ( pack_idx < pack_indicies.extent( 0 ) )
-                {
-                    pack_indicies( pack_idx ) = i;
-                    pack_ranks( pack_idx ) = proc_send;
-                }
+                pack_indicies( pack_idx ) = i;
+                pack_ranks( pack_idx ) = proc_send;
             }
         }
-        if ( phase == 2 )
+    }
+
+    // Mark for Cabana-migrate to any of the 26 neighbors (periodic shift)
+    KOKKOS_INLINE_FUNCTION
+    void operator()( const TagExchangePack26, const T_INT &i ) const
+    {
+        const double lo[3] = {s.local_mesh_lo_x, s.local_mesh_lo_y,
+                              s.local_mesh_lo_z};
+        const double hi[3] = {s.local_mesh_hi_x, s.local_mesh_hi_y,
+                              s.local_mesh_hi_z};
+        const double global[3] = {s.global_mesh_x, s.global_mesh_y,
+                                  s.global_mesh_z};
+
+        int offset = 0;
+        for ( int d = 0; d < 3; d++ )
         {
-            if ( x( i, 1 ) >= s.local_mesh_hi_y - comm_depth )
+            int o = 0;
+            if ( x( i, d ) > hi[d] )
             {
-                const std::size_t pack_idx = pack_count()++;
-                if ( pack_idx < pack_indicies.extent( 0 ) )
-                {
-                    pack_indicies( pack_idx ) = i;
-                    pack_ranks( pack_idx ) = proc_send;
-                }
+                o = 1;
+                if ( proc_pos[d] == proc_grid[d] - 1 )
+                    x( i, d ) -= global[d];
             }
-        }
-        if ( phase == 3 )
-        {
-            if ( x( i, 1 ) <= s.local_mesh_lo_y + comm_depth )
+            else if ( x( i, d ) < lo[d] )
             {
-                const std::size_t pack_idx = pack_count()++;
-                if ( pack_idx < pack_indicies.extent( 0 ) )
-                {
-                    pack_indicies( pack_idx ) = i;
-                    pack_ranks( pack_idx ) = proc_send;
-                }
+                o = -1;
+                if ( proc_pos[d] == 0 )
+                    x( i, d ) += global[d];
             }
+            offset = 3 * offset + o + 1;
         }
-        if ( phase == 4 )
+        pack_ranks_migrate( i ) = proc_neighbors_27[offset];
+    }
+
+    // Add ghosts to Cabana-gather for every neighbor within comm_depth
+    KOKKOS_INLINE_FUNCTION
+    void operator()( const TagHaloPack26, const T_INT &i ) const
+    {
+        const T_X_FLOAT pos[3] = {x( i, 0 ), x( i, 1 ), x( i, 2 )};
+        const double lo[3] = {s.local_mesh_lo_x, s.local_mesh_lo_y,
+                              s.local_mesh_lo_z};
+        const double hi[3] = {s.local_mesh_hi_x, s.local_mesh_hi_y,
+                              s.local_mesh_hi_z};
+
+        for ( int offset = 0; offset < 27; offset++ )
         {
-            if ( x( i, 2 ) >= s.local_mesh_hi_z - comm_depth )
+            if ( offset == 13 )
+                continue;
+            const int o[3] = {offset / 9 - 1, ( offset / 3 ) % 3 - 1,
+                              offset % 3 - 1};
+            bool send = true;
+            for ( int d = 0; d < 3; d++ )
             {
-                const std::size_t pack_idx = pack_count()++;
-                if ( pack_idx < pack_indicies.extent( 0 ) )
-                {
-                    pack_indicies( pack_idx ) = i;
-                    pack_ranks( pack_idx ) = proc_send;
-                }
+                if ( o[d] == 1 && pos[d] < hi[d] - comm_depth )
+                    send = false;
+                if ( o[d] == -1 && pos[d] > lo[d] + comm_depth )
+                    send = false;
             }
-        }
-        if ( phase == 5 )
-        {
-            if ( x( i, 2 ) <= s.local_mesh_lo_z + comm_depth )
+            if ( send )
             {
                 const std::size_t pack_idx = pack_count()++;
                 if ( pack_idx < pack_indicies.extent( 0 ) )
                 {
                     pack_indicies( pack_idx ) = i;
-                    pack_ranks( pack_idx ) = proc_send;
+                    pack_ranks( pack_idx ) = proc_neighbors_27[offset];
                 }
             }
         }
@@ -328,11 +484,11 @@ class Comm
         {
         case 0:
             if ( proc_pos[0] == 0 )
-                x( i, 0 ) -= s.global_mesh_x;
+                x( i, 0 ) -= s.period_x();
             break;
         case 1:
             if ( proc_pos[0] == proc_grid[0] - 1 )
-                x( i, 0 ) += s.global_mesh_x;
+                x( i, 0 ) += s.period_x();
             break;
         case 2:
             if ( proc_pos[1] == 0 )
@@ -354,6 +510,9 @@ class Comm
     }
 
     const char *name();
+    // Halo buffers pass through host memory (device build without GPU-aware
+    // MPI)
+    bool staged_halo();
     int process_rank();
     int num_processes();
 };
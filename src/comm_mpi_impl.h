@@ -51,23 +51,77 @@
 #include <algorithm>
 
 template <class t_System>
-Comm<t_System>::Comm( t_System *s, T_X_FLOAT comm_depth_ )
-    : neighbors_halo( 6 )
+Comm<t_System>::Comm( t_System *s, T_X_FLOAT comm_depth_, int comm_type_,
+                      int gpu_aware_mpi )
+    : comm_type( comm_type_ )
+    , comm_26( false )
+    , halo_phases( 6 )
+    , neighbors_halo( 6 )
     , neighbors_dist( 6 )
     , halo_all( 6 )
+    , halo_send_x( 6 )
+    , halo_recv_x( 6 )
+    , halo_send_f( 6 )
+    , halo_recv_f( 6 )
+    , halo_requests_x( 6 )
+    , halo_requests_f( 6 )
+    , halo_self( 6, false )
+    , halo_all_self( false )
+    , halo_send_s( 6 )
+    , halo_recv_s( 6 )
+    , halo_requests_s( 6 )
+    , halo_scalar( false )
+    , host_send_x( 6 )
+    , host_recv_x( 6 )
+    , host_send_f( 6 )
+    , host_recv_f( 6 )
+    , host_send_s( 6 )
+    , host_recv_s( 6 )
     , system( s )
     , comm_depth( comm_depth_ )
 {
     MPI_Comm_size( MPI_COMM_WORLD, &proc_size );
     MPI_Comm_rank( MPI_COMM_WORLD, &proc_rank );
 
+    const bool host_buffers =
+        Kokkos::SpaceAccessibility<Kokkos::HostSpace,
+                                   typename device_type::memory_space>::
+            accessible;
+    const bool gpu_aware =
+        gpu_aware_mpi == GPU_AWARE_ON ||
+        ( gpu_aware_mpi == GPU_AWARE_AUTO && mpi_gpu_aware() );
+    halo_staged = !host_buffers && !gpu_aware;
+
     pack_count = Kokkos::View<int, Kokkos::LayoutRight, device_type>(
-        "CommMPI::pack_count" );
+        "Comm::pack_count" );
     pack_indicies_all =
         Kokkos::View<T_INT **, Kokkos::LayoutRight, device_type>(
-            "CommMPI::pack_indicies_all", 6, 200 );
+            "Comm::pack_indicies_all", 6, 200 );
     pack_ranks_all = Kokkos::View<T_INT **, Kokkos::LayoutRight, device_type>(
-        "CommMPI::pack_ranks_all", 6, 200 );
+        "Comm::pack_ranks_all", 6, 200 );
+}
+
+template <class t_System>
+void Comm<t_System>::free_halo_plan()
+{
+    for ( auto &requests : halo_requests_x )
+    {
+        for ( auto &request : requests )
+            MPI_Request_free( &request );
+        requests.clear();
+    }
+    for ( auto &requests : halo_requests_f )
+    {
+        for ( auto &request : requests )
+            MPI_Request_free( &request );
+        requests.clear();
+    }
+    for ( auto &requests : halo_requests_s )
+    {
+        for ( auto &request : requests )
+            MPI_Request_free( &request );
+        requests.clear();
+    }
 }
 
 template <class t_System>
@@ -84,12 +138,12 @@ void Comm<t_System>::create_domain_decomposition()
         proc_pos[d] = system->rank_dim_pos[d];
     }
 
-    proc_neighbors_send[0] = system->local_grid->neighborRank( 1, 0, 0 );
-    proc_neighbors_send[1] = system->local_grid->neighborRank( -1, 0, 0 );
-    proc_neighbors_send[2] = system->local_grid->neighborRank( 0, 1, 0 );
-    proc_neighbors_send[3] = system->local_grid->neighborRank( 0, -1, 0 );
-    proc_neighbors_send[4] = system->local_grid->neighborRank( 0, 0, 1 );
-    proc_neighbors_send[5] = system->local_grid->neighborRank( 0, 0, -1 );
+    proc_neighbors_send[0] = system->neighbor_rank( 1, 0, 0 );
+    proc_neighbors_send[1] = system->neighbor_rank( -1, 0, 0 );
+    proc_neighbors_send[2] = system->neighbor_rank( 0, 1, 0 );
+    proc_neighbors_send[3] = system->neighbor_rank( 0, -1, 0 );
+    proc_neighbors_send[4] = system->neighbor_rank( 0, 0, 1 );
+    proc_neighbors_send[5] = system->neighbor_rank( 0, 0, -1 );
 
     proc_neighbors_recv[0] = proc_neighbors_send[1];
     proc_neighbors_recv[1] = proc_neighbors_send[0];
@@ -116,83 +170,111 @@ void Comm<t_System>::create_domain_decomposition()
         neighbors_dist[p].resize(
             std::distance( neighbors_dist[p].begin(), unique_end ) );
     }
+
+    for ( int i = -1; i < 2; i++ )
+        for ( int j = -1; j < 2; j++ )
+            for ( int k = -1; k < 2; k++ )
+                proc_neighbors_27[( i + 1 ) * 9 + ( j + 1 ) * 3 + k + 1] =
+                    system->neighbor_rank( i, j, k );
+
+    // Every offset must map to a distinct rank for the periodic shift of a
+    // ghost to be known from its destination alone
+    comm_26 = false;
+    if ( comm_type == COMM_MPI_26 )
+    {
+        if ( proc_grid[0] >= 3 && proc_grid[1] >= 3 && proc_grid[2] >= 3 )
+            comm_26 = true;
+        else if ( proc_rank == 0 )
+            log( std::cout, "Warning: --comm-type MPI_26 requires at least 3 "
+                            "ranks in every dimension; using 6 phase MPI." );
+    }
+    halo_phases = comm_26 ? 1 : 6;
+
+    neighbors_27.assign( proc_neighbors_27, proc_neighbors_27 + 27 );
+    std::sort( neighbors_27.begin(), neighbors_27.end() );
+    auto unique_27 = std::unique( neighbors_27.begin(), neighbors_27.end() );
+    neighbors_27.resize( std::distance( neighbors_27.begin(), unique_27 ) );
+    neighbors_26.clear();
+    for ( auto n : neighbors_27 )
+        if ( n != proc_rank )
+            neighbors_26.push_back( n );
 }
 
 template <class t_System>
 void Comm<t_System>::scan_int( T_INT *vals, T_INT count )
 {
-    if ( std::is_same<T_INT, int>::value )
-    {
-        MPI_Scan( MPI_IN_PLACE, vals, count, MPI_INT, MPI_SUM, MPI_COMM_WORLD );
-    }
+    MPI_Scan( MPI_IN_PLACE, vals, count, mpi_datatype( T_INT() ), MPI_SUM,
+              MPI_COMM_WORLD );
 }
 
 template <class t_System>
 void Comm<t_System>::reduce_int( T_INT *vals, T_INT count )
 {
-    if ( std::is_same<T_INT, int>::value )
-    {
-        MPI_Allreduce( MPI_IN_PLACE, vals, count, MPI_INT, MPI_SUM,
-                       MPI_COMM_WORLD );
-    }
+    MPI_Allreduce( MPI_IN_PLACE, vals, count, mpi_datatype( T_INT() ),
+                   MPI_SUM, MPI_COMM_WORLD );
 }
 
 template <class t_System>
 void Comm<t_System>::reduce_float( T_FLOAT *vals, T_INT count )
 {
-    if ( std::is_same<T_FLOAT, double>::value )
-    {
-        // This generates MPI_ERR_BUFFER for count>1
-        MPI_Allreduce( MPI_IN_PLACE, vals, count, MPI_DOUBLE, MPI_SUM,
-                       MPI_COMM_WORLD );
-    }
+    MPI_Allreduce( MPI_IN_PLACE, vals, count, mpi_datatype( T_FLOAT() ),
+                   MPI_SUM, MPI_COMM_WORLD );
+}
+
+template <class t_System>
+void Comm<t_System>::reduce_int_start( T_INT *vals, T_INT count,
+                                       MPI_Request *request )
+{
+    MPI_Iallreduce( MPI_IN_PLACE, vals, count, mpi_datatype( T_INT() ),
+                    MPI_SUM, MPI_COMM_WORLD, request );
+}
+
+template <class t_System>
+void Comm<t_System>::reduce_float_start( T_FLOAT *vals, T_INT count,
+                                         MPI_Request *request )
+{
+    MPI_Iallreduce( MPI_IN_PLACE, vals, count, mpi_datatype( T_FLOAT() ),
+                    MPI_SUM, MPI_COMM_WORLD, request );
 }
 
 template <class t_System>
 void Comm<t_System>::reduce_max_int( T_INT *vals, T_INT count )
 {
-    if ( std::is_same<T_INT, int>::value )
-    {
-        MPI_Allreduce( MPI_IN_PLACE, vals, count, MPI_INT, MPI_MAX,
-                       MPI_COMM_WORLD );
-    }
+    MPI_Allreduce( MPI_IN_PLACE, vals, count, mpi_datatype( T_INT() ),
+                   MPI_MAX, MPI_COMM_WORLD );
 }
 
 template <class t_System>
 void Comm<t_System>::reduce_max_float( T_FLOAT *vals, T_INT count )
 {
-    if ( std::is_same<T_FLOAT, double>::value )
-    {
-        MPI_Allreduce( MPI_IN_PLACE, vals, count, MPI_DOUBLE, MPI_MAX,
-                       MPI_COMM_WORLD );
-    }
+    MPI_Allreduce( MPI_IN_PLACE, vals, count, mpi_datatype( T_FLOAT() ),
+                   MPI_MAX, MPI_COMM_WORLD );
 }
 
 template <class t_System>
 void Comm<t_System>::reduce_min_int( T_INT *vals, T_INT count )
 {
-    if ( std::is_same<T_INT, int>::value )
-    {
-        MPI_Allreduce( MPI_IN_PLACE, vals, count, MPI_INT, MPI_MAX,
-                       MPI_COMM_WORLD );
-    }
+    MPI_Allreduce( MPI_IN_PLACE, vals, count, mpi_datatype( T_INT() ),
+                   MPI_MIN, MPI_COMM_WORLD );
 }
 
 template <class t_System>
 void Comm<t_System>::reduce_min_float( T_FLOAT *vals, T_INT count )
 {
-    if ( std::is_same<T_FLOAT, double>::value )
-    {
-        MPI_Allreduce( MPI_IN_PLACE, vals, count, MPI_DOUBLE, MPI_MAX,
-                       MPI_COMM_WORLD );
-    }
+    MPI_Allreduce( MPI_IN_PLACE, vals, count, mpi_datatype( T_FLOAT() ),
+                   MPI_MIN, MPI_COMM_WORLD );
 }
 
 template <class t_System>
 void Comm<t_System>::exchange()
 {
+    if ( comm_26 )
+    {
+        exchange_26();
+        return;
+    }
 
-    Kokkos::Profiling::pushRegion( "Comm::exchange" );
+    profile_push( "Comm::exchange" );
 
     N_local = system->N_local;
     system->resize( N_local );
@@ -200,13 +282,9 @@ void Comm<t_System>::exchange()
     s = *system;
     x = s.x;
 
-    max_local = x.size() * 1.1;
-
     std::shared_ptr<Cabana::Distributor<device_type>> distributor;
 
-    pack_ranks_migrate_all =
-        Kokkos::View<T_INT *, Kokkos::LayoutRight, device_type>(
-            "pack_ranks_migrate", max_local );
+    reserve_migrate( x.size() );
     Kokkos::parallel_for(
         "CommMPI::exchange_self",
         Kokkos::RangePolicy<exe_space, TagExchangeSelf,
@@ -218,6 +296,7 @@ void Comm<t_System>::exchange()
 
     for ( phase = 0; phase < 6; phase++ )
     {
+        ProfileRegion region( "phase " + std::to_string( phase ) );
         proc_num_send[phase] = 0;
         proc_num_recv[phase] = 0;
 
@@ -229,10 +308,7 @@ void Comm<t_System>::exchange()
             // If a previous phase resized the AoSoA, export ranks needs to be
             // resized as well
             if ( pack_ranks_migrate_all.extent( 0 ) < x.size() )
-            {
-                max_local *= 1.1;
-                Kokkos::realloc( pack_ranks_migrate_all, max_local );
-            }
+                reserve_migrate( x.size() );
             pack_ranks_migrate =
                 Kokkos::subview( pack_ranks_migrate_all,
                                  std::pair<size_t, size_t>( 0, x.size() ) );
@@ -271,14 +347,19 @@ void Comm<t_System>::exchange()
     system->N_local = N_local;
     system->N_ghost = 0;
 
-    Kokkos::Profiling::popRegion();
+    profile_pop();
 }
 
 template <class t_System>
 void Comm<t_System>::exchange_halo()
 {
+    if ( comm_26 )
+    {
+        exchange_halo_26();
+        return;
+    }
 
-    Kokkos::Profiling::pushRegion( "Comm::exchange_halo" );
+    profile_push( "Comm::exchange_halo" );
 
     N_local = system->N_local;
     N_ghost = 0;
@@ -289,6 +370,7 @@ void Comm<t_System>::exchange_halo()
 
     for ( phase = 0; phase < 6; phase++ )
     {
+        ProfileRegion region( "phase " + std::to_string( phase ) );
         pack_indicies =
             Kokkos::subview( pack_indicies_all, phase, Kokkos::ALL() );
         pack_ranks = Kokkos::subview( pack_ranks_all, phase, Kokkos::ALL() );
@@ -306,15 +388,14 @@ void Comm<t_System>::exchange_halo()
             *this );
 
         Kokkos::deep_copy( count, pack_count );
-        if ( (unsigned)count > pack_indicies.extent( 0 ) )
+        const bool overflow = (unsigned)count > pack_indicies.extent( 0 );
+        reserve_pack( count );
+        pack_indicies =
+            Kokkos::subview( pack_indicies_all, phase, Kokkos::ALL() );
+        pack_ranks = Kokkos::subview( pack_ranks_all, phase, Kokkos::ALL() );
+        if ( overflow )
         {
-            Kokkos::resize( pack_indicies_all, 6, count * 1.1 );
-            pack_indicies =
-                Kokkos::subview( pack_indicies_all, phase, Kokkos::ALL() );
-            Kokkos::resize( pack_ranks_all, 6, count * 1.1 );
-            pack_ranks =
-                Kokkos::subview( pack_ranks_all, phase, Kokkos::ALL() );
-
+            ProfileRegion retry( "resize" );
             Kokkos::deep_copy( pack_count, 0 );
             Kokkos::parallel_for(
                 "CommMPI::halo_exchange_pack",
@@ -343,6 +424,12 @@ void Comm<t_System>::exchange_halo()
 
         Cabana::gather( *halo_all[phase], x );
         Cabana::gather( *halo_all[phase], type );
+        // Ghost charges for the real space Coulomb sum
+        if ( system->has_charge() )
+        {
+            system->slice_q();
+            Cabana::gather( *halo_all[phase], system->q );
+        }
 
         proc_num_recv[phase] = halo_all[phase]->numGhost();
         count = proc_num_recv[phase];
@@ -361,91 +448,652 @@ void Comm<t_System>::exchange_halo()
 
     system->N_ghost = N_ghost;
 
-    Kokkos::Profiling::popRegion();
+    create_halo_plan();
+
+    profile_pop();
 }
 
 template <class t_System>
-void Comm<t_System>::update_halo()
+void Comm<t_System>::exchange_26()
+{
+
+    profile_push( "Comm::exchange_26" );
+
+    N_local = system->N_local;
+    system->resize( N_local );
+    system->slice_x();
+    s = *system;
+    x = s.x;
+
+    reserve_migrate( x.size() );
+    pack_ranks_migrate = Kokkos::subview(
+        pack_ranks_migrate_all, std::pair<size_t, size_t>( 0, x.size() ) );
+
+    Kokkos::parallel_for(
+        "CommMPI::exchange_pack_26",
+        Kokkos::RangePolicy<exe_space, TagExchangePack26,
+                            Kokkos::IndexType<T_INT>>( 0, x.size() ),
+        *this );
+
+    // One migrate to all neighbors; the distributor topology includes self
+    auto distributor = std::make_shared<Cabana::Distributor<device_type>>(
+        MPI_COMM_WORLD, pack_ranks_migrate, neighbors_27 );
+    system->migrate( distributor );
+    system->resize( distributor->totalNumImport() );
+
+    N_local = distributor->totalNumImport();
+    system->N_local = N_local;
+    system->N_ghost = 0;
+
+    profile_pop();
+}
+
+template <class t_System>
+void Comm<t_System>::exchange_halo_26()
 {
 
-    Kokkos::Profiling::pushRegion( "Comm::update_halo" );
+    profile_push( "Comm::exchange_halo_26" );
 
     N_local = system->N_local;
     N_ghost = 0;
+
     system->slice_x();
     s = *system;
     x = s.x;
 
-    for ( phase = 0; phase < 6; phase++ )
+    pack_indicies = Kokkos::subview( pack_indicies_all, 0, Kokkos::ALL() );
+    pack_ranks = Kokkos::subview( pack_ranks_all, 0, Kokkos::ALL() );
+
+    T_INT count = 0;
+    Kokkos::deep_copy( pack_count, 0 );
+    Kokkos::parallel_for(
+        "CommMPI::halo_exchange_pack_26",
+        Kokkos::RangePolicy<exe_space, TagHaloPack26,
+                            Kokkos::IndexType<T_INT>>( 0, N_local ),
+        *this );
+
+    Kokkos::deep_copy( count, pack_count );
+    const bool overflow = (unsigned)count > pack_indicies.extent( 0 );
+    reserve_pack( count );
+    pack_indicies = Kokkos::subview( pack_indicies_all, 0, Kokkos::ALL() );
+    pack_ranks = Kokkos::subview( pack_ranks_all, 0, Kokkos::ALL() );
+    if ( overflow )
     {
-        pack_indicies = Kokkos::subview(
-            pack_indicies_all, phase,
-            std::pair<size_t, size_t>( 0, proc_num_send[phase] ) );
-        pack_ranks = Kokkos::subview(
-            pack_ranks_all, phase,
-            std::pair<size_t, size_t>( 0, proc_num_send[phase] ) );
+        Kokkos::deep_copy( pack_count, 0 );
+        Kokkos::parallel_for(
+            "CommMPI::halo_exchange_pack_26",
+            Kokkos::RangePolicy<exe_space, TagHaloPack26,
+                                Kokkos::IndexType<T_INT>>( 0, N_local ),
+            *this );
+    }
+    proc_num_send[0] = count;
 
-        system->resize( halo_all[phase]->numLocal() +
-                        halo_all[phase]->numGhost() );
-        system->slice_x();
-        s = *system;
-        x = s.x;
-        Cabana::gather( *halo_all[phase], x );
+    pack_indicies = Kokkos::subview(
+        pack_indicies, std::pair<size_t, size_t>( 0, proc_num_send[0] ) );
+    pack_ranks = Kokkos::subview(
+        pack_ranks, std::pair<size_t, size_t>( 0, proc_num_send[0] ) );
+
+    auto halo = std::make_shared<Cabana::Halo<device_type>>(
+        MPI_COMM_WORLD, N_local, pack_indicies, pack_ranks, neighbors_26 );
+    halo_all[0] = halo;
+    system->resize( halo->numLocal() + halo->numGhost() );
+    system->slice_x();
+    system->slice_type();
+    s = *system;
+    x = s.x;
+    type = s.type;
+
+    Cabana::gather( *halo, type );
+    if ( system->has_charge() )
+    {
+        system->slice_q();
+        Cabana::gather( *halo, system->q );
+    }
+
+    // Periodic shift for each export, grouped by neighbor in the halo
+    if ( halo_shift.extent( 0 ) < halo->totalNumExport() )
+        Kokkos::realloc( halo_shift,
+                         buffer_capacity.capacity( halo->totalNumExport(),
+                                                   halo_shift.extent( 0 ) ) );
+    auto shift_host = Kokkos::create_mirror_view( halo_shift );
+    const double global[3] = {s.global_mesh_x, s.global_mesh_y,
+                              s.global_mesh_z};
+    std::size_t export_offset = 0;
+    for ( int n = 0; n < halo->numNeighbor(); n++ )
+    {
+        int offset = 0;
+        while ( proc_neighbors_27[offset] != halo->neighborRank( n ) )
+            offset++;
+        const int o[3] = {offset / 9 - 1, ( offset / 3 ) % 3 - 1,
+                          offset % 3 - 1};
+        T_X_FLOAT shift[3];
+        for ( int d = 0; d < 3; d++ )
+        {
+            shift[d] = 0.0;
+            if ( o[d] == 1 && proc_pos[d] == proc_grid[d] - 1 )
+                shift[d] = -global[d];
+            if ( o[d] == -1 && proc_pos[d] == 0 )
+                shift[d] = global[d];
+        }
+        for ( int i = 0; i < halo->numExport( n ); i++ )
+            for ( int d = 0; d < 3; d++ )
+                shift_host( export_offset + i, d ) = shift[d];
+        export_offset += halo->numExport( n );
+    }
+    Kokkos::deep_copy( halo_shift, shift_host );
+
+    proc_num_recv[0] = halo->numGhost();
+
+    create_halo_plan();
+    halo_pack_x( 0 );
+    Kokkos::fence();
+    halo_start_x( 0 );
+    halo_finish_x( 0 );
+    Kokkos::fence();
+
+    system->N_ghost = N_ghost;
+
+    profile_pop();
+}
+
+template <class t_System>
+void Comm<t_System>::reserve_migrate( std::size_t n )
+{
+    const std::size_t current = pack_ranks_migrate_all.extent( 0 );
+    const std::size_t capacity = migrate_capacity.capacity( n, current );
+    // Refilled before every use, nothing to keep
+    if ( capacity != current )
+        pack_ranks_migrate_all =
+            Kokkos::View<T_INT *, Kokkos::LayoutRight, device_type>(
+                "Comm::pack_ranks_migrate", capacity );
+}
+
+template <class t_System>
+void Comm<t_System>::reserve_pack( std::size_t n )
+{
+    const std::size_t current = pack_indicies_all.extent( 1 );
+    const std::size_t capacity = pack_capacity.capacity( n, current );
+    // Each Halo keeps its own copy of the earlier phases' lists
+    if ( capacity != current )
+    {
+        Kokkos::resize( pack_indicies_all, 6, capacity );
+        Kokkos::resize( pack_ranks_all, 6, capacity );
+    }
+}
+
+template <class t_System>
+void Comm<t_System>::create_halo_plan()
+{
+    halo_all_self = true;
+    for ( int p = 0; p < halo_phases; p++ )
+    {
+        auto halo = halo_all[p];
+        std::size_t num_export = halo->totalNumExport();
+        std::size_t num_import = halo->totalNumImport();
+
+        bool self = true;
+        for ( int n = 0; n < halo->numNeighbor(); n++ )
+            if ( halo->neighborRank( n ) != proc_rank )
+                self = false;
+        halo_self[p] = self;
+        halo_all_self = halo_all_self && self;
+
+        // Grow only; requests are rebuilt below regardless
+        if ( halo_send_x[p].extent( 0 ) < num_export )
+            Kokkos::realloc( halo_send_x[p],
+                             buffer_capacity.capacity(
+                                 num_export, halo_send_x[p].extent( 0 ) ) );
+        if ( halo_recv_x[p].extent( 0 ) < num_import )
+            Kokkos::realloc( halo_recv_x[p],
+                             buffer_capacity.capacity(
+                                 num_import, halo_recv_x[p].extent( 0 ) ) );
+        if ( halo_send_f[p].extent( 0 ) < num_import )
+            Kokkos::realloc( halo_send_f[p],
+                             buffer_capacity.capacity(
+                                 num_import, halo_send_f[p].extent( 0 ) ) );
+        if ( halo_recv_f[p].extent( 0 ) < num_export )
+            Kokkos::realloc( halo_recv_f[p],
+                             buffer_capacity.capacity(
+                                 num_export, halo_recv_f[p].extent( 0 ) ) );
+        if ( halo_staged )
+        {
+            if ( host_send_x[p].extent( 0 ) != halo_send_x[p].extent( 0 ) )
+                Kokkos::realloc( host_send_x[p], halo_send_x[p].extent( 0 ) );
+            if ( host_recv_x[p].extent( 0 ) != halo_recv_x[p].extent( 0 ) )
+                Kokkos::realloc( host_recv_x[p], halo_recv_x[p].extent( 0 ) );
+            if ( host_send_f[p].extent( 0 ) != halo_send_f[p].extent( 0 ) )
+                Kokkos::realloc( host_send_f[p], halo_send_f[p].extent( 0 ) );
+            if ( host_recv_f[p].extent( 0 ) != halo_recv_f[p].extent( 0 ) )
+                Kokkos::realloc( host_recv_f[p], halo_recv_f[p].extent( 0 ) );
+        }
+        T_X_FLOAT *send_x =
+            halo_staged ? host_send_x[p].data() : halo_send_x[p].data();
+        T_X_FLOAT *recv_x =
+            halo_staged ? host_recv_x[p].data() : halo_recv_x[p].data();
+        T_F_FLOAT *send_f =
+            halo_staged ? host_send_f[p].data() : halo_send_f[p].data();
+        T_F_FLOAT *recv_f =
+            halo_staged ? host_recv_f[p].data() : halo_recv_f[p].data();
+
+        for ( auto &request : halo_requests_x[p] )
+            MPI_Request_free( &request );
+        for ( auto &request : halo_requests_f[p] )
+            MPI_Request_free( &request );
+        halo_requests_x[p].clear();
+        halo_requests_f[p].clear();
+
+        // Positions go local -> ghost, forces ghost -> local, so the force
+        // buffers mirror the position buffers
+        const int tag_x = 1000 + p;
+        const int tag_f = 2000 + p;
+        MPI_Request request;
+        int num_n = halo->numNeighbor();
+        std::size_t export_offset = 0;
+        std::size_t import_offset = 0;
+        for ( int n = 0; n < num_n; n++ )
+        {
+            int rank = halo->neighborRank( n );
+            int bytes_x_import = 3 * halo->numImport( n ) * sizeof( T_X_FLOAT );
+            int bytes_f_export = 3 * halo->numExport( n ) * sizeof( T_F_FLOAT );
+
+            MPI_Recv_init( recv_x + 3 * import_offset,
+                           bytes_x_import, MPI_BYTE, rank, tag_x, halo->comm(),
+                           &request );
+            halo_requests_x[p].push_back( request );
+            MPI_Recv_init( recv_f + 3 * export_offset,
+                           bytes_f_export, MPI_BYTE, rank, tag_f, halo->comm(),
+                           &request );
+            halo_requests_f[p].push_back( request );
+
+            export_offset += halo->numExport( n );
+            import_offset += halo->numImport( n );
+        }
+        export_offset = 0;
+        import_offset = 0;
+        for ( int n = 0; n < num_n; n++ )
+        {
+            int rank = halo->neighborRank( n );
+            int bytes_x_export = 3 * halo->numExport( n ) * sizeof( T_X_FLOAT );
+            int bytes_f_import = 3 * halo->numImport( n ) * sizeof( T_F_FLOAT );
+
+            MPI_Send_init( send_x + 3 * export_offset,
+                           bytes_x_export, MPI_BYTE, rank, tag_x, halo->comm(),
+                           &request );
+            halo_requests_x[p].push_back( request );
+            MPI_Send_init( send_f + 3 * import_offset,
+                           bytes_f_import, MPI_BYTE, rank, tag_f, halo->comm(),
+                           &request );
+            halo_requests_f[p].push_back( request );
+
+            export_offset += halo->numExport( n );
+            import_offset += halo->numImport( n );
+        }
+    }
+
+    if ( halo_scalar )
+        create_halo_plan_scalar();
+}
+
+// Buffers and persistent requests for one value per ghost, mirroring the
+// position plan
+template <class t_System>
+void Comm<t_System>::create_halo_plan_scalar()
+{
+    halo_scalar = true;
+    for ( int p = 0; p < halo_phases; p++ )
+    {
+        auto halo = halo_all[p];
+        std::size_t num_export = halo->totalNumExport();
+        std::size_t num_import = halo->totalNumImport();
+
+        if ( halo_send_s[p].extent( 0 ) < num_export )
+            Kokkos::realloc( halo_send_s[p],
+                             buffer_capacity.capacity(
+                                 num_export, halo_send_s[p].extent( 0 ) ) );
+        if ( halo_recv_s[p].extent( 0 ) < num_import )
+            Kokkos::realloc( halo_recv_s[p],
+                             buffer_capacity.capacity(
+                                 num_import, halo_recv_s[p].extent( 0 ) ) );
+        if ( halo_staged )
+        {
+            if ( host_send_s[p].extent( 0 ) != halo_send_s[p].extent( 0 ) )
+                Kokkos::realloc( host_send_s[p], halo_send_s[p].extent( 0 ) );
+            if ( host_recv_s[p].extent( 0 ) != halo_recv_s[p].extent( 0 ) )
+                Kokkos::realloc( host_recv_s[p], halo_recv_s[p].extent( 0 ) );
+        }
+        T_FLOAT *send =
+            halo_staged ? host_send_s[p].data() : halo_send_s[p].data();
+        T_FLOAT *recv =
+            halo_staged ? host_recv_s[p].data() : halo_recv_s[p].data();
+
+        for ( auto &request : halo_requests_s[p] )
+            MPI_Request_free( &request );
+        halo_requests_s[p].clear();
+
+        const int tag = 3000 + p;
+        MPI_Request request;
+        int num_n = halo->numNeighbor();
+        std::size_t import_offset = 0;
+        for ( int n = 0; n < num_n; n++ )
+        {
+            int bytes = halo->numImport( n ) * sizeof( T_FLOAT );
+            MPI_Recv_init( recv + import_offset, bytes, MPI_BYTE,
+                           halo->neighborRank( n ), tag, halo->comm(),
+                           &request );
+            halo_requests_s[p].push_back( request );
+            import_offset += halo->numImport( n );
+        }
+        std::size_t export_offset = 0;
+        for ( int n = 0; n < num_n; n++ )
+        {
+            int bytes = halo->numExport( n ) * sizeof( T_FLOAT );
+            MPI_Send_init( send + export_offset, bytes, MPI_BYTE,
+                           halo->neighborRank( n ), tag, halo->comm(),
+                           &request );
+            halo_requests_s[p].push_back( request );
+            export_offset += halo->numExport( n );
+        }
+    }
+}
+
+template <class t_System>
+void Comm<t_System>::halo_pack_x( int p )
+{
+    ProfileRegion region( "pack " + std::to_string( p ) );
+    auto halo = halo_all[p];
+    auto steering = halo->getExportSteering();
+    auto send = halo_self[p] ? halo_recv_x[p] : halo_send_x[p];
+    auto x_copy = x;
 
+    if ( comm_26 )
+    {
+        auto shift = halo_shift;
+        Kokkos::parallel_for(
+            "CommMPI::halo_update_pack_26",
+            Kokkos::RangePolicy<exe_space>( 0, halo->totalNumExport() ),
+            KOKKOS_LAMBDA( const int i ) {
+                for ( int d = 0; d < 3; d++ )
+                    send( i, d ) = x_copy( steering( i ), d ) + shift( i, d );
+            } );
+        return;
+    }
+
+    Kokkos::parallel_for(
+        "CommMPI::halo_update_pack",
+        Kokkos::RangePolicy<exe_space>( 0, halo->totalNumExport() ),
+        KOKKOS_LAMBDA( const int i ) {
+            for ( int d = 0; d < 3; d++ )
+                send( i, d ) = x_copy( steering( i ), d );
+        } );
+}
+
+template <class t_System>
+void Comm<t_System>::halo_start_x( int p )
+{
+    if ( halo_self[p] )
+        return;
+
+    // Packed buffers must be complete before MPI reads them
+    Kokkos::fence();
+    if ( halo_staged )
+        halo_stage( host_send_x[p], halo_send_x[p],
+                    halo_all[p]->totalNumExport() );
+    auto &requests = halo_requests_x[p];
+    MPI_Startall( requests.size(), requests.data() );
+}
+
+template <class t_System>
+template <class t_dst, class t_src>
+void Comm<t_System>::halo_stage( t_dst dst, t_src src, std::size_t n )
+{
+    ProfileRegion region( "stage" );
+    auto range = std::make_pair( std::size_t( 0 ), n );
+    Kokkos::deep_copy( Kokkos::subview( dst, range, Kokkos::ALL() ),
+                       Kokkos::subview( src, range, Kokkos::ALL() ) );
+}
+
+template <class t_System>
+void Comm<t_System>::halo_finish_x( int p )
+{
+    ProfileRegion region( "phase " + std::to_string( p ) );
+    auto &requests = halo_requests_x[p];
+    auto halo = halo_all[p];
+    if ( !halo_self[p] )
+        MPI_Waitall( requests.size(), requests.data(), MPI_STATUSES_IGNORE );
+    if ( !halo_self[p] && halo_staged )
+        halo_stage( halo_recv_x[p], host_recv_x[p], halo->totalNumImport() );
+
+    auto recv = halo_recv_x[p];
+    auto x_copy = x;
+    T_INT num_local = halo->numLocal();
+
+    Kokkos::parallel_for(
+        "CommMPI::halo_update_unpack",
+        Kokkos::RangePolicy<exe_space>( 0, halo->totalNumImport() ),
+        KOKKOS_LAMBDA( const int i ) {
+            for ( int d = 0; d < 3; d++ )
+                x_copy( num_local + i, d ) = recv( i, d );
+        } );
+
+    // 26 neighbor ghosts were shifted by the sender
+    if ( !comm_26 )
+    {
+        phase = p;
         Kokkos::parallel_for(
             "CommMPI::halo_update_PBC",
             Kokkos::RangePolicy<exe_space, TagHaloPBC,
                                 Kokkos::IndexType<T_INT>>(
-                halo_all[phase]->numLocal(),
-                halo_all[phase]->numLocal() + halo_all[phase]->numGhost() ),
+                halo->numLocal(), halo->numLocal() + halo->numGhost() ),
             *this );
+    }
 
-        N_ghost += proc_num_recv[phase];
+    N_ghost += proc_num_recv[p];
+}
+
+template <class t_System>
+void Comm<t_System>::update_halo()
+{
+    update_halo_start();
+    update_halo_finish();
+}
+
+template <class t_System>
+void Comm<t_System>::update_halo_start()
+{
+
+    profile_push( "Comm::update_halo_start" );
+
+    N_local = system->N_local;
+    N_ghost = 0;
+    // The AoSoA already holds all ghosts from exchange_halo: no resize.
+    // The mesh copy in s is current from the last exchange.
+    system->slice_x();
+    x = system->x;
+
+    if ( halo_phases == 1 )
+    {
+        halo_pack_x( 0 );
+        halo_start_x( 0 );
+        profile_pop();
+        return;
     }
 
-    Kokkos::Profiling::popRegion();
+    // Each -dim phase only sends what the +dim phase did not receive, so
+    // both phases in a dimension can be in flight together
+    halo_pack_x( 0 );
+    halo_pack_x( 1 );
+    halo_start_x( 0 );
+    halo_start_x( 1 );
+
+    profile_pop();
+}
+
+template <class t_System>
+void Comm<t_System>::update_halo_finish()
+{
+
+    profile_push( "Comm::update_halo_finish" );
+
+    halo_finish_x( 0 );
+    if ( halo_phases > 1 )
+        halo_finish_x( 1 );
+
+    for ( int p = 2; p < halo_phases; p += 2 )
+    {
+        halo_pack_x( p );
+        halo_pack_x( p + 1 );
+        halo_start_x( p );
+        halo_start_x( p + 1 );
+        halo_finish_x( p );
+        halo_finish_x( p + 1 );
+    }
+    // Device-only updates stay queued behind the force kernels
+    if ( !halo_all_self )
+        Kokkos::fence();
+
+    profile_pop();
 }
 
 template <class t_System>
 void Comm<t_System>::update_force()
 {
 
-    Kokkos::Profiling::pushRegion( "Comm::update_force" );
+    profile_push( "Comm::update_force" );
 
     N_local = system->N_local;
     N_ghost = 0;
     system->slice_f();
-    s = *system;
-    f = s.f;
+    f = system->f;
+    auto f_copy = f;
 
-    for ( phase = 5; phase >= 0; phase-- )
+    for ( phase = halo_phases - 1; phase >= 0; phase-- )
     {
-        pack_indicies = Kokkos::subview(
-            pack_indicies_all, phase,
-            std::pair<size_t, size_t>( 0, proc_num_send[phase] ) );
-        pack_ranks = Kokkos::subview(
-            pack_ranks_all, phase,
-            std::pair<size_t, size_t>( 0, proc_num_send[phase] ) );
+        ProfileRegion region( "phase " + std::to_string( phase ) );
+        auto halo = halo_all[phase];
+        auto steering = halo->getExportSteering();
+        bool self = halo_self[phase];
+        auto recv = halo_recv_f[phase];
+        auto send = self ? recv : halo_send_f[phase];
+        T_INT num_local = halo->numLocal();
 
-        system->resize( halo_all[phase]->numLocal() +
-                        halo_all[phase]->numGhost() );
-        system->slice_f();
-        s = *system;
-        f = s.f;
-        Cabana::scatter( *halo_all[phase], f );
+        Kokkos::parallel_for(
+            "CommMPI::force_update_pack",
+            Kokkos::RangePolicy<exe_space>( 0, halo->totalNumImport() ),
+            KOKKOS_LAMBDA( const int i ) {
+                for ( int d = 0; d < 3; d++ )
+                    send( i, d ) = f_copy( num_local + i, d );
+            } );
+
+        if ( !self )
+        {
+            Kokkos::fence();
+            if ( halo_staged )
+                halo_stage( host_send_f[phase], halo_send_f[phase],
+                            halo->totalNumImport() );
+            auto &requests = halo_requests_f[phase];
+            MPI_Startall( requests.size(), requests.data() );
+            MPI_Waitall( requests.size(), requests.data(),
+                         MPI_STATUSES_IGNORE );
+            if ( halo_staged )
+                halo_stage( recv, host_recv_f[phase],
+                            halo->totalNumExport() );
+        }
+
+        Kokkos::parallel_for(
+            "CommMPI::force_update_unpack",
+            Kokkos::RangePolicy<exe_space>( 0, halo->totalNumExport() ),
+            KOKKOS_LAMBDA( const int i ) {
+                for ( int d = 0; d < 3; d++ )
+                    Kokkos::atomic_add( &f_copy( steering( i ), d ),
+                                        recv( i, d ) );
+            } );
+        if ( !self )
+            Kokkos::fence();
 
         N_ghost += proc_num_recv[phase];
     }
 
-    Kokkos::Profiling::popRegion();
+    profile_pop();
+}
+
+// Ghost update of one per-atom value (e.g. EAM embedding derivative) using
+// the existing halos and the persistent scalar plan, without touching the
+// AoSoA
+template <class t_System>
+template <class t_view>
+void Comm<t_System>::update_halo_scalar( t_view values )
+{
+
+    profile_push( "Comm::update_halo_scalar" );
+
+    if ( !halo_scalar )
+        create_halo_plan_scalar();
+
+    for ( int p = 0; p < halo_phases; p++ )
+    {
+        ProfileRegion region( "phase " + std::to_string( p ) );
+        auto halo = halo_all[p];
+        auto steering = halo->getExportSteering();
+        bool self = halo_self[p];
+        auto recv = halo_recv_s[p];
+        auto send = self ? recv : halo_send_s[p];
+        T_INT num_local = halo->numLocal();
+
+        Kokkos::parallel_for(
+            "CommMPI::scalar_update_pack",
+            Kokkos::RangePolicy<exe_space>( 0, halo->totalNumExport() ),
+            KOKKOS_LAMBDA( const int i ) {
+                send( i ) = values( steering( i ) );
+            } );
+
+        if ( !self )
+        {
+            Kokkos::fence();
+            auto send_range =
+                std::make_pair( std::size_t( 0 ), halo->totalNumExport() );
+            auto recv_range =
+                std::make_pair( std::size_t( 0 ), halo->totalNumImport() );
+            if ( halo_staged )
+                Kokkos::deep_copy(
+                    Kokkos::subview( host_send_s[p], send_range ),
+                    Kokkos::subview( send, send_range ) );
+            auto &requests = halo_requests_s[p];
+            MPI_Startall( requests.size(), requests.data() );
+            MPI_Waitall( requests.size(), requests.data(),
+                         MPI_STATUSES_IGNORE );
+            if ( halo_staged )
+                Kokkos::deep_copy(
+                    Kokkos::subview( recv, recv_range ),
+                    Kokkos::subview( host_recv_s[p], recv_range ) );
+        }
+
+        Kokkos::parallel_for(
+            "CommMPI::scalar_update_unpack",
+            Kokkos::RangePolicy<exe_space>( 0, halo->totalNumImport() ),
+            KOKKOS_LAMBDA( const int i ) {
+                values( num_local + i ) = recv( i );
+            } );
+    }
+    if ( !halo_all_self )
+        Kokkos::fence();
+
+    profile_pop();
 }
 
 template <class t_System>
 const char *Comm<t_System>::name()
 {
+    if ( comm_26 )
+        return "Comm:CabanaMPI26";
     return "Comm:CabanaMPI";
 }
 
+template <class t_System>
+bool Comm<t_System>::staged_halo()
+{
+    return halo_staged;
+}
+
 template <class t_System>
 int Comm<t_System>::process_rank()
 {
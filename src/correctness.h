@@ -0,0 +1,105 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef CORRECTNESS_H
+#define CORRECTNESS_H
+
+#include <Kokkos_Core.hpp>
+#include <Kokkos_UnorderedMap.hpp>
+
+#include <types.h>
+
+#include <string>
+
+// Squared deviations and maxima from the reference, reduced in one pass
+struct CorrectnessDelta
+{
+    T_FLOAT sumdelrsq, sumdelvsq, sumdelfsq, sumfrefsq;
+    T_FLOAT maxdelr, maxdelv, maxdelf;
+    T_INT missing;
+
+    KOKKOS_INLINE_FUNCTION
+    CorrectnessDelta()
+        : sumdelrsq( 0.0 )
+        , sumdelvsq( 0.0 )
+        , sumdelfsq( 0.0 )
+        , sumfrefsq( 0.0 )
+        , maxdelr( 0.0 )
+        , maxdelv( 0.0 )
+        , maxdelf( 0.0 )
+        , missing( 0 )
+    {
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    CorrectnessDelta &operator+=( const CorrectnessDelta &src )
+    {
+        sumdelrsq += src.sumdelrsq;
+        sumdelvsq += src.sumdelvsq;
+        sumdelfsq += src.sumdelfsq;
+        sumfrefsq += src.sumfrefsq;
+        maxdelr = maxdelr > src.maxdelr ? maxdelr : src.maxdelr;
+        maxdelv = maxdelv > src.maxdelv ? maxdelv : src.maxdelv;
+        maxdelf = maxdelf > src.maxdelf ? maxdelf : src.maxdelf;
+        missing += src.missing;
+        return *this;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    void operator+=( const volatile CorrectnessDelta &src ) volatile
+    {
+        sumdelrsq += src.sumdelrsq;
+        sumdelvsq += src.sumdelvsq;
+        sumdelfsq += src.sumdelfsq;
+        sumfrefsq += src.sumfrefsq;
+        maxdelr = maxdelr > src.maxdelr ? maxdelr : src.maxdelr;
+        maxdelv = maxdelv > src.maxdelv ? maxdelv : src.maxdelv;
+        maxdelf = maxdelf > src.maxdelf ? maxdelf : src.maxdelf;
+        missing += src.missing;
+    }
+};
+
+// Comparison against the shared reference files written by DumpBinary.
+// This rank's reference block is copied to the device and matched to the
+// current atoms by id through a device hash map, so atoms may be in any
+// order after migration and sorting.
+template <class t_System>
+class Correctness
+{
+  private:
+    using device_type = typename t_System::device_type;
+    using memory_space = typename t_System::memory_space;
+    using exe_space = typename t_System::execution_space;
+
+    std::string reference_path, output_file, error_file;
+    int rank, nprocs;
+
+    // Reference files are always double, xyz interleaved as in the file
+    Kokkos::View<T_INT *, memory_space> idref;
+    Kokkos::View<double * [3], Kokkos::LayoutRight, memory_space> xref, vref,
+        fref;
+    Kokkos::UnorderedMap<T_INT, T_INT, device_type> index;
+
+    void read( int step, T_INT n );
+
+  public:
+    Correctness( const std::string reference_path_,
+                 const std::string output_file_,
+                 const std::string error_file_ );
+
+    void check( t_System *system, int step );
+    void compare( t_System *system, CorrectnessDelta &delta );
+
+    const char *name();
+};
+
+#include <correctness_impl.h>
+#endif
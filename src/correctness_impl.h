@@ -0,0 +1,217 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#include <output.h>
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+// Sums in the first five entries, maxima in the last three
+inline void correctness_reduce( void *in, void *inout, int *len,
+                                MPI_Datatype * )
+{
+    double *a = static_cast<double *>( in );
+    double *b = static_cast<double *>( inout );
+    for ( int i = 0; i < *len; i++ )
+        if ( i % 8 < 5 )
+            b[i] += a[i];
+        else
+            b[i] = std::max( a[i], b[i] );
+}
+
+template <class t_System>
+Correctness<t_System>::Correctness( const std::string reference_path_,
+                                    const std::string output_file_,
+                                    const std::string error_file_ )
+    : reference_path( reference_path_ )
+    , output_file( output_file_ )
+    , error_file( error_file_ )
+{
+    MPI_Comm_rank( MPI_COMM_WORLD, &rank );
+    MPI_Comm_size( MPI_COMM_WORLD, &nprocs );
+}
+
+template <class t_System>
+void Correctness<t_System>::read( int step, T_INT n )
+{
+    std::ofstream err( error_file, std::ofstream::app );
+
+    std::ostringstream filename;
+    filename << reference_path << "/output." << std::setw( 10 )
+             << std::setfill( '0' ) << step;
+    FILE *fpref = fopen( filename.str().c_str(), "rb" );
+    if ( fpref == NULL )
+    {
+        log_err( err, "Cannot open input file: ", filename.str() );
+        return;
+    }
+
+    // Shared file written by DumpBinary: per rank counts, then rank blocks
+    // A mismatch stops every rank (log_err only throws on the print rank)
+    T_INT ntmp;
+    fread( &ntmp, sizeof( T_INT ), 1, fpref );
+    if ( ntmp != nprocs )
+    {
+        fclose( fpref );
+        log_err( err, "Mismatch in current and reference process counts" );
+        throw std::runtime_error( "Correctness: process count mismatch" );
+    }
+    std::vector<T_INT> counts( ntmp );
+    fread( counts.data(), sizeof( T_INT ), ntmp, fpref );
+    int mismatch = counts[rank] != n;
+    MPI_Allreduce( MPI_IN_PLACE, &mismatch, 1, MPI_INT, MPI_MAX,
+                   MPI_COMM_WORLD );
+    if ( mismatch )
+    {
+        fclose( fpref );
+        log_err( err, "Mismatch in current and reference atom counts" );
+        throw std::runtime_error( "Correctness: atom count mismatch" );
+    }
+    long atoms_before = 0;
+    for ( int r = 0; r < rank; r++ )
+        atoms_before += counts[r];
+    fseek( fpref,
+           atoms_before * ( 2 * sizeof( T_INT ) + 10 * sizeof( double ) ),
+           SEEK_CUR );
+
+    if ( idref.extent( 0 ) < (std::size_t)n )
+    {
+        Kokkos::realloc( idref, n * 1.1 );
+        Kokkos::realloc( xref, n * 1.1 );
+        Kokkos::realloc( vref, n * 1.1 );
+        Kokkos::realloc( fref, n * 1.1 );
+    }
+    auto h_idref = Kokkos::create_mirror_view( idref );
+    auto h_xref = Kokkos::create_mirror_view( xref );
+    auto h_vref = Kokkos::create_mirror_view( vref );
+    auto h_fref = Kokkos::create_mirror_view( fref );
+
+    // Block: id, type, q, x, v, f; type and q are not compared
+    fread( h_idref.data(), sizeof( T_INT ), n, fpref );
+    fseek( fpref, n * ( sizeof( T_INT ) + sizeof( double ) ), SEEK_CUR );
+    fread( h_xref.data(), sizeof( double ), 3 * n, fpref );
+    fread( h_vref.data(), sizeof( double ), 3 * n, fpref );
+    fread( h_fref.data(), sizeof( double ), 3 * n, fpref );
+    fclose( fpref );
+
+    Kokkos::deep_copy( idref, h_idref );
+    Kokkos::deep_copy( xref, h_xref );
+    Kokkos::deep_copy( vref, h_vref );
+    Kokkos::deep_copy( fref, h_fref );
+}
+
+template <class t_System>
+void Correctness<t_System>::compare( t_System *system,
+                                     CorrectnessDelta &delta )
+{
+    T_INT n = system->N_local;
+    system->slice_all();
+    auto x = system->x;
+    auto v = system->v;
+    auto f = system->f;
+    auto id = system->id;
+
+    // Current index of every local id
+    if ( index.capacity() < (uint32_t)n )
+        index = Kokkos::UnorderedMap<T_INT, T_INT, device_type>( n * 1.1 );
+    else
+        index.clear();
+    auto map = index;
+    Kokkos::parallel_for(
+        "Correctness::index", Kokkos::RangePolicy<exe_space>( 0, n ),
+        KOKKOS_LAMBDA( const int i ) { map.insert( id( i ), i ); } );
+
+    auto idref_ = idref;
+    auto xref_ = xref;
+    auto vref_ = vref;
+    auto fref_ = fref;
+    Kokkos::parallel_reduce(
+        "Correctness::compare", Kokkos::RangePolicy<exe_space>( 0, n ),
+        KOKKOS_LAMBDA( const int i, CorrectnessDelta &d ) {
+            const uint32_t found = map.find( idref_( i ) );
+            if ( !map.valid_at( found ) )
+            {
+                d.missing++;
+                return;
+            }
+            const T_INT ii = map.value_at( found );
+            for ( int k = 0; k < 3; k++ )
+            {
+                T_FLOAT delr = x( ii, k ) - xref_( i, k );
+                T_FLOAT delv = v( ii, k ) - vref_( i, k );
+                T_FLOAT delf = f( ii, k ) - fref_( i, k );
+                d.sumdelrsq += delr * delr;
+                d.sumdelvsq += delv * delv;
+                d.sumdelfsq += delf * delf;
+                d.sumfrefsq += fref_( i, k ) * fref_( i, k );
+                d.maxdelr = fmax( fabs( delr ), d.maxdelr );
+                d.maxdelv = fmax( fabs( delv ), d.maxdelv );
+                d.maxdelf = fmax( fabs( delf ), d.maxdelf );
+            }
+        },
+        delta );
+}
+
+template <class t_System>
+void Correctness<t_System>::check( t_System *system, int step )
+{
+    read( step, system->N_local );
+
+    CorrectnessDelta delta;
+    compare( system, delta );
+
+    // One reduction over ranks for both sums and maxima
+    double local[8] = {delta.sumdelrsq, delta.sumdelvsq, delta.sumdelfsq,
+                       delta.sumfrefsq, 1.0 * delta.missing, delta.maxdelr,
+                       delta.maxdelv,   delta.maxdelf};
+    double global[8];
+    MPI_Op op;
+    MPI_Op_create( correctness_reduce, 1, &op );
+    MPI_Allreduce( local, global, 8, MPI_DOUBLE, op, MPI_COMM_WORLD );
+    MPI_Op_free( &op );
+
+    if ( global[4] > 0 )
+    {
+        std::ofstream err( error_file, std::ofstream::app );
+        log_err( err, "Unable to find current ids matching ", (long)global[4],
+                 " reference ids" );
+    }
+
+    // Force error relative to the reference force norm, e.g. for reduced
+    // precision runs checked against a double reference
+    double deltafrel = global[3] > 0.0 ? sqrt( global[2] / global[3] )
+                                       : sqrt( global[2] );
+
+    if ( !print_rank() )
+        return;
+    FILE *fpout = fopen( output_file.c_str(), step == 0 ? "w" : "a" );
+    if ( step == 0 )
+        fprintf( fpout, "# timestep deltarnorm maxdelr deltavnorm maxdelv "
+                        "deltafnorm maxdelf deltafrel\n" );
+    fprintf( fpout, "%d %g %g %g %g %g %g %g\n", step, sqrt( global[0] ),
+             global[5], sqrt( global[1] ), global[6], sqrt( global[2] ),
+             global[7], deltafrel );
+    fclose( fpout );
+}
+
+template <class t_System>
+const char *Correctness<t_System>::name()
+{
+    return "Correctness:DeviceIdMap";
+}
@@ -0,0 +1,80 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#include <decomposition.h>
+#include <output.h>
+
+#include <algorithm>
+#include <iostream>
+
+bool node_decomposition( std::array<int, 3> &ranks_per_dim,
+                         MPI_Comm &grid_comm )
+{
+    int rank;
+    MPI_Comm_rank( MPI_COMM_WORLD, &rank );
+
+    MPI_Comm local;
+    int local_rank, local_size;
+    MPI_Comm_split_type( MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank,
+                         MPI_INFO_NULL, &local );
+    MPI_Comm_rank( local, &local_rank );
+    MPI_Comm_size( local, &local_size );
+
+    // Nodes are numbered by their first rank
+    MPI_Comm leaders;
+    MPI_Comm_split( MPI_COMM_WORLD, local_rank == 0 ? 0 : MPI_UNDEFINED, rank,
+                    &leaders );
+    int node[2] = {0, 0};
+    if ( local_rank == 0 )
+    {
+        MPI_Comm_rank( leaders, &node[0] );
+        MPI_Comm_size( leaders, &node[1] );
+        MPI_Comm_free( &leaders );
+    }
+    MPI_Bcast( node, 2, MPI_INT, 0, local );
+    MPI_Comm_free( &local );
+
+    int sizes[2] = {local_size, -local_size};
+    MPI_Allreduce( MPI_IN_PLACE, sizes, 2, MPI_INT, MPI_MAX, MPI_COMM_WORLD );
+    if ( sizes[0] != -sizes[1] )
+    {
+        if ( rank == 0 )
+            log( std::cout, "Warning: --decomposition NODE requires the same "
+                            "number of ranks on every node; using UNIFORM." );
+        return false;
+    }
+
+    // Long node block dimensions are split least within the node, which
+    // keeps the rank grid close to cubic
+    int node_dims[3] = {0, 0, 0};
+    int local_dims[3] = {0, 0, 0};
+    MPI_Dims_create( node[1], 3, node_dims );
+    MPI_Dims_create( local_size, 3, local_dims );
+    std::reverse( local_dims, local_dims + 3 );
+
+    int node_pos[3], local_pos[3];
+    node_pos[2] = node[0] % node_dims[2];
+    node_pos[1] = ( node[0] / node_dims[2] ) % node_dims[1];
+    node_pos[0] = node[0] / ( node_dims[1] * node_dims[2] );
+    local_pos[2] = local_rank % local_dims[2];
+    local_pos[1] = ( local_rank / local_dims[2] ) % local_dims[1];
+    local_pos[0] = local_rank / ( local_dims[1] * local_dims[2] );
+
+    int key = 0;
+    for ( int d = 0; d < 3; d++ )
+    {
+        ranks_per_dim[d] = node_dims[d] * local_dims[d];
+        key = key * ranks_per_dim[d] + node_pos[d] * local_dims[d] +
+              local_pos[d];
+    }
+    MPI_Comm_split( MPI_COMM_WORLD, 0, key, &grid_comm );
+    return true;
+}
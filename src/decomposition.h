@@ -0,0 +1,27 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef DECOMPOSITION_H
+#define DECOMPOSITION_H
+
+#include <mpi.h>
+
+#include <array>
+
+// Two level decomposition: a grid of node blocks, each split into the same
+// grid of node local ranks, so most neighbor sub domains share a node. On
+// success ranks_per_dim is set and grid_comm orders the ranks row major in
+// the rank grid (as MPI Cartesian communicators do); returns false (with a
+// warning) if nodes have different numbers of ranks.
+bool node_decomposition( std::array<int, 3> &ranks_per_dim,
+                         MPI_Comm &grid_comm );
+
+#endif
@@ -0,0 +1,119 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#include <device.h>
+
+#include <Kokkos_Core.hpp>
+
+#include <mpi.h>
+#if defined( OPEN_MPI ) && OPEN_MPI
+#include <mpi-ext.h>
+#endif
+
+#if defined( KOKKOS_ENABLE_CUDA )
+#include <cuda_runtime.h>
+#elif defined( KOKKOS_ENABLE_HIP )
+#include <hip/hip_runtime.h>
+#endif
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+
+int mpi_local_rank( int &local_size )
+{
+    int rank, local_rank;
+    MPI_Comm_rank( MPI_COMM_WORLD, &rank );
+
+    MPI_Comm local;
+    MPI_Comm_split_type( MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank,
+                         MPI_INFO_NULL, &local );
+    MPI_Comm_rank( local, &local_rank );
+    MPI_Comm_size( local, &local_size );
+    MPI_Comm_free( &local );
+    return local_rank;
+}
+
+int device_count()
+{
+    int count = 0;
+#if defined( KOKKOS_ENABLE_CUDA )
+    if ( cudaGetDeviceCount( &count ) != cudaSuccess )
+        count = 0;
+#elif defined( KOKKOS_ENABLE_HIP )
+    if ( hipGetDeviceCount( &count ) != hipSuccess )
+        count = 0;
+#endif
+    return count;
+}
+
+std::size_t device_memory()
+{
+    std::size_t free = 0, total = 0;
+#if defined( KOKKOS_ENABLE_CUDA )
+    if ( cudaMemGetInfo( &free, &total ) != cudaSuccess )
+        total = 0;
+#elif defined( KOKKOS_ENABLE_HIP )
+    if ( hipMemGetInfo( &free, &total ) != hipSuccess )
+        total = 0;
+#else
+    const long pages = sysconf( _SC_PHYS_PAGES );
+    const long page_size = sysconf( _SC_PAGE_SIZE );
+    if ( pages > 0 && page_size > 0 )
+        total = static_cast<std::size_t>( pages ) * page_size;
+#endif
+    (void)free;
+    return total;
+}
+
+bool mpi_gpu_aware()
+{
+#if defined( KOKKOS_ENABLE_CUDA ) && defined( MPIX_CUDA_AWARE_SUPPORT ) &&     \
+    MPIX_CUDA_AWARE_SUPPORT
+    if ( MPIX_Query_cuda_support() == 1 )
+        return true;
+#endif
+#if defined( KOKKOS_ENABLE_HIP ) && defined( MPIX_ROCM_AWARE_SUPPORT ) &&      \
+    MPIX_ROCM_AWARE_SUPPORT
+    if ( MPIX_Query_rocm_support() == 1 )
+        return true;
+#endif
+    for ( const char *name : {"MPICH_GPU_SUPPORT_ENABLED", "MV2_USE_CUDA"} )
+    {
+        const char *value = std::getenv( name );
+        if ( value != nullptr && std::strcmp( value, "1" ) == 0 )
+            return true;
+    }
+    return false;
+}
+
+std::vector<std::string> device_args( int argc, char *argv[] )
+{
+    std::vector<std::string> args( argv, argv + argc );
+    for ( int i = 1; i < argc; i++ )
+        if ( strstr( argv[i], "--kokkos-device-id" ) == argv[i] ||
+             strstr( argv[i], "--kokkos-num-devices" ) == argv[i] ||
+             strstr( argv[i], "--kokkos-ndevices" ) == argv[i] ||
+             strstr( argv[i], "--kokkos-map-device-id-by" ) == argv[i] )
+            return args;
+
+    // Launchers that give every rank its own device leave one visible
+    const int count = device_count();
+    if ( count > 1 )
+    {
+        int local_size;
+        const int local_rank = mpi_local_rank( local_size );
+        args.push_back( "--kokkos-device-id=" +
+                        std::to_string( local_rank % count ) );
+    }
+    return args;
+}
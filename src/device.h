@@ -0,0 +1,40 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef DEVICE_H
+#define DEVICE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Rank within this node and number of ranks on it (MPI shared memory
+// communicator)
+int mpi_local_rank( int &local_size );
+
+// Number of visible GPUs (0 without a GPU backend)
+int device_count();
+
+// Memory of the device of this rank in bytes, the node memory without a GPU
+// backend (0 if unknown)
+std::size_t device_memory();
+
+// Whether MPI accepts device buffers, where the MPI library can be queried
+// (Open MPI) or GPU support is enabled through the environment (Cray MPICH,
+// MVAPICH2)
+bool mpi_gpu_aware();
+
+// Arguments for Kokkos initialization: with several visible GPUs the node
+// local ranks are bound to them round robin, unless a device is selected
+// with --kokkos-device-id, --kokkos-num-devices or --kokkos-map-device-id-by
+std::vector<std::string> device_args( int argc, char *argv[] );
+
+#endif
@@ -0,0 +1,90 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef DUMP_BINARY_H
+#define DUMP_BINARY_H
+
+#include <Kokkos_Core.hpp>
+
+#include <types.h>
+
+#include <mpi.h>
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Binary trajectory output: one shared file per dump step. Layout: T_INT
+// nprocs, T_INT counts[nprocs], then each rank's block in rank order (id,
+// type as T_INT; q, x, v, f as double).
+//
+// Two staging slots form a pipeline: on a dump step atoms are packed on the
+// device and copied into pinned host memory, then the pinned buffers are
+// handed, through a datatype of their addresses, to a nonblocking
+// collective MPI-IO write that completes while the next steps run. A slot is
+// only reused once its previous write has completed.
+template <class t_System>
+class DumpBinary
+{
+  private:
+    using memory_space = typename t_System::memory_space;
+    using exe_space = typename t_System::execution_space;
+#ifdef KOKKOS_ENABLE_CUDA
+    using pinned_space = Kokkos::CudaHostPinnedSpace;
+#else
+    using pinned_space = Kokkos::HostSpace;
+#endif
+
+    struct Slot
+    {
+        Kokkos::View<T_INT *, memory_space> buf_int;
+        Kokkos::View<double *, memory_space> buf_real;
+        Kokkos::View<T_INT *, pinned_space> h_buf_int;
+        Kokkos::View<double *, pinned_space> h_buf_real;
+
+        // Header (rank 0) and this rank's block, written by one request
+        std::vector<T_INT> header;
+        MPI_Datatype block;
+        std::string filename;
+        MPI_File file;
+        MPI_Request request;
+        bool pending = false;
+    };
+
+    std::string path;
+    int rank, nprocs;
+
+    Slot slots[2];
+    int current;
+
+    // Host builds pack straight into the staged buffers
+    using in_place =
+        std::integral_constant<bool,
+                               std::is_same<memory_space, pinned_space>::value>;
+    void allocate( Slot &slot, std::size_t n, std::true_type );
+    void allocate( Slot &slot, std::size_t n, std::false_type );
+
+    void pack( t_System *system, Slot &slot, const std::vector<T_INT> &counts );
+    // Collective: complete the write of the slot and close its file
+    void wait( Slot &slot );
+
+  public:
+    DumpBinary( const std::string path_ );
+    ~DumpBinary();
+
+    void write( t_System *system, int step );
+    void finish();
+
+    const char *name();
+};
+
+#include <dump_binary_impl.h>
+#endif
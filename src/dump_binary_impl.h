@@ -0,0 +1,172 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#include <output.h>
+
+#include <mpi.h>
+
+#include <cstdio>
+#include <iostream>
+
+template <class t_System>
+DumpBinary<t_System>::DumpBinary( const std::string path_ )
+    : path( path_ )
+    , current( 0 )
+{
+    MPI_Comm_rank( MPI_COMM_WORLD, &rank );
+    MPI_Comm_size( MPI_COMM_WORLD, &nprocs );
+}
+
+template <class t_System>
+DumpBinary<t_System>::~DumpBinary()
+{
+    finish();
+}
+
+template <class t_System>
+void DumpBinary<t_System>::allocate( Slot &slot, std::size_t n,
+                                     std::true_type )
+{
+    Kokkos::realloc( slot.h_buf_int, 2 * n * 1.1 );
+    Kokkos::realloc( slot.h_buf_real, 10 * n * 1.1 );
+    // Same allocation: the copies to the host buffers are no-ops
+    slot.buf_int = slot.h_buf_int;
+    slot.buf_real = slot.h_buf_real;
+}
+
+template <class t_System>
+void DumpBinary<t_System>::allocate( Slot &slot, std::size_t n,
+                                     std::false_type )
+{
+    Kokkos::realloc( slot.buf_int, 2 * n * 1.1 );
+    Kokkos::realloc( slot.buf_real, 10 * n * 1.1 );
+    Kokkos::realloc( slot.h_buf_int, slot.buf_int.extent( 0 ) );
+    Kokkos::realloc( slot.h_buf_real, slot.buf_real.extent( 0 ) );
+}
+
+template <class t_System>
+void DumpBinary<t_System>::pack( t_System *system, Slot &slot,
+                                 const std::vector<T_INT> &counts )
+{
+    T_INT n = system->N_local;
+    if ( slot.buf_real.extent( 0 ) < (std::size_t)10 * n )
+        allocate( slot, n, in_place() );
+
+    // Slices are strided within the AoSoA and the file format must not
+    // depend on the build precision
+    system->slice_all();
+    auto x = system->x;
+    auto v = system->v;
+    auto f = system->f;
+    auto id = system->id;
+    auto type = system->type;
+    auto q = system->q;
+    auto buf_int = slot.buf_int;
+    auto buf_real = slot.buf_real;
+    Kokkos::parallel_for(
+        "DumpBinary::pack", Kokkos::RangePolicy<exe_space>( 0, n ),
+        KOKKOS_LAMBDA( const int i ) {
+            buf_int( i ) = id( i );
+            buf_int( n + i ) = type( i );
+            buf_real( i ) = q( i );
+            for ( int d = 0; d < 3; d++ )
+            {
+                buf_real( n + 3 * i + d ) = x( i, d );
+                buf_real( 4 * n + 3 * i + d ) = v( i, d );
+                buf_real( 7 * n + 3 * i + d ) = f( i, d );
+            }
+        } );
+    Kokkos::deep_copy( exe_space(), slot.h_buf_int, slot.buf_int );
+    Kokkos::deep_copy( exe_space(), slot.h_buf_real, slot.buf_real );
+    // MPI reads the host buffers, so the copies complete here
+    exe_space().fence();
+
+    // Rank 0 also writes the header. The blocks are described in place
+    // (absolute addresses) and counted in elements, not bytes
+    slot.header.clear();
+    if ( rank == 0 )
+    {
+        slot.header.push_back( nprocs );
+        slot.header.insert( slot.header.end(), counts.begin(), counts.end() );
+    }
+    int lengths[3] = {(int)slot.header.size(), 2 * n, 10 * n};
+    MPI_Aint addresses[3];
+    MPI_Get_address( slot.header.data(), &addresses[0] );
+    MPI_Get_address( slot.h_buf_int.data(), &addresses[1] );
+    MPI_Get_address( slot.h_buf_real.data(), &addresses[2] );
+    MPI_Datatype types[3] = {MPI_INT, MPI_INT, MPI_DOUBLE};
+    MPI_Type_create_struct( 3, lengths, addresses, types, &slot.block );
+    MPI_Type_commit( &slot.block );
+}
+
+template <class t_System>
+void DumpBinary<t_System>::wait( Slot &slot )
+{
+    if ( !slot.pending )
+        return;
+    MPI_Wait( &slot.request, MPI_STATUS_IGNORE );
+    MPI_File_close( &slot.file );
+    MPI_Type_free( &slot.block );
+    slot.pending = false;
+}
+
+template <class t_System>
+void DumpBinary<t_System>::write( t_System *system, int step )
+{
+    // The other slot may still be writing the previous dump
+    Slot &slot = slots[current];
+    current = 1 - current;
+    wait( slot );
+
+    T_INT n = system->N_local;
+    std::vector<T_INT> counts( nprocs );
+    MPI_Allgather( &n, 1, MPI_INT, counts.data(), 1, MPI_INT,
+                   MPI_COMM_WORLD );
+    pack( system, slot, counts );
+
+    // Atoms of all lower ranks precede this block
+    MPI_Offset atoms_before = 0;
+    for ( int r = 0; r < rank; r++ )
+        atoms_before += counts[r];
+    MPI_Offset offset = 0;
+    if ( rank > 0 )
+        offset = ( 1 + nprocs ) * sizeof( T_INT ) +
+                 atoms_before * ( 2 * sizeof( T_INT ) + 10 * sizeof( double ) );
+
+    char filename[1024];
+    snprintf( filename, sizeof( filename ), "%s%s.%010d", path.c_str(),
+              "/output", step );
+    slot.filename = filename;
+    if ( MPI_File_open( MPI_COMM_WORLD, filename,
+                        MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL,
+                        &slot.file ) != MPI_SUCCESS )
+        log_err( std::cerr, "Cannot open dump file: ", filename );
+    // An older, larger file of the same step must not leave trailing bytes
+    MPI_File_set_size( slot.file, 0 );
+
+    MPI_File_iwrite_at_all( slot.file, offset, MPI_BOTTOM, 1, slot.block,
+                            &slot.request );
+    slot.pending = true;
+}
+
+template <class t_System>
+void DumpBinary<t_System>::finish()
+{
+    // Oldest first, in the same order on every rank
+    wait( slots[current] );
+    wait( slots[1 - current] );
+}
+
+template <class t_System>
+const char *DumpBinary<t_System>::name()
+{
+    return "DumpBinary:AsyncMPIIO";
+}
@@ -49,11 +49,28 @@
 #ifndef FORCE_H
 #define FORCE_H
 
+#include <profile.h>
 #include <types.h>
 
 #include <string>
 #include <vector>
 
+// 0 based type bounds [lo, hi] of a pair_coeff type argument: n, * or the
+// LAMMPS ranges n*, *n and m*n
+inline void pair_coeff_types( const std::string &word, int ntypes, int &lo,
+                              int &hi )
+{
+    auto star = word.find( '*' );
+    if ( star == std::string::npos )
+    {
+        lo = hi = std::stoi( word ) - 1;
+        return;
+    }
+    lo = star > 0 ? std::stoi( word.substr( 0, star ) ) - 1 : 0;
+    hi = star + 1 < word.size() ? std::stoi( word.substr( star + 1 ) ) - 1
+                                : ntypes - 1;
+}
+
 template <class t_System, class t_Neighbor>
 class Force
 {
@@ -64,11 +81,41 @@ class Force
     virtual void init_coeff( std::vector<std::vector<std::string>> args ) = 0;
 
     virtual void compute( t_System *system, t_Neighbor *neighbor ) = 0;
-    virtual T_F_FLOAT compute_energy( t_System *, t_Neighbor * )
+
+    // Split compute for overlapping the halo update: interior atoms only
+    // need owned positions. Defaults compute everything after the halo.
+    virtual void compute_interior( t_System *, t_Neighbor * ) {}
+    virtual void compute_boundary( t_System *system, t_Neighbor *neighbor )
+    {
+        compute( system, neighbor );
+    }
+    // True if compute (and the interior/boundary split) assigns every owned
+    // atom force instead of accumulating, so the zeroing pass can be skipped
+    virtual bool assigns_force( t_Neighbor * ) { return false; }
+
+    virtual T_FLOAT compute_energy( t_System *, t_Neighbor * )
     {
         return 0.0;
     } // Only needed for thermo output
 
+    // Forces, potential energy and virial together on thermo steps (local
+    // contributions, consumed by PotE and Pressure). Only potentials that
+    // fuse the energy and virial into the force pass set thermo_valid; the
+    // default computes forces only, so PotE uses compute_energy and the
+    // virial holds just the kspace and bonded terms added to it.
+    bool thermo_valid = false;
+    T_FLOAT thermo_energy = 0.0;
+    T_FLOAT thermo_virial[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+    virtual void compute_thermo( t_System *system, t_Neighbor *neighbor )
+    {
+        compute( system, neighbor );
+        thermo_energy = 0.0;
+        for ( int v = 0; v < 6; v++ )
+            thermo_virial[v] = 0.0;
+        thermo_valid = false;
+    }
+
     virtual const char *name() { return "ForceNone"; }
     virtual const char *system_name() { return "ForceSystemNone"; }
 };
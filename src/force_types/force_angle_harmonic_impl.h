@@ -0,0 +1,158 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#include <cmath>
+
+template <class t_System>
+ForceAngleHarmonic<t_System>::ForceAngleHarmonic( t_System *system )
+    : energy( 0.0 )
+{
+    const int ntypes = system->topology->nangletypes;
+    k = t_coeff( "ForceAngleHarmonic::k", ntypes );
+    theta0 = t_coeff( "ForceAngleHarmonic::theta0", ntypes );
+    for ( int v = 0; v < 6; v++ )
+        virial[v] = 0.0;
+}
+
+template <class t_System>
+void ForceAngleHarmonic<t_System>::init_coeff(
+    std::vector<std::vector<std::string>> args )
+{
+    auto host_k = Kokkos::create_mirror_view( Kokkos::HostSpace{}, k );
+    auto host_theta0 =
+        Kokkos::create_mirror_view( Kokkos::HostSpace{}, theta0 );
+    for ( std::size_t a = 0; a < args.size(); a++ )
+    {
+        auto coeff = args.at( a );
+        int t = std::stoi( coeff.at( 1 ) ) - 1;
+        host_k( t ) = std::stod( coeff.at( 2 ) );
+        host_theta0( t ) = std::stod( coeff.at( 3 ) ) * M_PI / 180.0;
+    }
+    Kokkos::deep_copy( k, host_k );
+    Kokkos::deep_copy( theta0, host_theta0 );
+}
+
+template <class t_System>
+template <bool thermo>
+PairThermo ForceAngleHarmonic<t_System>::compute_angles( t_System *system )
+{
+    system->slice_x();
+    system->slice_f();
+    auto x = system->x;
+    auto f = system->f;
+    auto &angles = system->topology->angles;
+    auto offsets = angles.offsets;
+    auto index = angles.index;
+    auto slot = angles.slot;
+    auto type = angles.type;
+    auto k_copy = k;
+    auto theta0_copy = theta0;
+    const double L[3] = {system->global_mesh_x, system->global_mesh_y,
+                         system->global_mesh_z};
+
+    // One thread per owned atom over its own angles (atoms 1-2-3 with 2 the
+    // vertex): forces are assigned without atomics
+    PairThermo sum;
+    Kokkos::parallel_reduce(
+        "ForceAngleHarmonic::compute",
+        Kokkos::RangePolicy<exe_space>( 0, system->N_local ),
+        KOKKOS_LAMBDA( const int i, PairThermo &thermo_i ) {
+            T_F_FLOAT fi[3] = {0.0, 0.0, 0.0};
+            for ( T_INT a = offsets( i ); a < offsets( i + 1 ); a++ )
+            {
+                const T_INT i1 = index( a, 0 );
+                const T_INT i2 = index( a, 1 );
+                const T_INT i3 = index( a, 2 );
+                T_F_FLOAT del1[3], del2[3];
+                for ( int d = 0; d < 3; d++ )
+                {
+                    del1[d] = minimum_image( x( i1, d ) - x( i2, d ), L[d] );
+                    del2[d] = minimum_image( x( i3, d ) - x( i2, d ), L[d] );
+                }
+                const T_F_FLOAT rsq1 = del1[0] * del1[0] +
+                                       del1[1] * del1[1] + del1[2] * del1[2];
+                const T_F_FLOAT rsq2 = del2[0] * del2[0] +
+                                       del2[1] * del2[1] + del2[2] * del2[2];
+                const T_F_FLOAT r1 = sqrt( rsq1 );
+                const T_F_FLOAT r2 = sqrt( rsq2 );
+
+                T_F_FLOAT c = ( del1[0] * del2[0] + del1[1] * del2[1] +
+                                del1[2] * del2[2] ) /
+                              ( r1 * r2 );
+                c = MIN( MAX( c, -1.0 ), 1.0 );
+                T_F_FLOAT s = sqrt( 1.0 - c * c );
+                s = 1.0 / MAX( s, 0.001 );
+
+                const int t = type( a );
+                const T_F_FLOAT dtheta = acos( c ) - theta0_copy( t );
+                const T_F_FLOAT tk = k_copy( t ) * dtheta;
+                const T_F_FLOAT a0 = -2.0 * tk * s;
+                const T_F_FLOAT a11 = a0 * c / rsq1;
+                const T_F_FLOAT a12 = -a0 / ( r1 * r2 );
+                const T_F_FLOAT a22 = a0 * c / rsq2;
+
+                T_F_FLOAT f1[3], f3[3];
+                for ( int d = 0; d < 3; d++ )
+                {
+                    f1[d] = a11 * del1[d] + a12 * del2[d];
+                    f3[d] = a22 * del2[d] + a12 * del1[d];
+                }
+                for ( int d = 0; d < 3; d++ )
+                {
+                    if ( slot( a ) == 0 )
+                        fi[d] += f1[d];
+                    else if ( slot( a ) == 2 )
+                        fi[d] += f3[d];
+                    else
+                        fi[d] -= f1[d] + f3[d];
+                }
+
+                if ( thermo )
+                {
+                    const T_F_FLOAT third = 1.0 / 3.0;
+                    thermo_i.energy += third * tk * dtheta;
+                    thermo_i.virial[0] +=
+                        third * ( del1[0] * f1[0] + del2[0] * f3[0] );
+                    thermo_i.virial[1] +=
+                        third * ( del1[1] * f1[1] + del2[1] * f3[1] );
+                    thermo_i.virial[2] +=
+                        third * ( del1[2] * f1[2] + del2[2] * f3[2] );
+                    thermo_i.virial[3] +=
+                        third * ( del1[0] * f1[1] + del2[0] * f3[1] );
+                    thermo_i.virial[4] +=
+                        third * ( del1[0] * f1[2] + del2[0] * f3[2] );
+                    thermo_i.virial[5] +=
+                        third * ( del1[1] * f1[2] + del2[1] * f3[2] );
+                }
+            }
+            for ( int d = 0; d < 3; d++ )
+                f( i, d ) += fi[d];
+        },
+        sum );
+    return sum;
+}
+
+template <class t_System>
+void ForceAngleHarmonic<t_System>::compute( t_System *system )
+{
+    ProfileRegion region( "ForceAngleHarmonic::compute" );
+    compute_angles<false>( system );
+}
+
+template <class t_System>
+void ForceAngleHarmonic<t_System>::compute_thermo( t_System *system )
+{
+    ProfileRegion region( "ForceAngleHarmonic::compute_thermo" );
+    PairThermo thermo = compute_angles<true>( system );
+    energy = thermo.energy;
+    for ( int v = 0; v < 6; v++ )
+        virial[v] = thermo.virial[v];
+}
@@ -0,0 +1,61 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef FORCE_BOND_HARMONIC_H
+#define FORCE_BOND_HARMONIC_H
+
+#include <Cabana_Core.hpp>
+#include <Kokkos_Core.hpp>
+
+#include <pair_kernel.h>
+#include <profile.h>
+#include <topology.h>
+#include <types.h>
+
+#include <string>
+#include <vector>
+
+// bond_style harmonic: E = K ( r - r0 )^2. Both atoms of a bond hold a
+// copy (see Topology) and each computes the force on itself, so energy and
+// virial are counted at half weight.
+template <class t_System>
+class ForceBondHarmonic
+{
+  private:
+    using exe_space = typename t_System::execution_space;
+    using mem_space = typename t_System::memory_space;
+
+    typedef Kokkos::View<T_F_FLOAT *, mem_space> t_coeff;
+    t_coeff k, r0;
+
+    template <bool thermo>
+    PairThermo compute_bonds( t_System *system );
+
+  public:
+    // Local energy and virial of the last compute_thermo
+    T_FLOAT energy;
+    T_FLOAT virial[6];
+
+    ForceBondHarmonic( t_System *system );
+
+    // bond_coeff T K r0
+    void init_coeff( std::vector<std::vector<std::string>> args );
+
+    // Add the bond forces of owned atoms
+    void compute( t_System *system );
+    void compute_thermo( t_System *system );
+
+    const char *name() { return "Bond:Harmonic"; }
+};
+
+#include <force_bond_harmonic_impl.h>
+
+#endif
@@ -0,0 +1,114 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+template <class t_System>
+ForceBondHarmonic<t_System>::ForceBondHarmonic( t_System *system )
+    : energy( 0.0 )
+{
+    const int ntypes = system->topology->nbondtypes;
+    k = t_coeff( "ForceBondHarmonic::k", ntypes );
+    r0 = t_coeff( "ForceBondHarmonic::r0", ntypes );
+    for ( int v = 0; v < 6; v++ )
+        virial[v] = 0.0;
+}
+
+template <class t_System>
+void ForceBondHarmonic<t_System>::init_coeff(
+    std::vector<std::vector<std::string>> args )
+{
+    auto host_k = Kokkos::create_mirror_view( Kokkos::HostSpace{}, k );
+    auto host_r0 = Kokkos::create_mirror_view( Kokkos::HostSpace{}, r0 );
+    for ( std::size_t a = 0; a < args.size(); a++ )
+    {
+        auto coeff = args.at( a );
+        int t = std::stoi( coeff.at( 1 ) ) - 1;
+        host_k( t ) = std::stod( coeff.at( 2 ) );
+        host_r0( t ) = std::stod( coeff.at( 3 ) );
+    }
+    Kokkos::deep_copy( k, host_k );
+    Kokkos::deep_copy( r0, host_r0 );
+}
+
+template <class t_System>
+template <bool thermo>
+PairThermo ForceBondHarmonic<t_System>::compute_bonds( t_System *system )
+{
+    system->slice_x();
+    system->slice_f();
+    auto x = system->x;
+    auto f = system->f;
+    auto &bonds = system->topology->bonds;
+    auto offsets = bonds.offsets;
+    auto index = bonds.index;
+    auto slot = bonds.slot;
+    auto type = bonds.type;
+    auto k_copy = k;
+    auto r0_copy = r0;
+    const double L[3] = {system->global_mesh_x, system->global_mesh_y,
+                         system->global_mesh_z};
+
+    // One thread per owned atom over its own bonds: forces are assigned
+    // without atomics
+    PairThermo sum;
+    Kokkos::parallel_reduce(
+        "ForceBondHarmonic::compute",
+        Kokkos::RangePolicy<exe_space>( 0, system->N_local ),
+        KOKKOS_LAMBDA( const int i, PairThermo &thermo_i ) {
+            T_F_FLOAT fi[3] = {0.0, 0.0, 0.0};
+            for ( T_INT b = offsets( i ); b < offsets( i + 1 ); b++ )
+            {
+                const T_INT j = index( b, 1 - slot( b ) );
+                T_F_FLOAT dx[3];
+                for ( int d = 0; d < 3; d++ )
+                    dx[d] = minimum_image( x( i, d ) - x( j, d ), L[d] );
+                const T_F_FLOAT r =
+                    sqrt( dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2] );
+                const int t = type( b );
+                const T_F_FLOAT dr = r - r0_copy( t );
+                const T_F_FLOAT rk = k_copy( t ) * dr;
+                const T_F_FLOAT fbond = r > 0.0 ? -2.0 * rk / r : 0.0;
+                for ( int d = 0; d < 3; d++ )
+                    fi[d] += dx[d] * fbond;
+
+                if ( thermo )
+                {
+                    thermo_i.energy += 0.5 * rk * dr;
+                    thermo_i.virial[0] += 0.5 * dx[0] * dx[0] * fbond;
+                    thermo_i.virial[1] += 0.5 * dx[1] * dx[1] * fbond;
+                    thermo_i.virial[2] += 0.5 * dx[2] * dx[2] * fbond;
+                    thermo_i.virial[3] += 0.5 * dx[0] * dx[1] * fbond;
+                    thermo_i.virial[4] += 0.5 * dx[0] * dx[2] * fbond;
+                    thermo_i.virial[5] += 0.5 * dx[1] * dx[2] * fbond;
+                }
+            }
+            for ( int d = 0; d < 3; d++ )
+                f( i, d ) += fi[d];
+        },
+        sum );
+    return sum;
+}
+
+template <class t_System>
+void ForceBondHarmonic<t_System>::compute( t_System *system )
+{
+    ProfileRegion region( "ForceBondHarmonic::compute" );
+    compute_bonds<false>( system );
+}
+
+template <class t_System>
+void ForceBondHarmonic<t_System>::compute_thermo( t_System *system )
+{
+    ProfileRegion region( "ForceBondHarmonic::compute_thermo" );
+    PairThermo thermo = compute_bonds<true>( system );
+    energy = thermo.energy;
+    for ( int v = 0; v < 6; v++ )
+        virial[v] = thermo.virial[v];
+}
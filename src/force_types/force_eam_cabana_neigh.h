@@ -0,0 +1,90 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef FORCE_EAM_CABANA_NEIGH_H
+#define FORCE_EAM_CABANA_NEIGH_H
+
+#include <Cabana_Core.hpp>
+#include <Kokkos_Core.hpp>
+
+#include <comm_mpi.h>
+#include <force.h>
+
+#include <string>
+#include <vector>
+
+// Embedded atom method (pair_style eam/alloy, setfl files). Densities are
+// summed first, then the embedding derivative is sent to ghosts with a
+// scalar halo update before the force pass. Full neighbor lists only.
+template <class t_System, class t_Neighbor, class t_parallel>
+class ForceEAM : public Force<t_System, t_Neighbor>
+{
+  private:
+    int N_local, ntypes;
+
+    typedef typename t_System::t_f::atomic_access_slice t_f_a;
+
+    int step;
+
+    using exe_space = typename t_System::execution_space;
+    using mem_space = typename t_System::memory_space;
+
+    Comm<t_System> *comm;
+
+    // Per table point cubic spline: derivative (0-2) and value (3-6)
+    typedef Kokkos::View<T_F_FLOAT * * [7], mem_space,
+                         Kokkos::MemoryTraits<Kokkos::RandomAccess>>
+        t_spline;
+    typedef Kokkos::View<int **, mem_space,
+                         Kokkos::MemoryTraits<Kokkos::RandomAccess>>
+        t_pair_map;
+    typedef Kokkos::View<int *, mem_space,
+                         Kokkos::MemoryTraits<Kokkos::RandomAccess>>
+        t_type_map;
+    typedef Kokkos::View<T_FLOAT *, mem_space> t_scalar;
+
+    int nrho, nr;
+    T_F_FLOAT rdrho, rdr, cutforcesq;
+    t_spline frho_spline, rhor_spline, z2r_spline;
+    t_type_map type2frho, type2rhor;
+    t_pair_map type2z2r;
+
+    t_scalar rho, fp;
+
+    void read_setfl( const std::string file,
+                     std::vector<std::string> &elements, int &nelements,
+                     std::vector<double> &frho, std::vector<double> &rhor,
+                     std::vector<double> &z2r, double &drho, double &dr,
+                     double &cut );
+
+    template <class t_rho, class t_x, class t_type, class t_neigh>
+    void compute_density( t_rho rho_sum, const t_x x, const t_type type,
+                          const t_neigh neigh_list );
+    template <class t_type>
+    void compute_embedding( const t_type type );
+
+  public:
+    ForceEAM( t_System *system, Comm<t_System> *comm_ );
+
+    void init_coeff( std::vector<std::vector<std::string>> args ) override;
+    void compute( t_System *system, t_Neighbor *neighbor ) override;
+    T_FLOAT compute_energy( t_System *system, t_Neighbor *neighbor ) override;
+
+    template <class t_f, class t_x, class t_type, class t_neigh>
+    void compute_force_full( t_f f, const t_x x, const t_type type,
+                             const t_neigh neigh_list );
+
+    const char *name() override;
+};
+
+#include <force_eam_cabana_neigh_impl.h>
+
+#endif
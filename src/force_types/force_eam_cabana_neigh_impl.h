@@ -0,0 +1,454 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#include <output.h>
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+// Spline value and derivative at fractional position p in interval m
+template <class t_spline>
+KOKKOS_INLINE_FUNCTION T_F_FLOAT eam_value( const t_spline &s, const int t,
+                                            const int m, const T_F_FLOAT p )
+{
+    return ( ( s( t, m, 3 ) * p + s( t, m, 4 ) ) * p + s( t, m, 5 ) ) * p +
+           s( t, m, 6 );
+}
+
+template <class t_spline>
+KOKKOS_INLINE_FUNCTION T_F_FLOAT eam_deriv( const t_spline &s, const int t,
+                                            const int m, const T_F_FLOAT p )
+{
+    return ( s( t, m, 0 ) * p + s( t, m, 1 ) ) * p + s( t, m, 2 );
+}
+
+// Cubic spline coefficients for n uniformly spaced values (as in LAMMPS
+// PairEAM::interpolate)
+template <class t_host_spline>
+void eam_interpolate( const int n, const double delta, const double *f,
+                      t_host_spline &s, const int t )
+{
+    for ( int m = 0; m < n; m++ )
+        s( t, m, 6 ) = f[m];
+
+    s( t, 0, 5 ) = f[1] - f[0];
+    s( t, 1, 5 ) = 0.5 * ( f[2] - f[0] );
+    s( t, n - 2, 5 ) = 0.5 * ( f[n - 1] - f[n - 3] );
+    s( t, n - 1, 5 ) = f[n - 1] - f[n - 2];
+    for ( int m = 2; m < n - 2; m++ )
+        s( t, m, 5 ) =
+            ( ( f[m - 2] - f[m + 2] ) + 8.0 * ( f[m + 1] - f[m - 1] ) ) / 12.0;
+
+    for ( int m = 0; m < n - 1; m++ )
+    {
+        s( t, m, 4 ) = 3.0 * ( f[m + 1] - f[m] ) - 2.0 * s( t, m, 5 ) -
+                       s( t, m + 1, 5 );
+        s( t, m, 3 ) =
+            s( t, m, 5 ) + s( t, m + 1, 5 ) - 2.0 * ( f[m + 1] - f[m] );
+    }
+    s( t, n - 1, 4 ) = 0.0;
+    s( t, n - 1, 3 ) = 0.0;
+
+    for ( int m = 0; m < n; m++ )
+    {
+        s( t, m, 2 ) = s( t, m, 5 ) / delta;
+        s( t, m, 1 ) = 2.0 * s( t, m, 4 ) / delta;
+        s( t, m, 0 ) = 3.0 * s( t, m, 3 ) / delta;
+    }
+}
+
+template <class t_System, class t_Neighbor, class t_parallel>
+ForceEAM<t_System, t_Neighbor, t_parallel>::ForceEAM( t_System *system,
+                                                      Comm<t_System> *comm_ )
+    : Force<t_System, t_Neighbor>( system )
+    , comm( comm_ )
+{
+    ntypes = system->ntypes;
+    type2frho = t_type_map( "ForceEAMCabanaNeigh::type2frho", ntypes );
+    type2rhor = t_type_map( "ForceEAMCabanaNeigh::type2rhor", ntypes );
+    type2z2r = t_pair_map( "ForceEAMCabanaNeigh::type2z2r", ntypes, ntypes );
+
+    nrho = nr = 0;
+    rdrho = rdr = cutforcesq = 0.0;
+    N_local = 0;
+    step = 0;
+}
+
+template <class t_System, class t_Neighbor, class t_parallel>
+void ForceEAM<t_System, t_Neighbor, t_parallel>::read_setfl(
+    const std::string file, std::vector<std::string> &elements,
+    int &nelements, std::vector<double> &frho, std::vector<double> &rhor,
+    std::vector<double> &z2r, double &drho, double &dr, double &cut )
+{
+    std::ifstream in( file );
+    if ( !in.good() )
+        log_err( std::cerr, "Cannot open EAM potential file: ", file );
+
+    // Three comment lines, then the element list
+    std::string line;
+    for ( int l = 0; l < 4; l++ )
+        std::getline( in, line );
+    std::istringstream element_line( line );
+    element_line >> nelements;
+    elements.resize( nelements );
+    for ( int a = 0; a < nelements; a++ )
+        element_line >> elements[a];
+
+    in >> nrho >> drho >> nr >> dr >> cut;
+    if ( nrho < 5 || nr < 5 )
+        log_err( std::cerr, "Invalid EAM potential file: ", file );
+
+    frho.resize( nelements * nrho );
+    rhor.resize( nelements * nr );
+    for ( int a = 0; a < nelements; a++ )
+    {
+        // Atomic number, mass, lattice constant, lattice type
+        std::string skip;
+        in >> skip >> skip >> skip >> skip;
+        for ( int m = 0; m < nrho; m++ )
+            in >> frho[a * nrho + m];
+        for ( int m = 0; m < nr; m++ )
+            in >> rhor[a * nr + m];
+    }
+
+    // r * phi(r) for each element pair a >= b
+    int npairs = nelements * ( nelements + 1 ) / 2;
+    z2r.resize( npairs * nr );
+    for ( int n = 0; n < npairs * nr; n++ )
+        in >> z2r[n];
+
+    if ( in.fail() )
+        log_err( std::cerr, "Premature end of EAM potential file: ", file );
+}
+
+template <class t_System, class t_Neighbor, class t_parallel>
+void ForceEAM<t_System, t_Neighbor, t_parallel>::init_coeff(
+    std::vector<std::vector<std::string>> args )
+{
+    // pair_coeff * * file element_1 ... element_ntypes
+    auto pair = args.at( 0 );
+    if ( pair.size() != (unsigned)( 4 + ntypes ) )
+        log_err( std::cerr, "pair_coeff for eam/alloy requires one element "
+                            "per atom type" );
+
+    std::vector<std::string> elements;
+    std::vector<double> frho, rhor, z2r;
+    int nelements;
+    double drho, dr, cut;
+    read_setfl( pair.at( 3 ), elements, nelements, frho, rhor, z2r, drho, dr,
+                cut );
+
+    rdrho = 1.0 / drho;
+    rdr = 1.0 / dr;
+    cutforcesq = cut * cut;
+
+    int npairs = nelements * ( nelements + 1 ) / 2;
+    frho_spline =
+        t_spline( "ForceEAMCabanaNeigh::frho_spline", nelements, nrho );
+    rhor_spline = t_spline( "ForceEAMCabanaNeigh::rhor_spline", nelements, nr );
+    z2r_spline = t_spline( "ForceEAMCabanaNeigh::z2r_spline", npairs, nr );
+
+    auto host_frho =
+        Kokkos::create_mirror_view( Kokkos::HostSpace{}, frho_spline );
+    auto host_rhor =
+        Kokkos::create_mirror_view( Kokkos::HostSpace{}, rhor_spline );
+    auto host_z2r =
+        Kokkos::create_mirror_view( Kokkos::HostSpace{}, z2r_spline );
+    for ( int a = 0; a < nelements; a++ )
+    {
+        eam_interpolate( nrho, drho, &frho[a * nrho], host_frho, a );
+        eam_interpolate( nr, dr, &rhor[a * nr], host_rhor, a );
+    }
+    for ( int n = 0; n < npairs; n++ )
+        eam_interpolate( nr, dr, &z2r[n * nr], host_z2r, n );
+
+    auto host_type2frho =
+        Kokkos::create_mirror_view( Kokkos::HostSpace{}, type2frho );
+    auto host_type2rhor =
+        Kokkos::create_mirror_view( Kokkos::HostSpace{}, type2rhor );
+    auto host_type2z2r =
+        Kokkos::create_mirror_view( Kokkos::HostSpace{}, type2z2r );
+    std::vector<int> map( ntypes );
+    for ( int i = 0; i < ntypes; i++ )
+    {
+        map[i] = -1;
+        for ( int a = 0; a < nelements; a++ )
+            if ( elements[a] == pair.at( 4 + i ) )
+                map[i] = a;
+        if ( map[i] < 0 )
+            log_err( std::cerr, "Element ", pair.at( 4 + i ),
+                     " not found in EAM potential file" );
+        host_type2frho( i ) = map[i];
+        host_type2rhor( i ) = map[i];
+    }
+    for ( int i = 0; i < ntypes; i++ )
+        for ( int j = 0; j < ntypes; j++ )
+        {
+            int a = MAX( map[i], map[j] );
+            int b = MIN( map[i], map[j] );
+            host_type2z2r( i, j ) = a * ( a + 1 ) / 2 + b;
+        }
+
+    Kokkos::deep_copy( frho_spline, host_frho );
+    Kokkos::deep_copy( rhor_spline, host_rhor );
+    Kokkos::deep_copy( z2r_spline, host_z2r );
+    Kokkos::deep_copy( type2frho, host_type2frho );
+    Kokkos::deep_copy( type2rhor, host_type2rhor );
+    Kokkos::deep_copy( type2z2r, host_type2z2r );
+}
+
+template <class t_System, class t_Neighbor, class t_parallel>
+void ForceEAM<t_System, t_Neighbor, t_parallel>::compute( t_System *system,
+                                                          t_Neighbor *neighbor )
+{
+    ProfileRegion region( "ForceEAM::compute" );
+    N_local = system->N_local;
+    system->slice_force();
+    auto x = system->x;
+    auto f_sys = system->f;
+    t_f_a f_a = system->f;
+    auto type = system->type;
+
+    auto neigh_list = neighbor->get();
+
+    // Densities and embedding derivatives for owned and ghost atoms
+    std::size_t N_all = system->N_local + system->N_ghost;
+    if ( rho.extent( 0 ) < N_all )
+    {
+        Kokkos::realloc( rho, N_all * 1.1 );
+        Kokkos::realloc( fp, N_all * 1.1 );
+    }
+
+    // Pass 1: density of owned atoms (atomic if using team threading)
+    profile_push( "density" );
+    Kokkos::deep_copy( rho, 0.0 );
+    if ( std::is_same<t_parallel, Cabana::TeamOpTag>::value )
+    {
+        Kokkos::View<T_FLOAT *, mem_space,
+                     Kokkos::MemoryTraits<Kokkos::Atomic>>
+            rho_a = rho;
+        compute_density( rho_a, x, type, neigh_list );
+    }
+    else
+        compute_density( rho, x, type, neigh_list );
+    compute_embedding( type );
+    profile_pop();
+
+    // Embedding derivative to ghosts before the force pass
+    Kokkos::fence();
+    comm->update_halo_scalar( fp );
+
+    // Pass 2: forces
+    profile_push( "force" );
+    if ( std::is_same<t_parallel, Cabana::TeamOpTag>::value )
+        compute_force_full( f_a, x, type, neigh_list );
+    else
+        compute_force_full( f_sys, x, type, neigh_list );
+    Kokkos::fence();
+    profile_pop();
+
+    step++;
+}
+
+template <class t_System, class t_Neighbor, class t_parallel>
+template <class t_rho, class t_x, class t_type, class t_neigh>
+void ForceEAM<t_System, t_Neighbor, t_parallel>::compute_density(
+    t_rho rho_sum, const t_x x, const t_type type, const t_neigh neigh_list )
+{
+    auto cutforcesq_copy = cutforcesq;
+    auto rdr_copy = rdr;
+    auto nr_copy = nr;
+    auto rhor_copy = rhor_spline;
+    auto type2rhor_copy = type2rhor;
+
+    auto density = KOKKOS_LAMBDA( const int i, const int j )
+    {
+        const T_F_FLOAT dx = x( i, 0 ) - x( j, 0 );
+        const T_F_FLOAT dy = x( i, 1 ) - x( j, 1 );
+        const T_F_FLOAT dz = x( i, 2 ) - x( j, 2 );
+        const T_F_FLOAT rsq = dx * dx + dy * dy + dz * dz;
+
+        if ( rsq < cutforcesq_copy )
+        {
+            T_F_FLOAT p = sqrt( rsq ) * rdr_copy;
+            const int m = MIN( int( p ), nr_copy - 2 );
+            p -= m;
+            p = MIN( p, 1.0 );
+            rho_sum( i ) += eam_value( rhor_copy, type2rhor_copy( type( j ) ),
+                                       m, p );
+        }
+    };
+
+    Kokkos::RangePolicy<exe_space> policy( 0, N_local );
+    t_parallel neigh_parallel;
+    Cabana::neighbor_parallel_for( policy, density, neigh_list,
+                                   Cabana::FirstNeighborsTag(), neigh_parallel,
+                                   "ForceEAMCabanaNeigh::compute_density" );
+}
+
+template <class t_System, class t_Neighbor, class t_parallel>
+template <class t_type>
+void ForceEAM<t_System, t_Neighbor, t_parallel>::compute_embedding(
+    const t_type type )
+{
+    auto rho_copy = rho;
+    auto fp_copy = fp;
+    auto rdrho_copy = rdrho;
+    auto nrho_copy = nrho;
+    auto frho_copy = frho_spline;
+    auto type2frho_copy = type2frho;
+    Kokkos::parallel_for(
+        "ForceEAMCabanaNeigh::compute_embedding",
+        Kokkos::RangePolicy<exe_space>( 0, N_local ),
+        KOKKOS_LAMBDA( const int i ) {
+            T_F_FLOAT p = rho_copy( i ) * rdrho_copy;
+            const int m = MAX( 0, MIN( int( p ), nrho_copy - 2 ) );
+            p -= m;
+            p = MIN( p, 1.0 );
+            fp_copy( i ) =
+                eam_deriv( frho_copy, type2frho_copy( type( i ) ), m, p );
+        } );
+}
+
+template <class t_System, class t_Neighbor, class t_parallel>
+template <class t_f, class t_x, class t_type, class t_neigh>
+void ForceEAM<t_System, t_Neighbor, t_parallel>::compute_force_full(
+    t_f f, const t_x x, const t_type type, const t_neigh neigh_list )
+{
+    auto cutforcesq_copy = cutforcesq;
+    auto rdr_copy = rdr;
+    auto nr_copy = nr;
+    auto rhor_copy = rhor_spline;
+    auto z2r_copy = z2r_spline;
+    auto type2rhor_copy = type2rhor;
+    auto type2z2r_copy = type2z2r;
+    auto fp_copy = fp;
+
+    auto force_full = KOKKOS_LAMBDA( const int i, const int j )
+    {
+        const T_F_FLOAT dx = x( i, 0 ) - x( j, 0 );
+        const T_F_FLOAT dy = x( i, 1 ) - x( j, 1 );
+        const T_F_FLOAT dz = x( i, 2 ) - x( j, 2 );
+        const T_F_FLOAT rsq = dx * dx + dy * dy + dz * dz;
+
+        if ( rsq < cutforcesq_copy )
+        {
+            const int type_i = type( i );
+            const int type_j = type( j );
+            const T_F_FLOAT r = sqrt( rsq );
+            T_F_FLOAT p = r * rdr_copy;
+            const int m = MIN( int( p ), nr_copy - 2 );
+            p -= m;
+            p = MIN( p, 1.0 );
+
+            // rhoip: density at i from j; rhojp: density at j from i
+            const T_F_FLOAT rhoip =
+                eam_deriv( rhor_copy, type2rhor_copy( type_j ), m, p );
+            const T_F_FLOAT rhojp =
+                eam_deriv( rhor_copy, type2rhor_copy( type_i ), m, p );
+            const int z = type2z2r_copy( type_i, type_j );
+            const T_F_FLOAT z2 = eam_value( z2r_copy, z, m, p );
+            const T_F_FLOAT z2p = eam_deriv( z2r_copy, z, m, p );
+
+            const T_F_FLOAT recip = 1.0 / r;
+            const T_F_FLOAT phi = z2 * recip;
+            const T_F_FLOAT phip = z2p * recip - phi * recip;
+            const T_F_FLOAT psip =
+                fp_copy( i ) * rhojp + fp_copy( j ) * rhoip + phip;
+            const T_F_FLOAT fpair = -psip * recip;
+
+            f( i, 0 ) += dx * fpair;
+            f( i, 1 ) += dy * fpair;
+            f( i, 2 ) += dz * fpair;
+        }
+    };
+
+    Kokkos::RangePolicy<exe_space> policy( 0, N_local );
+    t_parallel neigh_parallel;
+    Cabana::neighbor_parallel_for( policy, force_full, neigh_list,
+                                   Cabana::FirstNeighborsTag(), neigh_parallel,
+                                   "ForceEAMCabanaNeigh::compute_full" );
+}
+
+template <class t_System, class t_Neighbor, class t_parallel>
+T_FLOAT ForceEAM<t_System, t_Neighbor, t_parallel>::compute_energy(
+    t_System *system, t_Neighbor *neighbor )
+{
+    ProfileRegion region( "ForceEAM::compute_energy" );
+    N_local = system->N_local;
+    system->slice_force();
+    auto x = system->x;
+    auto type = system->type;
+
+    auto neigh_list = neighbor->get();
+
+    // Embedding energy from the densities of the last compute
+    auto rho_copy = rho;
+    auto rdrho_copy = rdrho;
+    auto nrho_copy = nrho;
+    auto frho_copy = frho_spline;
+    auto type2frho_copy = type2frho;
+    T_FLOAT embed = 0.0;
+    Kokkos::parallel_reduce(
+        "ForceEAMCabanaNeigh::compute_energy_embed",
+        Kokkos::RangePolicy<exe_space>( 0, N_local ),
+        KOKKOS_LAMBDA( const int i, T_FLOAT &PE ) {
+            T_F_FLOAT p = rho_copy( i ) * rdrho_copy;
+            const int m = MAX( 0, MIN( int( p ), nrho_copy - 2 ) );
+            p -= m;
+            p = MIN( p, 1.0 );
+            PE += eam_value( frho_copy, type2frho_copy( type( i ) ), m, p );
+        },
+        embed );
+
+    auto cutforcesq_copy = cutforcesq;
+    auto rdr_copy = rdr;
+    auto nr_copy = nr;
+    auto z2r_copy = z2r_spline;
+    auto type2z2r_copy = type2z2r;
+
+    auto energy_full = KOKKOS_LAMBDA( const int i, const int j, T_FLOAT &PE )
+    {
+        const T_F_FLOAT dx = x( i, 0 ) - x( j, 0 );
+        const T_F_FLOAT dy = x( i, 1 ) - x( j, 1 );
+        const T_F_FLOAT dz = x( i, 2 ) - x( j, 2 );
+        const T_F_FLOAT rsq = dx * dx + dy * dy + dz * dz;
+
+        if ( rsq < cutforcesq_copy )
+        {
+            const T_F_FLOAT r = sqrt( rsq );
+            T_F_FLOAT p = r * rdr_copy;
+            const int m = MIN( int( p ), nr_copy - 2 );
+            p -= m;
+            p = MIN( p, 1.0 );
+            const int z = type2z2r_copy( type( i ), type( j ) );
+            PE += 0.5 * eam_value( z2r_copy, z, m, p ) / r;
+        }
+    };
+
+    T_FLOAT pair = 0.0;
+    Kokkos::RangePolicy<exe_space> policy( 0, N_local );
+    t_parallel neigh_parallel;
+    Cabana::neighbor_parallel_reduce(
+        policy, energy_full, neigh_list, Cabana::FirstNeighborsTag(),
+        neigh_parallel, pair, "ForceEAMCabanaNeigh::compute_energy_full" );
+    Kokkos::fence();
+
+    step++;
+    return embed + pair;
+}
+
+template <class t_System, class t_Neighbor, class t_parallel>
+const char *ForceEAM<t_System, t_Neighbor, t_parallel>::name()
+{
+    return "Force:EAMAlloyCabana";
+}
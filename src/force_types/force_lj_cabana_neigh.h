@@ -53,6 +53,86 @@
 #include <Kokkos_Core.hpp>
 
 #include <force.h>
+#include <neighbor_cluster.h>
+#include <pair_kernel.h>
+
+// Lennard-Jones pair potential for PairKernel, shifted to zero energy at
+// the cutoff. With single_type the coefficients of type pair (0, 0) are
+// passed by value and the views are never read.
+template <class t_fparams, bool is_single_type>
+struct PotentialLJ
+{
+    static constexpr bool single_type = is_single_type;
+
+    t_fparams lj1, lj2, cutsq;
+    T_F_FLOAT lj1_single, lj2_single, cutsq_single;
+
+    KOKKOS_INLINE_FUNCTION
+    T_F_FLOAT cutsq_ij( const int type_i, const int type_j ) const
+    {
+        return single_type ? cutsq_single : cutsq( type_i, type_j );
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    T_F_FLOAT compute_fpair( const T_F_FLOAT rsq, const int type_i,
+                             const int type_j ) const
+    {
+        const T_F_FLOAT lj1_ij =
+            single_type ? lj1_single : lj1( type_i, type_j );
+        const T_F_FLOAT lj2_ij =
+            single_type ? lj2_single : lj2( type_i, type_j );
+
+        const T_F_FLOAT r2inv = 1.0 / rsq;
+        const T_F_FLOAT r6inv = r2inv * r2inv * r2inv;
+        return ( r6inv * ( lj1_ij * r6inv - lj2_ij ) ) * r2inv;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    T_F_FLOAT compute_energy( const T_F_FLOAT rsq, const int type_i,
+                              const int type_j ) const
+    {
+        const T_F_FLOAT lj1_ij =
+            single_type ? lj1_single : lj1( type_i, type_j );
+        const T_F_FLOAT lj2_ij =
+            single_type ? lj2_single : lj2( type_i, type_j );
+
+        const T_F_FLOAT r2inv = 1.0 / rsq;
+        const T_F_FLOAT r6inv = r2inv * r2inv * r2inv;
+        const T_F_FLOAT r2invc = 1.0 / cutsq_ij( type_i, type_j );
+        const T_F_FLOAT r6invc = r2invc * r2invc * r2invc;
+        return ( r6inv * ( 0.5 * lj1_ij * r6inv - lj2_ij ) -
+                 r6invc * ( 0.5 * lj1_ij * r6invc - lj2_ij ) ) /
+               6.0;
+    }
+};
+
+// Per atom force summed over the vector lanes of a team thread
+struct ForceLJSum
+{
+    T_F_FLOAT f[3];
+
+    KOKKOS_INLINE_FUNCTION
+    ForceLJSum()
+    {
+        for ( int d = 0; d < 3; d++ )
+            f[d] = 0.0;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    ForceLJSum &operator+=( const ForceLJSum &src )
+    {
+        for ( int d = 0; d < 3; d++ )
+            f[d] += src.f[d];
+        return *this;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    void operator+=( const volatile ForceLJSum &src ) volatile
+    {
+        for ( int d = 0; d < 3; d++ )
+            f[d] += src.f[d];
+    }
+};
 
 template <class t_System, class t_Neighbor, class t_parallel>
 class ForceLJ : public Force<t_System, t_Neighbor>
@@ -60,8 +140,6 @@ class ForceLJ : public Force<t_System, t_Neighbor>
   private:
     int N_local, ntypes;
 
-    typedef typename t_System::t_f::atomic_access_slice t_f_a;
-
     int step;
 
     using exe_space = typename t_System::execution_space;
@@ -71,27 +149,57 @@ class ForceLJ : public Force<t_System, t_Neighbor>
                          Kokkos::MemoryTraits<Kokkos::RandomAccess>>
         t_fparams;
     t_fparams lj1, lj2, cutsq;
+    // Single type parameters, passed to kernels by value
+    T_F_FLOAT lj1_single, lj2_single, cutsq_single;
+
+    typedef PairKernel<t_System, t_parallel> t_pair_kernel;
+    typedef typename t_pair_kernel::t_index t_index;
+
+    // Kernels for one atom type (single_type) keep the coefficients in
+    // registers and never read the type slice
+    template <bool single_type>
+    PotentialLJ<t_fparams, single_type> potential() const;
+    template <bool single_type>
+    void compute_pairs( t_System *system, t_Neighbor *neighbor );
+    template <bool single_type>
+    void compute_subset( t_System *system, t_Neighbor *neighbor,
+                         const t_index atoms, const T_INT num_atoms );
+    template <bool single_type>
+    PairThermo compute_thermo_pairs( t_System *system, t_Neighbor *neighbor );
 
   public:
     ForceLJ( t_System *system );
 
     void init_coeff( std::vector<std::vector<std::string>> args ) override;
     void compute( t_System *system, t_Neighbor *neighbor ) override;
-    T_F_FLOAT compute_energy( t_System *system, t_Neighbor *neighbor ) override;
-
-    template <class t_f, class t_x, class t_type, class t_neigh>
+    void compute_interior( t_System *system, t_Neighbor *neighbor ) override;
+    void compute_boundary( t_System *system, t_Neighbor *neighbor ) override;
+    bool assigns_force( t_Neighbor *neighbor ) override;
+    T_FLOAT compute_energy( t_System *system, t_Neighbor *neighbor ) override;
+    void compute_thermo( t_System *system, t_Neighbor *neighbor ) override;
+
+    // Optionally restricted to a list of local atoms (num_atoms >= 0)
+    template <bool single_type, class t_f, class t_x, class t_type,
+              class t_neigh>
+    void compute_force_full( t_f f, const t_x x, const t_type type,
+                             const t_neigh neigh_list,
+                             const t_index atoms = t_index(),
+                             const T_INT num_atoms = -1 );
+    // Team per block of atoms with the neighbors of each atom spread over
+    // vector lanes and reduced, so forces are assigned without atomics.
+    // Type parameters are staged in team scratch (shared) memory.
+    template <bool single_type, class t_f, class t_x, class t_type,
+              class t_neigh>
+    void compute_force_full_team( t_f f, const t_x x, const t_type type,
+                                  const t_neigh neigh_list );
+
+    // Cluster pair lists: every atom pair of an i and j cluster in fixed
+    // size loops the compiler can vectorize
+    template <bool single_type, class t_f, class t_x, class t_type>
     void compute_force_full( t_f f, const t_x x, const t_type type,
-                             const t_neigh neigh_list );
-    template <class t_f, class t_x, class t_type, class t_neigh>
-    void compute_force_half( t_f f, const t_x x, const t_type type,
-                             const t_neigh neigh_list );
-
-    template <class t_x, class t_type, class t_neigh>
-    T_F_FLOAT compute_energy_full( const t_x x, const t_type type,
-                                   const t_neigh neigh_list );
-    template <class t_x, class t_type, class t_neigh>
-    T_F_FLOAT compute_energy_half( const t_x x, const t_type type,
-                                   const t_neigh neigh_list );
+                             const ClusterNeighborList<mem_space> neigh_list,
+                             const t_index atoms = t_index(),
+                             const T_INT num_atoms = -1 );
 
     const char *name() override;
 };
@@ -70,58 +70,122 @@ void ForceLJ<t_System, t_Neighbor, t_parallel>::init_coeff(
     for ( std::size_t a = 0; a < args.size(); a++ )
     {
         auto pair = args.at( a );
-        int i = std::stoi( pair.at( 1 ) ) - 1;
-        int j = std::stoi( pair.at( 2 ) ) - 1;
+        int ilo, ihi, jlo, jhi;
+        pair_coeff_types( pair.at( 1 ), ntypes, ilo, ihi );
+        pair_coeff_types( pair.at( 2 ), ntypes, jlo, jhi );
         double eps = std::stod( pair.at( 3 ) );
         double sigma = std::stod( pair.at( 4 ) );
         double cut = std::stod( pair.at( 5 ) );
 
-        host_lj1( i, j ) = 48.0 * eps * pow( sigma, 12.0 );
-        host_lj2( i, j ) = 24.0 * eps * pow( sigma, 6.0 );
-        host_cutsq( i, j ) = cut * cut;
-        host_lj1( j, i ) = host_lj1( i, j );
-        host_lj2( j, i ) = host_lj2( i, j );
-        host_cutsq( j, i ) = host_cutsq( i, j );
+        for ( int i = ilo; i <= ihi; i++ )
+            for ( int j = jlo; j <= jhi; j++ )
+            {
+                host_lj1( i, j ) = 48.0 * eps * pow( sigma, 12.0 );
+                host_lj2( i, j ) = 24.0 * eps * pow( sigma, 6.0 );
+                host_cutsq( i, j ) = cut * cut;
+                host_lj1( j, i ) = host_lj1( i, j );
+                host_lj2( j, i ) = host_lj2( i, j );
+                host_cutsq( j, i ) = host_cutsq( i, j );
+            }
     }
+    lj1_single = host_lj1( 0, 0 );
+    lj2_single = host_lj2( 0, 0 );
+    cutsq_single = host_cutsq( 0, 0 );
     Kokkos::deep_copy( lj1, host_lj1 );
     Kokkos::deep_copy( lj2, host_lj2 );
     Kokkos::deep_copy( cutsq, host_cutsq );
 }
 
+template <class t_System, class t_Neighbor, class t_parallel>
+template <bool single_type>
+PotentialLJ<typename ForceLJ<t_System, t_Neighbor, t_parallel>::t_fparams,
+            single_type>
+ForceLJ<t_System, t_Neighbor, t_parallel>::potential() const
+{
+    return { lj1, lj2, cutsq, lj1_single, lj2_single, cutsq_single };
+}
+
 template <class t_System, class t_Neighbor, class t_parallel>
 void ForceLJ<t_System, t_Neighbor, t_parallel>::compute( t_System *system,
                                                          t_Neighbor *neighbor )
+{
+    ProfileRegion region( "ForceLJ::compute" );
+    if ( ntypes == 1 )
+        compute_pairs<true>( system, neighbor );
+    else
+        compute_pairs<false>( system, neighbor );
+    // Not fenced: the halo and integrate kernels queue behind the force
+    // (force timings then include only the launch on devices)
+
+    step++;
+}
+
+template <class t_System, class t_Neighbor, class t_parallel>
+template <bool single_type>
+void ForceLJ<t_System, t_Neighbor, t_parallel>::compute_pairs(
+    t_System *system, t_Neighbor *neighbor )
 {
     N_local = system->N_local;
     system->slice_force();
     auto x = system->x;
     auto f = system->f;
-    t_f_a f_a = system->f;
     auto type = system->type;
 
     auto neigh_list = neighbor->get();
 
     if ( neighbor->half_neigh )
-    {
-        // Forces must be atomic for half list
-        compute_force_half( f_a, x, type, neigh_list );
-    }
+        t_pair_kernel::force_half( potential<single_type>(), f, x, type,
+                                   neigh_list, N_local, "ForceLJCabanaNeigh" );
+    else if ( std::is_same<t_parallel, Cabana::TeamVectorOpTag>::value )
+        compute_force_full_team<single_type>( f, x, type, neigh_list );
     else
-    {
-        // Forces only atomic if using team threading
-        if ( std::is_same<t_parallel, Cabana::TeamOpTag>::value )
-            compute_force_full( f_a, x, type, neigh_list );
-        else
-            compute_force_full( f, x, type, neigh_list );
-    }
-    Kokkos::fence();
+        compute_force_full<single_type>( f, x, type, neigh_list );
+}
 
-    step++;
+template <class t_System, class t_Neighbor, class t_parallel>
+void ForceLJ<t_System, t_Neighbor, t_parallel>::compute_interior(
+    t_System *system, t_Neighbor *neighbor )
+{
+    // Not fenced: on devices this overlaps with the host-side halo update
+    ProfileRegion region( "ForceLJ::compute_interior" );
+    if ( ntypes == 1 )
+        compute_subset<true>( system, neighbor, neighbor->interior,
+                              neighbor->num_interior );
+    else
+        compute_subset<false>( system, neighbor, neighbor->interior,
+                               neighbor->num_interior );
 }
 
 template <class t_System, class t_Neighbor, class t_parallel>
-T_F_FLOAT ForceLJ<t_System, t_Neighbor, t_parallel>::compute_energy(
+void ForceLJ<t_System, t_Neighbor, t_parallel>::compute_boundary(
     t_System *system, t_Neighbor *neighbor )
+{
+    ProfileRegion region( "ForceLJ::compute_boundary" );
+    if ( ntypes == 1 )
+        compute_subset<true>( system, neighbor, neighbor->boundary,
+                              neighbor->num_boundary );
+    else
+        compute_subset<false>( system, neighbor, neighbor->boundary,
+                               neighbor->num_boundary );
+
+    step++;
+}
+
+template <class t_System, class t_Neighbor, class t_parallel>
+bool ForceLJ<t_System, t_Neighbor, t_parallel>::assigns_force(
+    t_Neighbor *neighbor )
+{
+    // Full lists with one thread (or team thread) per atom; subsets always
+    // assign
+    return !neighbor->half_neigh &&
+           !std::is_same<t_parallel, Cabana::TeamOpTag>::value;
+}
+
+template <class t_System, class t_Neighbor, class t_parallel>
+template <bool single_type>
+void ForceLJ<t_System, t_Neighbor, t_parallel>::compute_subset(
+    t_System *system, t_Neighbor *neighbor, const t_index atoms,
+    const T_INT num_atoms )
 {
     N_local = system->N_local;
     system->slice_force();
@@ -131,11 +195,42 @@ T_F_FLOAT ForceLJ<t_System, t_Neighbor, t_parallel>::compute_energy(
 
     auto neigh_list = neighbor->get();
 
-    T_F_FLOAT energy;
+    // Each atom is handled by one thread, so only half lists need atomics
     if ( neighbor->half_neigh )
-        energy = compute_energy_half( x, type, neigh_list );
+        t_pair_kernel::force_half( potential<single_type>(), f, x, type,
+                                   neigh_list, N_local, "ForceLJCabanaNeigh",
+                                   atoms, num_atoms );
+    else
+        compute_force_full<single_type>( f, x, type, neigh_list, atoms,
+                                         num_atoms );
+}
+
+template <class t_System, class t_Neighbor, class t_parallel>
+T_FLOAT ForceLJ<t_System, t_Neighbor, t_parallel>::compute_energy(
+    t_System *system, t_Neighbor *neighbor )
+{
+    ProfileRegion region( "ForceLJ::compute_energy" );
+    N_local = system->N_local;
+    system->slice_force();
+    auto x = system->x;
+    auto type = system->type;
+
+    auto neigh_list = neighbor->get();
+
+    const std::string label = "ForceLJCabanaNeigh";
+    T_FLOAT energy;
+    if ( neighbor->half_neigh && ntypes == 1 )
+        energy = t_pair_kernel::energy_half( potential<true>(), x, type,
+                                             neigh_list, N_local, label );
+    else if ( neighbor->half_neigh )
+        energy = t_pair_kernel::energy_half( potential<false>(), x, type,
+                                             neigh_list, N_local, label );
+    else if ( ntypes == 1 )
+        energy = t_pair_kernel::energy_full( potential<true>(), x, type,
+                                             neigh_list, N_local, label );
     else
-        energy = compute_energy_full( x, type, neigh_list );
+        energy = t_pair_kernel::energy_full( potential<false>(), x, type,
+                                             neigh_list, N_local, label );
     Kokkos::fence();
 
     step++;
@@ -143,235 +238,275 @@ T_F_FLOAT ForceLJ<t_System, t_Neighbor, t_parallel>::compute_energy(
 }
 
 template <class t_System, class t_Neighbor, class t_parallel>
-const char *ForceLJ<t_System, t_Neighbor, t_parallel>::name()
+void ForceLJ<t_System, t_Neighbor, t_parallel>::compute_thermo(
+    t_System *system, t_Neighbor *neighbor )
 {
-    return "Force:LJCabana";
+    ProfileRegion region( "ForceLJ::compute_thermo" );
+    PairThermo thermo;
+    if ( ntypes == 1 )
+        thermo = compute_thermo_pairs<true>( system, neighbor );
+    else
+        thermo = compute_thermo_pairs<false>( system, neighbor );
+    Kokkos::fence();
+
+    this->thermo_energy = thermo.energy;
+    for ( int v = 0; v < 6; v++ )
+        this->thermo_virial[v] = thermo.virial[v];
+    this->thermo_valid = true;
+
+    step++;
 }
 
 template <class t_System, class t_Neighbor, class t_parallel>
-template <class t_f, class t_x, class t_type, class t_neigh>
-void ForceLJ<t_System, t_Neighbor, t_parallel>::compute_force_full(
-    t_f f, const t_x x, const t_type type, const t_neigh neigh_list )
+template <bool single_type>
+PairThermo ForceLJ<t_System, t_Neighbor, t_parallel>::compute_thermo_pairs(
+    t_System *system, t_Neighbor *neighbor )
 {
-    auto cutsq_copy = cutsq;
-    auto lj1_copy = lj1;
-    auto lj2_copy = lj2;
+    N_local = system->N_local;
+    system->slice_force();
+    auto x = system->x;
+    auto f = system->f;
+    auto type = system->type;
 
-    auto force_full = KOKKOS_LAMBDA( const int i, const int j )
-    {
-        const T_F_FLOAT x_i = x( i, 0 );
-        const T_F_FLOAT y_i = x( i, 1 );
-        const T_F_FLOAT z_i = x( i, 2 );
-        const int type_i = type( i );
-
-        T_F_FLOAT fxi = 0.0;
-        T_F_FLOAT fyi = 0.0;
-        T_F_FLOAT fzi = 0.0;
-
-        const T_F_FLOAT dx = x_i - x( j, 0 );
-        const T_F_FLOAT dy = y_i - x( j, 1 );
-        const T_F_FLOAT dz = z_i - x( j, 2 );
-
-        const int type_j = type( j );
-        const T_F_FLOAT rsq = dx * dx + dy * dy + dz * dz;
-
-        const T_F_FLOAT cutsq_ij = cutsq_copy( type_i, type_j );
-
-        if ( rsq < cutsq_ij )
-        {
-            const T_F_FLOAT lj1_ij = lj1_copy( type_i, type_j );
-            const T_F_FLOAT lj2_ij = lj2_copy( type_i, type_j );
-
-            T_F_FLOAT r2inv = 1.0 / rsq;
-            T_F_FLOAT r6inv = r2inv * r2inv * r2inv;
-            T_F_FLOAT fpair = ( r6inv * ( lj1_ij * r6inv - lj2_ij ) ) * r2inv;
-            fxi += dx * fpair;
-            fyi += dy * fpair;
-            fzi += dz * fpair;
-        }
-
-        f( i, 0 ) += fxi;
-        f( i, 1 ) += fyi;
-        f( i, 2 ) += fzi;
-    };
-
-    Kokkos::RangePolicy<exe_space> policy( 0, N_local );
-    t_parallel neigh_parallel;
-    Cabana::neighbor_parallel_for( policy, force_full, neigh_list,
-                                   Cabana::FirstNeighborsTag(), neigh_parallel,
-                                   "ForceLJCabanaNeigh::compute_full" );
+    auto neigh_list = neighbor->get();
+
+    if ( neighbor->half_neigh )
+        return t_pair_kernel::thermo_half( potential<single_type>(), f, x,
+                                           type, neigh_list, N_local,
+                                           "ForceLJCabanaNeigh" );
+    return t_pair_kernel::thermo_full( potential<single_type>(), f, x, type,
+                                       neigh_list, N_local,
+                                       "ForceLJCabanaNeigh" );
 }
 
 template <class t_System, class t_Neighbor, class t_parallel>
-template <class t_f, class t_x, class t_type, class t_neigh>
-void ForceLJ<t_System, t_Neighbor, t_parallel>::compute_force_half(
-    t_f f_a, const t_x x, const t_type type, const t_neigh neigh_list )
+const char *ForceLJ<t_System, t_Neighbor, t_parallel>::name()
 {
-    auto cutsq_copy = cutsq;
-    auto lj1_copy = lj1;
-    auto lj2_copy = lj2;
+    return "Force:LJCabana";
+}
 
-    auto force_half = KOKKOS_LAMBDA( const int i, const int j )
-    {
-        const T_F_FLOAT x_i = x( i, 0 );
-        const T_F_FLOAT y_i = x( i, 1 );
-        const T_F_FLOAT z_i = x( i, 2 );
-        const int type_i = type( i );
-
-        T_F_FLOAT fxi = 0.0;
-        T_F_FLOAT fyi = 0.0;
-        T_F_FLOAT fzi = 0.0;
-
-        const T_F_FLOAT dx = x_i - x( j, 0 );
-        const T_F_FLOAT dy = y_i - x( j, 1 );
-        const T_F_FLOAT dz = z_i - x( j, 2 );
-
-        const int type_j = type( j );
-        const T_F_FLOAT rsq = dx * dx + dy * dy + dz * dz;
-
-        const T_F_FLOAT cutsq_ij = cutsq_copy( type_i, type_j );
-
-        if ( rsq < cutsq_ij )
-        {
-            const T_F_FLOAT lj1_ij = lj1_copy( type_i, type_j );
-            const T_F_FLOAT lj2_ij = lj2_copy( type_i, type_j );
-
-            T_F_FLOAT r2inv = 1.0 / rsq;
-            T_F_FLOAT r6inv = r2inv * r2inv * r2inv;
-            T_F_FLOAT fpair = ( r6inv * ( lj1_ij * r6inv - lj2_ij ) ) * r2inv;
-            fxi += dx * fpair;
-            fyi += dy * fpair;
-            fzi += dz * fpair;
-            f_a( j, 0 ) -= dx * fpair;
-            f_a( j, 1 ) -= dy * fpair;
-            f_a( j, 2 ) -= dz * fpair;
-        }
-        f_a( i, 0 ) += fxi;
-        f_a( i, 1 ) += fyi;
-        f_a( i, 2 ) += fzi;
-    };
-
-    Kokkos::RangePolicy<exe_space> policy( 0, N_local );
-    t_parallel neigh_parallel;
-    Cabana::neighbor_parallel_for( policy, force_half, neigh_list,
-                                   Cabana::FirstNeighborsTag(), neigh_parallel,
-                                   "ForceLJCabanaNeigh::compute_half" );
+template <class t_System, class t_Neighbor, class t_parallel>
+template <bool single_type, class t_f, class t_x, class t_type,
+          class t_neigh>
+void ForceLJ<t_System, t_Neighbor, t_parallel>::compute_force_full(
+    t_f f, const t_x x, const t_type type, const t_neigh neigh_list,
+    const t_index atoms, const T_INT num_atoms )
+{
+    t_pair_kernel::force_full( potential<single_type>(), f, x, type,
+                               neigh_list, N_local, "ForceLJCabanaNeigh",
+                               atoms, num_atoms );
 }
 
 template <class t_System, class t_Neighbor, class t_parallel>
-template <class t_x, class t_type, class t_neigh>
-T_F_FLOAT ForceLJ<t_System, t_Neighbor, t_parallel>::compute_energy_full(
-    const t_x x, const t_type type, const t_neigh neigh_list )
+template <bool single_type, class t_f, class t_x, class t_type>
+void ForceLJ<t_System, t_Neighbor, t_parallel>::compute_force_full(
+    t_f f, const t_x x, const t_type type,
+    const ClusterNeighborList<mem_space> neigh_list, const t_index atoms,
+    const T_INT num_atoms )
 {
-    auto cutsq_copy = cutsq;
-    auto lj1_copy = lj1;
-    auto lj2_copy = lj2;
+    using t_list = ClusterNeighborList<mem_space>;
 
-    auto energy_full = KOKKOS_LAMBDA( const int i, const int j, T_F_FLOAT &PE )
+    // Atom subsets use the per atom pairs
+    if ( num_atoms >= 0 )
     {
-        const T_F_FLOAT x_i = x( i, 0 );
-        const T_F_FLOAT y_i = x( i, 1 );
-        const T_F_FLOAT z_i = x( i, 2 );
-        const int type_i = type( i );
-        const bool shift_flag = true;
-
-        const T_F_FLOAT dx = x_i - x( j, 0 );
-        const T_F_FLOAT dy = y_i - x( j, 1 );
-        const T_F_FLOAT dz = z_i - x( j, 2 );
-
-        const int type_j = type( j );
-        const T_F_FLOAT rsq = dx * dx + dy * dy + dz * dz;
-
-        const T_F_FLOAT cutsq_ij = cutsq_copy( type_i, type_j );
-
-        if ( rsq < cutsq_ij )
-        {
-            const T_F_FLOAT lj1_ij = lj1_copy( type_i, type_j );
-            const T_F_FLOAT lj2_ij = lj2_copy( type_i, type_j );
-
-            T_F_FLOAT r2inv = 1.0 / rsq;
-            T_F_FLOAT r6inv = r2inv * r2inv * r2inv;
-            PE += 0.5 * r6inv * ( 0.5 * lj1_ij * r6inv - lj2_ij ) /
-                  6.0; // optimize later
+        compute_force_full<single_type, t_f, t_x, t_type, t_list>(
+            f, x, type, neigh_list, atoms, num_atoms );
+        return;
+    }
 
-            if ( shift_flag )
+    constexpr int size = t_list::size;
+    auto cutsq_copy = cutsq;
+    auto lj1_copy = lj1;
+    auto lj2_copy = lj2;
+    const T_F_FLOAT lj1_s = lj1_single;
+    const T_F_FLOAT lj2_s = lj2_single;
+    const T_F_FLOAT cutsq_s = cutsq_single;
+    const T_INT N_local_copy = neigh_list.num_local;
+    const T_INT N_total = neigh_list.num_total;
+    auto cluster_counts = neigh_list.cluster_counts;
+    auto cluster_offsets = neigh_list.cluster_offsets;
+    auto cluster_neighbors = neigh_list.cluster_neighbors;
+
+    // One thread per i cluster; padding atoms repeat the last atom and are
+    // masked out, so each atom is assigned its total force
+    const T_INT num_i = ( N_local_copy + size - 1 ) / size;
+    Kokkos::parallel_for(
+        "ForceLJCabanaNeigh::compute_full_cluster",
+        Kokkos::RangePolicy<exe_space>( 0, num_i ),
+        KOKKOS_LAMBDA( const int ci ) {
+            T_F_FLOAT xi[size], yi[size], zi[size];
+            T_F_FLOAT fxi[size], fyi[size], fzi[size];
+            int ti[size];
+            for ( int a = 0; a < size; a++ )
             {
-                T_F_FLOAT r2invc = 1.0 / cutsq_ij;
-                T_F_FLOAT r6invc = r2invc * r2invc * r2invc;
-                PE -= 0.5 * r6invc * ( 0.5 * lj1_ij * r6invc - lj2_ij ) /
-                      6.0; // optimize later
+                int i = ci * size + a;
+                i = i < N_local_copy ? i : N_local_copy - 1;
+                xi[a] = x( i, 0 );
+                yi[a] = x( i, 1 );
+                zi[a] = x( i, 2 );
+                ti[a] = single_type ? 0 : type( i );
+                fxi[a] = 0.0;
+                fyi[a] = 0.0;
+                fzi[a] = 0.0;
             }
-        }
-    };
 
-    T_F_FLOAT energy = 0.0;
-    Kokkos::RangePolicy<exe_space> policy( 0, N_local );
-    t_parallel neigh_parallel;
-    Cabana::neighbor_parallel_reduce(
-        policy, energy_full, neigh_list, Cabana::FirstNeighborsTag(),
-        neigh_parallel, energy, "ForceLJCabanaNeigh::compute_energy_full" );
+            for ( int n = 0; n < cluster_counts( ci ); n++ )
+            {
+                const int cj = cluster_neighbors( cluster_offsets( ci ) + n );
+                T_F_FLOAT xj[size], yj[size], zj[size];
+                int tj[size];
+                bool valid_j[size];
+                for ( int b = 0; b < size; b++ )
+                {
+                    int j = cj * size + b;
+                    valid_j[b] = j < N_total;
+                    j = j < N_total ? j : N_total - 1;
+                    xj[b] = x( j, 0 );
+                    yj[b] = x( j, 1 );
+                    zj[b] = x( j, 2 );
+                    tj[b] = single_type ? 0 : type( j );
+                }
+
+                for ( int a = 0; a < size; a++ )
+                    for ( int b = 0; b < size; b++ )
+                    {
+                        const T_F_FLOAT dx = xi[a] - xj[b];
+                        const T_F_FLOAT dy = yi[a] - yj[b];
+                        const T_F_FLOAT dz = zi[a] - zj[b];
+                        const T_F_FLOAT rsq = dx * dx + dy * dy + dz * dz;
+
+                        const T_F_FLOAT cutsq_ab =
+                            single_type ? cutsq_s : cutsq_copy( ti[a], tj[b] );
+                        const T_F_FLOAT lj1_ab =
+                            single_type ? lj1_s : lj1_copy( ti[a], tj[b] );
+                        const T_F_FLOAT lj2_ab =
+                            single_type ? lj2_s : lj2_copy( ti[a], tj[b] );
+
+                        const bool self = cj == ci && a == b;
+                        const bool in = valid_j[b] && !self && rsq < cutsq_ab;
+
+                        const T_F_FLOAT r2inv = in ? 1.0 / rsq : 0.0;
+                        const T_F_FLOAT r6inv = r2inv * r2inv * r2inv;
+                        const T_F_FLOAT fpair =
+                            ( r6inv * ( lj1_ab * r6inv - lj2_ab ) ) * r2inv;
+                        fxi[a] += dx * fpair;
+                        fyi[a] += dy * fpair;
+                        fzi[a] += dz * fpair;
+                    }
+            }
 
-    return energy;
+            for ( int a = 0; a < size; a++ )
+            {
+                const int i = ci * size + a;
+                if ( i < N_local_copy )
+                {
+                    f( i, 0 ) = fxi[a];
+                    f( i, 1 ) = fyi[a];
+                    f( i, 2 ) = fzi[a];
+                }
+            }
+        } );
 }
 
 template <class t_System, class t_Neighbor, class t_parallel>
-template <class t_x, class t_type, class t_neigh>
-T_F_FLOAT ForceLJ<t_System, t_Neighbor, t_parallel>::compute_energy_half(
-    const t_x x, const t_type type, const t_neigh neigh_list )
+template <bool single_type, class t_f, class t_x, class t_type,
+          class t_neigh>
+void ForceLJ<t_System, t_Neighbor, t_parallel>::compute_force_full_team(
+    t_f f, const t_x x, const t_type type, const t_neigh neigh_list )
 {
-    auto N_local_copy = N_local;
+    using team_policy = Kokkos::TeamPolicy<exe_space>;
+    using t_scratch =
+        Kokkos::View<T_F_FLOAT **, typename exe_space::scratch_memory_space,
+                     Kokkos::MemoryUnmanaged>;
+
     auto cutsq_copy = cutsq;
     auto lj1_copy = lj1;
     auto lj2_copy = lj2;
-
-    auto energy_half = KOKKOS_LAMBDA( const int i, const int j, T_F_FLOAT &PE )
-    {
-        const T_F_FLOAT x_i = x( i, 0 );
-        const T_F_FLOAT y_i = x( i, 1 );
-        const T_F_FLOAT z_i = x( i, 2 );
-        const int type_i = type( i );
-        const bool shift_flag = true;
-
-        const T_F_FLOAT dx = x_i - x( j, 0 );
-        const T_F_FLOAT dy = y_i - x( j, 1 );
-        const T_F_FLOAT dz = z_i - x( j, 2 );
-
-        const int type_j = type( j );
-        const T_F_FLOAT rsq = dx * dx + dy * dy + dz * dz;
-
-        const T_F_FLOAT cutsq_ij = cutsq_copy( type_i, type_j );
-
-        if ( rsq < cutsq_ij )
-        {
-            const T_F_FLOAT lj1_ij = lj1_copy( type_i, type_j );
-            const T_F_FLOAT lj2_ij = lj2_copy( type_i, type_j );
-
-            T_F_FLOAT r2inv = 1.0 / rsq;
-            T_F_FLOAT r6inv = r2inv * r2inv * r2inv;
-            T_F_FLOAT fac;
-            if ( j < N_local_copy )
-                fac = 1.0;
-            else
-                fac = 0.5;
-
-            PE += fac * r6inv * ( 0.5 * lj1_ij * r6inv - lj2_ij ) /
-                  6.0; // optimize later
-
-            if ( shift_flag )
+    const T_F_FLOAT lj1_s = lj1_single;
+    const T_F_FLOAT lj2_s = lj2_single;
+    const T_F_FLOAT cutsq_s = cutsq_single;
+    const int nt = single_type ? 0 : ntypes;
+    const T_INT N = N_local;
+
+    // A warp (vector) per atom on devices; host teams keep one thread
+    const bool host =
+        Kokkos::SpaceAccessibility<Kokkos::HostSpace, mem_space>::accessible;
+    const int team_atoms = host ? 1 : 4;
+    const int vector = team_policy::vector_length_max() < 32
+                           ? team_policy::vector_length_max()
+                           : 32;
+    const int league = ( N + team_atoms - 1 ) / team_atoms;
+    const std::size_t scratch = 3 * t_scratch::shmem_size( nt, nt );
+
+    auto policy = team_policy( league, team_atoms, vector )
+                      .set_scratch_size( 0, Kokkos::PerTeam( scratch ) );
+
+    Kokkos::parallel_for(
+        "ForceLJCabanaNeigh::compute_full_team", policy,
+        KOKKOS_LAMBDA( const typename team_policy::member_type &team ) {
+            t_scratch lj1_t( team.team_scratch( 0 ), nt, nt );
+            t_scratch lj2_t( team.team_scratch( 0 ), nt, nt );
+            t_scratch cutsq_t( team.team_scratch( 0 ), nt, nt );
+            if ( !single_type )
             {
-                T_F_FLOAT r2invc = 1.0 / cutsq_ij;
-                T_F_FLOAT r6invc = r2invc * r2invc * r2invc;
-                PE -= fac * r6invc * ( 0.5 * lj1_ij * r6invc - lj2_ij ) /
-                      6.0; // optimize later
+                Kokkos::parallel_for(
+                    Kokkos::TeamThreadRange( team, nt * nt ),
+                    [&]( const int p ) {
+                        lj1_t( p / nt, p % nt ) = lj1_copy( p / nt, p % nt );
+                        lj2_t( p / nt, p % nt ) = lj2_copy( p / nt, p % nt );
+                        cutsq_t( p / nt, p % nt ) =
+                            cutsq_copy( p / nt, p % nt );
+                    } );
+                team.team_barrier();
             }
-        }
-    };
-
-    T_F_FLOAT energy = 0.0;
-    Kokkos::RangePolicy<exe_space> policy( 0, N_local );
-    t_parallel neigh_parallel;
-    Cabana::neighbor_parallel_reduce(
-        policy, energy_half, neigh_list, Cabana::FirstNeighborsTag(),
-        neigh_parallel, energy, "ForceLJCabanaNeigh::compute_energy_half" );
-    return energy;
+            const PotentialLJ<t_scratch, single_type> potential_t{
+                lj1_t, lj2_t, cutsq_t, lj1_s, lj2_s, cutsq_s };
+
+            Kokkos::parallel_for(
+                Kokkos::TeamThreadRange( team, team_atoms ),
+                [&]( const int a ) {
+                    const int i = team.league_rank() * team_atoms + a;
+                    if ( i >= N )
+                        return;
+
+                    const T_F_FLOAT x_i = x( i, 0 );
+                    const T_F_FLOAT y_i = x( i, 1 );
+                    const T_F_FLOAT z_i = x( i, 2 );
+                    const int type_i = single_type ? 0 : type( i );
+                    const int num_n =
+                        Cabana::NeighborList<t_neigh>::numNeighbor( neigh_list,
+                                                                    i );
+
+                    ForceLJSum sum;
+                    Kokkos::parallel_reduce(
+                        Kokkos::ThreadVectorRange( team, num_n ),
+                        [&]( const int n, ForceLJSum &sum_n ) {
+                            const int j =
+                                Cabana::NeighborList<t_neigh>::getNeighbor(
+                                    neigh_list, i, n );
+                            const T_F_FLOAT dx = x_i - x( j, 0 );
+                            const T_F_FLOAT dy = y_i - x( j, 1 );
+                            const T_F_FLOAT dz = z_i - x( j, 2 );
+                            const T_F_FLOAT rsq = dx * dx + dy * dy + dz * dz;
+
+                            const int type_j = single_type ? 0 : type( j );
+                            if ( rsq < potential_t.cutsq_ij( type_i, type_j ) )
+                            {
+                                const T_F_FLOAT fpair =
+                                    potential_t.compute_fpair( rsq, type_i,
+                                                               type_j );
+                                sum_n.f[0] += dx * fpair;
+                                sum_n.f[1] += dy * fpair;
+                                sum_n.f[2] += dz * fpair;
+                            }
+                        },
+                        sum );
+
+                    Kokkos::single( Kokkos::PerThread( team ), [&]() {
+                        f( i, 0 ) = sum.f[0];
+                        f( i, 1 ) = sum.f[1];
+                        f( i, 2 ) = sum.f[2];
+                    } );
+                } );
+        } );
 }
@@ -20,6 +20,8 @@
 #include <system_nnp.h>
 
 #include <force.h>
+#include <nnp_batch.h>
+#include <nnp_symmetry.h>
 
 template <class t_System, class t_System_NNP, class t_Neighbor,
           class t_neigh_parallel, class t_angle_parallel>
@@ -48,6 +50,16 @@ class ForceNNP : public Force<t_System, t_Neighbor>
     using device_type = typename t_System::device_type;
     using exe_space = typename t_System::execution_space;
 
+    // Batched atomic networks; atoms are regrouped by element on rebuild
+    NNPBatch<device_type> batch;
+    T_INT grouped_build = -1;
+
+    // Symmetry functions and forces in-tree (pair_style nnp ... symmetry
+    // cabana, or cache <MB> for the radial dG/dr cache) instead of n2p2;
+    // required for half neighbor lists
+    NNPSymmetry<device_type> symmetry;
+    bool in_tree = false;
+
   public:
     nnp::ModeCabana<device_type> *mode;
 
@@ -61,7 +73,7 @@ class ForceNNP : public Force<t_System, t_Neighbor>
 
     void init_coeff( std::vector<std::vector<std::string>> args ) override;
     void compute( t_System *system, t_Neighbor *neighbor ) override;
-    T_F_FLOAT compute_energy( t_System *system, t_Neighbor *neighbor ) override;
+    T_FLOAT compute_energy( t_System *system, t_Neighbor *neighbor ) override;
 
     const char *name() override;
     const char *system_name() override;
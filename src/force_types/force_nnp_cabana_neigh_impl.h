@@ -45,7 +45,15 @@ void ForceNNP<
     t_angle_parallel>::init_coeff( std::vector<std::vector<std::string>> args )
 {
     // This is the pair_style line (not coeff), so there's only one
-    auto path = args.at( 0 ).at( 3 );
+    // Model files are read from the shared path by rank 0 only; n2p2 then
+    // sets up from the node local copy
+    NNPModel model( args.at( 0 ).at( 3 ) );
+    model.read( "input.nn" );
+    model.read( "scaling.data" );
+    for ( auto &file : batch.weight_files( model.file( "input.nn" ) ) )
+        model.read( file );
+    model.stage();
+    auto path = model.path;
     mode = new ( nnp::ModeCabana<device_type> );
 
     mode->initialize();
@@ -63,6 +71,41 @@ void ForceNNP<
     std::string weightsfile = path + "/weights.%03zu.data";
     mode->setupSymmetryFunctionStatistics( false, false, true, false );
     mode->setupNeuralNetworkWeights( weightsfile );
+    batch.load( model );
+
+    // Keywords after the model directory come in pairs
+    double cflength = 1.8897261328;
+    double cfenergy = 0.0367493254;
+    double cache_mb = 0.0;
+    auto &words = args.at( 0 );
+    for ( std::size_t w = 4; w + 1 < words.size(); w += 2 )
+    {
+        if ( words[w] == "symmetry" )
+        {
+            if ( words[w + 1] != "cabana" && words[w + 1] != "n2p2" )
+                log_err( std::cout, "pair_style nnp: symmetry must be "
+                                    "'cabana' or 'n2p2'" );
+            in_tree = words[w + 1] == "cabana";
+        }
+        else if ( words[w] == "cache" )
+        {
+            cache_mb = std::stod( words[w + 1] );
+            in_tree = true;
+        }
+        else if ( words[w] == "cflength" )
+            cflength = std::stod( words[w + 1] );
+        else if ( words[w] == "cfenergy" )
+            cfenergy = std::stod( words[w + 1] );
+    }
+    if ( in_tree )
+    {
+        symmetry.cache_bytes = cache_mb * 1024 * 1024;
+        symmetry.load( model, batch.element_order( model.file( "input.nn" ) ),
+                       cflength, cfenergy );
+        if ( symmetry.widths != batch.input_widths() )
+            log_err( std::cout, "pair_style nnp: the symmetry functions of "
+                                "input.nn do not match the weights" );
+    }
 }
 
 template <class t_System, class t_System_NNP, class t_Neighbor,
@@ -70,9 +113,14 @@ template <class t_System, class t_System_NNP, class t_Neighbor,
 void ForceNNP<t_System, t_System_NNP, t_Neighbor, t_neigh_parallel,
               t_angle_parallel>::compute( t_System *s, t_Neighbor *neighbor )
 {
+    ProfileRegion region( "ForceNNP::compute" );
     N_local = s->N_local;
 
     auto neigh_list = neighbor->get();
+    const bool half = neighbor->half_neigh;
+    if ( half && !in_tree )
+        log_err( std::cout, "pair_style nnp: half neighbor lists need the "
+                            "in-tree symmetry functions (symmetry cabana)" );
 
     system_nnp->resize( N_local );
 
@@ -82,6 +130,15 @@ void ForceNNP<t_System, t_System_NNP, t_Neighbor, t_neigh_parallel,
     t_f_a f_a = s->f;
     auto type = s->type;
 
+    if ( neighbor->num_builds != grouped_build )
+    {
+        ProfileRegion group_region( "group" );
+        batch.group( type, N_local );
+        system_nnp->arrange( batch.order, batch.counts, batch.offsets,
+                             batch.input_widths() );
+        grouped_build = neighbor->num_builds;
+    }
+
     system_nnp->slice_G();
     system_nnp->slice_dEdG();
     system_nnp->slice_E();
@@ -90,20 +147,34 @@ void ForceNNP<t_System, t_System_NNP, t_Neighbor, t_neigh_parallel,
     auto dEdG = system_nnp->dEdG;
     auto E = system_nnp->E;
 
-    mode->calculateSymmetryFunctionGroups( x, type, G_a, neigh_list, N_local,
-                                           t_neigh_parallel(),
-                                           t_angle_parallel() );
-    mode->calculateAtomicNeuralNetworks( type, G, dEdG, E, N_local );
-    mode->calculateForces( x, f_a, type, dEdG, neigh_list, N_local,
-                           t_neigh_parallel(), t_angle_parallel() );
+    profile_push( "symmetry_functions" );
+    if ( in_tree )
+        symmetry.compute_G( x, type, G_a, neigh_list, N_local, half );
+    else
+        mode->calculateSymmetryFunctionGroups(
+            x, type, G_a, neigh_list, N_local, t_neigh_parallel(),
+            t_angle_parallel() );
+    profile_pop();
+    profile_push( "network" );
+    batch.compute( G, dEdG, E );
+    profile_pop();
+    profile_push( "forces" );
+    if ( in_tree )
+        symmetry.compute_forces( x, f_a, type, dEdG, neigh_list, N_local,
+                                 half );
+    else
+        mode->calculateForces( x, f_a, type, dEdG, neigh_list, N_local,
+                               t_neigh_parallel(), t_angle_parallel() );
+    profile_pop();
 }
 
 template <class t_System, class t_System_NNP, class t_Neighbor,
           class t_neigh_parallel, class t_angle_parallel>
-T_V_FLOAT ForceNNP<t_System, t_System_NNP, t_Neighbor, t_neigh_parallel,
-                   t_angle_parallel>::compute_energy( t_System *s,
-                                                      t_Neighbor * )
+T_FLOAT ForceNNP<t_System, t_System_NNP, t_Neighbor, t_neigh_parallel,
+                 t_angle_parallel>::compute_energy( t_System *s,
+                                                    t_Neighbor * )
 {
+    ProfileRegion region( "ForceNNP::compute_energy" );
     system_nnp->slice_E();
     auto energy = system_nnp->E;
 
@@ -0,0 +1,156 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef FORCE_TABLE_CABANA_NEIGH_H
+#define FORCE_TABLE_CABANA_NEIGH_H
+
+#include <Cabana_Core.hpp>
+#include <Kokkos_Core.hpp>
+
+#include <force.h>
+#include <pair_kernel.h>
+
+#include <string>
+#include <vector>
+
+// Interpolation of the uniform (in r) device tables, chosen at compile time
+struct TableLinearTag
+{
+};
+struct TableSplineTag
+{
+};
+
+// Linear: aux holds the difference to the next table entry
+template <class t_table>
+KOKKOS_INLINE_FUNCTION T_F_FLOAT
+table_interpolate( TableLinearTag, const t_table &y, const t_table &aux,
+                   const int t, const int k, const T_F_FLOAT frac,
+                   const T_F_FLOAT )
+{
+    return y( t, k ) + frac * aux( t, k );
+}
+
+// Cubic spline: aux holds second derivatives
+template <class t_table>
+KOKKOS_INLINE_FUNCTION T_F_FLOAT
+table_interpolate( TableSplineTag, const t_table &y, const t_table &aux,
+                   const int t, const int k, const T_F_FLOAT frac,
+                   const T_F_FLOAT deltasq6 )
+{
+    const T_F_FLOAT a = 1.0 - frac;
+    const T_F_FLOAT b = frac;
+    return a * y( t, k ) + b * y( t, k + 1 ) +
+           ( ( a * a * a - a ) * aux( t, k ) +
+             ( b * b * b - b ) * aux( t, k + 1 ) ) *
+               deltasq6;
+}
+
+// Tabulated pair potential for PairKernel; each type pair maps to a table
+template <class t_fparams, class t_tparams, class t_tabindex, class t_interp>
+struct PotentialTable
+{
+    static constexpr bool single_type = false;
+
+    t_fparams cutsq;
+    t_tabindex tabindex;
+    t_tparams rinner, invdelta, deltasq6;
+    t_fparams e, f, de, df;
+    int kmax;
+
+    KOKKOS_INLINE_FUNCTION
+    T_F_FLOAT cutsq_ij( const int type_i, const int type_j ) const
+    {
+        return cutsq( type_i, type_j );
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    T_F_FLOAT compute_fpair( const T_F_FLOAT rsq, const int type_i,
+                             const int type_j ) const
+    {
+        const int t = tabindex( type_i, type_j );
+        const T_F_FLOAT r = sqrt( rsq );
+        T_F_FLOAT tk = ( r - rinner( t ) ) * invdelta( t );
+        tk = MAX( tk, 0.0 );
+        const int k = MIN( int( tk ), kmax );
+        return table_interpolate( t_interp(), f, df, t, k, tk - k,
+                                  deltasq6( t ) ) /
+               r;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    T_F_FLOAT compute_energy( const T_F_FLOAT rsq, const int type_i,
+                              const int type_j ) const
+    {
+        const int t = tabindex( type_i, type_j );
+        const T_F_FLOAT r = sqrt( rsq );
+        T_F_FLOAT tk = ( r - rinner( t ) ) * invdelta( t );
+        tk = MAX( tk, 0.0 );
+        const int k = MIN( int( tk ), kmax );
+        return table_interpolate( t_interp(), e, de, t, k, tk - k,
+                                  deltasq6( t ) );
+    }
+};
+
+template <class t_System, class t_Neighbor, class t_parallel, class t_interp>
+class ForceTable : public Force<t_System, t_Neighbor>
+{
+  private:
+    int N_local, ntypes;
+
+    int step;
+
+    using exe_space = typename t_System::execution_space;
+    using mem_space = typename t_System::memory_space;
+
+    typedef Kokkos::View<T_F_FLOAT **, mem_space,
+                         Kokkos::MemoryTraits<Kokkos::RandomAccess>>
+        t_fparams;
+    typedef Kokkos::View<T_F_FLOAT *, mem_space,
+                         Kokkos::MemoryTraits<Kokkos::RandomAccess>>
+        t_tparams;
+    typedef Kokkos::View<int **, mem_space,
+                         Kokkos::MemoryTraits<Kokkos::RandomAccess>>
+        t_tabindex;
+
+    int tablength;
+    t_fparams cutsq;
+    t_tabindex tabindex;
+
+    // Per table: inner radius, inverse spacing, spacing^2 / 6
+    t_tparams rinner, invdelta, deltasq6;
+    // Per table entry: energy, force, and interpolation data
+    t_fparams e, f, de, df;
+
+    typedef PairKernel<t_System, t_parallel> t_pair_kernel;
+    typedef PotentialTable<t_fparams, t_tparams, t_tabindex, t_interp>
+        t_potential;
+    t_potential potential() const;
+
+    void read_table( const std::string file, const std::string keyword,
+                     std::vector<double> &r, std::vector<double> &e_file,
+                     std::vector<double> &f_file, double &fplo,
+                     double &fphi );
+
+  public:
+    ForceTable( t_System *system );
+
+    void init_coeff( std::vector<std::vector<std::string>> args ) override;
+    void compute( t_System *system, t_Neighbor *neighbor ) override;
+    T_FLOAT compute_energy( t_System *system, t_Neighbor *neighbor ) override;
+    void compute_thermo( t_System *system, t_Neighbor *neighbor ) override;
+
+    const char *name() override;
+};
+
+#include <force_table_cabana_neigh_impl.h>
+
+#endif
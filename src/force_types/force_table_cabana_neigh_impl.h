@@ -0,0 +1,376 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#include <output.h>
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+// Cubic spline second derivatives with given end point first derivatives
+inline void table_spline( const std::vector<double> &x,
+                          const std::vector<double> &y, const double yp1,
+                          const double ypn, std::vector<double> &y2 )
+{
+    const int n = x.size();
+    std::vector<double> u( n );
+    y2.resize( n );
+
+    y2[0] = -0.5;
+    u[0] = ( 3.0 / ( x[1] - x[0] ) ) *
+           ( ( y[1] - y[0] ) / ( x[1] - x[0] ) - yp1 );
+    for ( int i = 1; i < n - 1; i++ )
+    {
+        double sig = ( x[i] - x[i - 1] ) / ( x[i + 1] - x[i - 1] );
+        double p = sig * y2[i - 1] + 2.0;
+        y2[i] = ( sig - 1.0 ) / p;
+        u[i] = ( y[i + 1] - y[i] ) / ( x[i + 1] - x[i] ) -
+               ( y[i] - y[i - 1] ) / ( x[i] - x[i - 1] );
+        u[i] = ( 6.0 * u[i] / ( x[i + 1] - x[i - 1] ) - sig * u[i - 1] ) / p;
+    }
+    double qn = 0.5;
+    double un = ( 3.0 / ( x[n - 1] - x[n - 2] ) ) *
+                ( ypn - ( y[n - 1] - y[n - 2] ) / ( x[n - 1] - x[n - 2] ) );
+    y2[n - 1] = ( un - qn * u[n - 2] ) / ( qn * y2[n - 2] + 1.0 );
+    for ( int k = n - 2; k >= 0; k-- )
+        y2[k] = y2[k] * y2[k + 1] + u[k];
+}
+
+// Evaluate the spline at x0 (bisection for the interval)
+inline double table_splint( const std::vector<double> &x,
+                            const std::vector<double> &y,
+                            const std::vector<double> &y2, const double x0 )
+{
+    int klo = 0;
+    int khi = x.size() - 1;
+    while ( khi - klo > 1 )
+    {
+        int k = ( khi + klo ) >> 1;
+        if ( x[k] > x0 )
+            khi = k;
+        else
+            klo = k;
+    }
+    double h = x[khi] - x[klo];
+    double a = ( x[khi] - x0 ) / h;
+    double b = ( x0 - x[klo] ) / h;
+    return a * y[klo] + b * y[khi] +
+           ( ( a * a * a - a ) * y2[klo] + ( b * b * b - b ) * y2[khi] ) *
+               ( h * h ) / 6.0;
+}
+
+template <class t_System, class t_Neighbor, class t_parallel, class t_interp>
+ForceTable<t_System, t_Neighbor, t_parallel, t_interp>::ForceTable(
+    t_System *system )
+    : Force<t_System, t_Neighbor>( system )
+{
+    ntypes = system->ntypes;
+    cutsq = t_fparams( "ForceTableCabanaNeigh::cutsq", ntypes, ntypes );
+    tabindex =
+        t_tabindex( "ForceTableCabanaNeigh::tabindex", ntypes, ntypes );
+
+    tablength = 0;
+    N_local = 0;
+    step = 0;
+}
+
+template <class t_System, class t_Neighbor, class t_parallel, class t_interp>
+void ForceTable<t_System, t_Neighbor, t_parallel, t_interp>::read_table(
+    const std::string file, const std::string keyword, std::vector<double> &r,
+    std::vector<double> &e_file, std::vector<double> &f_file, double &fplo,
+    double &fphi )
+{
+    std::ifstream in( file );
+    if ( !in.good() )
+        log_err( std::cerr, "Cannot open pair table file: ", file );
+
+    std::string line, word;
+    while ( std::getline( in, line ) )
+    {
+        std::istringstream words( line );
+        if ( !( words >> word ) || word[0] == '#' )
+            continue;
+        bool match = word.compare( keyword ) == 0;
+
+        // Section parameters: N n [R/RSQ lo hi] [FP lo hi]
+        std::getline( in, line );
+        std::istringstream params( line );
+        int n = 0;
+        int rflag = 0;
+        double rlo = 0.0, rhi = 0.0;
+        while ( params >> word )
+        {
+            if ( word.compare( "N" ) == 0 )
+                params >> n;
+            else if ( word.compare( "R" ) == 0 )
+            {
+                rflag = 1;
+                params >> rlo >> rhi;
+            }
+            else if ( word.compare( "RSQ" ) == 0 )
+            {
+                rflag = 2;
+                params >> rlo >> rhi;
+            }
+            else if ( word.compare( "FP" ) == 0 && match )
+                params >> fplo >> fphi;
+            else if ( match )
+                log_err( std::cerr, "Unsupported pair table parameter: ",
+                         word );
+        }
+        if ( n < 2 )
+            log_err( std::cerr, "Invalid pair table length in ", file );
+
+        r.resize( n );
+        e_file.resize( n );
+        f_file.resize( n );
+        int i = 0;
+        while ( i < n && std::getline( in, line ) )
+        {
+            std::istringstream entry( line );
+            int index;
+            if ( !( entry >> index ) )
+                continue;
+            if ( match )
+                entry >> r[i] >> e_file[i] >> f_file[i];
+            i++;
+        }
+        if ( !match )
+            continue;
+        if ( i < n )
+            log_err( std::cerr, "Premature end of pair table ", keyword,
+                     " in ", file );
+
+        for ( i = 0; i < n; i++ )
+        {
+            if ( rflag == 1 )
+                r[i] = rlo + ( rhi - rlo ) * i / ( n - 1 );
+            else if ( rflag == 2 )
+                r[i] = sqrt( rlo * rlo + ( rhi * rhi - rlo * rlo ) * i /
+                                             ( n - 1 ) );
+        }
+        return;
+    }
+    log_err( std::cerr, "Did not find keyword ", keyword,
+             " in pair table file ", file );
+}
+
+template <class t_System, class t_Neighbor, class t_parallel, class t_interp>
+void ForceTable<t_System, t_Neighbor, t_parallel, t_interp>::init_coeff(
+    std::vector<std::vector<std::string>> args )
+{
+    // First line is pair_style table <linear|spline> N, the rest pair_coeff
+    tablength = std::stoi( args.at( 0 ).at( 3 ) );
+    if ( tablength < 2 )
+        log_err( std::cerr, "pair_style table requires N >= 2" );
+    const int ntables = args.size() - 1;
+    const bool spline = std::is_same<t_interp, TableSplineTag>::value;
+
+    rinner = t_tparams( "ForceTableCabanaNeigh::rinner", ntables );
+    invdelta = t_tparams( "ForceTableCabanaNeigh::invdelta", ntables );
+    deltasq6 = t_tparams( "ForceTableCabanaNeigh::deltasq6", ntables );
+    e = t_fparams( "ForceTableCabanaNeigh::e", ntables, tablength );
+    f = t_fparams( "ForceTableCabanaNeigh::f", ntables, tablength );
+    de = t_fparams( "ForceTableCabanaNeigh::de", ntables, tablength );
+    df = t_fparams( "ForceTableCabanaNeigh::df", ntables, tablength );
+
+    auto host_cutsq = Kokkos::create_mirror_view( Kokkos::HostSpace{}, cutsq );
+    auto host_tabindex =
+        Kokkos::create_mirror_view( Kokkos::HostSpace{}, tabindex );
+    auto host_rinner =
+        Kokkos::create_mirror_view( Kokkos::HostSpace{}, rinner );
+    auto host_invdelta =
+        Kokkos::create_mirror_view( Kokkos::HostSpace{}, invdelta );
+    auto host_deltasq6 =
+        Kokkos::create_mirror_view( Kokkos::HostSpace{}, deltasq6 );
+    auto host_e = Kokkos::create_mirror_view( Kokkos::HostSpace{}, e );
+    auto host_f = Kokkos::create_mirror_view( Kokkos::HostSpace{}, f );
+    auto host_de = Kokkos::create_mirror_view( Kokkos::HostSpace{}, de );
+    auto host_df = Kokkos::create_mirror_view( Kokkos::HostSpace{}, df );
+
+    for ( int t = 0; t < ntables; t++ )
+    {
+        // pair_coeff i j file keyword [cutoff]
+        auto pair = args.at( t + 1 );
+        int i = std::stoi( pair.at( 1 ) ) - 1;
+        int j = std::stoi( pair.at( 2 ) ) - 1;
+
+        std::vector<double> r, e_file, f_file;
+        double fplo = NAN, fphi = NAN;
+        read_table( pair.at( 3 ), pair.at( 4 ), r, e_file, f_file, fplo,
+                    fphi );
+        const int n = r.size();
+        double cut = pair.size() > 5 ? std::stod( pair.at( 5 ) ) : r[n - 1];
+
+        // Spline the file data: f = -dE/dr, force end slopes estimated
+        // unless given with FP
+        if ( std::isnan( fplo ) )
+            fplo = ( f_file[1] - f_file[0] ) / ( r[1] - r[0] );
+        if ( std::isnan( fphi ) )
+            fphi = ( f_file[n - 1] - f_file[n - 2] ) / ( r[n - 1] - r[n - 2] );
+        std::vector<double> e2_file, f2_file;
+        table_spline( r, e_file, -f_file[0], -f_file[n - 1], e2_file );
+        table_spline( r, f_file, fplo, fphi, f2_file );
+
+        // Resample uniformly in r from the inner radius to the cutoff
+        double delta = ( cut - r[0] ) / ( tablength - 1 );
+        std::vector<double> r_tab( tablength ), e_tab( tablength ),
+            f_tab( tablength );
+        for ( int k = 0; k < tablength; k++ )
+        {
+            r_tab[k] = r[0] + k * delta;
+            e_tab[k] = table_splint( r, e_file, e2_file, r_tab[k] );
+            f_tab[k] = table_splint( r, f_file, f2_file, r_tab[k] );
+        }
+
+        std::vector<double> e_aux( tablength, 0.0 ), f_aux( tablength, 0.0 );
+        if ( spline )
+        {
+            table_spline( r_tab, e_tab, -f_tab[0], -f_tab[tablength - 1],
+                          e_aux );
+            table_spline( r_tab, f_tab,
+                          ( f_tab[1] - f_tab[0] ) / delta,
+                          ( f_tab[tablength - 1] - f_tab[tablength - 2] ) /
+                              delta,
+                          f_aux );
+        }
+        else
+        {
+            for ( int k = 0; k < tablength - 1; k++ )
+            {
+                e_aux[k] = e_tab[k + 1] - e_tab[k];
+                f_aux[k] = f_tab[k + 1] - f_tab[k];
+            }
+        }
+
+        host_rinner( t ) = r[0];
+        host_invdelta( t ) = 1.0 / delta;
+        host_deltasq6( t ) = delta * delta / 6.0;
+        for ( int k = 0; k < tablength; k++ )
+        {
+            host_e( t, k ) = e_tab[k];
+            host_f( t, k ) = f_tab[k];
+            host_de( t, k ) = e_aux[k];
+            host_df( t, k ) = f_aux[k];
+        }
+
+        host_cutsq( i, j ) = cut * cut;
+        host_cutsq( j, i ) = host_cutsq( i, j );
+        host_tabindex( i, j ) = t;
+        host_tabindex( j, i ) = t;
+    }
+    Kokkos::deep_copy( cutsq, host_cutsq );
+    Kokkos::deep_copy( tabindex, host_tabindex );
+    Kokkos::deep_copy( rinner, host_rinner );
+    Kokkos::deep_copy( invdelta, host_invdelta );
+    Kokkos::deep_copy( deltasq6, host_deltasq6 );
+    Kokkos::deep_copy( e, host_e );
+    Kokkos::deep_copy( f, host_f );
+    Kokkos::deep_copy( de, host_de );
+    Kokkos::deep_copy( df, host_df );
+}
+
+template <class t_System, class t_Neighbor, class t_parallel, class t_interp>
+typename ForceTable<t_System, t_Neighbor, t_parallel, t_interp>::t_potential
+ForceTable<t_System, t_Neighbor, t_parallel, t_interp>::potential() const
+{
+    const int kmax = tablength - 2;
+    return { cutsq, tabindex, rinner, invdelta, deltasq6, e, f, de, df, kmax };
+}
+
+template <class t_System, class t_Neighbor, class t_parallel, class t_interp>
+void ForceTable<t_System, t_Neighbor, t_parallel, t_interp>::compute(
+    t_System *system, t_Neighbor *neighbor )
+{
+    ProfileRegion region( "ForceTable::compute" );
+    N_local = system->N_local;
+    system->slice_force();
+    auto x = system->x;
+    auto f_sys = system->f;
+    auto type = system->type;
+
+    auto neigh_list = neighbor->get();
+
+    if ( neighbor->half_neigh )
+        t_pair_kernel::force_half( potential(), f_sys, x, type, neigh_list,
+                                   N_local, "ForceTableCabanaNeigh" );
+    else
+        t_pair_kernel::force_full( potential(), f_sys, x, type, neigh_list,
+                                   N_local, "ForceTableCabanaNeigh" );
+    Kokkos::fence();
+
+    step++;
+}
+
+template <class t_System, class t_Neighbor, class t_parallel, class t_interp>
+T_FLOAT ForceTable<t_System, t_Neighbor, t_parallel, t_interp>::compute_energy(
+    t_System *system, t_Neighbor *neighbor )
+{
+    ProfileRegion region( "ForceTable::compute_energy" );
+    N_local = system->N_local;
+    system->slice_force();
+    auto x = system->x;
+    auto type = system->type;
+
+    auto neigh_list = neighbor->get();
+
+    T_FLOAT energy;
+    if ( neighbor->half_neigh )
+        energy = t_pair_kernel::energy_half( potential(), x, type, neigh_list,
+                                             N_local, "ForceTableCabanaNeigh" );
+    else
+        energy = t_pair_kernel::energy_full( potential(), x, type, neigh_list,
+                                             N_local, "ForceTableCabanaNeigh" );
+    Kokkos::fence();
+
+    step++;
+    return energy;
+}
+
+template <class t_System, class t_Neighbor, class t_parallel, class t_interp>
+void ForceTable<t_System, t_Neighbor, t_parallel, t_interp>::compute_thermo(
+    t_System *system, t_Neighbor *neighbor )
+{
+    ProfileRegion region( "ForceTable::compute_thermo" );
+    N_local = system->N_local;
+    system->slice_force();
+    auto x = system->x;
+    auto f_sys = system->f;
+    auto type = system->type;
+
+    auto neigh_list = neighbor->get();
+
+    PairThermo thermo;
+    if ( neighbor->half_neigh )
+        thermo = t_pair_kernel::thermo_half( potential(), f_sys, x, type,
+                                             neigh_list, N_local,
+                                             "ForceTableCabanaNeigh" );
+    else
+        thermo = t_pair_kernel::thermo_full( potential(), f_sys, x, type,
+                                             neigh_list, N_local,
+                                             "ForceTableCabanaNeigh" );
+    Kokkos::fence();
+
+    this->thermo_energy = thermo.energy;
+    for ( int v = 0; v < 6; v++ )
+        this->thermo_virial[v] = thermo.virial[v];
+    this->thermo_valid = true;
+
+    step++;
+}
+
+template <class t_System, class t_Neighbor, class t_parallel, class t_interp>
+const char *ForceTable<t_System, t_Neighbor, t_parallel, t_interp>::name()
+{
+    if ( std::is_same<t_interp, TableSplineTag>::value )
+        return "Force:TableSplineCabana";
+    return "Force:TableLinearCabana";
+}
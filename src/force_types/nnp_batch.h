@@ -0,0 +1,523 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef NNP_BATCH_H
+#define NNP_BATCH_H
+
+#include <CabanaMD_config.hpp>
+
+#include <Kokkos_Core.hpp>
+#ifdef CabanaMD_ENABLE_KOKKOSKERNELS
+#include <KokkosBlas3_gemm.hpp>
+#endif
+
+#include <nnp_model.h>
+#include <output.h>
+#include <types.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <istream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Activation functions, by their n2p2 settings code
+enum
+{
+    NNP_AF_IDENTITY,
+    NNP_AF_TANH,
+    NNP_AF_LOGISTIC,
+    NNP_AF_SOFTPLUS,
+    NNP_AF_RELU,
+    NNP_AF_GAUSSIAN
+};
+
+// Atomic neural networks evaluated for all atoms of an element at once:
+// each layer is a dense matrix product over the batch. Atoms are grouped
+// by element once per neighbor build; weights are kept on the device.
+template <class t_device>
+class NNPBatch
+{
+    using exe_space = typename t_device::execution_space;
+    using mem_space = typename t_device::memory_space;
+
+  public:
+    using t_matrix =
+        Kokkos::View<T_NNP_FLOAT **, Kokkos::LayoutRight, mem_space>;
+    using t_vector = Kokkos::View<T_NNP_FLOAT *, mem_space>;
+    using t_index = Kokkos::View<T_INT *, mem_space>;
+
+    // Per element, per layer (layer 0 is the input)
+    std::vector<std::vector<int>> neurons;
+    std::vector<std::vector<int>> activation;
+    std::vector<std::vector<t_matrix>> weights;
+    std::vector<std::vector<t_vector>> bias;
+
+    // Atoms grouped by element: order[offsets[e], offsets[e] + counts[e])
+    t_index order;
+    std::vector<T_INT> counts, offsets;
+
+    // Activations and derivatives per layer, sized for the largest group
+    std::vector<t_matrix> values, derivs;
+    t_matrix delta, delta_next;
+
+    // Elements of input.nn in n2p2 order (the type index)
+    std::vector<std::string> element_order( const std::string &settings )
+    {
+        std::vector<std::string> elements;
+        std::vector<std::vector<int>> hidden_nodes;
+        std::vector<int> af;
+        std::istringstream in( settings );
+        read_settings( in, elements, hidden_nodes, af );
+        return sorted_elements( elements );
+    }
+
+    // Weight files of the elements in input.nn, in n2p2 element order
+    std::vector<std::string> weight_files( const std::string &settings )
+    {
+        std::vector<std::string> files;
+        for ( auto &e : element_order( settings ) )
+        {
+            char file[32];
+            std::snprintf( file, sizeof( file ), "weights.%03d.data",
+                           atomic_number( e ) );
+            files.push_back( file );
+        }
+        return files;
+    }
+
+    // From the model file contents (input.nn and the weight files)
+    void load( const NNPModel &model )
+    {
+        std::vector<std::string> elements;
+        std::vector<std::vector<int>> hidden_nodes;
+        std::vector<int> af;
+        std::istringstream settings( model.file( "input.nn" ) );
+        read_settings( settings, elements, hidden_nodes, af );
+
+        auto sorted = sorted_elements( elements );
+        auto files = weight_files( model.file( "input.nn" ) );
+        int num_elements = files.size();
+        neurons.resize( num_elements );
+        activation.resize( num_elements );
+        weights.resize( num_elements );
+        bias.resize( num_elements );
+        for ( int e = 0; e < num_elements; e++ )
+        {
+            auto index =
+                std::find( elements.begin(), elements.end(), sorted[e] ) -
+                elements.begin();
+            std::istringstream in( model.file( files[e] ) );
+            read_weights( in, files[e], e, hidden_nodes[index], af );
+        }
+    }
+
+    // Symmetry functions (network inputs) per element
+    std::vector<int> input_widths()
+    {
+        std::vector<int> widths;
+        for ( auto &n : neurons )
+            widths.push_back( n[0] );
+        return widths;
+    }
+
+    // Group local atoms by element (stable within an element)
+    template <class t_type>
+    void group( const t_type type, const T_INT N_local )
+    {
+        int num_elements = neurons.size();
+        if ( order.extent( 0 ) < (std::size_t)N_local )
+            Kokkos::realloc( order, N_local * 1.1 );
+        counts.assign( num_elements, 0 );
+        offsets.assign( num_elements, 0 );
+
+        auto order_copy = order;
+        T_INT offset = 0;
+        for ( int e = 0; e < num_elements; e++ )
+        {
+            T_INT count = 0;
+            Kokkos::parallel_scan(
+                "NNPBatch::group", Kokkos::RangePolicy<exe_space>( 0, N_local ),
+                KOKKOS_LAMBDA( const int i, T_INT &num, const bool final ) {
+                    if ( type( i ) == e )
+                    {
+                        if ( final )
+                            order_copy( offset + num ) = i;
+                        num++;
+                    }
+                },
+                count );
+            counts[e] = count;
+            offsets[e] = offset;
+            offset += count;
+        }
+    }
+
+    // Atomic energies E and derivatives dEdG from the symmetry functions G
+    template <class t_G, class t_dEdG, class t_E>
+    void compute( const t_G G, t_dEdG dEdG, t_E E )
+    {
+        for ( std::size_t e = 0; e < neurons.size(); e++ )
+            if ( counts[e] > 0 )
+                compute_element( e, G, dEdG, E );
+    }
+
+    template <class t_G, class t_dEdG, class t_E>
+    void compute_element( const int e, const t_G G, t_dEdG dEdG, t_E E )
+    {
+        const T_INT batch = counts[e];
+        const T_INT offset = offsets[e];
+        const int num_layers = neurons[e].size();
+        reserve( batch );
+
+        auto order_copy = order;
+        using t_mdrange = Kokkos::MDRangePolicy<exe_space, Kokkos::Rank<2>>;
+
+        // Input layer
+        const int num_in = neurons[e][0];
+        auto x0 = rows( values[0], batch, num_in );
+        Kokkos::parallel_for(
+            "NNPBatch::gather", t_mdrange( {0, 0}, {batch, num_in} ),
+            KOKKOS_LAMBDA( const int a, const int k ) {
+                x0( a, k ) = G( order_copy( offset + a ), k );
+            } );
+
+        // Forward: z = x W^T + b, then the activation and its derivative
+        for ( int l = 1; l < num_layers; l++ )
+        {
+            const int n = neurons[e][l];
+            auto x_prev = rows( values[l - 1], batch, neurons[e][l - 1] );
+            auto x = rows( values[l], batch, n );
+            auto dx = rows( derivs[l], batch, n );
+            dense( x_prev, weights[e][l], x, true );
+
+            auto b = bias[e][l];
+            const int af = activation[e][l];
+            Kokkos::parallel_for(
+                "NNPBatch::activate", t_mdrange( {0, 0}, {batch, n} ),
+                KOKKOS_LAMBDA( const int a, const int j ) {
+                    activate( af, x( a, j ) + b( j ), x( a, j ), dx( a, j ) );
+                } );
+        }
+
+        // Backward: dE/dx through each layer down to the inputs
+        auto out = rows( values[num_layers - 1], batch, 1 );
+        auto d_out = rows( derivs[num_layers - 1], batch, 1 );
+        auto d = rows( delta, batch, 1 );
+        Kokkos::parallel_for(
+            "NNPBatch::energy", Kokkos::RangePolicy<exe_space>( 0, batch ),
+            KOKKOS_LAMBDA( const int a ) {
+                E( order_copy( offset + a ) ) = out( a, 0 );
+                d( a, 0 ) = d_out( a, 0 );
+            } );
+        for ( int l = num_layers - 1; l > 0; l-- )
+        {
+            const int n_prev = neurons[e][l - 1];
+            auto d_l = rows( delta, batch, neurons[e][l] );
+            auto d_prev = rows( delta_next, batch, n_prev );
+            dense( d_l, weights[e][l], d_prev, false );
+            if ( l > 1 )
+            {
+                auto dx = rows( derivs[l - 1], batch, n_prev );
+                Kokkos::parallel_for(
+                    "NNPBatch::backward", t_mdrange( {0, 0}, {batch, n_prev} ),
+                    KOKKOS_LAMBDA( const int a, const int k ) {
+                        d_prev( a, k ) *= dx( a, k );
+                    } );
+            }
+            std::swap( delta, delta_next );
+        }
+
+        auto d_in = rows( delta, batch, num_in );
+        Kokkos::parallel_for(
+            "NNPBatch::scatter", t_mdrange( {0, 0}, {batch, num_in} ),
+            KOKKOS_LAMBDA( const int a, const int k ) {
+                dEdG( order_copy( offset + a ), k ) = d_in( a, k );
+            } );
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static void activate( const int af, const T_NNP_FLOAT z, T_NNP_FLOAT &f,
+                          T_NNP_FLOAT &df )
+    {
+        if ( af == NNP_AF_TANH )
+        {
+            f = tanh( z );
+            df = 1.0 - f * f;
+        }
+        else if ( af == NNP_AF_LOGISTIC )
+        {
+            f = 1.0 / ( 1.0 + exp( -z ) );
+            df = f * ( 1.0 - f );
+        }
+        else if ( af == NNP_AF_SOFTPLUS )
+        {
+            f = z > 0.0 ? z + log( 1.0 + exp( -z ) ) : log( 1.0 + exp( z ) );
+            df = 1.0 / ( 1.0 + exp( -z ) );
+        }
+        else if ( af == NNP_AF_RELU )
+        {
+            f = z > 0.0 ? z : 0.0;
+            df = z > 0.0 ? 1.0 : 0.0;
+        }
+        else if ( af == NNP_AF_GAUSSIAN )
+        {
+            f = exp( -0.5 * z * z );
+            df = -z * f;
+        }
+        else
+        {
+            f = z;
+            df = 1.0;
+        }
+    }
+
+    static auto rows( const t_matrix m, const T_INT num_rows,
+                      const int num_cols )
+        -> decltype( Kokkos::subview( m, Kokkos::pair<int, int>(),
+                                      Kokkos::pair<int, int>() ) )
+    {
+        return Kokkos::subview( m, Kokkos::pair<int, int>( 0, num_rows ),
+                                Kokkos::pair<int, int>( 0, num_cols ) );
+    }
+
+    // c = a * b^T (transpose) or c = a * b
+    template <class t_a, class t_b, class t_c>
+    static void dense( const t_a a, const t_b b, t_c c, const bool transpose )
+    {
+#ifdef CabanaMD_ENABLE_KOKKOSKERNELS
+        KokkosBlas::gemm( "N", transpose ? "T" : "N", 1.0, a, b, 0.0, c );
+#else
+        const int inner = a.extent( 1 );
+        using t_mdrange = Kokkos::MDRangePolicy<exe_space, Kokkos::Rank<2>>;
+        Kokkos::parallel_for(
+            "NNPBatch::dense",
+            t_mdrange( {0, 0}, {(int)c.extent( 0 ), (int)c.extent( 1 )} ),
+            KOKKOS_LAMBDA( const int i, const int j ) {
+                T_NNP_FLOAT sum = 0.0;
+                for ( int k = 0; k < inner; k++ )
+                    sum += a( i, k ) * ( transpose ? b( j, k ) : b( k, j ) );
+                c( i, j ) = sum;
+            } );
+#endif
+    }
+
+    void reserve( const T_INT batch )
+    {
+        int width = 1;
+        int num_layers = 0;
+        for ( auto &n : neurons )
+        {
+            width = std::max( width, *std::max_element( n.begin(), n.end() ) );
+            num_layers = std::max( num_layers, (int)n.size() );
+        }
+        if ( values.size() == (std::size_t)num_layers &&
+             values[0].extent( 0 ) >= (std::size_t)batch )
+            return;
+
+        T_INT size = batch * 1.1;
+        values.resize( num_layers );
+        derivs.resize( num_layers );
+        for ( int l = 0; l < num_layers; l++ )
+        {
+            values[l] = t_matrix( "NNPBatch::values", size, width );
+            derivs[l] = t_matrix( "NNPBatch::derivs", size, width );
+        }
+        delta = t_matrix( "NNPBatch::delta", size, width );
+        delta_next = t_matrix( "NNPBatch::delta_next", size, width );
+    }
+
+  private:
+    // Network settings of input.nn: hidden layer sizes per element (in the
+    // order of the elements keyword) and one activation per layer. Settings
+    // the batched layers cannot represent are rejected rather than ignored.
+    void read_settings( std::istream &in, std::vector<std::string> &elements,
+                        std::vector<std::vector<int>> &hidden_nodes,
+                        std::vector<int> &af )
+    {
+        std::vector<int> global_nodes;
+        std::vector<std::pair<std::string, std::vector<int>>> element_nodes;
+        int hidden_layers = -1;
+        std::string line;
+        while ( std::getline( in, line ) )
+        {
+            std::istringstream words( line.substr( 0, line.find( '#' ) ) );
+            std::string key, word;
+            words >> key;
+            if ( key == "elements" )
+                while ( words >> word )
+                    elements.push_back( word );
+            else if ( key == "global_hidden_layers_short" )
+                words >> hidden_layers;
+            else if ( key == "global_nodes_short" )
+                while ( words >> word )
+                    global_nodes.push_back( std::stoi( word ) );
+            else if ( key == "element_nodes_short" )
+            {
+                std::pair<std::string, std::vector<int>> nodes;
+                words >> nodes.first;
+                while ( words >> word )
+                    nodes.second.push_back( std::stoi( word ) );
+                element_nodes.push_back( nodes );
+            }
+            else if ( key == "global_activation_short" )
+                while ( words >> word )
+                    af.push_back( activation_code( word ) );
+            else if ( key == "element_activation_short" ||
+                      key == "normalize_nodes" )
+                log_err( std::cout, "NNPBatch: ", key,
+                         " is not supported by the batched networks" );
+        }
+
+        for ( auto &e : elements )
+        {
+            std::vector<int> nodes = global_nodes;
+            for ( auto &override_nodes : element_nodes )
+                if ( override_nodes.first == e )
+                    nodes = override_nodes.second;
+            if ( hidden_layers >= 0 &&
+                 nodes.size() != (std::size_t)hidden_layers )
+                log_err( std::cout, "NNPBatch: expected ", hidden_layers,
+                         " hidden layer sizes for ", e );
+            if ( af.size() != nodes.size() + 1 )
+                log_err( std::cout, "NNPBatch: expected one activation per "
+                                    "hidden layer and one for the output" );
+            hidden_nodes.push_back( nodes );
+        }
+    }
+
+    // n2p2 orders elements by atomic number
+    std::vector<std::string>
+    sorted_elements( std::vector<std::string> elements )
+    {
+        std::sort( elements.begin(), elements.end(),
+                   [this]( const std::string &a, const std::string &b ) {
+                       return atomic_number( a ) < atomic_number( b );
+                   } );
+        return elements;
+    }
+
+    // n2p2 weights: one value per line with its type (a: weight, b: bias)
+    // and connection; neurons are numbered from 1
+    void read_weights( std::istream &in, const std::string file, const int e,
+                       const std::vector<int> &hidden_nodes,
+                       const std::vector<int> &af )
+    {
+        struct Entry
+        {
+            double value;
+            char kind;
+            int l0, n0, l1, n1;
+        };
+        std::vector<Entry> entries;
+        int num_in = 0;
+        std::string line;
+        while ( std::getline( in, line ) )
+        {
+            if ( line.empty() || line[0] == '#' )
+                continue;
+            std::istringstream words( line );
+            Entry entry;
+            int index;
+            words >> entry.value >> entry.kind >> index;
+            if ( entry.kind == 'a' )
+            {
+                words >> entry.l0 >> entry.n0 >> entry.l1 >> entry.n1;
+                if ( entry.l0 == 0 )
+                    num_in = std::max( num_in, entry.n0 );
+            }
+            else
+            {
+                words >> entry.l1 >> entry.n1;
+            }
+            entries.push_back( entry );
+        }
+
+        auto &n = neurons[e];
+        n.push_back( num_in );
+        for ( auto h : hidden_nodes )
+            n.push_back( h );
+        n.push_back( 1 );
+        activation[e].push_back( NNP_AF_IDENTITY );
+        for ( auto a : af )
+            activation[e].push_back( a );
+
+        const int num_layers = n.size();
+        std::vector<typename t_matrix::HostMirror> h_weights( num_layers );
+        std::vector<typename t_vector::HostMirror> h_bias( num_layers );
+        weights[e].resize( num_layers );
+        bias[e].resize( num_layers );
+        for ( int l = 1; l < num_layers; l++ )
+        {
+            weights[e][l] = t_matrix( "NNPBatch::weights", n[l], n[l - 1] );
+            bias[e][l] = t_vector( "NNPBatch::bias", n[l] );
+            h_weights[l] = Kokkos::create_mirror_view( weights[e][l] );
+            h_bias[l] = Kokkos::create_mirror_view( bias[e][l] );
+        }
+        for ( auto &entry : entries )
+        {
+            if ( entry.l1 < 1 || entry.l1 >= num_layers ||
+                 entry.n1 > n[entry.l1] )
+                log_err( std::cout, "NNPBatch: ", file,
+                         " does not match the network in input.nn" );
+            else if ( entry.kind == 'a' )
+                h_weights[entry.l1]( entry.n1 - 1, entry.n0 - 1 ) =
+                    entry.value;
+            else
+                h_bias[entry.l1]( entry.n1 - 1 ) = entry.value;
+        }
+        for ( int l = 1; l < num_layers; l++ )
+        {
+            Kokkos::deep_copy( weights[e][l], h_weights[l] );
+            Kokkos::deep_copy( bias[e][l], h_bias[l] );
+        }
+    }
+
+    int activation_code( const std::string code )
+    {
+        if ( code == "l" )
+            return NNP_AF_IDENTITY;
+        if ( code == "t" )
+            return NNP_AF_TANH;
+        if ( code == "s" )
+            return NNP_AF_LOGISTIC;
+        if ( code == "p" )
+            return NNP_AF_SOFTPLUS;
+        if ( code == "r" )
+            return NNP_AF_RELU;
+        if ( code == "g" )
+            return NNP_AF_GAUSSIAN;
+        log_err( std::cout, "NNPBatch: unsupported activation ", code );
+        return NNP_AF_IDENTITY;
+    }
+
+    int atomic_number( const std::string symbol )
+    {
+        static const char *symbols =
+            "H He Li Be B C N O F Ne Na Mg Al Si P S Cl Ar K Ca Sc Ti V Cr "
+            "Mn Fe Co Ni Cu Zn Ga Ge As Se Br Kr Rb Sr Y Zr Nb Mo Tc Ru Rh "
+            "Pd Ag Cd In Sn Sb Te I Xe Cs Ba La Ce Pr Nd Pm Sm Eu Gd Tb Dy "
+            "Ho Er Tm Yb Lu Hf Ta W Re Os Ir Pt Au Hg Tl Pb Bi Po At Rn Fr "
+            "Ra Ac Th Pa U Np Pu Am Cm Bk Cf Es Fm Md No Lr";
+        std::istringstream words( symbols );
+        std::string word;
+        for ( int z = 1; words >> word; z++ )
+            if ( word == symbol )
+                return z;
+        log_err( std::cout, "NNPBatch: unknown element ", symbol );
+        return 0;
+    }
+};
+
+#endif
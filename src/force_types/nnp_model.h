@@ -0,0 +1,171 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef NNP_MODEL_H
+#define NNP_MODEL_H
+
+#include <mpi.h>
+
+#include <output.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+// NNP model text files read once by rank 0 and broadcast to every rank,
+// instead of every rank reading the shared file system. n2p2 only reads
+// files, so the first rank of every node also writes the broadcast copy to
+// node local storage ($CABANAMD_NNP_CACHE, $TMPDIR or /tmp) for the n2p2
+// setup; if that fails, n2p2 falls back to the shared path.
+class NNPModel
+{
+  public:
+    // Where the n2p2 setup should read the model files
+    std::string path;
+
+    NNPModel( const std::string shared_path_ )
+        : path( shared_path_ )
+        , shared_path( shared_path_ )
+    {
+        MPI_Comm_rank( MPI_COMM_WORLD, &rank );
+        MPI_Comm_split_type( MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank,
+                             MPI_INFO_NULL, &node_comm );
+        MPI_Comm_rank( node_comm, &node_rank );
+    }
+
+    ~NNPModel()
+    {
+        unstage();
+        MPI_Comm_free( &node_comm );
+    }
+
+    // Read a file of the model directory on rank 0 and broadcast it
+    void read( const std::string name )
+    {
+        std::string content;
+        long long size = -1;
+        if ( rank == 0 )
+        {
+            std::ifstream in( shared_path + "/" + name, std::ios::binary );
+            if ( in )
+            {
+                std::ostringstream buffer;
+                buffer << in.rdbuf();
+                content = buffer.str();
+                size = content.size();
+            }
+        }
+        MPI_Bcast( &size, 1, MPI_LONG_LONG, 0, MPI_COMM_WORLD );
+        if ( size < 0 )
+            log_err( std::cout, "NNPModel: cannot open ", shared_path, "/",
+                     name );
+        content.resize( size );
+        MPI_Bcast( &content[0], size, MPI_CHAR, 0, MPI_COMM_WORLD );
+        files[name] = content;
+    }
+
+    const std::string &file( const std::string name ) const
+    {
+        auto f = files.find( name );
+        if ( f == files.end() )
+            log_err( std::cout, "NNPModel: ", name, " was not read" );
+        return f->second;
+    }
+
+    // Write all files read so far to a node local directory. The name
+    // holds rank 0's process id, the host name and the world rank of the
+    // node leader, so leaders never share a directory even when the base
+    // path is on a shared file system.
+    void stage()
+    {
+        long long tag = getpid();
+        MPI_Bcast( &tag, 1, MPI_LONG_LONG, 0, MPI_COMM_WORLD );
+        int leader = rank;
+        MPI_Bcast( &leader, 1, MPI_INT, 0, node_comm );
+        char host[256] = "host";
+        gethostname( host, sizeof( host ) );
+        host[sizeof( host ) - 1] = '\0';
+        const char *base = std::getenv( "CABANAMD_NNP_CACHE" );
+        if ( !base )
+            base = std::getenv( "TMPDIR" );
+        if ( !base )
+            base = "/tmp";
+        local_path = std::string( base ) + "/cabanamd_nnp_" +
+                     std::to_string( tag ) + "_" + host + "_" +
+                     std::to_string( leader );
+
+        int staged = 1;
+        if ( node_rank == 0 )
+        {
+            // An existing directory is not ours: leave it alone
+            created_dir = mkdir( local_path.c_str(), 0700 ) == 0;
+            staged = created_dir;
+            for ( auto &f : files )
+            {
+                if ( !staged )
+                    break;
+                std::string name = local_path + "/" + f.first;
+                std::ofstream out( name, std::ios::binary );
+                if ( out )
+                    created.push_back( name );
+                out.write( f.second.data(), f.second.size() );
+                staged = out.good();
+            }
+        }
+        MPI_Bcast( &staged, 1, MPI_INT, 0, node_comm );
+        if ( staged )
+            path = local_path;
+        else
+        {
+            unstage();
+            if ( rank == 0 )
+                log( std::cout, "Warning: NNPModel: cannot write ",
+                     local_path, "; every rank reads ", shared_path );
+        }
+    }
+
+    // Remove the node local copy once the n2p2 setup is done; only the
+    // files and directory this leader created are removed
+    void unstage()
+    {
+        if ( local_path.empty() )
+            return;
+        MPI_Barrier( node_comm );
+        if ( node_rank == 0 )
+        {
+            for ( auto &name : created )
+                std::remove( name.c_str() );
+            if ( created_dir )
+                rmdir( local_path.c_str() );
+        }
+        created.clear();
+        created_dir = false;
+        local_path.clear();
+        path = shared_path;
+    }
+
+  private:
+    std::string shared_path, local_path;
+    std::map<std::string, std::string> files;
+    std::vector<std::string> created;
+    bool created_dir = false;
+    MPI_Comm node_comm;
+    int rank, node_rank;
+};
+
+#endif
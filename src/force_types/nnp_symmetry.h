@@ -0,0 +1,1069 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef NNP_SYMMETRY_H
+#define NNP_SYMMETRY_H
+
+#include <CabanaMD_config.hpp>
+
+#include <Cabana_Core.hpp>
+#include <Kokkos_Core.hpp>
+
+#include <neighbor_cell.h>
+#include <nnp_model.h>
+#include <output.h>
+#include <types.h>
+
+#include <algorithm>
+#include <cmath>
+#include <istream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Cutoff functions, by their n2p2 settings code
+enum
+{
+    NNP_CT_HARD,
+    NNP_CT_COS,
+    NNP_CT_TANHU,
+    NNP_CT_TANH,
+    NNP_CT_EXP,
+    NNP_CT_POLY1,
+    NNP_CT_POLY2
+};
+
+// Radial (n2p2 type 2) and angular (type 3) symmetry functions and their
+// forces, evaluated in-tree instead of by nnp::ModeCabana. Functions of an
+// element are sorted as in n2p2 (radial first), scaled as configured in
+// input.nn, and written to the G columns the networks read.
+//
+// The radial pass can keep the scaled dG/dr of every neighbor pair so the
+// force pass only reads them back; the cache is used while it fits in
+// cache_bytes and recomputed otherwise. Half lists are supported: radial
+// terms are added to both atoms of a pair, angular terms use a short full
+// list built from the half list.
+template <class t_device>
+class NNPSymmetry
+{
+    using exe_space = typename t_device::execution_space;
+    using mem_space = typename t_device::memory_space;
+
+  public:
+    using t_param = Kokkos::View<double *, mem_space>;
+    using t_element = Kokkos::View<int *, mem_space>;
+    using t_scaling = Kokkos::View<double **, Kokkos::LayoutRight, mem_space>;
+    using t_cache =
+        Kokkos::View<T_NNP_FLOAT **, Kokkos::LayoutRight, mem_space>;
+
+    // Functions of element e: radial [rad_begin(e), rad_begin(e + 1)) in
+    // columns 0..., angular [ang_begin(e), ang_begin(e + 1)) after them
+    t_element rad_begin, rad_e1;
+    t_param rad_eta, rad_rs, rad_rc;
+    t_element ang_begin, ang_e1, ang_e2;
+    t_param ang_eta, ang_rs, ang_rc, ang_lambda, ang_zeta;
+
+    // Scaled G = shift + factor * G, per element and column
+    t_scaling factor, shift;
+
+    std::vector<int> num_radial, widths;
+    int cutoff_type = NNP_CT_COS;
+    double cutoff_alpha = 0.0;
+    double max_cutoff = 0.0;
+
+    // Positions to model length units, model to CabanaMD force units
+    double length = 1.0;
+    double force_unit = 1.0;
+
+    // Radial dG/dr per neighbor pair (in list order)
+    std::size_t cache_bytes = 0;
+    bool cached = false;
+    t_cache dGdr;
+    Kokkos::View<std::size_t *, mem_space> pair_offset;
+
+    // Full list within the cutoff, built from a half list
+    CellNeighborList<mem_space> short_list;
+
+    // From input.nn and scaling.data; elements in n2p2 order. cflength and
+    // cfenergy convert CabanaMD to model units, as in the n2p2 interfaces.
+    void load( const NNPModel &model, const std::vector<std::string> &elements,
+               const double cflength, const double cfenergy )
+    {
+        std::istringstream settings( model.file( "input.nn" ) );
+        std::vector<std::vector<Function>> functions( elements.size() );
+        int scaling = read_settings( settings, elements, functions );
+        int num_elements = elements.size();
+
+        length = cflength * conv_length;
+        force_unit = length / ( cfenergy * conv_energy );
+
+        num_radial.assign( num_elements, 0 );
+        widths.assign( num_elements, 0 );
+        std::vector<int> h_rad_begin( num_elements + 1, 0 );
+        std::vector<int> h_ang_begin( num_elements + 1, 0 );
+        std::vector<Function> radial, angular;
+        for ( int e = 0; e < num_elements; e++ )
+        {
+            auto &f = functions[e];
+            std::stable_sort( f.begin(), f.end() );
+            for ( auto &sf : f )
+            {
+                if ( sf.type == 2 )
+                    radial.push_back( sf );
+                else
+                    angular.push_back( sf );
+                max_cutoff = std::max( max_cutoff, sf.rc );
+            }
+            widths[e] = f.size();
+            num_radial[e] =
+                std::count_if( f.begin(), f.end(), []( const Function &sf ) {
+                    return sf.type == 2;
+                } );
+            h_rad_begin[e + 1] = radial.size();
+            h_ang_begin[e + 1] = angular.size();
+        }
+        max_cutoff /= length;
+
+        copy( rad_begin, h_rad_begin );
+        copy( ang_begin, h_ang_begin );
+        copy_params( radial, rad_eta, rad_rs, rad_rc, rad_e1 );
+        copy_params( angular, ang_eta, ang_rs, ang_rc, ang_e1 );
+        std::vector<double> lambda, zeta;
+        std::vector<int> e2;
+        for ( auto &sf : angular )
+        {
+            lambda.push_back( sf.lambda );
+            zeta.push_back( sf.zeta );
+            e2.push_back( sf.e2 );
+        }
+        copy( ang_lambda, lambda );
+        copy( ang_zeta, zeta );
+        copy( ang_e2, e2 );
+
+        std::istringstream statistics( model.file( "scaling.data" ) );
+        read_scaling( statistics, scaling );
+    }
+
+    // Scaled symmetry functions of the local atoms. A half list is
+    // splatted to both atoms (radial) and expanded to a short full list
+    // (angular).
+    template <class t_x, class t_type, class t_G, class t_list>
+    void compute_G( const t_x x, const t_type type, t_G G,
+                    const t_list &neigh_list, const T_INT N_local,
+                    const bool half )
+    {
+        int max_radial = *std::max_element( num_radial.begin(),
+                                            num_radial.end() );
+        cached = reserve_cache( neigh_list, N_local,
+                                half ? 2 * max_radial : max_radial );
+
+        auto rad_begin_copy = rad_begin;
+        auto ang_begin_copy = ang_begin;
+        Kokkos::parallel_for(
+            "NNPSymmetry::zero", Kokkos::RangePolicy<exe_space>( 0, N_local ),
+            KOKKOS_LAMBDA( const int i ) {
+                const int ei = type( i );
+                const int width = rad_begin_copy( ei + 1 ) -
+                                  rad_begin_copy( ei ) +
+                                  ang_begin_copy( ei + 1 ) -
+                                  ang_begin_copy( ei );
+                for ( int k = 0; k < width; k++ )
+                    G( i, k ) = 0.0;
+            } );
+
+        radial_G( x, type, G, neigh_list, N_local, half, max_radial );
+        if ( half )
+        {
+            build_short( x, neigh_list, N_local );
+            angular_G( x, type, G, short_list, N_local );
+        }
+        else
+            angular_G( x, type, G, neigh_list, N_local );
+
+        auto factor_copy = factor;
+        auto shift_copy = shift;
+        Kokkos::parallel_for(
+            "NNPSymmetry::scale", Kokkos::RangePolicy<exe_space>( 0, N_local ),
+            KOKKOS_LAMBDA( const int i ) {
+                const int ei = type( i );
+                const int width = rad_begin_copy( ei + 1 ) -
+                                  rad_begin_copy( ei ) +
+                                  ang_begin_copy( ei + 1 ) -
+                                  ang_begin_copy( ei );
+                for ( int k = 0; k < width; k++ )
+                    G( i, k ) =
+                        shift_copy( ei, k ) + factor_copy( ei, k ) * G( i, k );
+            } );
+        Kokkos::fence();
+    }
+
+    // Forces -dE/dx from dE/dG, with the list of the last compute_G
+    template <class t_x, class t_f, class t_type, class t_dEdG,
+              class t_list>
+    void compute_forces( const t_x x, t_f f, const t_type type,
+                         const t_dEdG dEdG, const t_list &neigh_list,
+                         const T_INT N_local, const bool half )
+    {
+        int max_radial = *std::max_element( num_radial.begin(),
+                                            num_radial.end() );
+        radial_forces( x, f, type, dEdG, neigh_list, N_local, half,
+                       max_radial );
+        if ( half )
+            angular_forces( x, f, type, dEdG, short_list, N_local );
+        else
+            angular_forces( x, f, type, dEdG, neigh_list, N_local );
+        Kokkos::fence();
+    }
+
+    // Radial terms of every pair of the list; a half list adds each pair
+    // to both atoms if both are local. Cached dG/dr of atom i are in
+    // columns [0, max_radial), those of j after them.
+    template <class t_x, class t_type, class t_G, class t_list>
+    void radial_G( const t_x x, const t_type type, t_G G,
+                   const t_list &neigh_list, const T_INT N_local,
+                   const bool half, const int max_radial )
+    {
+        using t_traits = Cabana::NeighborList<t_list>;
+        auto rad_begin_copy = rad_begin;
+        auto rad_e1_copy = rad_e1;
+        auto rad_eta_copy = rad_eta;
+        auto rad_rs_copy = rad_rs;
+        auto rad_rc_copy = rad_rc;
+        auto factor_copy = factor;
+        auto dGdr_copy = dGdr;
+        auto pair_offset_copy = pair_offset;
+        const bool use_cache = cached;
+        const int ct = cutoff_type;
+        const double alpha = cutoff_alpha;
+        const double conv = length;
+        const double cutsq = max_cutoff * max_cutoff;
+
+        Kokkos::parallel_for(
+            "NNPSymmetry::radial_G",
+            Kokkos::RangePolicy<exe_space>( 0, N_local ),
+            KOKKOS_LAMBDA( const int i ) {
+                const int ei = type( i );
+                const int rbi = rad_begin_copy( ei );
+                const int nri = rad_begin_copy( ei + 1 ) - rbi;
+                const int num_neigh = t_traits::numNeighbor( neigh_list, i );
+                for ( int jj = 0; jj < num_neigh; jj++ )
+                {
+                    const int j = t_traits::getNeighbor( neigh_list, i, jj );
+                    double rij = 0.0;
+                    for ( int d = 0; d < 3; d++ )
+                        rij += ( x( j, d ) - x( i, d ) ) *
+                               ( x( j, d ) - x( i, d ) );
+                    if ( rij >= cutsq )
+                        continue;
+                    rij = sqrt( rij ) * conv;
+                    const int ej = type( j );
+                    const std::size_t p =
+                        use_cache ? pair_offset_copy( i ) + jj : 0;
+
+                    for ( int k = 0; k < nri; k++ )
+                    {
+                        const int s = rbi + k;
+                        double g = 0.0;
+                        double dg = 0.0;
+                        if ( rad_e1_copy( s ) == ej && rij < rad_rc_copy( s ) )
+                            radial( ct, alpha, rad_eta_copy( s ),
+                                    rad_rs_copy( s ), rad_rc_copy( s ), rij, g,
+                                    dg );
+                        G( i, k ) += g;
+                        if ( use_cache )
+                            dGdr_copy( p, k ) = factor_copy( ei, k ) * dg / rij;
+                    }
+                    if ( !half || j >= N_local )
+                        continue;
+
+                    const int rbj = rad_begin_copy( ej );
+                    const int nrj = rad_begin_copy( ej + 1 ) - rbj;
+                    for ( int k = 0; k < nrj; k++ )
+                    {
+                        const int s = rbj + k;
+                        double g = 0.0;
+                        double dg = 0.0;
+                        if ( rad_e1_copy( s ) == ei && rij < rad_rc_copy( s ) )
+                            radial( ct, alpha, rad_eta_copy( s ),
+                                    rad_rs_copy( s ), rad_rc_copy( s ), rij, g,
+                                    dg );
+                        G( j, k ) += g;
+                        if ( use_cache )
+                            dGdr_copy( p, max_radial + k ) =
+                                factor_copy( ej, k ) * dg / rij;
+                    }
+                }
+            } );
+    }
+
+    // Angular terms of atom i over pairs of its (full) neighbor list
+    template <class t_x, class t_type, class t_G, class t_list>
+    void angular_G( const t_x x, const t_type type, t_G G,
+                    const t_list &neigh_list, const T_INT N_local )
+    {
+        using t_traits = Cabana::NeighborList<t_list>;
+        auto rad_begin_copy = rad_begin;
+        auto ang_begin_copy = ang_begin;
+        auto ang_e1_copy = ang_e1;
+        auto ang_e2_copy = ang_e2;
+        auto ang_eta_copy = ang_eta;
+        auto ang_rs_copy = ang_rs;
+        auto ang_rc_copy = ang_rc;
+        auto ang_lambda_copy = ang_lambda;
+        auto ang_zeta_copy = ang_zeta;
+        const int ct = cutoff_type;
+        const double alpha = cutoff_alpha;
+        const double conv = length;
+        const double cutsq = max_cutoff * max_cutoff;
+
+        Kokkos::parallel_for(
+            "NNPSymmetry::angular_G",
+            Kokkos::RangePolicy<exe_space>( 0, N_local ),
+            KOKKOS_LAMBDA( const int i ) {
+                const int ei = type( i );
+                const int nr = rad_begin_copy( ei + 1 ) - rad_begin_copy( ei );
+                const int ab = ang_begin_copy( ei );
+                const int na = ang_begin_copy( ei + 1 ) - ab;
+                if ( na == 0 )
+                    return;
+                const int num_neigh = t_traits::numNeighbor( neigh_list, i );
+                for ( int jj = 0; jj < num_neigh; jj++ )
+                {
+                    const int j = t_traits::getNeighbor( neigh_list, i, jj );
+                    double a[3];
+                    double rij = 0.0;
+                    for ( int d = 0; d < 3; d++ )
+                    {
+                        a[d] = x( j, d ) - x( i, d );
+                        rij += a[d] * a[d];
+                    }
+                    if ( rij >= cutsq )
+                        continue;
+                    rij = sqrt( rij ) * conv;
+                    const int ej = type( j );
+
+                    for ( int kk = jj + 1; kk < num_neigh; kk++ )
+                    {
+                        const int k =
+                            t_traits::getNeighbor( neigh_list, i, kk );
+                        double b[3], c[3];
+                        double rik = 0.0;
+                        double rjk = 0.0;
+                        for ( int d = 0; d < 3; d++ )
+                        {
+                            b[d] = x( k, d ) - x( i, d );
+                            c[d] = x( k, d ) - x( j, d );
+                            rik += b[d] * b[d];
+                            rjk += c[d] * c[d];
+                        }
+                        if ( rik >= cutsq || rjk >= cutsq )
+                            continue;
+                        rik = sqrt( rik ) * conv;
+                        rjk = sqrt( rjk ) * conv;
+                        const double cos_ijk =
+                            conv * conv *
+                            ( a[0] * b[0] + a[1] * b[1] + a[2] * b[2] ) /
+                            ( rij * rik );
+                        const int ek = type( k );
+                        for ( int m = 0; m < na; m++ )
+                        {
+                            const int s = ab + m;
+                            if ( !pair_matches( ang_e1_copy( s ),
+                                                ang_e2_copy( s ), ej, ek ) )
+                                continue;
+                            Triplet t;
+                            if ( angular( ct, alpha, ang_eta_copy( s ),
+                                          ang_rs_copy( s ), ang_rc_copy( s ),
+                                          ang_lambda_copy( s ),
+                                          ang_zeta_copy( s ), rij, rik, rjk,
+                                          cos_ijk, t ) )
+                                G( i, nr + m ) += t.value;
+                        }
+                    }
+                }
+            } );
+    }
+
+    // Radial forces of every pair of the list (from E_i, and from E_j for
+    // a half list with both atoms local)
+    template <class t_x, class t_f, class t_type, class t_dEdG,
+              class t_list>
+    void radial_forces( const t_x x, t_f f, const t_type type,
+                        const t_dEdG dEdG, const t_list &neigh_list,
+                        const T_INT N_local, const bool half,
+                        const int max_radial )
+    {
+        using t_traits = Cabana::NeighborList<t_list>;
+        auto rad_begin_copy = rad_begin;
+        auto rad_e1_copy = rad_e1;
+        auto rad_eta_copy = rad_eta;
+        auto rad_rs_copy = rad_rs;
+        auto rad_rc_copy = rad_rc;
+        auto factor_copy = factor;
+        auto dGdr_copy = dGdr;
+        auto pair_offset_copy = pair_offset;
+        const bool use_cache = cached;
+        const int ct = cutoff_type;
+        const double alpha = cutoff_alpha;
+        const double conv = length;
+        const double conv_force = force_unit;
+        const double cutsq = max_cutoff * max_cutoff;
+
+        Kokkos::parallel_for(
+            "NNPSymmetry::radial_forces",
+            Kokkos::RangePolicy<exe_space>( 0, N_local ),
+            KOKKOS_LAMBDA( const int i ) {
+                const int ei = type( i );
+                const int rbi = rad_begin_copy( ei );
+                const int nri = rad_begin_copy( ei + 1 ) - rbi;
+                double fi[3] = {0.0, 0.0, 0.0};
+                const int num_neigh = t_traits::numNeighbor( neigh_list, i );
+                for ( int jj = 0; jj < num_neigh; jj++ )
+                {
+                    const int j = t_traits::getNeighbor( neigh_list, i, jj );
+                    double a[3];
+                    double rij = 0.0;
+                    for ( int d = 0; d < 3; d++ )
+                    {
+                        a[d] = x( j, d ) - x( i, d );
+                        rij += a[d] * a[d];
+                    }
+                    if ( rij >= cutsq )
+                        continue;
+                    rij = sqrt( rij ) * conv;
+                    const int ej = type( j );
+                    const std::size_t p =
+                        use_cache ? pair_offset_copy( i ) + jj : 0;
+
+                    // dE/dr / r along a = x_j - x_i, from E_i and E_j
+                    double t = 0.0;
+                    for ( int k = 0; k < nri; k++ )
+                    {
+                        const int s = rbi + k;
+                        double dgr = 0.0;
+                        if ( use_cache )
+                            dgr = dGdr_copy( p, k );
+                        else if ( rad_e1_copy( s ) == ej &&
+                                  rij < rad_rc_copy( s ) )
+                        {
+                            double g, dg;
+                            radial( ct, alpha, rad_eta_copy( s ),
+                                    rad_rs_copy( s ), rad_rc_copy( s ), rij, g,
+                                    dg );
+                            dgr = factor_copy( ei, k ) * dg / rij;
+                        }
+                        t += dEdG( i, k ) * dgr;
+                    }
+                    if ( half && j < N_local )
+                    {
+                        const int rbj = rad_begin_copy( ej );
+                        const int nrj = rad_begin_copy( ej + 1 ) - rbj;
+                        for ( int k = 0; k < nrj; k++ )
+                        {
+                            const int s = rbj + k;
+                            double dgr = 0.0;
+                            if ( use_cache )
+                                dgr = dGdr_copy( p, max_radial + k );
+                            else if ( rad_e1_copy( s ) == ei &&
+                                      rij < rad_rc_copy( s ) )
+                            {
+                                double g, dg;
+                                radial( ct, alpha, rad_eta_copy( s ),
+                                        rad_rs_copy( s ), rad_rc_copy( s ),
+                                        rij, g, dg );
+                                dgr = factor_copy( ej, k ) * dg / rij;
+                            }
+                            t += dEdG( j, k ) * dgr;
+                        }
+                    }
+                    t *= conv * conv_force;
+                    for ( int d = 0; d < 3; d++ )
+                    {
+                        fi[d] += t * a[d];
+                        f( j, d ) -= t * a[d];
+                    }
+                }
+                for ( int d = 0; d < 3; d++ )
+                    f( i, d ) += fi[d];
+            } );
+    }
+
+    // Angular forces from E_i over pairs of its (full) neighbor list
+    template <class t_x, class t_f, class t_type, class t_dEdG,
+              class t_list>
+    void angular_forces( const t_x x, t_f f, const t_type type,
+                         const t_dEdG dEdG, const t_list &neigh_list,
+                         const T_INT N_local )
+    {
+        using t_traits = Cabana::NeighborList<t_list>;
+        auto rad_begin_copy = rad_begin;
+        auto ang_begin_copy = ang_begin;
+        auto ang_e1_copy = ang_e1;
+        auto ang_e2_copy = ang_e2;
+        auto ang_eta_copy = ang_eta;
+        auto ang_rs_copy = ang_rs;
+        auto ang_rc_copy = ang_rc;
+        auto ang_lambda_copy = ang_lambda;
+        auto ang_zeta_copy = ang_zeta;
+        auto factor_copy = factor;
+        const int ct = cutoff_type;
+        const double alpha = cutoff_alpha;
+        const double conv = length;
+        const double conv_force = force_unit;
+        const double cutsq = max_cutoff * max_cutoff;
+
+        Kokkos::parallel_for(
+            "NNPSymmetry::angular_forces",
+            Kokkos::RangePolicy<exe_space>( 0, N_local ),
+            KOKKOS_LAMBDA( const int i ) {
+                const int ei = type( i );
+                const int nr = rad_begin_copy( ei + 1 ) - rad_begin_copy( ei );
+                const int ab = ang_begin_copy( ei );
+                const int na = ang_begin_copy( ei + 1 ) - ab;
+                if ( na == 0 )
+                    return;
+                double fi[3] = {0.0, 0.0, 0.0};
+                const int num_neigh = t_traits::numNeighbor( neigh_list, i );
+                for ( int jj = 0; jj < num_neigh; jj++ )
+                {
+                    const int j = t_traits::getNeighbor( neigh_list, i, jj );
+                    double a[3];
+                    double rij = 0.0;
+                    for ( int d = 0; d < 3; d++ )
+                    {
+                        a[d] = x( j, d ) - x( i, d );
+                        rij += a[d] * a[d];
+                    }
+                    if ( rij >= cutsq )
+                        continue;
+                    rij = sqrt( rij ) * conv;
+                    const int ej = type( j );
+
+                    for ( int kk = jj + 1; kk < num_neigh; kk++ )
+                    {
+                        const int k =
+                            t_traits::getNeighbor( neigh_list, i, kk );
+                        double b[3], c[3];
+                        double rik = 0.0;
+                        double rjk = 0.0;
+                        for ( int d = 0; d < 3; d++ )
+                        {
+                            b[d] = x( k, d ) - x( i, d );
+                            c[d] = x( k, d ) - x( j, d );
+                            rik += b[d] * b[d];
+                            rjk += c[d] * c[d];
+                        }
+                        if ( rik >= cutsq || rjk >= cutsq )
+                            continue;
+                        rik = sqrt( rik ) * conv;
+                        rjk = sqrt( rjk ) * conv;
+                        const double cos_ijk =
+                            conv * conv *
+                            ( a[0] * b[0] + a[1] * b[1] + a[2] * b[2] ) /
+                            ( rij * rik );
+                        const int ek = type( k );
+
+                        // Coefficients of the gradients of E_i along a, b
+                        // and c (model units)
+                        double ccos = 0.0;
+                        double ca = 0.0;
+                        double cb = 0.0;
+                        double cc = 0.0;
+                        for ( int m = 0; m < na; m++ )
+                        {
+                            const int s = ab + m;
+                            if ( !pair_matches( ang_e1_copy( s ),
+                                                ang_e2_copy( s ), ej, ek ) )
+                                continue;
+                            Triplet tr;
+                            if ( !angular( ct, alpha, ang_eta_copy( s ),
+                                           ang_rs_copy( s ), ang_rc_copy( s ),
+                                           ang_lambda_copy( s ),
+                                           ang_zeta_copy( s ), rij, rik, rjk,
+                                           cos_ijk, tr ) )
+                                continue;
+                            const double w =
+                                dEdG( i, nr + m ) * factor_copy( ei, nr + m );
+                            ccos += w * tr.d_cos;
+                            ca += w * tr.d_rij / rij;
+                            cb += w * tr.d_rik / rik;
+                            cc += w * tr.d_rjk / rjk;
+                        }
+                        if ( ccos == 0.0 && ca == 0.0 && cb == 0.0 &&
+                             cc == 0.0 )
+                            continue;
+                        const double inv = 1.0 / ( rij * rik );
+                        for ( int d = 0; d < 3; d++ )
+                        {
+                            // d cos / d a = b / ( rij rik ) - cos a / rij^2
+                            const double am = a[d] * conv;
+                            const double bm = b[d] * conv;
+                            const double cm = c[d] * conv;
+                            const double gj =
+                                conv_force *
+                                ( ccos * ( bm * inv -
+                                           cos_ijk * am / ( rij * rij ) ) +
+                                  ca * am - cc * cm );
+                            const double gk =
+                                conv_force *
+                                ( ccos * ( am * inv -
+                                           cos_ijk * bm / ( rik * rik ) ) +
+                                  cb * bm + cc * cm );
+                            f( j, d ) -= gj;
+                            f( k, d ) -= gk;
+                            fi[d] += gj + gk;
+                        }
+                    }
+                }
+                for ( int d = 0; d < 3; d++ )
+                    f( i, d ) += fi[d];
+            } );
+    }
+
+    // Full list of the local atoms within the cutoff from a half list:
+    // each pair is added to both atoms if both are local
+    template <class t_x, class t_list>
+    void build_short( const t_x x, const t_list &neigh_list,
+                      const T_INT N_local )
+    {
+        using t_traits = Cabana::NeighborList<t_list>;
+        if ( short_list.counts.extent( 0 ) < (std::size_t)N_local )
+        {
+            Kokkos::realloc( short_list.counts, N_local * 1.1 );
+            Kokkos::realloc( short_list.offsets, N_local * 1.1 );
+        }
+        auto counts = short_list.counts;
+        auto offsets = short_list.offsets;
+        const double cutsq = max_cutoff * max_cutoff;
+        auto within = KOKKOS_LAMBDA( const int i, const int j )
+        {
+            double rsq = 0.0;
+            for ( int d = 0; d < 3; d++ )
+                rsq += ( x( j, d ) - x( i, d ) ) * ( x( j, d ) - x( i, d ) );
+            return rsq < cutsq;
+        };
+
+        Kokkos::deep_copy( counts, 0 );
+        Kokkos::parallel_for(
+            "NNPSymmetry::count_short",
+            Kokkos::RangePolicy<exe_space>( 0, N_local ),
+            KOKKOS_LAMBDA( const int i ) {
+                const int num_neigh = t_traits::numNeighbor( neigh_list, i );
+                for ( int jj = 0; jj < num_neigh; jj++ )
+                {
+                    const int j = t_traits::getNeighbor( neigh_list, i, jj );
+                    if ( !within( i, j ) )
+                        continue;
+                    Kokkos::atomic_increment( &counts( i ) );
+                    if ( j < N_local )
+                        Kokkos::atomic_increment( &counts( j ) );
+                }
+            } );
+        T_INT total = 0;
+        T_INT max_count = 0;
+        Kokkos::parallel_scan(
+            "NNPSymmetry::offset_short",
+            Kokkos::RangePolicy<exe_space>( 0, N_local ),
+            KOKKOS_LAMBDA( const int i, T_INT &offset, const bool final ) {
+                if ( final )
+                    offsets( i ) = offset;
+                offset += counts( i );
+            },
+            total );
+        Kokkos::parallel_reduce(
+            "NNPSymmetry::max_short",
+            Kokkos::RangePolicy<exe_space>( 0, N_local ),
+            KOKKOS_LAMBDA( const int i, T_INT &m ) {
+                if ( counts( i ) > m )
+                    m = counts( i );
+            },
+            Kokkos::Max<T_INT>( max_count ) );
+        short_list.max_neighbors = max_count;
+        if ( short_list.neighbors.extent( 0 ) < (std::size_t)total )
+            Kokkos::realloc( short_list.neighbors, total * 1.1 );
+        auto neighbors = short_list.neighbors;
+
+        Kokkos::deep_copy( counts, 0 );
+        Kokkos::parallel_for(
+            "NNPSymmetry::fill_short",
+            Kokkos::RangePolicy<exe_space>( 0, N_local ),
+            KOKKOS_LAMBDA( const int i ) {
+                const int num_neigh = t_traits::numNeighbor( neigh_list, i );
+                for ( int jj = 0; jj < num_neigh; jj++ )
+                {
+                    const int j = t_traits::getNeighbor( neigh_list, i, jj );
+                    if ( !within( i, j ) )
+                        continue;
+                    T_INT n = Kokkos::atomic_fetch_add( &counts( i ), 1 );
+                    neighbors( offsets( i ) + n ) = j;
+                    if ( j < N_local )
+                    {
+                        n = Kokkos::atomic_fetch_add( &counts( j ), 1 );
+                        neighbors( offsets( j ) + n ) = i;
+                    }
+                }
+            } );
+    }
+
+    // Parameters of one symmetry function from input.nn
+    struct Function
+    {
+        int type;
+        int e1, e2;
+        double eta, rs, rc, lambda, zeta;
+
+        // n2p2 order: type, cutoff, eta, then the shape and neighbor
+        // elements
+        bool operator<( const Function &other ) const
+        {
+            return std::tie( type, rc, eta, zeta, lambda, rs, e1, e2 ) <
+                   std::tie( other.type, other.rc, other.eta, other.zeta,
+                             other.lambda, other.rs, other.e1, other.e2 );
+        }
+    };
+
+    // Value and explicit derivatives of one angular term
+    struct Triplet
+    {
+        double value, d_cos, d_rij, d_rik, d_rjk;
+    };
+
+    KOKKOS_INLINE_FUNCTION
+    static void cutoff( const int ct, const double alpha, const double r,
+                        const double rc, double &fc, double &dfc )
+    {
+        fc = 1.0;
+        dfc = 0.0;
+        const double rci = alpha * rc;
+        if ( ct == NNP_CT_TANHU || ct == NNP_CT_TANH )
+        {
+            const double th = tanh( 1.0 - r / rc );
+            const double norm = ct == NNP_CT_TANH ? 1.0 / pow( tanh( 1.0 ), 3 )
+                                                  : 1.0;
+            fc = norm * th * th * th;
+            dfc = -3.0 * norm * th * th * ( 1.0 - th * th ) / rc;
+        }
+        else if ( ct != NNP_CT_HARD && r > rci )
+        {
+            const double x = ( r - rci ) / ( rc - rci );
+            const double dx = 1.0 / ( rc - rci );
+            if ( ct == NNP_CT_COS )
+            {
+                fc = 0.5 * ( cos( M_PI * x ) + 1.0 );
+                dfc = -0.5 * M_PI * sin( M_PI * x ) * dx;
+            }
+            else if ( ct == NNP_CT_EXP )
+            {
+                const double y = 1.0 - x * x;
+                fc = exp( 1.0 - 1.0 / y );
+                dfc = -2.0 * x / ( y * y ) * fc * dx;
+            }
+            else if ( ct == NNP_CT_POLY1 )
+            {
+                fc = ( 2.0 * x - 3.0 ) * x * x + 1.0;
+                dfc = 6.0 * x * ( x - 1.0 ) * dx;
+            }
+            else if ( ct == NNP_CT_POLY2 )
+            {
+                fc = ( ( 15.0 - 6.0 * x ) * x - 10.0 ) * x * x * x + 1.0;
+                dfc = -30.0 * x * x * ( x - 1.0 ) * ( x - 1.0 ) * dx;
+            }
+        }
+    }
+
+    // exp( -eta ( r - rs )^2 ) fc( r ) and its derivative
+    KOKKOS_INLINE_FUNCTION
+    static void radial( const int ct, const double alpha, const double eta,
+                        const double rs, const double rc, const double r,
+                        double &g, double &dg )
+    {
+        double fc, dfc;
+        cutoff( ct, alpha, r, rc, fc, dfc );
+        const double e = exp( -eta * ( r - rs ) * ( r - rs ) );
+        g = e * fc;
+        dg = e * ( dfc - 2.0 * eta * ( r - rs ) * fc );
+    }
+
+    // 2^(1 - zeta) ( 1 + lambda cos )^zeta exp( -eta sum ( r - rs )^2 )
+    // fc( rij ) fc( rik ) fc( rjk ); false outside the cutoff
+    KOKKOS_INLINE_FUNCTION
+    static bool angular( const int ct, const double alpha, const double eta,
+                         const double rs, const double rc,
+                         const double lambda, const double zeta,
+                         const double rij, const double rik, const double rjk,
+                         const double cos_ijk, Triplet &t )
+    {
+        if ( rij >= rc || rik >= rc || rjk >= rc )
+            return false;
+        const double p = 1.0 + lambda * cos_ijk;
+        if ( p <= 0.0 )
+            return false;
+        double fij, dfij, fik, dfik, fjk, dfjk;
+        cutoff( ct, alpha, rij, rc, fij, dfij );
+        cutoff( ct, alpha, rik, rc, fik, dfik );
+        cutoff( ct, alpha, rjk, rc, fjk, dfjk );
+        const double fc = fij * fik * fjk;
+        const double pz = pow( p, zeta - 1.0 );
+        const double e =
+            pow( 2.0, 1.0 - zeta ) *
+            exp( -eta * ( ( rij - rs ) * ( rij - rs ) +
+                          ( rik - rs ) * ( rik - rs ) +
+                          ( rjk - rs ) * ( rjk - rs ) ) );
+        const double ep = e * pz * p;
+        t.value = ep * fc;
+        t.d_cos = e * zeta * lambda * pz * fc;
+        t.d_rij = ep * ( dfij * fik * fjk - 2.0 * eta * ( rij - rs ) * fc );
+        t.d_rik = ep * ( fij * dfik * fjk - 2.0 * eta * ( rik - rs ) * fc );
+        t.d_rjk = ep * ( fij * fik * dfjk - 2.0 * eta * ( rjk - rs ) * fc );
+        return true;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static bool pair_matches( const int e1, const int e2, const int ej,
+                              const int ek )
+    {
+        return ( e1 == ej && e2 == ek ) || ( e1 == ek && e2 == ej );
+    }
+
+  private:
+    // Scaling, by the n2p2 input.nn keywords
+    enum
+    {
+        SCALE_NONE,
+        SCALE_MINMAX,
+        SCALE_CENTER,
+        SCALE_MINMAX_CENTER,
+        SCALE_SIGMA
+    };
+    double scale_min = 0.0;
+    double scale_max = 1.0;
+
+    // Normalization of input.nn
+    double conv_length = 1.0;
+    double conv_energy = 1.0;
+
+    // Symmetry functions, cutoff and scaling of input.nn; returns the
+    // scaling type. Functions the in-tree kernels cannot evaluate are
+    // rejected rather than ignored.
+    int read_settings( std::istream &in,
+                       const std::vector<std::string> &elements,
+                       std::vector<std::vector<Function>> &functions )
+    {
+        auto element = [&elements]( const std::string &symbol ) {
+            auto e = std::find( elements.begin(), elements.end(), symbol );
+            if ( e == elements.end() )
+                log_err( std::cout, "NNPSymmetry: unknown element ", symbol );
+            return (int)( e - elements.begin() );
+        };
+
+        bool minmax = false;
+        bool center = false;
+        bool sigma = false;
+        std::string line;
+        while ( std::getline( in, line ) )
+        {
+            std::istringstream words( line.substr( 0, line.find( '#' ) ) );
+            std::string key, word;
+            words >> key;
+            if ( key == "cutoff_type" )
+            {
+                words >> cutoff_type;
+                if ( !( words >> cutoff_alpha ) )
+                    cutoff_alpha = 0.0;
+                if ( cutoff_type < NNP_CT_HARD || cutoff_type > NNP_CT_POLY2 )
+                    log_err( std::cout, "NNPSymmetry: cutoff_type ",
+                             cutoff_type, " is not supported in-tree" );
+            }
+            else if ( key == "scale_symmetry_functions" )
+                minmax = true;
+            else if ( key == "center_symmetry_functions" )
+                center = true;
+            else if ( key == "scale_symmetry_functions_sigma" )
+                sigma = true;
+            else if ( key == "scale_min_short" )
+                words >> scale_min;
+            else if ( key == "scale_max_short" )
+                words >> scale_max;
+            else if ( key == "conv_length" )
+                words >> conv_length;
+            else if ( key == "conv_energy" )
+                words >> conv_energy;
+            else if ( key == "symfunction_short" )
+            {
+                std::string center_element, e1, e2;
+                Function f;
+                words >> center_element >> f.type >> e1;
+                f.e1 = element( e1 );
+                f.e2 = f.e1;
+                f.rs = 0.0;
+                f.lambda = 0.0;
+                f.zeta = 0.0;
+                if ( f.type == 2 )
+                    words >> f.eta >> f.rs >> f.rc;
+                else if ( f.type == 3 )
+                {
+                    words >> e2 >> f.eta >> f.lambda >> f.zeta >> f.rc;
+                    words >> f.rs;
+                    f.e2 = element( e2 );
+                    if ( f.e2 < f.e1 )
+                        std::swap( f.e1, f.e2 );
+                }
+                else
+                    log_err( std::cout, "NNPSymmetry: symmetry function "
+                                        "type ",
+                             f.type, " is not supported in-tree" );
+                functions[element( center_element )].push_back( f );
+            }
+        }
+
+        if ( sigma )
+            return SCALE_SIGMA;
+        if ( minmax && center )
+            return SCALE_MINMAX_CENTER;
+        if ( minmax )
+            return SCALE_MINMAX;
+        if ( center )
+            return SCALE_CENTER;
+        return SCALE_NONE;
+    }
+
+    // scaling.data: element and function (from 1), Gmin, Gmax, Gmean and
+    // Gsigma per line
+    void read_scaling( std::istream &in, const int scaling )
+    {
+        int num_elements = widths.size();
+        int max_width = *std::max_element( widths.begin(), widths.end() );
+        factor = t_scaling( "NNPSymmetry::factor", num_elements, max_width );
+        shift = t_scaling( "NNPSymmetry::shift", num_elements, max_width );
+        auto h_factor = Kokkos::create_mirror_view( factor );
+        auto h_shift = Kokkos::create_mirror_view( shift );
+        for ( int e = 0; e < num_elements; e++ )
+            for ( int k = 0; k < max_width; k++ )
+            {
+                h_factor( e, k ) = 1.0;
+                h_shift( e, k ) = 0.0;
+            }
+
+        std::string line;
+        while ( std::getline( in, line ) )
+        {
+            if ( line.empty() || line[0] == '#' )
+                continue;
+            std::istringstream words( line );
+            int e, k;
+            double g_min, g_max, g_mean, g_sigma = 0.0;
+            if ( !( words >> e >> k >> g_min >> g_max >> g_mean ) )
+                continue;
+            words >> g_sigma;
+            e--;
+            k--;
+            if ( e < 0 || e >= num_elements || k < 0 || k >= widths[e] )
+                log_err( std::cout, "NNPSymmetry: scaling.data does not "
+                                    "match the symmetry functions" );
+            double s = 1.0;
+            double offset = 0.0;
+            if ( scaling == SCALE_MINMAX )
+            {
+                s = ( scale_max - scale_min ) / ( g_max - g_min );
+                offset = scale_min - s * g_min;
+            }
+            else if ( scaling == SCALE_CENTER )
+                offset = -g_mean;
+            else if ( scaling == SCALE_MINMAX_CENTER )
+            {
+                s = ( scale_max - scale_min ) / ( g_max - g_min );
+                offset = scale_min - s * g_mean;
+            }
+            else if ( scaling == SCALE_SIGMA )
+            {
+                s = ( scale_max - scale_min ) / g_sigma;
+                offset = scale_min - s * g_mean;
+            }
+            h_factor( e, k ) = s;
+            h_shift( e, k ) = offset;
+        }
+        Kokkos::deep_copy( factor, h_factor );
+        Kokkos::deep_copy( shift, h_shift );
+    }
+
+    // Pair offsets of the list, and room for max_radial values per pair if
+    // the cache fits in cache_bytes
+    template <class t_list>
+    bool reserve_cache( const t_list &neigh_list, const T_INT N_local,
+                        const int max_radial )
+    {
+        if ( cache_bytes == 0 || max_radial == 0 )
+            return false;
+
+        using t_traits = Cabana::NeighborList<t_list>;
+        if ( pair_offset.extent( 0 ) < (std::size_t)N_local )
+            Kokkos::realloc( pair_offset, N_local * 1.1 );
+        auto pair_offset_copy = pair_offset;
+        std::size_t num_pairs = 0;
+        Kokkos::parallel_scan(
+            "NNPSymmetry::pair_offset",
+            Kokkos::RangePolicy<exe_space>( 0, N_local ),
+            KOKKOS_LAMBDA( const int i, std::size_t &offset,
+                           const bool final ) {
+                if ( final )
+                    pair_offset_copy( i ) = offset;
+                offset += t_traits::numNeighbor( neigh_list, i );
+            },
+            num_pairs );
+
+        if ( num_pairs * max_radial * sizeof( T_NNP_FLOAT ) > cache_bytes )
+            return false;
+        if ( dGdr.extent( 0 ) < num_pairs ||
+             dGdr.extent( 1 ) < (std::size_t)max_radial )
+        {
+            std::size_t size = std::min<std::size_t>(
+                num_pairs * 1.1, cache_bytes / sizeof( T_NNP_FLOAT ) /
+                                     max_radial );
+            dGdr = t_cache();
+            dGdr = t_cache( Kokkos::ViewAllocateWithoutInitializing(
+                                "NNPSymmetry::dGdr" ),
+                            size, max_radial );
+        }
+        return true;
+    }
+
+    template <class t_view, class t_value>
+    static void copy( t_view &view, const std::vector<t_value> &values )
+    {
+        view = t_view( "NNPSymmetry::param", values.size() );
+        auto h_view = Kokkos::create_mirror_view( view );
+        for ( std::size_t n = 0; n < values.size(); n++ )
+            h_view( n ) = values[n];
+        Kokkos::deep_copy( view, h_view );
+    }
+
+    static void copy_params( const std::vector<Function> &functions,
+                             t_param &eta, t_param &rs, t_param &rc,
+                             t_element &e1 )
+    {
+        std::vector<double> h_eta, h_rs, h_rc;
+        std::vector<int> h_e1;
+        for ( auto &f : functions )
+        {
+            h_eta.push_back( f.eta );
+            h_rs.push_back( f.rs );
+            h_rc.push_back( f.rc );
+            h_e1.push_back( f.e1 );
+        }
+        copy( eta, h_eta );
+        copy( rs, h_rs );
+        copy( rc, h_rc );
+        copy( e1, h_e1 );
+    }
+};
+
+#endif
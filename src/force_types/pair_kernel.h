@@ -0,0 +1,142 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef PAIR_KERNEL_H
+#define PAIR_KERNEL_H
+
+#include <Cabana_Core.hpp>
+#include <Kokkos_Core.hpp>
+
+#include <types.h>
+
+#include <string>
+#include <type_traits>
+
+// Reduction value for the fused force, energy, and virial pass
+struct PairThermo
+{
+    T_FLOAT energy;
+    T_FLOAT virial[6];
+
+    KOKKOS_INLINE_FUNCTION
+    PairThermo()
+        : energy( 0.0 )
+    {
+        for ( int v = 0; v < 6; v++ )
+            virial[v] = 0.0;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    PairThermo &operator+=( const PairThermo &src )
+    {
+        energy += src.energy;
+        for ( int v = 0; v < 6; v++ )
+            virial[v] += src.virial[v];
+        return *this;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    void operator+=( const volatile PairThermo &src ) volatile
+    {
+        energy += src.energy;
+        for ( int v = 0; v < 6; v++ )
+            virial[v] += src.virial[v];
+    }
+};
+
+// Neighbor list traversals shared by the pair potentials. A potential
+// (t_Potential) is a copyable functor with
+//   static constexpr bool single_type: never read the type slice
+//   T_F_FLOAT cutsq_ij( type_i, type_j ): squared cutoff of a type pair
+//   T_F_FLOAT compute_fpair( rsq, type_i, type_j ): force over distance
+//   T_F_FLOAT compute_energy( rsq, type_i, type_j ): energy of one pair
+// and gets every full/half list force, energy, and thermo traversal. The
+// per atom values handed to the potential come from the type argument,
+// usually the type slice (charges for the real space Coulomb sum).
+// Half lists add the reaction force to the neighbor (ghosts included) and
+// count pairs with a ghost at half weight, since the neighbor rank counts
+// them too. Kernel labels start with the label of the calling force.
+template <class t_System, class t_parallel>
+class PairKernel
+{
+  private:
+    using exe_space = typename t_System::execution_space;
+    using mem_space = typename t_System::memory_space;
+
+    typedef typename t_System::t_x t_x;
+    typedef typename t_System::t_f t_f;
+    typedef typename t_System::t_f::atomic_access_slice t_f_a;
+
+  public:
+    typedef Kokkos::View<T_INT *, mem_space> t_index;
+
+    // TeamVectorOpTag has no first neighbor traversal; those loops run
+    // with TeamOpTag
+    using t_pair_parallel = typename std::conditional<
+        std::is_same<t_parallel, Cabana::TeamVectorOpTag>::value,
+        Cabana::TeamOpTag, t_parallel>::type;
+
+    // Full list forces are assigned with one thread per atom (serial or
+    // restricted to a list of local atoms, num_atoms >= 0) and summed
+    // atomically with team threading
+    template <class t_Potential, class t_neigh, class t_type>
+    static void force_full( const t_Potential potential, t_f f, const t_x x,
+                            const t_type type, const t_neigh neigh_list,
+                            const T_INT N_local, const std::string label,
+                            const t_index atoms = t_index(),
+                            const T_INT num_atoms = -1 );
+    template <class t_Potential, class t_neigh, class t_type>
+    static void force_half( const t_Potential potential, t_f f, const t_x x,
+                            const t_type type, const t_neigh neigh_list,
+                            const T_INT N_local, const std::string label,
+                            const t_index atoms = t_index(),
+                            const T_INT num_atoms = -1 );
+
+    template <class t_Potential, class t_neigh, class t_type>
+    static T_FLOAT energy_full( const t_Potential potential, const t_x x,
+                                const t_type type, const t_neigh neigh_list,
+                                const T_INT N_local,
+                                const std::string label );
+    template <class t_Potential, class t_neigh, class t_type>
+    static T_FLOAT energy_half( const t_Potential potential, const t_x x,
+                                const t_type type, const t_neigh neigh_list,
+                                const T_INT N_local,
+                                const std::string label );
+
+    // Forces, energy, and virial in a single neighbor traversal
+    template <class t_Potential, class t_neigh, class t_type>
+    static PairThermo thermo_full( const t_Potential potential, t_f f,
+                                   const t_x x, const t_type type,
+                                   const t_neigh neigh_list,
+                                   const T_INT N_local,
+                                   const std::string label );
+    template <class t_Potential, class t_neigh, class t_type>
+    static PairThermo thermo_half( const t_Potential potential, t_f f,
+                                   const t_x x, const t_type type,
+                                   const t_neigh neigh_list,
+                                   const T_INT N_local,
+                                   const std::string label );
+
+  private:
+    // Full list sums are atomic only with team threading
+    typedef typename std::conditional<
+        std::is_same<t_pair_parallel, Cabana::TeamOpTag>::value, t_f_a,
+        t_f>::type t_f_full;
+
+    template <class t_kernel, class t_neigh>
+    static void subset_for( const t_kernel kernel, const t_neigh neigh_list,
+                            const t_index atoms, const T_INT num_atoms,
+                            const std::string label );
+};
+
+#include <pair_kernel_impl.h>
+
+#endif
@@ -0,0 +1,325 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+template <class t_System, class t_parallel>
+template <class t_kernel, class t_neigh>
+void PairKernel<t_System, t_parallel>::subset_for(
+    const t_kernel kernel, const t_neigh neigh_list, const t_index atoms,
+    const T_INT num_atoms, const std::string label )
+{
+    Kokkos::parallel_for(
+        label, Kokkos::RangePolicy<exe_space>( 0, num_atoms ),
+        KOKKOS_LAMBDA( const int a ) {
+            const int i = atoms( a );
+            const int num_n =
+                Cabana::NeighborList<t_neigh>::numNeighbor( neigh_list, i );
+            for ( int n = 0; n < num_n; n++ )
+                kernel( i, Cabana::NeighborList<t_neigh>::getNeighbor(
+                               neigh_list, i, n ) );
+        } );
+}
+
+template <class t_System, class t_parallel>
+template <class t_Potential, class t_neigh, class t_type>
+void PairKernel<t_System, t_parallel>::force_full(
+    const t_Potential potential, t_f f, const t_x x, const t_type type,
+    const t_neigh neigh_list, const T_INT N_local, const std::string label,
+    const t_index atoms, const T_INT num_atoms )
+{
+    auto force_pair = KOKKOS_LAMBDA( const int i, const int j, T_F_FLOAT &fxi,
+                                     T_F_FLOAT &fyi, T_F_FLOAT &fzi )
+    {
+        const auto type_i = t_Potential::single_type ? 0 : type( i );
+
+        const T_F_FLOAT dx = x( i, 0 ) - x( j, 0 );
+        const T_F_FLOAT dy = x( i, 1 ) - x( j, 1 );
+        const T_F_FLOAT dz = x( i, 2 ) - x( j, 2 );
+
+        const auto type_j = t_Potential::single_type ? 0 : type( j );
+        const T_F_FLOAT rsq = dx * dx + dy * dy + dz * dz;
+
+        if ( rsq < potential.cutsq_ij( type_i, type_j ) )
+        {
+            const T_F_FLOAT fpair =
+                potential.compute_fpair( rsq, type_i, type_j );
+            fxi += dx * fpair;
+            fyi += dy * fpair;
+            fzi += dz * fpair;
+        }
+    };
+
+    // One thread per atom: sum all neighbors, then assign (no zeroing needed)
+    if ( num_atoms >= 0 ||
+         std::is_same<t_parallel, Cabana::SerialOpTag>::value )
+    {
+        const bool subset = num_atoms >= 0;
+        const T_INT num = subset ? num_atoms : N_local;
+        Kokkos::parallel_for(
+            label + "::compute_full_assign",
+            Kokkos::RangePolicy<exe_space>( 0, num ),
+            KOKKOS_LAMBDA( const int a ) {
+                const int i = subset ? atoms( a ) : a;
+                T_F_FLOAT fxi = 0.0;
+                T_F_FLOAT fyi = 0.0;
+                T_F_FLOAT fzi = 0.0;
+
+                const int num_n =
+                    Cabana::NeighborList<t_neigh>::numNeighbor( neigh_list, i );
+                for ( int n = 0; n < num_n; n++ )
+                {
+                    const int j = Cabana::NeighborList<t_neigh>::getNeighbor(
+                        neigh_list, i, n );
+                    force_pair( i, j, fxi, fyi, fzi );
+                }
+
+                f( i, 0 ) = fxi;
+                f( i, 1 ) = fyi;
+                f( i, 2 ) = fzi;
+            } );
+        return;
+    }
+
+    t_f_full f_full = f;
+    auto force_full = KOKKOS_LAMBDA( const int i, const int j )
+    {
+        T_F_FLOAT fxi = 0.0;
+        T_F_FLOAT fyi = 0.0;
+        T_F_FLOAT fzi = 0.0;
+        force_pair( i, j, fxi, fyi, fzi );
+
+        f_full( i, 0 ) += fxi;
+        f_full( i, 1 ) += fyi;
+        f_full( i, 2 ) += fzi;
+    };
+
+    Kokkos::RangePolicy<exe_space> policy( 0, N_local );
+    t_pair_parallel neigh_parallel;
+    Cabana::neighbor_parallel_for( policy, force_full, neigh_list,
+                                   Cabana::FirstNeighborsTag(), neigh_parallel,
+                                   label + "::compute_full" );
+}
+
+template <class t_System, class t_parallel>
+template <class t_Potential, class t_neigh, class t_type>
+void PairKernel<t_System, t_parallel>::force_half(
+    const t_Potential potential, t_f f, const t_x x, const t_type type,
+    const t_neigh neigh_list, const T_INT N_local, const std::string label,
+    const t_index atoms, const T_INT num_atoms )
+{
+    // Forces must be atomic for half list
+    t_f_a f_a = f;
+
+    auto force_half = KOKKOS_LAMBDA( const int i, const int j )
+    {
+        const auto type_i = t_Potential::single_type ? 0 : type( i );
+
+        const T_F_FLOAT dx = x( i, 0 ) - x( j, 0 );
+        const T_F_FLOAT dy = x( i, 1 ) - x( j, 1 );
+        const T_F_FLOAT dz = x( i, 2 ) - x( j, 2 );
+
+        const auto type_j = t_Potential::single_type ? 0 : type( j );
+        const T_F_FLOAT rsq = dx * dx + dy * dy + dz * dz;
+
+        if ( rsq < potential.cutsq_ij( type_i, type_j ) )
+        {
+            const T_F_FLOAT fpair =
+                potential.compute_fpair( rsq, type_i, type_j );
+            f_a( i, 0 ) += dx * fpair;
+            f_a( i, 1 ) += dy * fpair;
+            f_a( i, 2 ) += dz * fpair;
+            f_a( j, 0 ) -= dx * fpair;
+            f_a( j, 1 ) -= dy * fpair;
+            f_a( j, 2 ) -= dz * fpair;
+        }
+    };
+
+    if ( num_atoms >= 0 )
+    {
+        subset_for( force_half, neigh_list, atoms, num_atoms,
+                    label + "::compute_half_subset" );
+        return;
+    }
+
+    Kokkos::RangePolicy<exe_space> policy( 0, N_local );
+    t_pair_parallel neigh_parallel;
+    Cabana::neighbor_parallel_for( policy, force_half, neigh_list,
+                                   Cabana::FirstNeighborsTag(), neigh_parallel,
+                                   label + "::compute_half" );
+}
+
+template <class t_System, class t_parallel>
+template <class t_Potential, class t_neigh, class t_type>
+T_FLOAT PairKernel<t_System, t_parallel>::energy_full(
+    const t_Potential potential, const t_x x, const t_type type,
+    const t_neigh neigh_list, const T_INT N_local, const std::string label )
+{
+    auto energy_full = KOKKOS_LAMBDA( const int i, const int j, T_FLOAT &PE )
+    {
+        const auto type_i = t_Potential::single_type ? 0 : type( i );
+
+        const T_F_FLOAT dx = x( i, 0 ) - x( j, 0 );
+        const T_F_FLOAT dy = x( i, 1 ) - x( j, 1 );
+        const T_F_FLOAT dz = x( i, 2 ) - x( j, 2 );
+
+        const auto type_j = t_Potential::single_type ? 0 : type( j );
+        const T_F_FLOAT rsq = dx * dx + dy * dy + dz * dz;
+
+        // Each pair is visited from both atoms
+        if ( rsq < potential.cutsq_ij( type_i, type_j ) )
+            PE += 0.5 * potential.compute_energy( rsq, type_i, type_j );
+    };
+
+    T_FLOAT energy = 0.0;
+    Kokkos::RangePolicy<exe_space> policy( 0, N_local );
+    t_pair_parallel neigh_parallel;
+    Cabana::neighbor_parallel_reduce(
+        policy, energy_full, neigh_list, Cabana::FirstNeighborsTag(),
+        neigh_parallel, energy, label + "::compute_energy_full" );
+    return energy;
+}
+
+template <class t_System, class t_parallel>
+template <class t_Potential, class t_neigh, class t_type>
+T_FLOAT PairKernel<t_System, t_parallel>::energy_half(
+    const t_Potential potential, const t_x x, const t_type type,
+    const t_neigh neigh_list, const T_INT N_local, const std::string label )
+{
+    auto energy_half = KOKKOS_LAMBDA( const int i, const int j, T_FLOAT &PE )
+    {
+        const auto type_i = t_Potential::single_type ? 0 : type( i );
+
+        const T_F_FLOAT dx = x( i, 0 ) - x( j, 0 );
+        const T_F_FLOAT dy = x( i, 1 ) - x( j, 1 );
+        const T_F_FLOAT dz = x( i, 2 ) - x( j, 2 );
+
+        const auto type_j = t_Potential::single_type ? 0 : type( j );
+        const T_F_FLOAT rsq = dx * dx + dy * dy + dz * dz;
+
+        if ( rsq < potential.cutsq_ij( type_i, type_j ) )
+        {
+            const T_F_FLOAT fac = ( j < N_local ) ? 1.0 : 0.5;
+            PE += fac * potential.compute_energy( rsq, type_i, type_j );
+        }
+    };
+
+    T_FLOAT energy = 0.0;
+    Kokkos::RangePolicy<exe_space> policy( 0, N_local );
+    t_pair_parallel neigh_parallel;
+    Cabana::neighbor_parallel_reduce(
+        policy, energy_half, neigh_list, Cabana::FirstNeighborsTag(),
+        neigh_parallel, energy, label + "::compute_energy_half" );
+    return energy;
+}
+
+template <class t_System, class t_parallel>
+template <class t_Potential, class t_neigh, class t_type>
+PairThermo PairKernel<t_System, t_parallel>::thermo_full(
+    const t_Potential potential, t_f f, const t_x x, const t_type type,
+    const t_neigh neigh_list, const T_INT N_local, const std::string label )
+{
+    t_f_full f_full = f;
+
+    auto thermo_full =
+        KOKKOS_LAMBDA( const int i, const int j, PairThermo &thermo )
+    {
+        const auto type_i = t_Potential::single_type ? 0 : type( i );
+
+        const T_F_FLOAT dx = x( i, 0 ) - x( j, 0 );
+        const T_F_FLOAT dy = x( i, 1 ) - x( j, 1 );
+        const T_F_FLOAT dz = x( i, 2 ) - x( j, 2 );
+
+        const auto type_j = t_Potential::single_type ? 0 : type( j );
+        const T_F_FLOAT rsq = dx * dx + dy * dy + dz * dz;
+
+        if ( rsq < potential.cutsq_ij( type_i, type_j ) )
+        {
+            const T_F_FLOAT fpair =
+                potential.compute_fpair( rsq, type_i, type_j );
+            f_full( i, 0 ) += dx * fpair;
+            f_full( i, 1 ) += dy * fpair;
+            f_full( i, 2 ) += dz * fpair;
+
+            // Each pair is visited from both atoms
+            thermo.energy +=
+                0.5 * potential.compute_energy( rsq, type_i, type_j );
+
+            thermo.virial[0] += 0.5 * dx * dx * fpair;
+            thermo.virial[1] += 0.5 * dy * dy * fpair;
+            thermo.virial[2] += 0.5 * dz * dz * fpair;
+            thermo.virial[3] += 0.5 * dx * dy * fpair;
+            thermo.virial[4] += 0.5 * dx * dz * fpair;
+            thermo.virial[5] += 0.5 * dy * dz * fpair;
+        }
+    };
+
+    PairThermo thermo;
+    Kokkos::RangePolicy<exe_space> policy( 0, N_local );
+    t_pair_parallel neigh_parallel;
+    Cabana::neighbor_parallel_reduce(
+        policy, thermo_full, neigh_list, Cabana::FirstNeighborsTag(),
+        neigh_parallel, thermo, label + "::compute_thermo_full" );
+    return thermo;
+}
+
+template <class t_System, class t_parallel>
+template <class t_Potential, class t_neigh, class t_type>
+PairThermo PairKernel<t_System, t_parallel>::thermo_half(
+    const t_Potential potential, t_f f, const t_x x, const t_type type,
+    const t_neigh neigh_list, const T_INT N_local, const std::string label )
+{
+    // Forces must be atomic for half list
+    t_f_a f_a = f;
+
+    auto thermo_half =
+        KOKKOS_LAMBDA( const int i, const int j, PairThermo &thermo )
+    {
+        const auto type_i = t_Potential::single_type ? 0 : type( i );
+
+        const T_F_FLOAT dx = x( i, 0 ) - x( j, 0 );
+        const T_F_FLOAT dy = x( i, 1 ) - x( j, 1 );
+        const T_F_FLOAT dz = x( i, 2 ) - x( j, 2 );
+
+        const auto type_j = t_Potential::single_type ? 0 : type( j );
+        const T_F_FLOAT rsq = dx * dx + dy * dy + dz * dz;
+
+        if ( rsq < potential.cutsq_ij( type_i, type_j ) )
+        {
+            const T_F_FLOAT fpair =
+                potential.compute_fpair( rsq, type_i, type_j );
+            f_a( i, 0 ) += dx * fpair;
+            f_a( i, 1 ) += dy * fpair;
+            f_a( i, 2 ) += dz * fpair;
+            f_a( j, 0 ) -= dx * fpair;
+            f_a( j, 1 ) -= dy * fpair;
+            f_a( j, 2 ) -= dz * fpair;
+
+            // Pairs with a ghost are also counted on the neighbor rank
+            const T_F_FLOAT fac = ( j < N_local ) ? 1.0 : 0.5;
+            thermo.energy +=
+                fac * potential.compute_energy( rsq, type_i, type_j );
+
+            thermo.virial[0] += fac * dx * dx * fpair;
+            thermo.virial[1] += fac * dy * dy * fpair;
+            thermo.virial[2] += fac * dz * dz * fpair;
+            thermo.virial[3] += fac * dx * dy * fpair;
+            thermo.virial[4] += fac * dx * dz * fpair;
+            thermo.virial[5] += fac * dy * dz * fpair;
+        }
+    };
+
+    PairThermo thermo;
+    Kokkos::RangePolicy<exe_space> policy( 0, N_local );
+    t_pair_parallel neigh_parallel;
+    Cabana::neighbor_parallel_reduce(
+        policy, thermo_half, neigh_list, Cabana::FirstNeighborsTag(),
+        neigh_parallel, thermo, label + "::compute_thermo_half" );
+    return thermo;
+}
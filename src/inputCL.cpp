@@ -61,6 +61,17 @@ InputCL::InputCL()
     force_iteration_type = FORCE_ITER_NEIGH_FULL;
     set_force_iteration = false;
     force_neigh_parallel_type = FORCE_PARALLEL_NEIGH_SERIAL;
+    overlap_comm = false;
+    comm_type = COMM_MPI;
+    gpu_aware_mpi = GPU_AWARE_AUTO;
+    decomposition_type = DECOMPOSITION_UNIFORM;
+    binning_type = BINNING_LINKEDCELL;
+    layout_type = 0;
+    vector_length = 0;
+    lattice_size[0] = lattice_size[1] = lattice_size[2] = 0;
+    replicas = 1;
+    timers = false;
+    memory_report = false;
 }
 
 InputCL::~InputCL() {}
@@ -101,10 +112,65 @@ void InputCL::read_args( int argc, char *argv[] )
                  "  --neigh-type [TYPE]:      Specify Neighbor Routines ",
                  "implementation\n",
                  "                                (VERLET_2D, VERLET_CSR, "
-                 "TREE_2D, TREE_CSR)" );
+                 "TREE_2D, TREE_CSR, CELL_CSR, CLUSTER, AUTO: CELL_CSR or "
+                 "TREE_CSR from the spread of atoms per bin)" );
+            log( std::cout,
+                 "  --comm-type [TYPE]:       Specify MPI communication ",
+                 "pattern\n",
+                 "                                (MPI: six phases, MPI_26: ",
+                 "single round with all 26 neighbors)" );
+            log( std::cout,
+                 "  --gpu-aware-mpi [MODE]:   Pass device halo buffers to ",
+                 "MPI or stage them through pinned host memory\n",
+                 "                                (AUTO: query MPI, ON, OFF)" );
+            log( std::cout,
+                 "  --decomposition [TYPE]:   Specify the MPI rank grid\n",
+                 "                                (UNIFORM, NODE: blocks of ",
+                 "node local ranks on a grid of nodes)" );
+            log( std::cout,
+                 "  --binning-type [TYPE]:    Specify atom sort order\n",
+                 "                                (LINKEDCELL, MORTON: ",
+                 "Z-order curve over half size cells)" );
+            log( std::cout,
+                 "  --layout [N]:             Number of AoSoAs for atom ",
+                 "properties (1, 2, 3, 6; default: configured layout)\n",
+                 "                                (other layouts need ",
+                 "--vector-length and a CabanaMD_RUNTIME_SYSTEMS entry)" );
+            log( std::cout,
+                 "  --vector-length [N]:      AoSoA vector length for ",
+                 "all AoSoAs (default: configured vector lengths)\n",
+                 "                                (run time choices: ",
+                 "CabanaMD_RUNTIME_SYSTEMS)" );
+            log( std::cout,
+                 "  --lattice-size [NX] [NY] [NZ]: Override the lattice ",
+                 "cells of the 'region' command" );
+            log( std::cout,
+                 "  --replicas [N] [FILE]:    Run N independent copies of ",
+                 "the lattice system in one launch per kernel\n",
+                 "                                (per replica thermo output ",
+                 "to FILE, default: cabanaMD.replicas)" );
+            log( std::cout,
+                 "  --overlap-comm:           Overlap the ghost position ",
+                 "update with interior atom forces" );
+            log( std::cout,
+                 "  --timers:                 Time nested regions (fenced) ",
+                 "and report min/avg/max over ranks" );
+            log( std::cout,
+                 "  --timers-csv [FILE]:      Also write region times of ",
+                 "every step to FILE (FILE.<rank> with several ranks)" );
+            log( std::cout,
+                 "  --memory-report:          Report Kokkos allocations per ",
+                 "subsystem after setup and at the end, with the atoms that ",
+                 "fit on a device" );
+            log( std::cout,
+                 "  --monitor [SOCKET]:       Serve status and accept ",
+                 "steering commands on a Unix socket of rank 0, every ",
+                 "thermo step\n",
+                 "                                (status, thermo N, ",
+                 "dumpbinary N, checkpoint)" );
             log( std::cout,
                  "  --dumpbinary [N] [PATH]:  Request that binary output ",
-                 "files PATH/output* be generated every N steps\n",
+                 "file PATH/output.<step> be written every N steps\n",
                  "                                (N = positive integer)\n",
                  "                                (PATH = location of ",
                  "directory)" );
@@ -183,13 +249,20 @@ void InputCL::read_args( int argc, char *argv[] )
                 neighbor_type = NEIGH_TREE_2D;
             else if ( ( strcmp( argv[i + 1], "TREE_CSR" ) == 0 ) )
                 neighbor_type = NEIGH_TREE_CSR;
+            else if ( ( strcmp( argv[i + 1], "CELL_CSR" ) == 0 ) )
+                neighbor_type = NEIGH_CELL_CSR;
+            else if ( ( strcmp( argv[i + 1], "CLUSTER" ) == 0 ) )
+                neighbor_type = NEIGH_CLUSTER;
+            else if ( ( strcmp( argv[i + 1], "AUTO" ) == 0 ) )
+                neighbor_type = NEIGH_AUTO;
             else
                 log_err( std::cout, "Unknown commandline option: ", argv[i],
                          " ", argv[i + 1] );
             ++i;
 #ifndef Cabana_ENABLE_ARBORX
             if ( neighbor_type == NEIGH_TREE_2D ||
-                 neighbor_type == NEIGH_TREE_CSR )
+                 neighbor_type == NEIGH_TREE_CSR ||
+                 neighbor_type == NEIGH_AUTO )
             {
                 log_err( std::cout,
                          "ArborX requested, but not enabled in Cabana!" );
@@ -212,6 +285,126 @@ void InputCL::read_args( int argc, char *argv[] )
             ++i;
         }
 
+        // Communication type
+        else if ( ( strcmp( argv[i], "--comm-type" ) == 0 ) )
+        {
+            if ( ( strcmp( argv[i + 1], "MPI" ) == 0 ) )
+                comm_type = COMM_MPI;
+            else if ( ( strcmp( argv[i + 1], "MPI_26" ) == 0 ) )
+                comm_type = COMM_MPI_26;
+            else
+                log_err( std::cout, "Unknown commandline option: ", argv[i],
+                         " ", argv[i + 1] );
+            ++i;
+        }
+
+        // GPU-aware MPI
+        else if ( ( strcmp( argv[i], "--gpu-aware-mpi" ) == 0 ) )
+        {
+            if ( ( strcmp( argv[i + 1], "AUTO" ) == 0 ) )
+                gpu_aware_mpi = GPU_AWARE_AUTO;
+            else if ( ( strcmp( argv[i + 1], "ON" ) == 0 ) )
+                gpu_aware_mpi = GPU_AWARE_ON;
+            else if ( ( strcmp( argv[i + 1], "OFF" ) == 0 ) )
+                gpu_aware_mpi = GPU_AWARE_OFF;
+            else
+                log_err( std::cout, "Unknown commandline option: ", argv[i],
+                         " ", argv[i + 1] );
+            ++i;
+        }
+
+        // Domain decomposition
+        else if ( ( strcmp( argv[i], "--decomposition" ) == 0 ) )
+        {
+            if ( ( strcmp( argv[i + 1], "UNIFORM" ) == 0 ) )
+                decomposition_type = DECOMPOSITION_UNIFORM;
+            else if ( ( strcmp( argv[i + 1], "NODE" ) == 0 ) )
+                decomposition_type = DECOMPOSITION_NODE;
+            else
+                log_err( std::cout, "Unknown commandline option: ", argv[i],
+                         " ", argv[i + 1] );
+            ++i;
+        }
+
+        // Binning type
+        else if ( ( strcmp( argv[i], "--binning-type" ) == 0 ) )
+        {
+            if ( ( strcmp( argv[i + 1], "LINKEDCELL" ) == 0 ) )
+                binning_type = BINNING_LINKEDCELL;
+            else if ( ( strcmp( argv[i + 1], "MORTON" ) == 0 ) )
+                binning_type = BINNING_MORTON;
+            else
+                log_err( std::cout, "Unknown commandline option: ", argv[i],
+                         " ", argv[i + 1] );
+            ++i;
+        }
+
+        // AoSoA layout and vector length
+        else if ( ( strcmp( argv[i], "--layout" ) == 0 ) )
+        {
+            layout_type = atoi( argv[i + 1] );
+            ++i;
+        }
+        else if ( ( strcmp( argv[i], "--vector-length" ) == 0 ) )
+        {
+            vector_length = atoi( argv[i + 1] );
+            ++i;
+        }
+
+        // Lattice size override
+        else if ( ( strcmp( argv[i], "--lattice-size" ) == 0 ) )
+        {
+            for ( int d = 0; d < 3; d++ )
+                lattice_size[d] = atoi( argv[i + 1 + d] );
+            i += 3;
+        }
+
+        // Batched replicas
+        else if ( ( strcmp( argv[i], "--replicas" ) == 0 ) )
+        {
+            replicas = atoi( argv[i + 1] );
+            if ( replicas < 1 )
+                log_err( std::cout, "Unknown commandline option: ", argv[i],
+                         " ", argv[i + 1] );
+            ++i;
+            if ( i + 1 < argc && argv[i + 1][0] != '-' )
+            {
+                replica_file = argv[i + 1];
+                ++i;
+            }
+        }
+
+        // Communication overlap
+        else if ( ( strcmp( argv[i], "--overlap-comm" ) == 0 ) )
+        {
+            overlap_comm = true;
+        }
+
+        // Region timers
+        else if ( ( strcmp( argv[i], "--timers" ) == 0 ) )
+        {
+            timers = true;
+        }
+        else if ( ( strcmp( argv[i], "--timers-csv" ) == 0 ) )
+        {
+            timers = true;
+            timers_csv = argv[i + 1];
+            ++i;
+        }
+
+        // Memory report
+        else if ( ( strcmp( argv[i], "--memory-report" ) == 0 ) )
+        {
+            memory_report = true;
+        }
+
+        // Monitoring and steering
+        else if ( ( strcmp( argv[i], "--monitor" ) == 0 ) )
+        {
+            monitor_socket = argv[i + 1];
+            ++i;
+        }
+
         // Dump Binary
         else if ( ( strcmp( argv[i], "--dumpbinary" ) == 0 ) )
         {
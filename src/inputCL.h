@@ -60,9 +60,28 @@ class InputCL
     int force_iteration_type;
     bool set_force_iteration;
     int force_neigh_parallel_type;
+    // 0: the configured CabanaMD_LAYOUT and vector lengths
     int layout_type;
-    int nnp_layout_type;
+    int vector_length;
     int device_type;
+    bool overlap_comm;
+    int comm_type;
+    int gpu_aware_mpi;
+    int decomposition_type;
+    int binning_type;
+    // Overrides the 'region' lattice size if positive
+    int lattice_size[3];
+    // Independent copies of the lattice system run together, with per
+    // replica thermo output written to replica_file
+    int replicas;
+    std::string replica_file = "cabanaMD.replicas";
+    // Fenced per region timers, optionally written per step to a CSV file
+    bool timers;
+    std::string timers_csv;
+    // Allocations per subsystem after setup and at the end of the run
+    bool memory_report;
+    // Unix socket of rank 0 for run monitoring and steering, if not empty
+    std::string monitor_socket;
 
     int dumpbinary_rate, correctness_rate;
     bool dumpbinaryflag, correctnessflag;
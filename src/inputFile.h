@@ -58,9 +58,42 @@
 #include <system.h>
 #include <types.h>
 
+#include <array>
 #include <fstream>
 #include <vector>
 
+// Reduction value for the lattice velocity initialization
+struct LatticeMomentum
+{
+    T_FLOAT mass;
+    T_FLOAT momentum[3];
+
+    KOKKOS_INLINE_FUNCTION
+    LatticeMomentum()
+        : mass( 0.0 )
+    {
+        for ( int d = 0; d < 3; d++ )
+            momentum[d] = 0.0;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    LatticeMomentum &operator+=( const LatticeMomentum &src )
+    {
+        mass += src.mass;
+        for ( int d = 0; d < 3; d++ )
+            momentum[d] += src.momentum[d];
+        return *this;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    void operator+=( const volatile LatticeMomentum &src ) volatile
+    {
+        mass += src.mass;
+        for ( int d = 0; d < 3; d++ )
+            momentum[d] += src.momentum[d];
+    }
+};
+
 // Class replicating LAMMPS Random velocity initialization with GEOM option
 #define IA 16807
 #define IM 2147483647
@@ -174,24 +207,58 @@ class InputFile
     int integrator_type;
     int nsteps;
 
+    // fix nvt / fix langevin: target temperature ramp and damping time
+    int thermostat_type;
+    double thermostat_t_start, thermostat_t_stop, thermostat_t_damp;
+    int thermostat_seed;
+
+    // r-RESPA: inner steps per outer step and the inner LJ force
+    int respa_loop;
+    T_F_FLOAT respa_inner_cutoff;
+    std::vector<std::vector<std::string>> respa_coeff_lines;
+
     int binning_type;
 
     int comm_type;
     int comm_exchange_rate;
+    bool overlap_comm;
+
+    int balance_rate;
+    double balance_thresh;
+    std::array<bool, 3> balance_dims;
 
     int force_type;
     int force_iteration_type;
     int force_neigh_parallel_type;
 
     T_F_FLOAT force_cutoff;
+    // Global LJ cutoff of pair_style lj/cut and lj/cut/coul/long
+    T_F_FLOAT lj_cutoff;
+    int table_style;
     std::vector<std::vector<std::string>> force_coeff_lines;
 
+    // pair_style lj/cut/coul/long cutoff and the long range solver;
+    // kspace_mesh 0 picks the mesh from the accuracy
+    T_F_FLOAT coul_cutoff;
+    int kspace_type;
+    double kspace_accuracy;
+    std::array<int, 3> kspace_mesh;
+
+    // bond_style and angle_style with their coeff lines
+    int bond_style;
+    int angle_style;
+    std::vector<std::vector<std::string>> bond_coeff_lines;
+    std::vector<std::vector<std::string>> angle_coeff_lines;
+
+    // compute rdf, msd and count/type lines (in-situ analysis)
+    std::vector<std::vector<std::string>> compute_lines;
+
     T_F_FLOAT neighbor_skin;
+    bool neighbor_check;
     int neighbor_type;
     T_INT max_neigh_guess;
 
     int layout_type;
-    int nnp_layout_type;
 
     int thermo_rate, dumpbinary_rate, correctness_rate;
     bool dumpbinaryflag, correctnessflag;
@@ -200,6 +267,11 @@ class InputFile
     std::string output_data_file;
     bool read_data_flag = false;
     bool write_data_flag = false;
+    std::string input_restart_file;
+    std::string output_restart_file;
+    bool read_restart_flag = false;
+    bool write_restart_flag = false;
+    int initial_step = 0;
 
     InputFile( InputCL cl, t_System *s );
     void read_file( const char *filename = NULL );
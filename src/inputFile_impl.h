@@ -49,8 +49,10 @@
 #include <inputFile.h>
 #include <property_temperature.h>
 
+#include <iomanip>
 #include <iostream>
 #include <regex>
+#include <sstream>
 
 std::vector<std::string> split( const std::string &line )
 {
@@ -73,6 +75,9 @@ InputFile<t_System>::InputFile( InputCL commandline_, t_System *system_ )
 {
     comm_type = COMM_MPI;
     integrator_type = INTEGRATOR_NVE;
+    respa_loop = 1;
+    respa_inner_cutoff = 0.0;
+    thermostat_type = THERMOSTAT_NONE;
     neighbor_type = NEIGH_VERLET_2D;
     force_type = FORCE_LJ;
     binning_type = BINNING_LINKEDCELL;
@@ -80,6 +85,9 @@ InputFile<t_System>::InputFile( InputCL commandline_, t_System *system_ )
     neighbor_type = commandline.neighbor_type;
     force_iteration_type = commandline.force_iteration_type;
     force_neigh_parallel_type = commandline.force_neigh_parallel_type;
+    overlap_comm = commandline.overlap_comm;
+    comm_type = commandline.comm_type;
+    binning_type = commandline.binning_type;
 
     output_file = commandline.output_file;
     error_file = commandline.error_file;
@@ -119,8 +127,23 @@ InputFile<t_System>::InputFile( InputCL commandline_, t_System *system_ )
     neighbor_skin = 0.0; // for metal and real units
     max_neigh_guess = 50;
     comm_exchange_rate = 20;
+    neighbor_check = false;
+
+    balance_rate = 0;
+    balance_thresh = 1.1;
+    balance_dims = {true, true, true};
 
     force_cutoff = 2.5;
+    lj_cutoff = 2.5;
+    table_style = TABLE_LINEAR;
+
+    coul_cutoff = 0.0;
+    kspace_type = KSPACE_NONE;
+    kspace_accuracy = 1e-4;
+    kspace_mesh = {0, 0, 0};
+
+    bond_style = BOND_NONE;
+    angle_style = ANGLE_NONE;
 }
 
 template <class t_System>
@@ -192,6 +215,8 @@ void InputFile<t_System>::check_lammps_command( std::string line,
             system->boltz = 8.617343e-5;
             // hplanck = 95.306976368;
             system->mvv2e = 1.0364269e-4;
+            system->nktv2p = 1.6021765e6;
+            system->qqrd2e = 14.399645;
             system->dt = 0.001;
         }
         else if ( words.at( 1 ).compare( "real" ) == 0 )
@@ -201,6 +226,8 @@ void InputFile<t_System>::check_lammps_command( std::string line,
             system->boltz = 0.0019872067;
             // hplanck = 95.306976368;
             system->mvv2e = 48.88821291 * 48.88821291;
+            system->nktv2p = 68568.415;
+            system->qqrd2e = 332.06371;
             if ( !timestepflag )
                 system->dt = 1.0;
         }
@@ -211,6 +238,8 @@ void InputFile<t_System>::check_lammps_command( std::string line,
             system->boltz = 1.0;
             // hplanck = 0.18292026;
             system->mvv2e = 1.0;
+            system->nktv2p = 1.0;
+            system->qqrd2e = 1.0;
             if ( !timestepflag )
                 system->dt = 0.005;
         }
@@ -231,10 +260,20 @@ void InputFile<t_System>::check_lammps_command( std::string line,
             known = true;
             system->atom_style = "charge";
         }
+        else if ( words.at( 1 ).compare( "bond" ) == 0 ||
+                  words.at( 1 ).compare( "angle" ) == 0 ||
+                  words.at( 1 ).compare( "molecular" ) == 0 ||
+                  words.at( 1 ).compare( "full" ) == 0 )
+        {
+            // Molecule ids are read but not stored
+            known = true;
+            system->atom_style = words.at( 1 );
+        }
         else
         {
             log_err( err, "LAMMPS-Command: 'atom_style' command only supports "
-                          "'atomic' and 'charge' in CabanaMD" );
+                          "'atomic', 'charge', 'bond', 'angle', 'molecular', "
+                          "and 'full' in CabanaMD" );
         }
     }
     if ( keyword.compare( "lattice" ) == 0 )
@@ -296,6 +335,12 @@ void InputFile<t_System>::check_lammps_command( std::string line,
             lattice_nx = box[1];
             lattice_ny = box[3];
             lattice_nz = box[5];
+            if ( commandline.lattice_size[0] > 0 )
+            {
+                lattice_nx = commandline.lattice_size[0];
+                lattice_ny = commandline.lattice_size[1];
+                lattice_nz = commandline.lattice_size[2];
+            }
         }
         else
         {
@@ -335,6 +380,18 @@ void InputFile<t_System>::check_lammps_command( std::string line,
         write_data_flag = true;
         output_data_file = words.at( 1 );
     }
+    if ( keyword.compare( "read_restart" ) == 0 )
+    {
+        known = true;
+        read_restart_flag = true;
+        input_restart_file = words.at( 1 );
+    }
+    if ( keyword.compare( "write_restart" ) == 0 )
+    {
+        known = true;
+        write_restart_flag = true;
+        output_restart_file = words.at( 1 );
+    }
     if ( keyword.compare( "pair_style" ) == 0 )
     {
         if ( words.at( 1 ).compare( "lj/cut" ) == 0 )
@@ -342,6 +399,20 @@ void InputFile<t_System>::check_lammps_command( std::string line,
             known = true;
             force_type = FORCE_LJ;
             force_cutoff = std::stod( words.at( 2 ) );
+            lj_cutoff = force_cutoff;
+        }
+        if ( words.at( 1 ).compare( "lj/cut/coul/long" ) == 0 )
+        {
+            // LJ plus the real space part of the kspace_style Coulomb sum
+            known = true;
+            force_type = FORCE_LJ;
+            lj_cutoff = std::stod( words.at( 2 ) );
+            force_cutoff = lj_cutoff;
+            coul_cutoff = lj_cutoff;
+            if ( words.size() > 3 )
+                coul_cutoff = std::stod( words.at( 3 ) );
+            if ( coul_cutoff > force_cutoff )
+                force_cutoff = coul_cutoff;
         }
         if ( words.at( 1 ).compare( "snap" ) == 0 )
         {
@@ -356,21 +427,144 @@ void InputFile<t_System>::check_lammps_command( std::string line,
             force_coeff_lines.resize( 1 );
             force_coeff_lines.at( 0 ) = split( line );
         }
+        if ( words.at( 1 ).compare( "table" ) == 0 )
+        {
+            known = true;
+            force_type = FORCE_TABLE;
+            if ( words.size() < 4 )
+                log_err( err, "LAMMPS-Command: 'pair_style table' requires "
+                              "a style and table length" );
+            if ( words.at( 2 ).compare( "linear" ) == 0 )
+                table_style = TABLE_LINEAR;
+            else if ( words.at( 2 ).compare( "spline" ) == 0 )
+                table_style = TABLE_SPLINE;
+            else
+                log_err( err, "LAMMPS-Command: 'pair_style table' only "
+                              "supports 'linear' and 'spline' in CabanaMD" );
+            force_cutoff = 0.0;
+            force_coeff_lines.resize( 1 );
+            force_coeff_lines.at( 0 ) = split( line );
+        }
+        if ( words.at( 1 ).compare( "eam/alloy" ) == 0 )
+        {
+            known = true;
+            force_type = FORCE_EAM;
+        }
         if ( !known )
             log_err( err, "LAMMPS-Command: 'pair_style' command only supports "
-                          "'lj/cut' and 'nnp' style in CabanaMD" );
+                          "'lj/cut', 'lj/cut/coul/long', 'table', "
+                          "'eam/alloy', and 'nnp' style in CabanaMD" );
+    }
+    if ( keyword.compare( "bond_style" ) == 0 )
+    {
+        if ( words.at( 1 ).compare( "harmonic" ) == 0 )
+        {
+            known = true;
+            bond_style = BOND_HARMONIC;
+        }
+        else
+            log_err( err, "LAMMPS-Command: 'bond_style' command only "
+                          "supports 'harmonic' in CabanaMD" );
+    }
+    if ( keyword.compare( "bond_coeff" ) == 0 )
+    {
+        known = true;
+        bond_coeff_lines.push_back( split( line ) );
+    }
+    if ( keyword.compare( "angle_style" ) == 0 )
+    {
+        if ( words.at( 1 ).compare( "harmonic" ) == 0 )
+        {
+            known = true;
+            angle_style = ANGLE_HARMONIC;
+        }
+        else
+            log_err( err, "LAMMPS-Command: 'angle_style' command only "
+                          "supports 'harmonic' in CabanaMD" );
+    }
+    if ( keyword.compare( "angle_coeff" ) == 0 )
+    {
+        known = true;
+        angle_coeff_lines.push_back( split( line ) );
+    }
+    if ( keyword.compare( "kspace_style" ) == 0 )
+    {
+        if ( words.size() > 2 && words.at( 1 ).compare( "pppm" ) == 0 )
+        {
+            known = true;
+            kspace_type = KSPACE_PPPM;
+            kspace_accuracy = std::stod( words.at( 2 ) );
+        }
+        else
+            log_err( err, "LAMMPS-Command: 'kspace_style' command only "
+                          "supports 'pppm [accuracy]' in CabanaMD" );
+    }
+    if ( keyword.compare( "kspace_modify" ) == 0 )
+    {
+        if ( words.size() > 4 && words.at( 1 ).compare( "mesh" ) == 0 )
+        {
+            known = true;
+            for ( int d = 0; d < 3; d++ )
+                kspace_mesh[d] = std::stoi( words.at( 2 + d ) );
+        }
+        else
+            log_err( err, "LAMMPS-Command: 'kspace_modify' command only "
+                          "supports 'mesh [NX] [NY] [NZ]' in CabanaMD" );
     }
     if ( keyword.compare( "pair_coeff" ) == 0 )
     {
         known = true;
-        if ( force_type == FORCE_NNP )
+        if ( words.size() > 3 && words.at( 3 ).compare( "lj/cut" ) == 0 )
+        {
+            // LJ baseline (hybrid/overlay style) for the r-RESPA inner force
+            auto coeff = split( line );
+            coeff.erase( coeff.begin() + 3 );
+            respa_coeff_lines.push_back( coeff );
+        }
+        else if ( force_type == FORCE_NNP )
             force_cutoff = std::stod( words.at( 3 ) );
-        else
+        else if ( force_type == FORCE_TABLE )
         {
+            // The neighbor cutoff is needed before the tables are read
+            if ( words.size() < 6 )
+                log_err( err, "LAMMPS-Command: 'pair_coeff' for 'table' "
+                              "requires an explicit cutoff in CabanaMD" );
+            double cut = std::stod( words.at( 5 ) );
+            if ( cut > force_cutoff )
+                force_cutoff = cut;
             int nlines = force_coeff_lines.size();
             force_coeff_lines.resize( nlines + 1 );
             force_coeff_lines.at( nlines ) = split( line );
         }
+        else if ( force_type == FORCE_EAM )
+        {
+            // The cutoff is the last entry of the setfl header (line 5)
+            std::ifstream setfl( words.at( 3 ) );
+            if ( !setfl.good() )
+                log_err( err, "LAMMPS-Command: cannot open EAM potential "
+                              "file ",
+                         words.at( 3 ) );
+            std::string header;
+            for ( int l = 0; l < 5; l++ )
+                std::getline( setfl, header );
+            auto header_words = split( header );
+            force_cutoff = std::stod( header_words.at( 4 ) );
+            force_coeff_lines.resize( 1 );
+            force_coeff_lines.at( 0 ) = split( line );
+        }
+        else
+        {
+            // LJ pairs without their own cutoff use the pair_style one (not
+            // the Coulomb cutoff of lj/cut/coul/long)
+            auto coeff = split( line );
+            if ( coeff.size() < 6 )
+            {
+                std::ostringstream cut;
+                cut << std::setprecision( 17 ) << lj_cutoff;
+                coeff.push_back( cut.str() );
+            }
+            force_coeff_lines.push_back( coeff );
+        }
     }
     if ( keyword.compare( "velocity" ) == 0 )
     {
@@ -404,6 +598,17 @@ void InputFile<t_System>::check_lammps_command( std::string line,
                 comm_exchange_rate = std::stoi( words.at( i + 1 ) );
                 i += 2;
             }
+            else if ( words.at( i ).compare( "check" ) == 0 )
+            {
+                if ( words.at( i + 1 ).compare( "yes" ) == 0 )
+                    neighbor_check = true;
+                else if ( words.at( i + 1 ).compare( "no" ) == 0 )
+                    neighbor_check = false;
+                else
+                    log_err( err, "LAMMPS-Command: 'neigh_modify check' must "
+                                  "be followed by 'yes' or 'no'" );
+                i += 2;
+            }
             else if ( words.at( i ).compare( "one" ) == 0 )
             {
                 max_neigh_guess = std::stoi( words.at( i + 1 ) );
@@ -412,10 +617,37 @@ void InputFile<t_System>::check_lammps_command( std::string line,
             else
             {
                 log_err( err, "LAMMPS-Command: 'neigh_modify' only supports "
-                              "'every' and 'one' in CabanaMD" );
+                              "'every', 'check', and 'one' in CabanaMD" );
             }
         }
     }
+    if ( keyword.compare( "run_style" ) == 0 )
+    {
+        if ( words.at( 1 ).compare( "verlet" ) == 0 )
+        {
+            known = true;
+            integrator_type = INTEGRATOR_NVE;
+        }
+        else if ( words.at( 1 ).compare( "respa" ) == 0 )
+        {
+            // run_style respa 2 n inner 1 cut_lo cut_hi
+            known = true;
+            integrator_type = INTEGRATOR_RESPA;
+            if ( words.size() < 8 || std::stoi( words.at( 2 ) ) != 2 ||
+                 words.at( 4 ).compare( "inner" ) != 0 )
+                log_err( err, "LAMMPS-Command: 'run_style respa' only "
+                              "supports '2 n inner 1 cut_lo cut_hi' in "
+                              "CabanaMD" );
+            respa_loop = std::stoi( words.at( 3 ) );
+            // No switching region: the inner force is cut at cut_hi
+            respa_inner_cutoff = std::stod( words.at( 7 ) );
+        }
+        else
+        {
+            log_err( err, "LAMMPS-Command: 'run_style' only supports "
+                          "'verlet' and 'respa' in CabanaMD" );
+        }
+    }
     if ( keyword.compare( "fix" ) == 0 )
     {
         if ( words.at( 3 ).compare( "nve" ) == 0 )
@@ -423,12 +655,72 @@ void InputFile<t_System>::check_lammps_command( std::string line,
             known = true;
             integrator_type = INTEGRATOR_NVE;
         }
+        else if ( words.at( 3 ).compare( "nvt" ) == 0 )
+        {
+            // fix ID group nvt temp Tstart Tstop Tdamp
+            known = true;
+            if ( words.size() < 8 || words.at( 4 ).compare( "temp" ) != 0 )
+                log_err( err, "LAMMPS-Command: 'fix nvt' only supports "
+                              "'temp Tstart Tstop Tdamp' in CabanaMD" );
+            thermostat_type = THERMOSTAT_NOSE_HOOVER;
+            thermostat_t_start = std::stod( words.at( 5 ) );
+            thermostat_t_stop = std::stod( words.at( 6 ) );
+            thermostat_t_damp = std::stod( words.at( 7 ) );
+        }
+        else if ( words.at( 3 ).compare( "langevin" ) == 0 )
+        {
+            // fix ID group langevin Tstart Tstop damp seed (with fix nve)
+            known = true;
+            if ( words.size() < 8 )
+                log_err( err, "LAMMPS-Command: 'fix langevin' requires "
+                              "'Tstart Tstop damp seed'" );
+            thermostat_type = THERMOSTAT_LANGEVIN;
+            thermostat_t_start = std::stod( words.at( 4 ) );
+            thermostat_t_stop = std::stod( words.at( 5 ) );
+            thermostat_t_damp = std::stod( words.at( 6 ) );
+            thermostat_seed = std::stoi( words.at( 7 ) );
+        }
+        else if ( words.at( 3 ).compare( "balance" ) == 0 )
+        {
+            // fix ID group balance Nfreq thresh [shift dimstr]
+            known = true;
+            balance_rate = std::stoi( words.at( 4 ) );
+            balance_thresh = std::stod( words.at( 5 ) );
+            if ( words.size() > 6 )
+            {
+                if ( words.at( 6 ).compare( "shift" ) != 0 ||
+                     words.size() < 8 )
+                    log_err( err, "LAMMPS-Command: 'fix balance' only "
+                                  "supports 'shift dimstr' in CabanaMD" );
+                auto dimstr = words.at( 7 );
+                balance_dims = {dimstr.find( 'x' ) != std::string::npos,
+                                dimstr.find( 'y' ) != std::string::npos,
+                                dimstr.find( 'z' ) != std::string::npos};
+            }
+        }
         else
         {
-            log_err( err, "LAMMPS-Command: 'fix' command only supports 'nve' "
-                          "style in CabanaMD" );
+            log_err( err, "LAMMPS-Command: 'fix' command only supports 'nve', "
+                          "'nvt', 'langevin', and 'balance' styles in "
+                          "CabanaMD" );
         }
     }
+    if ( keyword.compare( "compute" ) == 0 )
+    {
+        // compute ID group rdf Nbin | msd | count/type atom
+        //     [every N] [file F] (CabanaMD sampling and output keywords)
+        known = true;
+        if ( words.size() < 4 ||
+             ( words.at( 3 ).compare( "rdf" ) != 0 &&
+               words.at( 3 ).compare( "msd" ) != 0 &&
+               words.at( 3 ).compare( "count/type" ) != 0 ) )
+            log_err( err, "LAMMPS-Command: 'compute' command only supports "
+                          "'rdf', 'msd', and 'count/type' styles in "
+                          "CabanaMD" );
+        if ( words.at( 3 ).compare( "rdf" ) == 0 && words.size() < 5 )
+            log_err( err, "LAMMPS-Command: 'compute rdf' requires Nbin" );
+        compute_lines.push_back( words );
+    }
     if ( keyword.compare( "run" ) == 0 )
     {
         known = true;
@@ -483,24 +775,27 @@ template <class t_System>
 void InputFile<t_System>::create_lattice( Comm<t_System> *comm )
 {
     std::ofstream out( output_file, std::ofstream::app );
+    using exe_space = typename t_System::execution_space;
 
-    t_System s = *system;
-    System<Kokkos::Device<Kokkos::DefaultHostExecutionSpace, Kokkos::HostSpace>,
-           CabanaMD_LAYOUT>
-        host_system;
-
-    using h_t_mass = typename t_System::h_t_mass;
-    h_t_mass h_mass = Kokkos::create_mirror_view( s.mass );
-    Kokkos::deep_copy( h_mass, s.mass );
-
-    // Create the mesh.
-    T_X_FLOAT max_x = lattice_constant * lattice_nx;
-    T_X_FLOAT max_y = lattice_constant * lattice_ny;
-    T_X_FLOAT max_z = lattice_constant * lattice_nz;
-    std::array<T_X_FLOAT, 3> global_low = {0.0, 0.0, 0.0};
-    std::array<T_X_FLOAT, 3> global_high = {max_x, max_y, max_z};
+    // Create the mesh. Replicas are separated along x by twice the neighbor
+    // cutoff (plus the skin drifted between rebuilds), so no pair interacts
+    // across two replicas.
+    double max_x = lattice_constant * lattice_nx;
+    double max_y = lattice_constant * lattice_ny;
+    double max_z = lattice_constant * lattice_nz;
+    int replicas = system->replicas;
+    system->replica_lx = max_x;
+    system->replica_width = max_x;
+    if ( replicas > 1 )
+        system->replica_width +=
+            2.0 * ( force_cutoff + neighbor_skin ) + neighbor_skin;
+    std::array<double, 3> global_low = {0.0, 0.0, 0.0};
+    std::array<double, 3> global_high = {replicas * system->replica_width,
+                                         max_y, max_z};
+    if ( replicas == 1 )
+        global_high[0] = max_x;
     system->create_domain( global_low, global_high );
-    s = *system;
+    t_System s = *system;
 
     auto local_mesh_lo_x = s.local_mesh_lo_x;
     auto local_mesh_lo_y = s.local_mesh_lo_y;
@@ -513,265 +808,223 @@ void InputFile<t_System>::create_lattice( Comm<t_System> *comm )
     T_INT iy_start = local_mesh_lo_y / s.global_mesh_y * lattice_ny - 0.5;
     T_INT iz_start = local_mesh_lo_z / s.global_mesh_z * lattice_nz - 0.5;
     T_INT ix_end = local_mesh_hi_x / s.global_mesh_x * lattice_nx + 0.5;
+    // Every replica is whole on this rank (x is never split)
+    if ( replicas > 1 )
+    {
+        ix_start = 0;
+        ix_end = lattice_nx;
+    }
     T_INT iy_end = local_mesh_hi_y / s.global_mesh_y * lattice_ny + 0.5;
     T_INT iz_end = local_mesh_hi_z / s.global_mesh_z * lattice_nz + 0.5;
 
-    // Create Simple Cubic Lattice
-    if ( lattice_style == LATTICE_SC )
+    // Basis of the Simple Cubic or Face Centered Cubic (FCC) Lattice
+    int num_basis = 1;
+    Kokkos::Array<double, 12> basis;
+    for ( int c = 0; c < 12; c++ )
+        basis[c] = 0.0;
+    if ( lattice_style == LATTICE_FCC )
     {
-        T_INT n = 0;
-
-        for ( T_INT iz = iz_start; iz <= iz_end; iz++ )
-        {
-            T_FLOAT ztmp = lattice_constant * ( iz + lattice_offset_z );
-            for ( T_INT iy = iy_start; iy <= iy_end; iy++ )
-            {
-                T_FLOAT ytmp = lattice_constant * ( iy + lattice_offset_y );
-                for ( T_INT ix = ix_start; ix <= ix_end; ix++ )
-                {
-                    T_FLOAT xtmp = lattice_constant * ( ix + lattice_offset_x );
-                    if ( ( xtmp >= local_mesh_lo_x ) &&
-                         ( ytmp >= local_mesh_lo_y ) &&
-                         ( ztmp >= local_mesh_lo_z ) &&
-                         ( xtmp < local_mesh_hi_x ) &&
-                         ( ytmp < local_mesh_hi_y ) &&
-                         ( ztmp < local_mesh_hi_z ) )
-                    {
-                        n++;
-                    }
-                }
-            }
-        }
-        system->N_local = n;
-        system->N = n;
-        system->resize( n );
-        system->slice_all();
-        s = *system;
-        auto x = s.x;
-        auto v = s.v;
-        auto id = s.id;
-        auto type = s.type;
-        auto q = s.q;
-
-        n = 0;
-        for ( T_INT iz = iz_start; iz <= iz_end; iz++ )
-        {
-            T_FLOAT ztmp = lattice_constant * ( iz + lattice_offset_z );
-            for ( T_INT iy = iy_start; iy <= iy_end; iy++ )
-            {
-                T_FLOAT ytmp = lattice_constant * ( iy + lattice_offset_y );
-                for ( T_INT ix = ix_start; ix <= ix_end; ix++ )
-                {
-                    T_FLOAT xtmp = lattice_constant * ( ix + lattice_offset_x );
-                    if ( ( xtmp >= local_mesh_lo_x ) &&
-                         ( ytmp >= local_mesh_lo_y ) &&
-                         ( ztmp >= local_mesh_lo_z ) &&
-                         ( xtmp < local_mesh_hi_x ) &&
-                         ( ytmp < local_mesh_hi_y ) &&
-                         ( ztmp < local_mesh_hi_z ) )
-                    {
-                        x( n, 0 ) = xtmp;
-                        x( n, 1 ) = ytmp;
-                        x( n, 2 ) = ztmp;
-                        type( n ) = rand() % s.ntypes;
-                        id( n ) = n + 1;
-                        n++;
-                    }
-                }
-            }
-        }
-        comm->reduce_int( &system->N, 1 );
-
-        // Make ids unique over all processes
-        T_INT N_local_offset = n;
-        comm->scan_int( &N_local_offset, 1 );
-        for ( T_INT i = 0; i < n; i++ )
-            id( i ) += N_local_offset - n;
+        num_basis = 4;
+        basis[3] = 0.5;
+        basis[4] = 0.5;
+        basis[6] = 0.5;
+        basis[8] = 0.5;
+        basis[10] = 0.5;
+        basis[11] = 0.5;
     }
-
-    // Create Face Centered Cubic (FCC) Lattice
-    if ( lattice_style == LATTICE_FCC )
+    for ( int k = 0; k < num_basis; k++ )
     {
-        double basis[4][3];
-        basis[0][0] = 0.0;
-        basis[0][1] = 0.0;
-        basis[0][2] = 0.0;
-        basis[1][0] = 0.5;
-        basis[1][1] = 0.5;
-        basis[1][2] = 0.0;
-        basis[2][0] = 0.5;
-        basis[2][1] = 0.0;
-        basis[2][2] = 0.5;
-        basis[3][0] = 0.0;
-        basis[3][1] = 0.5;
-        basis[3][2] = 0.5;
-
-        for ( int i = 0; i < 4; i++ )
-        {
-            basis[i][0] += lattice_offset_x;
-            basis[i][1] += lattice_offset_y;
-            basis[i][2] += lattice_offset_z;
-        }
+        basis[3 * k] += lattice_offset_x;
+        basis[3 * k + 1] += lattice_offset_y;
+        basis[3 * k + 2] += lattice_offset_z;
+    }
 
-        T_INT n = 0;
+    // Flat index over lattice sites in (replica, iz, iy, ix, basis) order;
+    // xyz is the position within the replica box
+    T_INT nx = ix_end - ix_start + 1;
+    T_INT ny = iy_end - iy_start + 1;
+    T_INT nz = iz_end - iz_start + 1;
+    T_INT num_sites = nx * ny * nz * num_basis * replicas;
+    T_FLOAT a = lattice_constant;
+    T_X_FLOAT replica_lx = s.replica_lx;
+    auto site = KOKKOS_LAMBDA( const T_INT idx, T_FLOAT xyz[3] )
+    {
+        const int k = idx % num_basis;
+        const T_INT cell = ( idx / num_basis ) % ( nx * ny * nz );
+        const T_INT ix = ix_start + cell % nx;
+        const T_INT iy = iy_start + ( cell / nx ) % ny;
+        const T_INT iz = iz_start + cell / ( nx * ny );
+        xyz[0] = a * ( 1.0 * ix + basis[3 * k] );
+        xyz[1] = a * ( 1.0 * iy + basis[3 * k + 1] );
+        xyz[2] = a * ( 1.0 * iz + basis[3 * k + 2] );
+        if ( replicas > 1 )
+            return ( xyz[0] >= 0.0 ) && ( xyz[0] < replica_lx ) &&
+                   ( xyz[1] >= local_mesh_lo_y ) &&
+                   ( xyz[2] >= local_mesh_lo_z ) &&
+                   ( xyz[1] < local_mesh_hi_y ) && ( xyz[2] < local_mesh_hi_z );
+        return ( xyz[0] >= local_mesh_lo_x ) && ( xyz[1] >= local_mesh_lo_y ) &&
+               ( xyz[2] >= local_mesh_lo_z ) && ( xyz[0] < local_mesh_hi_x ) &&
+               ( xyz[1] < local_mesh_hi_y ) && ( xyz[2] < local_mesh_hi_z );
+    };
+    // Offset of the replica holding a site
+    T_X_FLOAT replica_width = s.replica_width;
+    T_INT replica_sites = nx * ny * nz * num_basis;
+    auto site_offset = KOKKOS_LAMBDA( const T_INT idx )
+    {
+        return ( idx / replica_sites ) * replica_width;
+    };
 
-        for ( T_INT iz = iz_start; iz <= iz_end; iz++ )
-        {
-            for ( T_INT iy = iy_start; iy <= iy_end; iy++ )
-            {
-                for ( T_INT ix = ix_start; ix <= ix_end; ix++ )
-                {
-                    for ( int k = 0; k < 4; k++ )
-                    {
-                        T_FLOAT xtmp =
-                            lattice_constant * ( 1.0 * ix + basis[k][0] );
-                        T_FLOAT ytmp =
-                            lattice_constant * ( 1.0 * iy + basis[k][1] );
-                        T_FLOAT ztmp =
-                            lattice_constant * ( 1.0 * iz + basis[k][2] );
-                        if ( ( xtmp >= local_mesh_lo_x ) &&
-                             ( ytmp >= local_mesh_lo_y ) &&
-                             ( ztmp >= local_mesh_lo_z ) &&
-                             ( xtmp < local_mesh_hi_x ) &&
-                             ( ytmp < local_mesh_hi_y ) &&
-                             ( ztmp < local_mesh_hi_z ) )
-                        {
-                            n++;
-                        }
-                    }
-                }
-            }
-        }
+    T_INT n = 0;
+    Kokkos::parallel_reduce(
+        "InputFile::count_lattice",
+        Kokkos::RangePolicy<exe_space>( 0, num_sites ),
+        KOKKOS_LAMBDA( const T_INT idx, T_INT &count ) {
+            T_FLOAT xyz[3];
+            if ( site( idx, xyz ) )
+                count++;
+        },
+        n );
 
-        system->N_local = n;
-        system->N = n;
-        system->resize( n );
-        system->slice_all();
+    system->N_local = n;
+    system->N = n;
+    system->resize( n );
+    system->slice_all();
+    s = *system;
+    auto x = s.x;
+    auto v = s.v;
+    auto id = s.id;
+    auto type = s.type;
+    auto q = s.q;
+    comm->reduce_int( &system->N, 1 );
 
-        host_system.resize( n );
-        host_system.slice_all();
-        auto h_x = host_system.x;
-        auto h_id = host_system.id;
-        auto h_type = host_system.type;
+    // Make ids unique over all processes
+    T_INT N_local_offset = n;
+    comm->scan_int( &N_local_offset, 1 );
+    T_INT id_offset = N_local_offset - n;
 
-        n = 0;
-        for ( T_INT iz = iz_start; iz <= iz_end; iz++ )
-        {
-            for ( T_INT iy = iy_start; iy <= iy_end; iy++ )
+    // Types from a per site hash (the same in every replica); ids follow the
+    // site order
+    int ntypes = s.ntypes;
+    int seed = temperature_seed;
+    Kokkos::parallel_scan(
+        "InputFile::fill_lattice",
+        Kokkos::RangePolicy<exe_space>( 0, num_sites ),
+        KOKKOS_LAMBDA( const T_INT idx, T_INT &i, const bool final ) {
+            T_FLOAT xyz[3];
+            if ( site( idx, xyz ) )
             {
-                for ( T_INT ix = ix_start; ix <= ix_end; ix++ )
+                if ( final )
                 {
-                    for ( int k = 0; k < 4; k++ )
-                    {
-                        T_FLOAT xtmp =
-                            lattice_constant * ( 1.0 * ix + basis[k][0] );
-                        T_FLOAT ytmp =
-                            lattice_constant * ( 1.0 * iy + basis[k][1] );
-                        T_FLOAT ztmp =
-                            lattice_constant * ( 1.0 * iz + basis[k][2] );
-                        if ( ( xtmp >= local_mesh_lo_x ) &&
-                             ( ytmp >= local_mesh_lo_y ) &&
-                             ( ztmp >= local_mesh_lo_z ) &&
-                             ( xtmp < local_mesh_hi_x ) &&
-                             ( ytmp < local_mesh_hi_y ) &&
-                             ( ztmp < local_mesh_hi_z ) )
-                        {
-                            h_x( n, 0 ) = xtmp;
-                            h_x( n, 1 ) = ytmp;
-                            h_x( n, 2 ) = ztmp;
-                            h_type( n ) = rand() % s.ntypes;
-                            h_id( n ) = n + 1;
-                            n++;
-                        }
-                    }
+                    for ( int d = 0; d < 3; d++ )
+                        x( i, d ) = xyz[d];
+                    x( i, 0 ) += site_offset( idx );
+                    LAMMPS_RandomVelocityGeom random;
+                    double site_i[3] = {xyz[0], xyz[1], xyz[2]};
+                    random.reset( seed + 1, site_i );
+                    type( i ) = int( random.uniform() * ntypes ) % ntypes;
+                    id( i ) = id_offset + i + 1;
                 }
+                i++;
             }
-        }
-        comm->reduce_int( &system->N, 1 );
-
-        // Make ids unique over all processes
-        T_INT N_local_offset = n;
-        comm->scan_int( &N_local_offset, 1 );
-        for ( T_INT i = 0; i < n; i++ )
-            h_id( i ) += N_local_offset - n;
-
-        // Already sliced
-        s = *system;
-        auto x = s.x;
-        auto id = s.id;
-        auto type = s.type;
-        system->deep_copy( host_system );
-    }
+        } );
     log( out, "Atoms: ", system->N, " ", system->N_local );
 
     // Initialize velocity using the equivalent of the LAMMPS
     // velocity geom option, i.e. uniform random kinetic energies.
     // zero out momentum of the whole system afterwards, to eliminate
     // drift (bad for energy statistics)
+    auto mass = s.mass;
+    LatticeMomentum total;
+    Kokkos::parallel_reduce(
+        "InputFile::init_velocity", Kokkos::RangePolicy<exe_space>( 0, n ),
+        KOKKOS_LAMBDA( const T_INT i, LatticeMomentum &sum ) {
+            LAMMPS_RandomVelocityGeom random;
+            double x_i[3] = {x( i, 0 ), x( i, 1 ), x( i, 2 )};
+            random.reset( seed, x_i );
 
-    // already sliced
-    auto h_x = host_system.x;
-    auto h_v = host_system.v;
-    auto h_q = host_system.q;
-    auto h_type = host_system.type;
-
-    T_FLOAT total_mass = 0.0;
-    T_FLOAT total_momentum_x = 0.0;
-    T_FLOAT total_momentum_y = 0.0;
-    T_FLOAT total_momentum_z = 0.0;
+            T_FLOAT mass_i = mass( type( i ) );
+            T_FLOAT vx = random.uniform() - 0.5;
+            T_FLOAT vy = random.uniform() - 0.5;
+            T_FLOAT vz = random.uniform() - 0.5;
 
-    for ( T_INT i = 0; i < system->N_local; i++ )
-    {
-        LAMMPS_RandomVelocityGeom random;
-        double x_i[3] = {h_x( i, 0 ), h_x( i, 1 ), h_x( i, 2 )};
-        random.reset( temperature_seed, x_i );
+            v( i, 0 ) = vx / sqrt( mass_i );
+            v( i, 1 ) = vy / sqrt( mass_i );
+            v( i, 2 ) = vz / sqrt( mass_i );
 
-        T_FLOAT mass_i = h_mass( h_type( i ) );
-        T_FLOAT vx = random.uniform() - 0.5;
-        T_FLOAT vy = random.uniform() - 0.5;
-        T_FLOAT vz = random.uniform() - 0.5;
+            q( i ) = 0.0;
 
-        h_v( i, 0 ) = vx / sqrt( mass_i );
-        h_v( i, 1 ) = vy / sqrt( mass_i );
-        h_v( i, 2 ) = vz / sqrt( mass_i );
+            sum.mass += mass_i;
+            for ( int d = 0; d < 3; d++ )
+                sum.momentum[d] += mass_i * v( i, d );
+        },
+        total );
+    T_FLOAT sums[4] = {total.momentum[0], total.momentum[1],
+                       total.momentum[2], total.mass};
+    comm->reduce_float( sums, 4 );
+    for ( int d = 0; d < 3; d++ )
+        total.momentum[d] = sums[d];
+    total.mass = sums[3];
 
-        h_q( i ) = 0.0;
-
-        total_mass += mass_i;
-        total_momentum_x += mass_i * h_v( i, 0 );
-        total_momentum_y += mass_i * h_v( i, 1 );
-        total_momentum_z += mass_i * h_v( i, 2 );
-    }
-    comm->reduce_float( &total_momentum_x, 1 );
-    comm->reduce_float( &total_momentum_y, 1 );
-    comm->reduce_float( &total_momentum_z, 1 );
-    comm->reduce_float( &total_mass, 1 );
+    T_FLOAT system_vx = total.momentum[0] / total.mass;
+    T_FLOAT system_vy = total.momentum[1] / total.mass;
+    T_FLOAT system_vz = total.momentum[2] / total.mass;
 
-    T_FLOAT system_vx = total_momentum_x / total_mass;
-    T_FLOAT system_vy = total_momentum_y / total_mass;
-    T_FLOAT system_vz = total_momentum_z / total_mass;
+    Kokkos::parallel_for(
+        "InputFile::zero_momentum", Kokkos::RangePolicy<exe_space>( 0, n ),
+        KOKKOS_LAMBDA( const T_INT i ) {
+            v( i, 0 ) -= system_vx;
+            v( i, 1 ) -= system_vy;
+            v( i, 2 ) -= system_vz;
+        } );
 
-    for ( T_INT i = 0; i < system->N_local; i++ )
+    // Every replica drifts on its own
+    if ( replicas > 1 )
     {
-        h_v( i, 0 ) -= system_vx;
-        h_v( i, 1 ) -= system_vy;
-        h_v( i, 2 ) -= system_vz;
+        using device_type = typename t_System::device_type;
+        Kokkos::View<T_FLOAT * [4], device_type> replica_sums(
+            "InputFile::replica_momentum", replicas );
+        Kokkos::parallel_for(
+            "InputFile::replica_momentum",
+            Kokkos::RangePolicy<exe_space>( 0, n ),
+            KOKKOS_LAMBDA( const T_INT i ) {
+                const int r = s.replica_of( x( i, 0 ) );
+                T_FLOAT mass_i = mass( type( i ) );
+                for ( int d = 0; d < 3; d++ )
+                    Kokkos::atomic_add( &replica_sums( r, d ),
+                                        mass_i * v( i, d ) );
+                Kokkos::atomic_add( &replica_sums( r, 3 ), mass_i );
+            } );
+        auto host_sums = Kokkos::create_mirror_view_and_copy(
+            Kokkos::HostSpace(), replica_sums );
+        comm->reduce_float( host_sums.data(), 4 * replicas );
+        for ( int r = 0; r < replicas; r++ )
+            for ( int d = 0; d < 3; d++ )
+                host_sums( r, d ) /= host_sums( r, 3 );
+        Kokkos::deep_copy( replica_sums, host_sums );
+        Kokkos::parallel_for(
+            "InputFile::replica_zero_momentum",
+            Kokkos::RangePolicy<exe_space>( 0, n ),
+            KOKKOS_LAMBDA( const T_INT i ) {
+                const int r = s.replica_of( x( i, 0 ) );
+                for ( int d = 0; d < 3; d++ )
+                    v( i, d ) -= replica_sums( r, d );
+            } );
     }
-    // temperature computed on the device
-    system->deep_copy( host_system );
 
+    // temperature computed on the device
     Temperature<t_System> temp( comm );
     T_V_FLOAT T = temp.compute( system );
 
     T_V_FLOAT T_init_scale = sqrt( temperature_target / T );
 
-    for ( T_INT i = 0; i < system->N_local; i++ )
-    {
-        h_v( i, 0 ) *= T_init_scale;
-        h_v( i, 1 ) *= T_init_scale;
-        h_v( i, 2 ) *= T_init_scale;
-    }
-    system->deep_copy( host_system );
+    Kokkos::parallel_for(
+        "InputFile::scale_velocity", Kokkos::RangePolicy<exe_space>( 0, n ),
+        KOKKOS_LAMBDA( const T_INT i ) {
+            v( i, 0 ) *= T_init_scale;
+            v( i, 1 ) *= T_init_scale;
+            v( i, 2 ) *= T_init_scale;
+        } );
+    Kokkos::fence();
 
     out.close();
 }
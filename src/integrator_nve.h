@@ -65,15 +65,28 @@ class Integrator
 
     typename t_System::t_mass_const mass;
 
+    // System slice generation of the cached slices
+    T_INT generation = -1;
+    void slice( t_System *s );
+
     using exe_space = typename t_System::execution_space;
 
   public:
     Integrator( t_System *s );
+    // Explicit step size (inner steps of a multiple time-step run)
+    Integrator( t_System *s, T_V_FLOAT dt );
     ~Integrator() {}
     T_V_FLOAT timestep_size;
+    // Velocity scale applied before the first half (Nose-Hoover)
+    T_V_FLOAT vscale = 1.0;
 
     void initial_integrate( t_System *s );
     void final_integrate( t_System *s );
+    // Second half with the local sum of m*v^2 for thermo output
+    T_V_FLOAT final_integrate_mv2( t_System *s );
+    // Second half of one step and first half of the next in one pass, when
+    // nothing reads the velocities in between
+    void final_initial_integrate( t_System *s );
 
     const char *name();
 
@@ -83,18 +96,24 @@ class Integrator
     struct TagFinal
     {
     };
+    struct TagFinalInitial
+    {
+    };
     typedef Kokkos::RangePolicy<exe_space, TagInitial, Kokkos::IndexType<T_INT>>
         t_policy_initial;
     typedef Kokkos::RangePolicy<exe_space, TagFinal, Kokkos::IndexType<T_INT>>
         t_policy_final;
+    typedef Kokkos::RangePolicy<exe_space, TagFinalInitial,
+                                Kokkos::IndexType<T_INT>>
+        t_policy_final_initial;
 
     KOKKOS_INLINE_FUNCTION
     void operator()( TagInitial, const T_INT &i ) const
     {
         const T_V_FLOAT dtfm = dtf / mass( type( i ) );
-        v( i, 0 ) += dtfm * f( i, 0 );
-        v( i, 1 ) += dtfm * f( i, 1 );
-        v( i, 2 ) += dtfm * f( i, 2 );
+        v( i, 0 ) = vscale * v( i, 0 ) + dtfm * f( i, 0 );
+        v( i, 1 ) = vscale * v( i, 1 ) + dtfm * f( i, 1 );
+        v( i, 2 ) = vscale * v( i, 2 ) + dtfm * f( i, 2 );
         x( i, 0 ) += dtv * v( i, 0 );
         x( i, 1 ) += dtv * v( i, 1 );
         x( i, 2 ) += dtv * v( i, 2 );
@@ -108,6 +127,31 @@ class Integrator
         v( i, 1 ) += dtfm * f( i, 1 );
         v( i, 2 ) += dtfm * f( i, 2 );
     }
+
+    KOKKOS_INLINE_FUNCTION
+    void operator()( TagFinal, const T_INT &i, T_V_FLOAT &mv2 ) const
+    {
+        const T_V_FLOAT m = mass( type( i ) );
+        const T_V_FLOAT dtfm = dtf / m;
+        v( i, 0 ) += dtfm * f( i, 0 );
+        v( i, 1 ) += dtfm * f( i, 1 );
+        v( i, 2 ) += dtfm * f( i, 2 );
+        mv2 += ( v( i, 0 ) * v( i, 0 ) + v( i, 1 ) * v( i, 1 ) +
+                 v( i, 2 ) * v( i, 2 ) ) *
+               m;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    void operator()( TagFinalInitial, const T_INT &i ) const
+    {
+        const T_V_FLOAT dtfm = 2.0 * dtf / mass( type( i ) );
+        v( i, 0 ) += dtfm * f( i, 0 );
+        v( i, 1 ) += dtfm * f( i, 1 );
+        v( i, 2 ) += dtfm * f( i, 2 );
+        x( i, 0 ) += dtv * v( i, 0 );
+        x( i, 1 ) += dtv * v( i, 1 );
+        x( i, 2 ) += dtv * v( i, 2 );
+    }
 };
 
 #include <integrator_nve_impl.h>
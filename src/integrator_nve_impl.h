@@ -54,36 +54,60 @@ Integrator<t_System>::Integrator( t_System *system )
 }
 
 template <class t_System>
-void Integrator<t_System>::initial_integrate( t_System *system )
+Integrator<t_System>::Integrator( t_System *system, T_V_FLOAT dt )
 {
-    mass = system->mass;
+    dtf = 0.5 * dt / system->mvv2e;
+    dtv = dt;
+}
 
+template <class t_System>
+void Integrator<t_System>::slice( t_System *system )
+{
+    if ( generation == system->slice_generation )
+        return;
+
+    mass = system->mass;
     system->slice_integrate();
     x = system->x;
     v = system->v;
     f = system->f;
     type = system->type;
+    generation = system->slice_generation;
+}
 
-    static int step = 1;
+template <class t_System>
+void Integrator<t_System>::initial_integrate( t_System *system )
+{
+    slice( system );
     Kokkos::parallel_for( "IntegratorNVE::initial_integrate",
                           t_policy_initial( 0, system->N_local ), *this );
-    step++;
 }
 
 template <class t_System>
 void Integrator<t_System>::final_integrate( t_System *system )
 {
-    mass = system->mass;
-
-    system->slice_integrate();
-    v = system->v;
-    f = system->f;
-    type = system->type;
-
-    static int step = 1;
+    slice( system );
     Kokkos::parallel_for( "IntegratorNVE::final_integrate",
                           t_policy_final( 0, system->N_local ), *this );
-    step++;
+}
+
+template <class t_System>
+T_V_FLOAT Integrator<t_System>::final_integrate_mv2( t_System *system )
+{
+    slice( system );
+    T_V_FLOAT mv2 = 0.0;
+    Kokkos::parallel_reduce( "IntegratorNVE::final_integrate_mv2",
+                             t_policy_final( 0, system->N_local ), *this,
+                             mv2 );
+    return mv2;
+}
+
+template <class t_System>
+void Integrator<t_System>::final_initial_integrate( t_System *system )
+{
+    slice( system );
+    Kokkos::parallel_for( "IntegratorNVE::final_initial_integrate",
+                          t_policy_final_initial( 0, system->N_local ), *this );
 }
 
 template <class t_System>
@@ -0,0 +1,92 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef INTEGRATOR_NVT_H
+#define INTEGRATOR_NVT_H
+
+#include <Kokkos_Core.hpp>
+#include <Kokkos_Random.hpp>
+
+#include <types.h>
+
+#include <cstdint>
+
+// Nose-Hoover thermostat (single chain element) around the velocity Verlet
+// integrator, as in LAMMPS fix nvt. The temperature of each half step comes
+// from the final integrate reduction (scaled analytically), so there is one
+// reduction per step.
+template <class t_System>
+class ThermostatNoseHoover
+{
+    T_V_FLOAT t_start, t_stop, t_freq;
+    T_V_FLOAT dthalf, dt4;
+    T_V_FLOAT eta_dot, eta_dotdot;
+    T_V_FLOAT t_current, t_target;
+
+    using exe_space = typename t_System::execution_space;
+
+    T_V_FLOAT half_step();
+
+  public:
+    ThermostatNoseHoover( t_System *s, T_V_FLOAT t_start_, T_V_FLOAT t_stop_,
+                          T_V_FLOAT t_damp );
+    ~ThermostatNoseHoover() {}
+
+    void setup( T_V_FLOAT temperature );
+    // Thermostat half step before the first half; returns the velocity
+    // scale for Integrator::vscale. fraction is the run progress (ramp).
+    T_V_FLOAT initial_integrate( T_V_FLOAT fraction );
+    // Thermostat half step after the second half at the given temperature;
+    // scales the velocities and returns the scale
+    T_V_FLOAT final_integrate( t_System *s, T_V_FLOAT temperature );
+
+    // Chain state for restart files; restore before setup()
+    void state( double &eta_dot_, double &eta_dotdot_ ) const;
+    void restore( double eta_dot_, double eta_dotdot_ );
+
+    const char *name() { return "Thermostat:NoseHoover"; }
+};
+
+// Counter based seed: the same atom, step and seed always give the same
+// random stream, independent of the thread count or atom order
+KOKKOS_INLINE_FUNCTION
+uint64_t langevin_hash( uint64_t x )
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = ( x ^ ( x >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+    x = ( x ^ ( x >> 27 ) ) * 0x94d049bb133111ebULL;
+    return x ^ ( x >> 31 );
+}
+
+// Langevin thermostat force (used with fix nve), as in LAMMPS fix langevin
+template <class t_System>
+class ThermostatLangevin
+{
+    T_V_FLOAT t_start, t_stop, t_period;
+    uint64_t seed;
+
+    using device_type = typename t_System::device_type;
+    using exe_space = typename t_System::execution_space;
+
+  public:
+    ThermostatLangevin( t_System *s, T_V_FLOAT t_start_, T_V_FLOAT t_stop_,
+                        T_V_FLOAT t_damp, int seed_ );
+    ~ThermostatLangevin() {}
+
+    // Add drag and random forces to owned atoms after the force compute;
+    // step is absolute (restart aware) so a restarted run draws new noise
+    void post_force( t_System *s, int step, T_V_FLOAT fraction );
+
+    const char *name() { return "Thermostat:Langevin"; }
+};
+
+#include <integrator_nvt_impl.h>
+#endif
@@ -0,0 +1,138 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+template <class t_System>
+ThermostatNoseHoover<t_System>::ThermostatNoseHoover( t_System *system,
+                                                      T_V_FLOAT t_start_,
+                                                      T_V_FLOAT t_stop_,
+                                                      T_V_FLOAT t_damp )
+    : t_start( t_start_ )
+    , t_stop( t_stop_ )
+{
+    t_freq = 1.0 / t_damp;
+    dthalf = 0.5 * system->dt;
+    dt4 = 0.25 * system->dt;
+    eta_dot = 0.0;
+    eta_dotdot = 0.0;
+    t_current = t_start;
+    t_target = t_start;
+}
+
+template <class t_System>
+void ThermostatNoseHoover<t_System>::setup( T_V_FLOAT temperature )
+{
+    t_current = temperature;
+    eta_dotdot = t_freq * t_freq * ( t_current / t_target - 1.0 );
+}
+
+template <class t_System>
+void ThermostatNoseHoover<t_System>::state( double &eta_dot_,
+                                            double &eta_dotdot_ ) const
+{
+    eta_dot_ = eta_dot;
+    eta_dotdot_ = eta_dotdot;
+}
+
+template <class t_System>
+void ThermostatNoseHoover<t_System>::restore( double eta_dot_,
+                                              double eta_dotdot_ )
+{
+    eta_dot = eta_dot_;
+    eta_dotdot = eta_dotdot_;
+}
+
+template <class t_System>
+T_V_FLOAT ThermostatNoseHoover<t_System>::half_step()
+{
+    // eta_mass = dof k T_target / t_freq^2
+    eta_dot += eta_dotdot * dt4;
+    T_V_FLOAT factor = exp( -dthalf * eta_dot );
+    t_current *= factor * factor;
+    eta_dotdot = t_freq * t_freq * ( t_current / t_target - 1.0 );
+    eta_dot += eta_dotdot * dt4;
+    return factor;
+}
+
+template <class t_System>
+T_V_FLOAT
+ThermostatNoseHoover<t_System>::initial_integrate( T_V_FLOAT fraction )
+{
+    t_target = t_start + fraction * ( t_stop - t_start );
+    eta_dotdot = t_freq * t_freq * ( t_current / t_target - 1.0 );
+    return half_step();
+}
+
+template <class t_System>
+T_V_FLOAT ThermostatNoseHoover<t_System>::final_integrate(
+    t_System *system, T_V_FLOAT temperature )
+{
+    t_current = temperature;
+    eta_dotdot = t_freq * t_freq * ( t_current / t_target - 1.0 );
+    T_V_FLOAT factor = half_step();
+
+    system->slice_v();
+    auto v = system->v;
+    Kokkos::parallel_for(
+        "ThermostatNoseHoover::scale",
+        Kokkos::RangePolicy<exe_space>( 0, system->N_local ),
+        KOKKOS_LAMBDA( const int i ) {
+            for ( int d = 0; d < 3; d++ )
+                v( i, d ) *= factor;
+        } );
+    return factor;
+}
+
+template <class t_System>
+ThermostatLangevin<t_System>::ThermostatLangevin( t_System *,
+                                                  T_V_FLOAT t_start_,
+                                                  T_V_FLOAT t_stop_,
+                                                  T_V_FLOAT t_damp, int seed_ )
+    : t_start( t_start_ )
+    , t_stop( t_stop_ )
+    , t_period( t_damp )
+    , seed( seed_ )
+{
+}
+
+template <class t_System>
+void ThermostatLangevin<t_System>::post_force( t_System *system, int step,
+                                               T_V_FLOAT fraction )
+{
+    system->slice_all();
+    auto v = system->v;
+    auto f = system->f;
+    auto type = system->type;
+    auto id = system->id;
+    auto mass = system->mass;
+
+    // Force-time/mass to velocity conversion is 1/mvv2e in all units
+    T_V_FLOAT t_target = t_start + fraction * ( t_stop - t_start );
+    T_V_FLOAT mvv2e = system->mvv2e;
+    T_V_FLOAT drag = mvv2e / t_period;
+    T_V_FLOAT noise = sqrt( 24.0 * system->boltz * t_target / t_period /
+                            system->dt / mvv2e ) *
+                      mvv2e;
+    uint64_t seed_step = langevin_hash( seed ) + step;
+
+    Kokkos::parallel_for(
+        "ThermostatLangevin::post_force",
+        Kokkos::RangePolicy<exe_space>( 0, system->N_local ),
+        KOKKOS_LAMBDA( const int i ) {
+            uint64_t state =
+                langevin_hash( seed_step ^ langevin_hash( id( i ) ) ) | 1;
+            Kokkos::Random_XorShift64<device_type> gen( state );
+            const T_V_FLOAT m = mass( type( i ) );
+            const T_V_FLOAT gamma2 = sqrt( m ) * noise;
+            for ( int d = 0; d < 3; d++ )
+                f( i, d ) +=
+                    -m * drag * v( i, d ) + gamma2 * ( gen.drand() - 0.5 );
+        } );
+}
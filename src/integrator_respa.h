@@ -0,0 +1,55 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef INTEGRATOR_RESPA_H
+#define INTEGRATOR_RESPA_H
+
+#include <Kokkos_Core.hpp>
+
+#include <types.h>
+
+// Two level r-RESPA: the outer (slow) force kicks velocities every outer
+// step, the inner (fast) force is integrated by velocity Verlet with
+// `loop` inner steps. The system force holds the fast force; the slow force
+// of the owned atoms is stored here, so the atom order must not change
+// between the two outer kicks.
+template <class t_System>
+class IntegratorRESPA
+{
+    T_V_FLOAT dtf_outer;
+
+    using device_type = typename t_System::device_type;
+    using exe_space = typename t_System::execution_space;
+    typedef Kokkos::View<T_F_FLOAT * [3], device_type> t_f_store;
+    t_f_store f_fast, f_slow;
+
+  public:
+    int loop;
+    // Outer force is the full potential (inner part subtracted), otherwise
+    // the two forces are added (e.g. LJ baseline plus NNP)
+    bool subtract;
+
+    IntegratorRESPA( t_System *s, int loop_, bool subtract_ );
+    ~IntegratorRESPA() {}
+
+    // Inner step size for the velocity Verlet integrator
+    T_V_FLOAT inner_timestep( t_System *s ) { return s->dt / loop; }
+
+    void outer_kick( t_System *s );
+    void save_fast( t_System *s );
+    void store_slow( t_System *s );
+    void restore_fast( t_System *s );
+
+    const char *name();
+};
+
+#include <integrator_respa_impl.h>
+#endif
@@ -0,0 +1,101 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+template <class t_System>
+IntegratorRESPA<t_System>::IntegratorRESPA( t_System *system, int loop_,
+                                            bool subtract_ )
+    : loop( loop_ )
+    , subtract( subtract_ )
+{
+    dtf_outer = 0.5 * system->dt / system->mvv2e;
+    f_fast = t_f_store( "IntegratorRESPA::f_fast", 0 );
+    f_slow = t_f_store( "IntegratorRESPA::f_slow", 0 );
+}
+
+template <class t_System>
+void IntegratorRESPA<t_System>::outer_kick( t_System *system )
+{
+    auto mass = system->mass;
+    system->slice_integrate();
+    auto v = system->v;
+    auto type = system->type;
+    auto f_slow_copy = f_slow;
+    auto dtf = dtf_outer;
+
+    Kokkos::parallel_for(
+        "IntegratorRESPA::outer_kick",
+        Kokkos::RangePolicy<exe_space>( 0, system->N_local ),
+        KOKKOS_LAMBDA( const int i ) {
+            const T_V_FLOAT dtfm = dtf / mass( type( i ) );
+            for ( int d = 0; d < 3; d++ )
+                v( i, d ) += dtfm * f_slow_copy( i, d );
+        } );
+}
+
+template <class t_System>
+void IntegratorRESPA<t_System>::save_fast( t_System *system )
+{
+    T_INT N_local = system->N_local;
+    if ( f_fast.extent( 0 ) < (std::size_t)N_local )
+    {
+        Kokkos::realloc( f_fast, N_local * 1.1 );
+        Kokkos::realloc( f_slow, N_local * 1.1 );
+    }
+
+    system->slice_f();
+    auto f = system->f;
+    auto f_fast_copy = f_fast;
+    Kokkos::parallel_for(
+        "IntegratorRESPA::save_fast",
+        Kokkos::RangePolicy<exe_space>( 0, N_local ),
+        KOKKOS_LAMBDA( const int i ) {
+            for ( int d = 0; d < 3; d++ )
+                f_fast_copy( i, d ) = f( i, d );
+        } );
+}
+
+template <class t_System>
+void IntegratorRESPA<t_System>::store_slow( t_System *system )
+{
+    system->slice_f();
+    auto f = system->f;
+    auto f_fast_copy = f_fast;
+    auto f_slow_copy = f_slow;
+    T_F_FLOAT scale = subtract ? 1.0 : 0.0;
+    Kokkos::parallel_for(
+        "IntegratorRESPA::store_slow",
+        Kokkos::RangePolicy<exe_space>( 0, system->N_local ),
+        KOKKOS_LAMBDA( const int i ) {
+            for ( int d = 0; d < 3; d++ )
+                f_slow_copy( i, d ) = f( i, d ) - scale * f_fast_copy( i, d );
+        } );
+}
+
+template <class t_System>
+void IntegratorRESPA<t_System>::restore_fast( t_System *system )
+{
+    system->slice_f();
+    auto f = system->f;
+    auto f_fast_copy = f_fast;
+    Kokkos::parallel_for(
+        "IntegratorRESPA::restore_fast",
+        Kokkos::RangePolicy<exe_space>( 0, system->N_local ),
+        KOKKOS_LAMBDA( const int i ) {
+            for ( int d = 0; d < 3; d++ )
+                f( i, d ) = f_fast_copy( i, d );
+        } );
+}
+
+template <class t_System>
+const char *IntegratorRESPA<t_System>::name()
+{
+    return "Integrator:rRESPA";
+}
@@ -0,0 +1,146 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef KSPACE_PPPM_H
+#define KSPACE_PPPM_H
+
+#include <Cabana_Core.hpp>
+#include <Cajita.hpp>
+#include <Kokkos_Core.hpp>
+
+#include <comm_mpi.h>
+#include <pair_kernel.h>
+#include <types.h>
+
+#include <array>
+#include <memory>
+
+// Real space Ewald term (pair_style lj/cut/coul/long): erfc screened
+// Coulomb between charges, pair parameters are the charges themselves
+struct PotentialCoulLong
+{
+    static constexpr bool single_type = false;
+
+    T_F_FLOAT cut_coulsq;
+    T_F_FLOAT g_ewald;
+    T_F_FLOAT qqrd2e;
+
+    KOKKOS_INLINE_FUNCTION
+    T_F_FLOAT cutsq_ij( const T_FLOAT, const T_FLOAT ) const
+    {
+        return cut_coulsq;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    T_F_FLOAT compute_fpair( const T_F_FLOAT rsq, const T_FLOAT q_i,
+                             const T_FLOAT q_j ) const
+    {
+        const T_F_FLOAT r = sqrt( rsq );
+        const T_F_FLOAT grij = g_ewald * r;
+        const T_F_FLOAT prefactor = qqrd2e * q_i * q_j / r;
+        // 2 / sqrt(pi)
+        const T_F_FLOAT forcecoul =
+            prefactor *
+            ( erfc( grij ) + 1.12837916709551 * grij * exp( -grij * grij ) );
+        return forcecoul / rsq;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    T_F_FLOAT compute_energy( const T_F_FLOAT rsq, const T_FLOAT q_i,
+                              const T_FLOAT q_j ) const
+    {
+        const T_F_FLOAT r = sqrt( rsq );
+        return qqrd2e * q_i * q_j * erfc( g_ewald * r ) / r;
+    }
+};
+
+// Long range electrostatics (kspace_style pppm) as a smooth particle mesh
+// Ewald sum on a periodic Cajita mesh: charges are spread with cubic
+// B-splines, convolved with the Ewald influence function through a
+// distributed FFT, and forces are the spline gradients of the resulting
+// potential. The mesh is partitioned like the processor grid of the
+// system, so every rank spreads its own atoms into its own block.
+template <class t_System, class t_Neighbor>
+class PPPM
+{
+  private:
+    using device_type = typename t_System::device_type;
+    using exe_space = typename t_System::execution_space;
+    using memory_space = typename t_System::memory_space;
+
+    using t_mesh = Cajita::UniformMesh<double>;
+    using t_grid = Cajita::LocalGrid<t_mesh>;
+    using t_array = Cajita::Array<double, Cajita::Node, t_mesh, device_type>;
+    using t_halo = Cajita::Halo<double, device_type>;
+    using t_fft = Cajita::Experimental::FastFourierTransform<
+        double, Cajita::Node, t_mesh, device_type>;
+    using t_pair_kernel = PairKernel<t_System, Cabana::TeamOpTag>;
+    using t_field = Kokkos::View<T_F_FLOAT * [3], memory_space>;
+
+    // Cubic B-spline charge assignment
+    static constexpr int spline_order = 3;
+
+    Comm<t_System> *comm;
+
+    T_F_FLOAT cut_coul;
+    T_F_FLOAT qqrd2e;
+    double qsum, qsqsum;
+    T_INT natoms;
+    double volume;
+    std::array<double, 3> prd;
+
+    std::shared_ptr<t_grid> local_grid;
+    // Charge, then potential, per node; complex work array for the FFT
+    std::shared_ptr<t_array> density;
+    std::shared_ptr<t_array> work;
+    std::shared_ptr<t_halo> halo;
+    std::shared_ptr<t_fft> fft;
+    // Influence function per owned node (mode) and potential gradient per
+    // owned atom
+    Kokkos::View<double ***, memory_space> greens;
+    t_field field;
+
+    void setup_mesh( t_System *system, T_X_FLOAT skin );
+    // LAMMPS estimate of the RMS mesh force error along one dimension
+    double mesh_error( int n, double length ) const;
+    void compute_greens();
+    PotentialCoulLong potential() const;
+    void compute_real( t_System *system, t_Neighbor *neighbor );
+    // Spread, convolve, interpolate; with thermo also the mesh energy and
+    // virial
+    void compute_reciprocal( t_System *system, bool thermo );
+
+  public:
+    T_F_FLOAT accuracy;
+    T_F_FLOAT g_ewald;
+    std::array<int, 3> mesh;
+    // Estimated absolute RMS force error of the mesh term
+    T_F_FLOAT estimated_error;
+
+    // Local energy and virial of the last compute_thermo
+    T_FLOAT energy;
+    T_FLOAT virial[6];
+
+    // mesh entries of 0 are picked from the accuracy; atoms move up to skin
+    // beyond their sub domain between exchanges
+    PPPM( t_System *system, Comm<t_System> *comm_, T_F_FLOAT accuracy_,
+          T_F_FLOAT cut_coul_, std::array<int, 3> mesh_, T_X_FLOAT skin );
+
+    // Add the Coulomb forces (real space and mesh) to the short range
+    // forces
+    void compute( t_System *system, t_Neighbor *neighbor );
+    void compute_thermo( t_System *system, t_Neighbor *neighbor );
+
+    const char *name() { return "KSpace:PPPM"; }
+};
+
+#include <kspace_pppm_impl.h>
+#endif
@@ -0,0 +1,408 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#include <profile.h>
+
+#include <cmath>
+
+template <class t_System, class t_Neighbor>
+PPPM<t_System, t_Neighbor>::PPPM( t_System *system, Comm<t_System> *comm_,
+                                  T_F_FLOAT accuracy_, T_F_FLOAT cut_coul_,
+                                  std::array<int, 3> mesh_, T_X_FLOAT skin )
+    : comm( comm_ )
+    , cut_coul( cut_coul_ )
+    , accuracy( accuracy_ )
+    , mesh( mesh_ )
+    , energy( 0.0 )
+{
+    for ( int v = 0; v < 6; v++ )
+        virial[v] = 0.0;
+
+    qqrd2e = system->qqrd2e;
+    prd = {system->global_mesh_x, system->global_mesh_y,
+           system->global_mesh_z};
+    volume = prd[0] * prd[1] * prd[2];
+
+    // Charge sums for the splitting parameter, self energy, and the
+    // neutralizing background
+    system->slice_q();
+    auto q = system->q;
+    T_FLOAT sums[2];
+    Kokkos::parallel_reduce(
+        "PPPM::qsum", Kokkos::RangePolicy<exe_space>( 0, system->N_local ),
+        KOKKOS_LAMBDA( const int i, T_FLOAT &sum ) { sum += q( i ); },
+        sums[0] );
+    Kokkos::parallel_reduce(
+        "PPPM::qsqsum", Kokkos::RangePolicy<exe_space>( 0, system->N_local ),
+        KOKKOS_LAMBDA( const int i, T_FLOAT &sum ) { sum += q( i ) * q( i ); },
+        sums[1] );
+    comm->reduce_float( sums, 2 );
+    qsum = sums[0];
+    qsqsum = sums[1];
+
+    // Real space error estimate of LAMMPS (Kolafa and Perram)
+    natoms = system->N_local;
+    comm->reduce_int( &natoms, 1 );
+    const double acc = accuracy * qqrd2e;
+    const double q2 = qsqsum * qqrd2e;
+    g_ewald = ( 1.35 - 0.15 * log( acc ) ) / cut_coul;
+    if ( q2 > 0.0 )
+    {
+        const double g =
+            acc * sqrt( natoms * cut_coul * volume ) / ( 2.0 * q2 );
+        if ( g < 1.0 )
+            g_ewald = sqrt( -log( g ) ) / cut_coul;
+    }
+
+    setup_mesh( system, skin );
+    compute_greens();
+}
+
+template <class t_System, class t_Neighbor>
+void PPPM<t_System, t_Neighbor>::setup_mesh( t_System *system,
+                                             T_X_FLOAT skin )
+{
+    // As LAMMPS: shrink the mesh spacing from 4 / g_ewald in 5% steps
+    // until the estimated force error is within the accuracy, then size
+    // the mesh for the FFT (factors 2, 3, 5) with at least two points per
+    // rank. Given mesh dimensions are kept.
+    auto factorable = []( int n ) {
+        for ( int f : {2, 3, 5} )
+            while ( n % f == 0 )
+                n /= f;
+        return n == 1;
+    };
+    auto estimate = [&]( const std::array<int, 3> &n ) {
+        double error_sq = 0.0;
+        for ( int d = 0; d < 3; d++ )
+            error_sq += pow( mesh_error( n[d], prd[d] ), 2.0 );
+        return sqrt( error_sq / 3.0 );
+    };
+    const double acc = accuracy * qqrd2e;
+    std::array<int, 3> n;
+    double h = 4.0 / g_ewald;
+    for ( int count = 0;; count++ )
+    {
+        for ( int d = 0; d < 3; d++ )
+            n[d] = mesh[d] > 0 ? mesh[d] : MAX( (int)( prd[d] / h ), 2 );
+        if ( estimate( n ) <= acc )
+            break;
+        if ( count > 500 )
+            log_err( std::cerr, "PPPM: cannot find a mesh for accuracy ",
+                     accuracy );
+        h *= 0.95;
+    }
+    for ( int d = 0; d < 3; d++ )
+    {
+        if ( mesh[d] > 0 )
+            continue;
+        n[d] = MAX( n[d], 2 * system->ranks_per_dim[d] );
+        while ( !factorable( n[d] ) )
+            n[d]++;
+        mesh[d] = n[d];
+    }
+    estimated_error = estimate( mesh );
+
+    // Same process grid (and rank placement) as the atom sub domains
+    const auto &global_grid = system->local_grid->globalGrid();
+    std::array<double, 3> low_corner;
+    std::array<double, 3> high_corner;
+    for ( int d = 0; d < 3; d++ )
+    {
+        low_corner[d] = global_grid.globalMesh().lowCorner( d );
+        high_corner[d] = low_corner[d] + prd[d];
+    }
+    auto global_mesh =
+        Cajita::createUniformGlobalMesh( low_corner, high_corner, mesh );
+    std::array<bool, 3> is_periodic = {true, true, true};
+    Cajita::ManualPartitioner partitioner( system->ranks_per_dim );
+    auto grid = Cajita::createGlobalGrid( global_grid.comm(), global_mesh,
+                                          is_periodic, partitioner );
+
+    // Spline stencil plus the drift of owned atoms out of the sub domain
+    // between exchanges
+    T_X_FLOAT h = prd[0] / mesh[0];
+    for ( int d = 1; d < 3; d++ )
+        h = MIN( h, prd[d] / mesh[d] );
+    const int halo_width = 3 + ceil( skin / h );
+    local_grid = Cajita::createLocalGrid( grid, halo_width );
+
+    auto scalar_layout =
+        Cajita::createArrayLayout( local_grid, 1, Cajita::Node() );
+    auto complex_layout =
+        Cajita::createArrayLayout( local_grid, 2, Cajita::Node() );
+    density = Cajita::createArray<double, device_type>( "PPPM::density",
+                                                        scalar_layout );
+    work = Cajita::createArray<double, device_type>( "PPPM::work",
+                                                     complex_layout );
+    halo = Cajita::createHalo<double, device_type>( *scalar_layout,
+                                                    Cajita::FullHaloPattern() );
+    fft = Cajita::Experimental::createFastFourierTransform<double,
+                                                           device_type>(
+        *complex_layout, Cajita::Experimental::FastFourierTransformParams{} );
+}
+
+template <class t_System, class t_Neighbor>
+double PPPM<t_System, t_Neighbor>::mesh_error( int n, double length ) const
+{
+    // Deserno and Holm for order 4 (cubic B-spline) charge assignment
+    const double acons[4] = {1.0 / 4320.0, 3.0 / 1936.0, 7601.0 / 2271360.0,
+                             143.0 / 28800.0};
+    if ( natoms == 0 )
+        return 0.0;
+    const double hg = length / n * g_ewald;
+    double sum = 0.0;
+    for ( int m = 0; m < 4; m++ )
+        sum += acons[m] * pow( hg, 2.0 * m );
+    const double q2 = qsqsum * qqrd2e;
+    return q2 * pow( hg, 4.0 ) *
+           sqrt( g_ewald * length * sqrt( 2.0 * M_PI ) * sum / natoms ) /
+           ( length * length );
+}
+
+template <class t_System, class t_Neighbor>
+void PPPM<t_System, t_Neighbor>::compute_greens()
+{
+    // Ewald influence function divided by the squared structure factor of
+    // the cubic B-spline, |b(m)|^2 = 1 / ( 2/3 + cos( 2 pi m / K ) / 3 )^2
+    auto own_space = local_grid->indexSpace( Cajita::Own(), Cajita::Node(),
+                                             Cajita::Local() );
+    auto global_space = local_grid->indexSpace( Cajita::Own(), Cajita::Node(),
+                                                Cajita::Global() );
+    greens = Kokkos::View<double ***, memory_space>(
+        "PPPM::greens", own_space.extent( 0 ), own_space.extent( 1 ),
+        own_space.extent( 2 ) );
+
+    auto greens_copy = greens;
+    const int offset[3] = {global_space.min( 0 ), global_space.min( 1 ),
+                           global_space.min( 2 )};
+    const int K[3] = {mesh[0], mesh[1], mesh[2]};
+    const double L[3] = {prd[0], prd[1], prd[2]};
+    const double pi = M_PI;
+    const double prefactor = 4.0 * pi / volume;
+    const double gew_sq4 = 4.0 * g_ewald * g_ewald;
+    Kokkos::parallel_for(
+        "PPPM::greens",
+        Kokkos::MDRangePolicy<exe_space, Kokkos::Rank<3>>(
+            {0, 0, 0}, {greens.extent( 0 ), greens.extent( 1 ),
+                        greens.extent( 2 )} ),
+        KOKKOS_LAMBDA( const int i, const int j, const int k ) {
+            const int g[3] = {offset[0] + i, offset[1] + j, offset[2] + k};
+            double ksq = 0.0;
+            double denom = 1.0;
+            for ( int d = 0; d < 3; d++ )
+            {
+                const int m = g[d] <= K[d] / 2 ? g[d] : g[d] - K[d];
+                const double kd = 2.0 * pi * m / L[d];
+                const double b = 2.0 / 3.0 + cos( 2.0 * pi * m / K[d] ) / 3.0;
+                ksq += kd * kd;
+                denom *= b * b;
+            }
+            greens_copy( i, j, k ) =
+                ksq > 0.0
+                    ? prefactor * exp( -ksq / gew_sq4 ) / ( ksq * denom )
+                    : 0.0;
+        } );
+}
+
+template <class t_System, class t_Neighbor>
+PotentialCoulLong PPPM<t_System, t_Neighbor>::potential() const
+{
+    return {cut_coul * cut_coul, g_ewald, qqrd2e};
+}
+
+template <class t_System, class t_Neighbor>
+void PPPM<t_System, t_Neighbor>::compute_real( t_System *system,
+                                               t_Neighbor *neighbor )
+{
+    system->slice_force();
+    system->slice_q();
+    auto x = system->x;
+    auto f = system->f;
+    auto q = system->q;
+    auto neigh_list = neighbor->get();
+
+    // Team threading sums full list forces atomically on top of the short
+    // range force
+    if ( neighbor->half_neigh )
+        t_pair_kernel::force_half( potential(), f, x, q, neigh_list,
+                                   system->N_local, "PPPM::real" );
+    else
+        t_pair_kernel::force_full( potential(), f, x, q, neigh_list,
+                                   system->N_local, "PPPM::real" );
+}
+
+template <class t_System, class t_Neighbor>
+void PPPM<t_System, t_Neighbor>::compute_reciprocal( t_System *system,
+                                                     bool thermo )
+{
+    const T_INT N_local = system->N_local;
+    system->slice_x();
+    system->slice_f();
+    system->slice_q();
+    auto x = system->x;
+    auto f = system->f;
+    auto q = system->q;
+
+    // Spread the charges (ghost node contributions are summed into their
+    // owners)
+    Cajita::p2g( Cajita::createScalarValueP2G( q, 1.0 ), x, N_local,
+                 Cajita::Spline<spline_order>(), *halo, *density );
+
+    auto own_space = local_grid->indexSpace( Cajita::Own(), Cajita::Node(),
+                                             Cajita::Local() );
+    auto policy = Cajita::createExecutionPolicy( own_space, exe_space() );
+    auto rho = density->view();
+    auto w = work->view();
+    Kokkos::parallel_for(
+        "PPPM::copy_density", policy,
+        KOKKOS_LAMBDA( const int i, const int j, const int k ) {
+            w( i, j, k, 0 ) = rho( i, j, k, 0 );
+            w( i, j, k, 1 ) = 0.0;
+        } );
+    fft->forward( *work, Cajita::Experimental::FFTScaleNone() );
+
+    // Convolve with the influence function; the energy and virial are sums
+    // over the modes
+    auto greens_copy = greens;
+    const int imin[3] = {own_space.min( 0 ), own_space.min( 1 ),
+                         own_space.min( 2 )};
+    if ( thermo )
+    {
+        auto global_space = local_grid->indexSpace(
+            Cajita::Own(), Cajita::Node(), Cajita::Global() );
+        const int offset[3] = {global_space.min( 0 ), global_space.min( 1 ),
+                               global_space.min( 2 )};
+        const int K[3] = {mesh[0], mesh[1], mesh[2]};
+        const double L[3] = {prd[0], prd[1], prd[2]};
+        const double pi = M_PI;
+        const double gew_sq4 = 4.0 * g_ewald * g_ewald;
+        PairThermo mesh_thermo;
+        Kokkos::parallel_reduce(
+            "PPPM::convolve_thermo", policy,
+            KOKKOS_LAMBDA( const int i, const int j, const int k,
+                           PairThermo &sum ) {
+                const int gi = i - imin[0];
+                const int gj = j - imin[1];
+                const int gk = k - imin[2];
+                const int g[3] = {offset[0] + gi, offset[1] + gj,
+                                  offset[2] + gk};
+                double kv[3];
+                double ksq = 0.0;
+                for ( int d = 0; d < 3; d++ )
+                {
+                    const int m = g[d] <= K[d] / 2 ? g[d] : g[d] - K[d];
+                    kv[d] = 2.0 * pi * m / L[d];
+                    ksq += kv[d] * kv[d];
+                }
+                const double psi = greens_copy( gi, gj, gk );
+                const double eng =
+                    psi * ( w( i, j, k, 0 ) * w( i, j, k, 0 ) +
+                            w( i, j, k, 1 ) * w( i, j, k, 1 ) );
+                sum.energy += eng;
+                if ( ksq > 0.0 )
+                {
+                    const double vterm = 2.0 * ( 1.0 / ksq + 1.0 / gew_sq4 );
+                    sum.virial[0] += eng * ( 1.0 - vterm * kv[0] * kv[0] );
+                    sum.virial[1] += eng * ( 1.0 - vterm * kv[1] * kv[1] );
+                    sum.virial[2] += eng * ( 1.0 - vterm * kv[2] * kv[2] );
+                    sum.virial[3] -= eng * vterm * kv[0] * kv[1];
+                    sum.virial[4] -= eng * vterm * kv[0] * kv[2];
+                    sum.virial[5] -= eng * vterm * kv[1] * kv[2];
+                }
+                w( i, j, k, 0 ) *= psi;
+                w( i, j, k, 1 ) *= psi;
+            },
+            mesh_thermo );
+
+        energy = 0.5 * qqrd2e * mesh_thermo.energy;
+        for ( int v = 0; v < 6; v++ )
+            virial[v] = 0.5 * qqrd2e * mesh_thermo.virial[v];
+
+        // Self energy and the neutralizing background, counted once
+        if ( comm->process_rank() == 0 )
+            energy -= qqrd2e * ( g_ewald * qsqsum / sqrt( pi ) +
+                                 pi * qsum * qsum /
+                                     ( 2.0 * volume * g_ewald * g_ewald ) );
+    }
+    else
+    {
+        Kokkos::parallel_for(
+            "PPPM::convolve", policy,
+            KOKKOS_LAMBDA( const int i, const int j, const int k ) {
+                const double psi =
+                    greens_copy( i - imin[0], j - imin[1], k - imin[2] );
+                w( i, j, k, 0 ) *= psi;
+                w( i, j, k, 1 ) *= psi;
+            } );
+    }
+
+    // Potential on the mesh (no 1/N: the influence function is normalized)
+    fft->reverse( *work, Cajita::Experimental::FFTScaleNone() );
+    Kokkos::parallel_for(
+        "PPPM::copy_potential", policy,
+        KOKKOS_LAMBDA( const int i, const int j, const int k ) {
+            rho( i, j, k, 0 ) = w( i, j, k, 0 );
+        } );
+
+    // Interpolate the potential gradient (ghost nodes gathered first)
+    if ( field.extent( 0 ) < (std::size_t)N_local )
+        field = t_field( "PPPM::field", system->N_max );
+    Kokkos::deep_copy( field, 0.0 );
+    Cajita::g2p( *density, *halo, x, N_local, Cajita::Spline<spline_order>(),
+                 Cajita::createScalarGradientG2P( field, 1.0 ) );
+
+    auto field_copy = field;
+    const T_F_FLOAT qqrd2e_copy = qqrd2e;
+    Kokkos::parallel_for(
+        "PPPM::apply_field", Kokkos::RangePolicy<exe_space>( 0, N_local ),
+        KOKKOS_LAMBDA( const int i ) {
+            for ( int d = 0; d < 3; d++ )
+                f( i, d ) -= qqrd2e_copy * q( i ) * field_copy( i, d );
+        } );
+}
+
+template <class t_System, class t_Neighbor>
+void PPPM<t_System, t_Neighbor>::compute( t_System *system,
+                                          t_Neighbor *neighbor )
+{
+    ProfileRegion region( "PPPM::compute" );
+    compute_real( system, neighbor );
+    compute_reciprocal( system, false );
+}
+
+template <class t_System, class t_Neighbor>
+void PPPM<t_System, t_Neighbor>::compute_thermo( t_System *system,
+                                                 t_Neighbor *neighbor )
+{
+    ProfileRegion region( "PPPM::compute_thermo" );
+    system->slice_force();
+    system->slice_q();
+    auto x = system->x;
+    auto f = system->f;
+    auto q = system->q;
+    auto neigh_list = neighbor->get();
+
+    PairThermo thermo;
+    if ( neighbor->half_neigh )
+        thermo = t_pair_kernel::thermo_half( potential(), f, x, q, neigh_list,
+                                             system->N_local, "PPPM::real" );
+    else
+        thermo = t_pair_kernel::thermo_full( potential(), f, x, q, neigh_list,
+                                             system->N_local, "PPPM::real" );
+
+    compute_reciprocal( system, true );
+    Kokkos::fence();
+
+    energy += thermo.energy;
+    for ( int v = 0; v < 6; v++ )
+        virial[v] += thermo.virial[v];
+}
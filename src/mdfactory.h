@@ -69,7 +69,13 @@ class MDfactory
             return createImplTree<t_sys, Cabana::VerletLayout2D>( half_neigh );
         else if ( neigh == NEIGH_TREE_CSR )
             return createImplTree<t_sys, Cabana::VerletLayoutCSR>( half_neigh );
+        else if ( neigh == NEIGH_AUTO )
+            return new CbnMD<t_sys, NeighborAuto<t_sys>>;
 #endif // ArborX
+        else if ( neigh == NEIGH_CELL_CSR )
+            return new CbnMD<t_sys, NeighborCell<t_sys>>;
+        else if ( neigh == NEIGH_CLUSTER )
+            return new CbnMD<t_sys, NeighborCluster<t_sys>>;
         return nullptr;
     }
 
@@ -79,10 +85,31 @@ class MDfactory
         int neigh = commandline.neighbor_type;
         bool half_neigh =
             commandline.force_iteration_type == FORCE_ITER_NEIGH_HALF;
+        int layout = commandline.layout_type;
+        int vector_length = commandline.vector_length;
 
-        return createImplSystem<System<t_device, CabanaMD_LAYOUT>>(
-            neigh, half_neigh );
+        if ( ( layout == 0 || layout == CabanaMD_LAYOUT ) &&
+             vector_length == 0 )
+            return createImplSystem<System<t_device, CabanaMD_LAYOUT>>(
+                neigh, half_neigh );
+        // Only the configured layout is built with the configured vector
+        // lengths; every other layout is a layout:vector_length entry
+        if ( vector_length == 0 )
+            throw std::runtime_error( "--layout other than the configured "
+                                      "CabanaMD_LAYOUT requires "
+                                      "--vector-length (see "
+                                      "CabanaMD_RUNTIME_SYSTEMS)" );
 
+        // Layout and vector length combinations compiled for run time use
+#define CabanaMD_SYSTEM( l, vl )                                               \
+    if ( layout == l && vector_length == vl )                                  \
+        return createImplSystem<System<t_device, l, vl>>( neigh, half_neigh );
+        CabanaMD_RUNTIME_SYSTEMS
+#undef CabanaMD_SYSTEM
+
+        throw std::runtime_error( "CabanaMD not compiled with the requested "
+                                  "layout and vector length "
+                                  "(CabanaMD_RUNTIME_SYSTEMS)" );
         return nullptr;
     }
 
@@ -0,0 +1,209 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#include <device.h>
+#include <memory_usage.h>
+#include <output.h>
+
+#include <Kokkos_Core.hpp>
+
+#include <mpi.h>
+
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+using t_events = Kokkos::Tools::Experimental::EventSet;
+
+struct MemoryUsage
+{
+    double current = 0.0;
+    double high_water = 0.0;
+
+    void add( double bytes )
+    {
+        current += bytes;
+        if ( current > high_water )
+            high_water = current;
+    }
+};
+
+struct MemoryState
+{
+    bool enabled = false;
+    // Callbacks of a loaded tool library, called first
+    t_events tool;
+    // Keyed by "space subsystem" and "space Total"
+    std::map<std::string, MemoryUsage> usage;
+    std::map<const void *, std::pair<std::string, double>> allocations;
+    std::vector<std::string> regions;
+};
+
+MemoryState &memory_state()
+{
+    static MemoryState state;
+    return state;
+}
+
+std::string prefix( const std::string &name )
+{
+    return name.substr( 0, name.find( "::" ) );
+}
+
+void memory_push( const char *name )
+{
+    auto &state = memory_state();
+    if ( state.tool.push_region )
+        state.tool.push_region( name );
+    state.regions.push_back( name );
+}
+
+void memory_pop()
+{
+    auto &state = memory_state();
+    if ( state.tool.pop_region )
+        state.tool.pop_region();
+    if ( !state.regions.empty() )
+        state.regions.pop_back();
+}
+
+void memory_allocate( const Kokkos::Profiling::SpaceHandle space,
+                      const char *label, const void *ptr,
+                      const std::uint64_t size )
+{
+    auto &state = memory_state();
+    if ( state.tool.allocate_data )
+        state.tool.allocate_data( space, label, ptr, size );
+
+    std::string name( label );
+    std::string subsystem;
+    if ( name.find( "::" ) != std::string::npos )
+        subsystem = prefix( name );
+    else if ( !state.regions.empty() )
+        subsystem = prefix( state.regions.front() );
+    else
+        subsystem = "Other";
+    std::string key = std::string( space.name ) + " " + subsystem;
+
+    state.usage[key].add( size );
+    state.usage[std::string( space.name ) + " Total"].add( size );
+    state.allocations[ptr] = std::make_pair( key, 1.0 * size );
+}
+
+void memory_deallocate( const Kokkos::Profiling::SpaceHandle space,
+                        const char *label, const void *ptr,
+                        const std::uint64_t size )
+{
+    auto &state = memory_state();
+    if ( state.tool.deallocate_data )
+        state.tool.deallocate_data( space, label, ptr, size );
+
+    // Allocations from before memory_enable are not known
+    auto a = state.allocations.find( ptr );
+    if ( a == state.allocations.end() )
+        return;
+    state.usage[a->second.first].add( -a->second.second );
+    state.usage[std::string( space.name ) + " Total"].add(
+        -a->second.second );
+    state.allocations.erase( a );
+}
+} // namespace
+
+void memory_enable()
+{
+    auto &state = memory_state();
+    if ( state.enabled )
+        return;
+    state.enabled = true;
+    state.tool = Kokkos::Tools::Experimental::get_callbacks();
+
+    Kokkos::Tools::Experimental::set_push_region_callback( memory_push );
+    Kokkos::Tools::Experimental::set_pop_region_callback( memory_pop );
+    Kokkos::Tools::Experimental::set_allocate_data_callback( memory_allocate );
+    Kokkos::Tools::Experimental::set_deallocate_data_callback(
+        memory_deallocate );
+}
+
+bool memory_enabled() { return memory_state().enabled; }
+
+void memory_report( std::ofstream &out, const std::string &when,
+                    long local_atoms )
+{
+    auto &state = memory_state();
+    if ( !state.enabled )
+        return;
+
+    int size;
+    MPI_Comm_size( MPI_COMM_WORLD, &size );
+
+    // As for the timers, ranks may not see the same subsystems
+    std::string names;
+    for ( auto &u : state.usage )
+        names += u.first + "\n";
+    int length = names.size();
+    MPI_Bcast( &length, 1, MPI_INT, 0, MPI_COMM_WORLD );
+    names.resize( length );
+    MPI_Bcast( &names[0], length, MPI_CHAR, 0, MPI_COMM_WORLD );
+
+    std::vector<std::string> keys;
+    std::vector<double> local;
+    std::istringstream lines( names );
+    for ( std::string key; std::getline( lines, key ); )
+    {
+        auto u = state.usage.find( key );
+        keys.push_back( key );
+        local.push_back( u == state.usage.end() ? 0.0 : u->second.current );
+        local.push_back( u == state.usage.end() ? 0.0
+                                                : u->second.high_water );
+    }
+
+    int n = local.size();
+    std::vector<double> min( n ), max( n ), sum( n );
+    MPI_Reduce( local.data(), min.data(), n, MPI_DOUBLE, MPI_MIN, 0,
+                MPI_COMM_WORLD );
+    MPI_Reduce( local.data(), max.data(), n, MPI_DOUBLE, MPI_MAX, 0,
+                MPI_COMM_WORLD );
+    MPI_Reduce( local.data(), sum.data(), n, MPI_DOUBLE, MPI_SUM, 0,
+                MPI_COMM_WORLD );
+
+    const double mb = 1.0 / ( 1024.0 * 1024.0 );
+    log( out, "\n#Memory ", when, " (MB) | Current Min Avg Max | ",
+         "High-water Min Avg Max | Space Subsystem" );
+    for ( std::size_t k = 0; k < keys.size(); k++ )
+        log( out, std::fixed, std::setprecision( 2 ), min[2 * k] * mb, " ",
+             sum[2 * k] / size * mb, " ", max[2 * k] * mb, " | ",
+             min[2 * k + 1] * mb, " ", sum[2 * k + 1] / size * mb, " ",
+             max[2 * k + 1] * mb, " | ", keys[k] );
+
+    // Linear in the local atoms, so the ghost fraction and fixed tables of
+    // this run are included in the bytes per atom
+    std::string device_space =
+        Kokkos::DefaultExecutionSpace::memory_space::name();
+    auto total = state.usage.find( device_space + " Total" );
+    double per_atom =
+        total != state.usage.end() && local_atoms > 0
+            ? total->second.high_water / local_atoms
+            : 0.0;
+    MPI_Allreduce( MPI_IN_PLACE, &per_atom, 1, MPI_DOUBLE, MPI_MAX,
+                   MPI_COMM_WORLD );
+
+    const double device_bytes = device_memory();
+    if ( per_atom > 0.0 && device_bytes > 0.0 )
+        log( out, std::fixed, std::setprecision( 0 ),
+             "#Memory estimate: ", per_atom, " bytes per local atom in ",
+             device_space, ", ", device_bytes * mb, " MB per device: max ",
+             std::scientific, std::setprecision( 2 ),
+             device_bytes / per_atom, " atoms per device" );
+}
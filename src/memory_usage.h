@@ -0,0 +1,32 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef MEMORY_USAGE_H
+#define MEMORY_USAGE_H
+
+#include <fstream>
+#include <string>
+
+// Kokkos allocations per memory space and subsystem, counted through the
+// Kokkos Tools allocation and region callbacks. A loaded tool library (e.g.
+// memory-events) still sees every event. An allocation belongs to the prefix
+// of its label ("System::x" to System), or else to the outermost open region
+// ("Neighbor::create" to Neighbor).
+void memory_enable();
+bool memory_enabled();
+
+// Current and high-water bytes per subsystem (min/avg/max over ranks of the
+// subsystems seen on rank 0) and the atoms that would fit on a device at the
+// largest device high-water bytes per local atom of any rank
+void memory_report( std::ofstream &out, const std::string &when,
+                    long local_atoms );
+
+#endif
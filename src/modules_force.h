@@ -48,7 +48,9 @@
 
 #include <CabanaMD_config.hpp>
 
+#include <force_eam_cabana_neigh.h>
 #include <force_lj_cabana_neigh.h>
+#include <force_table_cabana_neigh.h>
 
 #ifdef CabanaMD_ENABLE_NNP
 #include <force_nnp_cabana_neigh.h>
@@ -11,8 +11,11 @@
 
 #include <Cabana_Core.hpp>
 
+#include <neighbor_cell.h>
+#include <neighbor_cluster.h>
 #include <neighbor_verlet.h>
 
 #ifdef Cabana_ENABLE_ARBORX
+#include <neighbor_auto.h>
 #include <neighbor_tree.h>
 #endif
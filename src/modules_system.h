@@ -9,10 +9,8 @@
  * SPDX-License-Identifier: BSD-3-Clause                                    *
  ****************************************************************************/
 
-#if ( CabanaMD_LAYOUT == 1 )
+// All layouts: the factory can select any of them at run time
 #include <system_1aosoa.h>
-#elif ( CabanaMD_LAYOUT == 2 )
 #include <system_2aosoa.h>
-#elif ( CabanaMD_LAYOUT == 6 )
+#include <system_3aosoa.h>
 #include <system_6aosoa.h>
-#endif
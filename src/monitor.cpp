@@ -0,0 +1,165 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#include <monitor.h>
+#include <output.h>
+
+#include <mpi.h>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+Monitor::Monitor( std::string path_ )
+    : path( path_ )
+{
+    if ( !print_rank() )
+        return;
+
+    sockaddr_un addr;
+    std::memset( &addr, 0, sizeof( addr ) );
+    addr.sun_family = AF_UNIX;
+    if ( path.size() >= sizeof( addr.sun_path ) )
+        log_err( std::cerr, "Monitor socket path too long: ", path );
+    std::strcpy( addr.sun_path, path.c_str() );
+
+    // A socket left behind by an earlier run is replaced
+    unlink( path.c_str() );
+    fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+    if ( fd < 0 ||
+         bind( fd, reinterpret_cast<sockaddr *>( &addr ), sizeof( addr ) ) ||
+         listen( fd, 16 ) )
+    {
+        if ( fd >= 0 )
+            close( fd );
+        fd = -1;
+        log( std::cerr, "Warning: monitor socket ", path,
+             " could not be opened: ", std::strerror( errno ) );
+        return;
+    }
+    fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) | O_NONBLOCK );
+}
+
+Monitor::~Monitor()
+{
+    for ( auto &client : clients )
+        close( client.fd );
+    if ( fd >= 0 )
+    {
+        close( fd );
+        unlink( path.c_str() );
+    }
+}
+
+MonitorRequest Monitor::poll()
+{
+    MonitorRequest request;
+    if ( fd >= 0 )
+    {
+        int client;
+        while ( (int)clients.size() < max_clients &&
+                ( client = accept( fd, nullptr, nullptr ) ) >= 0 )
+        {
+            fcntl( client, F_SETFL, fcntl( client, F_GETFL ) | O_NONBLOCK );
+            clients.push_back( {client, "", 0} );
+        }
+
+        // Only what has already arrived is read, so no client can stall
+        // the run; incomplete requests wait for the next poll
+        for ( auto c = clients.begin(); c != clients.end(); )
+        {
+            char buffer[256];
+            ssize_t n = -1;
+            while ( c->line.find( '\n' ) == std::string::npos &&
+                    c->line.size() < 1024 &&
+                    ( n = recv( c->fd, buffer, sizeof( buffer ),
+                                MSG_DONTWAIT ) ) > 0 )
+                c->line.append( buffer, n );
+            bool complete = c->line.find( '\n' ) != std::string::npos ||
+                            c->line.size() >= 1024 || n == 0;
+            if ( !complete && ++c->polls < max_polls )
+            {
+                ++c;
+                continue;
+            }
+
+            std::string reply =
+                complete ? handle( c->line.substr( 0, c->line.find( '\n' ) ),
+                                   request )
+                         : "error: no request line received";
+            reply += "\n";
+            send( c->fd, reply.c_str(), reply.size(),
+                  MSG_NOSIGNAL | MSG_DONTWAIT );
+            close( c->fd );
+            c = clients.erase( c );
+        }
+    }
+
+    int data[3] = {request.thermo_rate, request.dumpbinary_rate,
+                   request.checkpoint ? 1 : 0};
+    MPI_Bcast( data, 3, MPI_INT, 0, MPI_COMM_WORLD );
+    request.thermo_rate = data[0];
+    request.dumpbinary_rate = data[1];
+    request.checkpoint = data[2];
+    return request;
+}
+
+std::string Monitor::handle( const std::string &line, MonitorRequest &request )
+{
+    std::istringstream words( line );
+    std::string command;
+    words >> command;
+
+    if ( command.empty() || command == "status" )
+        return format_status();
+    if ( command == "checkpoint" )
+    {
+        request.checkpoint = true;
+        return "ok checkpoint";
+    }
+    if ( command == "thermo" || command == "dumpbinary" )
+    {
+        int rate = 0;
+        if ( !( words >> rate ) || rate <= 0 )
+            return "error: " + command + " needs a positive rate";
+        if ( command == "thermo" )
+            request.thermo_rate = rate;
+        else
+            request.dumpbinary_rate = rate;
+        return "ok " + command + " " + std::to_string( rate );
+    }
+    return "error: unknown command '" + command +
+           "' (status, thermo N, dumpbinary N, checkpoint)";
+}
+
+std::string Monitor::format_status()
+{
+    char buffer[1024];
+    std::snprintf(
+        buffer, sizeof( buffer ),
+        "step=%d thermo_step=%d nsteps=%d atoms=%ld time=%.3f temp=%.6f "
+        "pe=%.6f etotal=%.6f press=%.6f atomsteps_per_s=%.4e t_force=%.3f "
+        "t_neigh=%.3f t_comm=%.3f t_int=%.3f t_other=%.3f thermo=%d "
+        "dumpbinary=%d",
+        status.step, status.thermo_step, status.nsteps, status.natoms,
+        status.time, status.temperature, status.potential_energy,
+        status.total_energy, status.pressure, status.atomsteps_per_sec,
+        status.force_time, status.neigh_time, status.comm_time,
+        status.integrate_time, status.other_time, status.thermo_rate, status.dumpbinary_rate );
+    return buffer;
+}
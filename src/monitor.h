@@ -0,0 +1,89 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef MONITOR_H
+#define MONITOR_H
+
+#include <string>
+#include <vector>
+
+// Latest progress of the run, answered to every monitor connection. The
+// thermo values (temperature to atomsteps_per_sec) belong to thermo_step,
+// the last thermo step whose reduction completed; step is the poll step.
+struct MonitorStatus
+{
+    int step = 0;
+    int thermo_step = 0;
+    int nsteps = 0;
+    long natoms = 0;
+    double time = 0.0;
+    double temperature = 0.0;
+    double potential_energy = 0.0;
+    double total_energy = 0.0;
+    double pressure = 0.0;
+    double atomsteps_per_sec = 0.0;
+    double force_time = 0.0;
+    double neigh_time = 0.0;
+    double comm_time = 0.0;
+    double integrate_time = 0.0;
+    double other_time = 0.0;
+    int thermo_rate = 0;
+    int dumpbinary_rate = 0;
+};
+
+// Changes requested since the last poll; zero rates are unchanged
+struct MonitorRequest
+{
+    int thermo_rate = 0;
+    int dumpbinary_rate = 0;
+    bool checkpoint = false;
+};
+
+// Steering and monitoring through a Unix domain socket of rank 0. Every
+// connection sends one line and gets one line back:
+//   status                 the current MonitorStatus as key=value pairs
+//   thermo N, dumpbinary N change the output rate
+//   checkpoint             write a restart file at the poll step
+// Connections are only served in poll(), so a client waits for the next
+// thermo step at most. Each poll accepts up to max_clients connections and
+// reads without blocking; a client that has not sent its line within
+// max_polls polls gets an error reply.
+class Monitor
+{
+  public:
+    MonitorStatus status;
+
+    Monitor( std::string path );
+    ~Monitor();
+
+    // Collective: rank 0 answers the pending connections and broadcasts
+    // the combined request
+    MonitorRequest poll();
+
+  private:
+    struct Client
+    {
+        int fd;
+        std::string line;
+        int polls;
+    };
+    static constexpr int max_clients = 8;
+    static constexpr int max_polls = 2;
+
+    std::string path;
+    int fd = -1;
+    std::vector<Client> clients;
+
+    std::string format_status();
+    std::string handle( const std::string &line, MonitorRequest &request );
+};
+
+#endif
@@ -49,16 +49,49 @@
 #ifndef NEIGHBOR_H
 #define NEIGHBOR_H
 
+#include <Cabana_Core.hpp>
+#include <Kokkos_Core.hpp>
+
+#include <binning_cabana.h>
+#include <profile.h>
 #include <types.h>
 
+#include <cmath>
+
 template <class t_System>
 class Neighbor
 {
+    using memory_space = typename t_System::memory_space;
+    using exe_space = typename t_System::execution_space;
+
+    // Local atom positions at the last neighbor list build
+    Kokkos::View<T_X_FLOAT * [3], memory_space> x_last;
+
   public:
     T_X_FLOAT neigh_cut;
     bool half_neigh;
     T_INT max_neigh_guess;
 
+    // Local atoms without ghost neighbors (interior) and all others
+    // (boundary), built with the list if requested
+    bool split_interior = false;
+    Kokkos::View<T_INT *, memory_space> interior, boundary;
+    T_INT num_interior = 0;
+    T_INT num_boundary = 0;
+
+    // Neighbor counts of the last build (local atoms). Dense (2D) lists
+    // allocate max_neigh_guess entries for every atom.
+    bool dense_layout = false;
+    T_INT max_neighbors = 0;
+    double mean_neighbors = 0.0;
+
+    // Number of builds, so data derived from the atom order can be kept
+    // until the next rebuild
+    T_INT num_builds = 0;
+
+    // Binning of the run, for lists built from its persistent cells
+    Binning<t_System> *binning = nullptr;
+
     Neighbor();
     Neighbor( T_X_FLOAT neigh_cut_, bool half_neigh_,
               T_INT max_neigh_guess_ = 0 )
@@ -71,6 +104,124 @@ class Neighbor
 
     virtual void create( t_System *system ) = 0;
 
+    template <class t_list>
+    void build_interior( const t_list &list, const T_INT N_local )
+    {
+        ProfileRegion region( "interior" );
+        if ( interior.extent( 0 ) < (std::size_t)N_local )
+        {
+            Kokkos::realloc( interior, N_local );
+            Kokkos::realloc( boundary, N_local );
+        }
+        auto interior_copy = interior;
+        auto boundary_copy = boundary;
+
+        T_INT count = 0;
+        Kokkos::parallel_scan(
+            "Neighbor::build_interior",
+            Kokkos::RangePolicy<exe_space>( 0, N_local ),
+            KOKKOS_LAMBDA( const int i, T_INT &num, const bool final ) {
+                bool ghost = false;
+                const int num_n =
+                    Cabana::NeighborList<t_list>::numNeighbor( list, i );
+                for ( int n = 0; n < num_n; n++ )
+                    if ( Cabana::NeighborList<t_list>::getNeighbor(
+                             list, i, n ) >= N_local )
+                        ghost = true;
+
+                if ( !ghost )
+                {
+                    if ( final )
+                        interior_copy( num ) = i;
+                    num++;
+                }
+                else if ( final )
+                    boundary_copy( i - num ) = i;
+            },
+            count );
+        num_interior = count;
+        num_boundary = N_local - count;
+    }
+
+    // Track the neighbor count distribution and size the next build: grow
+    // past the largest count, and shrink once the capacity is more than
+    // twice what is needed
+    template <class t_list>
+    void update_capacity( const t_list &list, const T_INT N_local )
+    {
+        ProfileRegion region( "capacity" );
+        T_INT max_n = 0;
+        T_INT sum_n = 0;
+        Kokkos::parallel_reduce(
+            "Neighbor::max_neighbors",
+            Kokkos::RangePolicy<exe_space>( 0, N_local ),
+            KOKKOS_LAMBDA( const int i, T_INT &max_i ) {
+                const T_INT num_n =
+                    Cabana::NeighborList<t_list>::numNeighbor( list, i );
+                if ( num_n > max_i )
+                    max_i = num_n;
+            },
+            Kokkos::Max<T_INT>( max_n ) );
+        Kokkos::parallel_reduce(
+            "Neighbor::sum_neighbors",
+            Kokkos::RangePolicy<exe_space>( 0, N_local ),
+            KOKKOS_LAMBDA( const int i, T_INT &sum_i ) {
+                sum_i += Cabana::NeighborList<t_list>::numNeighbor( list, i );
+            },
+            sum_n );
+        max_neighbors = max_n;
+        mean_neighbors = N_local > 0 ? 1.0 * sum_n / N_local : 0.0;
+
+        T_INT need = max_n * 1.1 + 1;
+        if ( max_n > max_neigh_guess || max_neigh_guess > 2 * need )
+            max_neigh_guess = need;
+    }
+
+    // Store local positions as the reference for displacement checks
+    void store_positions( t_System *system )
+    {
+        T_INT N_local = system->N_local;
+        if ( x_last.extent( 0 ) < (std::size_t)N_local )
+            Kokkos::realloc( x_last, N_local );
+
+        system->slice_x();
+        auto x = system->x;
+        auto x_last_copy = x_last;
+        Kokkos::parallel_for(
+            "Neighbor::store_positions",
+            Kokkos::RangePolicy<exe_space>( 0, N_local ),
+            KOKKOS_LAMBDA( const int i ) {
+                for ( int d = 0; d < 3; d++ )
+                    x_last_copy( i, d ) = x( i, d );
+            } );
+    }
+
+    // Largest local displacement since store_positions (not reduced)
+    T_X_FLOAT max_displacement( t_System *system )
+    {
+        T_INT N_local = system->N_local;
+
+        system->slice_x();
+        auto x = system->x;
+        auto x_last_copy = x_last;
+        T_X_FLOAT max_dsq = 0.0;
+        Kokkos::parallel_reduce(
+            "Neighbor::max_displacement",
+            Kokkos::RangePolicy<exe_space>( 0, N_local ),
+            KOKKOS_LAMBDA( const int i, T_X_FLOAT &max_i ) {
+                T_X_FLOAT dsq = 0.0;
+                for ( int d = 0; d < 3; d++ )
+                {
+                    const T_X_FLOAT dx = x( i, d ) - x_last_copy( i, d );
+                    dsq += dx * dx;
+                }
+                if ( dsq > max_i )
+                    max_i = dsq;
+            },
+            Kokkos::Max<T_X_FLOAT>( max_dsq ) );
+        return sqrt( max_dsq );
+    }
+
     virtual const char *name() { return "Neighbor:None"; };
 };
 
@@ -0,0 +1,153 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef NEIGHBOR_AUTO_H
+#define NEIGHBOR_AUTO_H
+
+#include <Cabana_Core.hpp>
+#include <Kokkos_Core.hpp>
+
+#include <neighbor.h>
+#include <neighbor_cell.h>
+#include <neighbor_tree.h>
+#include <types.h>
+
+#include <cmath>
+
+// Cell or tree search, chosen at every build from the spread of the local
+// atom counts over the bins of the sort. Uniform systems use the cell
+// search; porous or vacuum heavy systems, where most bins are empty or
+// crowded, use the tree search. Both give the CSR of the cell lists.
+template <class t_System>
+class NeighborAuto : public Neighbor<t_System>
+{
+    using device_type = typename t_System::device_type;
+    using memory_space = typename t_System::memory_space;
+    using exe_space = typename t_System::execution_space;
+
+  public:
+    T_X_FLOAT neigh_cut;
+    bool half_neigh;
+
+    // Coefficient of variation of the bin counts above which the tree
+    // search is used, and the value measured at the last build
+    T_X_FLOAT max_variation = 1.0;
+    T_X_FLOAT variation = 0.0;
+    bool use_tree = false;
+
+    using t_neigh_list = CellNeighborList<memory_space>;
+
+    NeighborAuto( T_X_FLOAT neigh_cut_, bool half_neigh_,
+                  T_INT max_neigh_guess_ )
+        : Neighbor<t_System>( neigh_cut_, half_neigh_, max_neigh_guess_ )
+        , neigh_cut( neigh_cut_ )
+        , half_neigh( half_neigh_ )
+        , cell( neigh_cut_, half_neigh_, max_neigh_guess_ )
+    {
+    }
+
+    void create( t_System *system ) override
+    {
+        this->num_builds++;
+        T_INT N_local = system->N_local;
+        auto binning = this->binning;
+
+        // Without the sorted bins the cell search is not possible
+        use_tree = true;
+        if ( binning != nullptr && binning->sorted )
+        {
+            variation = bin_variation( binning->cell_list, binning->nhalo );
+            use_tree = variation > max_variation;
+        }
+
+        if ( use_tree )
+        {
+            system->slice_x();
+            auto x = system->x;
+            profile_push( "build" );
+            auto full = Cabana::Experimental::makeNeighborList<device_type>(
+                Cabana::FullNeighborTag(), x, 0, N_local, neigh_cut,
+                this->max_neigh_guess );
+            tree_to_cell_list<exe_space>( full, N_local, half_neigh,
+                                          tree_list );
+            profile_pop();
+            this->update_capacity( tree_list, N_local );
+            tree_list.max_neighbors = this->max_neighbors;
+        }
+        else
+        {
+            cell.binning = binning;
+            cell.create( system );
+            this->max_neighbors = cell.max_neighbors;
+            this->mean_neighbors = cell.mean_neighbors;
+            this->max_neigh_guess = cell.max_neigh_guess;
+        }
+
+        if ( this->split_interior )
+            this->build_interior( get(), N_local );
+    }
+
+    t_neigh_list &get() { return use_tree ? tree_list : cell.get(); }
+
+    const char *name() override
+    {
+        return half_neigh ? "Neighbor:AutoHalf" : "Neighbor:AutoFull";
+    }
+
+  private:
+    NeighborCell<t_System> cell;
+    t_neigh_list tree_list;
+
+    // Standard deviation over mean of the atom counts of the inner bins
+    template <class t_bins>
+    T_X_FLOAT bin_variation( const t_bins &bins, const int nhalo )
+    {
+        const int nx = bins.numBin( 0 );
+        const int ny = bins.numBin( 1 );
+        const int nz = bins.numBin( 2 );
+        const T_INT num = ( nx - 2 * nhalo ) * ( ny - 2 * nhalo ) *
+                          ( nz - 2 * nhalo );
+        double sum = 0.0;
+        double sum_sq = 0.0;
+        Kokkos::parallel_reduce(
+            "NeighborAuto::bin_sum",
+            Kokkos::RangePolicy<exe_space>( 0, bins.totalBins() ),
+            KOKKOS_LAMBDA( const int b, double &s ) {
+                int i, j, k;
+                bins.ijkBinIndex( b, i, j, k );
+                if ( i >= nhalo && i < nx - nhalo && j >= nhalo &&
+                     j < ny - nhalo && k >= nhalo && k < nz - nhalo )
+                    s += bins.binSize( i, j, k );
+            },
+            sum );
+        Kokkos::parallel_reduce(
+            "NeighborAuto::bin_sum_sq",
+            Kokkos::RangePolicy<exe_space>( 0, bins.totalBins() ),
+            KOKKOS_LAMBDA( const int b, double &s_sq ) {
+                int i, j, k;
+                bins.ijkBinIndex( b, i, j, k );
+                if ( i >= nhalo && i < nx - nhalo && j >= nhalo &&
+                     j < ny - nhalo && k >= nhalo && k < nz - nhalo )
+                {
+                    const double count = bins.binSize( i, j, k );
+                    s_sq += count * count;
+                }
+            },
+            sum_sq );
+        if ( num <= 0 || sum == 0.0 )
+            return 0.0;
+        const double mean = sum / num;
+        const double var = sum_sq / num - mean * mean;
+        return var > 0.0 ? std::sqrt( var ) / mean : 0.0;
+    }
+};
+
+#endif
@@ -0,0 +1,238 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef NEIGHBOR_CELL_H
+#define NEIGHBOR_CELL_H
+
+#include <Cabana_Core.hpp>
+#include <Kokkos_Core.hpp>
+
+#include <neighbor.h>
+#include <output.h>
+#include <types.h>
+
+// Compressed (CSR) neighbor list of the local atoms
+template <class MemorySpace>
+struct CellNeighborList
+{
+    Kokkos::View<T_INT *, MemorySpace> counts;
+    Kokkos::View<T_INT *, MemorySpace> offsets;
+    Kokkos::View<T_INT *, MemorySpace> neighbors;
+    T_INT max_neighbors = 0;
+};
+
+namespace Cabana
+{
+template <class MemorySpace>
+class NeighborList<CellNeighborList<MemorySpace>>
+{
+  public:
+    using memory_space = MemorySpace;
+    using list_type = CellNeighborList<MemorySpace>;
+
+    KOKKOS_INLINE_FUNCTION
+    static std::size_t maxNeighbor( const list_type &list )
+    {
+        return list.max_neighbors;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static std::size_t numNeighbor( const list_type &list,
+                                    const std::size_t particle_index )
+    {
+        return list.counts( particle_index );
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static std::size_t getNeighbor( const list_type &list,
+                                    const std::size_t particle_index,
+                                    const std::size_t neighbor_index )
+    {
+        return list.neighbors( list.offsets( particle_index ) +
+                               neighbor_index );
+    }
+};
+} // namespace Cabana
+
+// Search of the 27 surrounding bins for every local atom of a bin, with one
+// team per bin and one thread per atom of the bin. Local atoms are already
+// sorted by bin; ghosts go through their bin permutation.
+template <class t_exe, class t_x, class t_bins, class t_view>
+struct NeighborCellSearch
+{
+    using t_member = typename Kokkos::TeamPolicy<t_exe>::member_type;
+
+    t_x x;
+    t_bins local_bins, ghost_bins;
+    t_view counts, offsets, neighbors;
+    T_X_FLOAT cutsq;
+    bool half, fill;
+
+    KOKKOS_INLINE_FUNCTION
+    void add( const int a, const int b, T_INT &count ) const
+    {
+        const T_X_FLOAT dx = x( a, 0 ) - x( b, 0 );
+        const T_X_FLOAT dy = x( a, 1 ) - x( b, 1 );
+        const T_X_FLOAT dz = x( a, 2 ) - x( b, 2 );
+        if ( dx * dx + dy * dy + dz * dz < cutsq )
+        {
+            if ( fill )
+                neighbors( offsets( a ) + count ) = b;
+            count++;
+        }
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    void operator()( const t_member &team ) const
+    {
+        const int bin = team.league_rank();
+        int ib, jb, kb;
+        local_bins.ijkBinIndex( bin, ib, jb, kb );
+        const int a_begin = local_bins.binOffset( ib, jb, kb );
+        const int a_end = a_begin + local_bins.binSize( ib, jb, kb );
+
+        const int i_min = ib > 0 ? ib - 1 : 0;
+        const int j_min = jb > 0 ? jb - 1 : 0;
+        const int k_min = kb > 0 ? kb - 1 : 0;
+        const int i_max = ib + 1 < local_bins.numBin( 0 ) ? ib + 1 : ib;
+        const int j_max = jb + 1 < local_bins.numBin( 1 ) ? jb + 1 : jb;
+        const int k_max = kb + 1 < local_bins.numBin( 2 ) ? kb + 1 : kb;
+
+        Kokkos::parallel_for(
+            Kokkos::TeamThreadRange( team, a_begin, a_end ),
+            [&]( const int a ) {
+                T_INT count = 0;
+                for ( int i = i_min; i <= i_max; i++ )
+                    for ( int j = j_min; j <= j_max; j++ )
+                        for ( int k = k_min; k <= k_max; k++ )
+                        {
+                            const int b_begin =
+                                local_bins.binOffset( i, j, k );
+                            const int b_end =
+                                b_begin + local_bins.binSize( i, j, k );
+                            for ( int b = b_begin; b < b_end; b++ )
+                                if ( b != a && !( half && b < a ) )
+                                    add( a, b, count );
+
+                            const int g_begin =
+                                ghost_bins.binOffset( i, j, k );
+                            const int g_end =
+                                g_begin + ghost_bins.binSize( i, j, k );
+                            for ( int g = g_begin; g < g_end; g++ )
+                                add( a, ghost_bins.permutation( g ), count );
+                        }
+                if ( !fill )
+                    counts( a ) = count;
+            } );
+    }
+};
+
+template <class t_System>
+class NeighborCell : public Neighbor<t_System>
+{
+    using device_type = typename t_System::device_type;
+    using memory_space = typename t_System::memory_space;
+    using exe_space = typename t_System::execution_space;
+
+  public:
+    T_X_FLOAT neigh_cut;
+    bool half_neigh;
+
+    using t_neigh_list = CellNeighborList<memory_space>;
+
+    NeighborCell( T_X_FLOAT neigh_cut_, bool half_neigh_,
+                  T_INT max_neigh_guess_ )
+        : Neighbor<t_System>( neigh_cut_, half_neigh_, max_neigh_guess_ )
+        , neigh_cut( neigh_cut_ )
+        , half_neigh( half_neigh_ )
+    {
+    }
+
+    void create( t_System *system ) override
+    {
+        this->num_builds++;
+        T_INT N_local = system->N_local;
+        auto binning = this->binning;
+        if ( binning == nullptr || !binning->sorted )
+        {
+            log_err( std::cout, "Neighbor:Cell needs atoms sorted by the "
+                                "Binning before the list is built" );
+            return;
+        }
+
+        // Only the ghosts still need binning; use the grid of the sort
+        binning->create_binning( neigh_cut, neigh_cut, neigh_cut,
+                                 binning->nhalo, false, true, false );
+
+        if ( list.counts.extent( 0 ) < (std::size_t)N_local )
+        {
+            Kokkos::realloc( list.counts, N_local * 1.1 );
+            Kokkos::realloc( list.offsets, N_local * 1.1 );
+        }
+
+        system->slice_x();
+        using t_x = decltype( system->x );
+        using t_bins = Cabana::LinkedCellList<device_type>;
+        using t_view = Kokkos::View<T_INT *, memory_space>;
+        NeighborCellSearch<exe_space, t_x, t_bins, t_view> search;
+        search.x = system->x;
+        search.local_bins = binning->cell_list;
+        search.ghost_bins = binning->ghost_cell_list;
+        search.counts = list.counts;
+        search.offsets = list.offsets;
+        search.cutsq = neigh_cut * neigh_cut;
+        search.half = half_neigh;
+        search.fill = false;
+        const int num_bins = binning->cell_list.totalBins();
+        Kokkos::TeamPolicy<exe_space> policy( num_bins, Kokkos::AUTO );
+
+        profile_push( "build" );
+        Kokkos::parallel_for( "NeighborCell::count", policy, search );
+
+        auto counts = list.counts;
+        auto offsets = list.offsets;
+        T_INT total = 0;
+        Kokkos::parallel_scan(
+            "NeighborCell::offsets",
+            Kokkos::RangePolicy<exe_space>( 0, N_local ),
+            KOKKOS_LAMBDA( const int i, T_INT &sum, const bool final ) {
+                if ( final )
+                    offsets( i ) = sum;
+                sum += counts( i );
+            },
+            total );
+
+        if ( list.neighbors.extent( 0 ) < (std::size_t)total )
+            Kokkos::realloc( list.neighbors, total * 1.1 );
+        search.neighbors = list.neighbors;
+        search.fill = true;
+        Kokkos::parallel_for( "NeighborCell::fill", policy, search );
+        profile_pop();
+
+        this->update_capacity( list, N_local );
+        list.max_neighbors = this->max_neighbors;
+
+        if ( this->split_interior )
+            this->build_interior( list, N_local );
+    }
+
+    t_neigh_list &get() { return list; }
+
+    const char *name() override
+    {
+        return half_neigh ? "Neighbor:CellHalf" : "Neighbor:CellFull";
+    }
+
+  private:
+    t_neigh_list list;
+};
+
+#endif
@@ -0,0 +1,380 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef NEIGHBOR_CLUSTER_H
+#define NEIGHBOR_CLUSTER_H
+
+#include <CabanaMD_config.hpp>
+
+#include <Cabana_Core.hpp>
+#include <Kokkos_Core.hpp>
+
+#include <neighbor.h>
+#include <neighbor_cell.h>
+#include <types.h>
+
+#include <cmath>
+
+// Atoms per cluster, matched to the system vector length
+#if defined( CabanaMD_VECTORLENGTH_0 ) && CabanaMD_VECTORLENGTH_0 >= 8
+#define CabanaMD_CLUSTERSIZE 8
+#else
+#define CabanaMD_CLUSTERSIZE 4
+#endif
+
+// Cluster c holds atoms [c * size, (c + 1) * size) of the local and ghost
+// range. Each local (i) cluster lists the clusters (j) whose bounding boxes
+// are within the cutoff. The atom pairs are also kept in CSR form for
+// kernels that iterate per atom. Clusters wider than half the cutoff (e.g.
+// ones spanning periodic images) are tested against every i cluster
+// directly, so they do not widen the bin stencil of the others.
+template <class MemorySpace>
+struct ClusterNeighborList : public CellNeighborList<MemorySpace>
+{
+    static constexpr int size = CabanaMD_CLUSTERSIZE;
+
+    T_INT num_local = 0; // Owned atoms; i clusters only cover these
+    T_INT num_total = 0; // Owned and ghost atoms
+    Kokkos::View<T_INT *, MemorySpace> cluster_counts;
+    Kokkos::View<T_INT *, MemorySpace> cluster_offsets;
+    Kokkos::View<T_INT *, MemorySpace> cluster_neighbors;
+};
+
+namespace Cabana
+{
+template <class MemorySpace>
+class NeighborList<ClusterNeighborList<MemorySpace>>
+    : public NeighborList<CellNeighborList<MemorySpace>>
+{
+  public:
+    using memory_space = MemorySpace;
+    using list_type = ClusterNeighborList<MemorySpace>;
+};
+} // namespace Cabana
+
+template <class t_System>
+class NeighborCluster : public Neighbor<t_System>
+{
+    using device_type = typename t_System::device_type;
+    using memory_space = typename t_System::memory_space;
+    using exe_space = typename t_System::execution_space;
+
+    using t_centers =
+        Cabana::AoSoA<Cabana::MemberTypes<T_X_FLOAT[3]>, device_type>;
+
+    Kokkos::View<T_X_FLOAT * [6], memory_space> bbox;
+    Kokkos::View<T_X_FLOAT *, memory_space> radius;
+    Kokkos::View<T_INT *, memory_space> large;
+    t_centers centers;
+
+  public:
+    T_X_FLOAT neigh_cut;
+    bool half_neigh;
+
+    using t_neigh_list = ClusterNeighborList<memory_space>;
+    using t_view = Kokkos::View<T_INT *, memory_space>;
+
+    NeighborCluster( T_X_FLOAT neigh_cut_, bool half_neigh_,
+                     T_INT max_neigh_guess_ )
+        : Neighbor<t_System>( neigh_cut_, half_neigh_, max_neigh_guess_ )
+        , neigh_cut( neigh_cut_ )
+        , half_neigh( half_neigh_ )
+    {
+    }
+
+    void create( t_System *system ) override
+    {
+        this->num_builds++;
+        const int size = t_neigh_list::size;
+        T_INT N_local = system->N_local;
+        T_INT N_total = N_local + system->N_ghost;
+        T_INT num_i = ( N_local + size - 1 ) / size;
+        T_INT num_j = ( N_total + size - 1 ) / size;
+        list.num_local = N_local;
+        list.num_total = N_total;
+
+        system->slice_x();
+        auto x = system->x;
+
+        // Cluster bounding boxes, centers and radii
+        if ( bbox.extent( 0 ) < (std::size_t)num_j )
+        {
+            Kokkos::realloc( bbox, num_j * 1.1 );
+            Kokkos::realloc( radius, num_j * 1.1 );
+            Kokkos::realloc( large, num_j * 1.1 );
+        }
+        centers.resize( num_j );
+        auto bbox_copy = bbox;
+        auto radius_copy = radius;
+        auto center = Cabana::slice<0>( centers );
+        Kokkos::parallel_for(
+            "NeighborCluster::bbox", Kokkos::RangePolicy<exe_space>( 0, num_j ),
+            KOKKOS_LAMBDA( const int c ) {
+                const int end =
+                    ( c + 1 ) * size < N_total ? ( c + 1 ) * size : N_total;
+                T_X_FLOAT r = 0.0;
+                for ( int d = 0; d < 3; d++ )
+                {
+                    T_X_FLOAT lo = x( c * size, d );
+                    T_X_FLOAT hi = lo;
+                    for ( int a = c * size + 1; a < end; a++ )
+                    {
+                        lo = x( a, d ) < lo ? x( a, d ) : lo;
+                        hi = x( a, d ) > hi ? x( a, d ) : hi;
+                    }
+                    bbox_copy( c, d ) = lo;
+                    bbox_copy( c, d + 3 ) = hi;
+                    center( c, d ) = 0.5 * ( lo + hi );
+                    r += 0.25 * ( hi - lo ) * ( hi - lo );
+                }
+                radius_copy( c ) = sqrt( r );
+            } );
+
+        // Clusters beyond the stencil radius bound are searched directly
+        const T_X_FLOAT max_radius = 0.5 * neigh_cut;
+        auto large_copy = large;
+        T_INT num_large = 0;
+        Kokkos::parallel_scan(
+            "NeighborCluster::large",
+            Kokkos::RangePolicy<exe_space>( 0, num_j ),
+            KOKKOS_LAMBDA( const int c, T_INT &num, const bool final ) {
+                if ( radius_copy( c ) > max_radius )
+                {
+                    if ( final )
+                        large_copy( num ) = c;
+                    num++;
+                }
+            },
+            num_large );
+
+        // Bin the cluster centers over the ghost mesh, in whole cells
+        T_X_FLOAT delta[3] = {neigh_cut, neigh_cut, neigh_cut};
+        const double grid_lo[3] = {system->ghost_mesh_lo_x,
+                                   system->ghost_mesh_lo_y,
+                                   system->ghost_mesh_lo_z};
+        const double grid_hi[3] = {system->ghost_mesh_hi_x,
+                                   system->ghost_mesh_hi_y,
+                                   system->ghost_mesh_hi_z};
+        T_X_FLOAT grid_min[3], grid_max[3];
+        for ( int d = 0; d < 3; d++ )
+        {
+            grid_min[d] = grid_lo[d];
+            grid_max[d] =
+                grid_lo[d] +
+                delta[d] * std::ceil( ( grid_hi[d] - grid_lo[d] ) / delta[d] );
+        }
+        Cabana::LinkedCellList<device_type> bins( center, delta, grid_min,
+                                                  grid_max );
+
+        if ( list.cluster_counts.extent( 0 ) < (std::size_t)num_i )
+        {
+            Kokkos::realloc( list.cluster_counts, num_i * 1.1 );
+            Kokkos::realloc( list.cluster_offsets, num_i * 1.1 );
+        }
+        if ( list.counts.extent( 0 ) < (std::size_t)N_local )
+        {
+            Kokkos::realloc( list.counts, N_local * 1.1 );
+            Kokkos::realloc( list.offsets, N_local * 1.1 );
+        }
+
+        // Cluster pairs: count, offsets, fill
+        search_clusters( bins, grid_min, max_radius, num_i, num_large, false );
+        T_INT total = scan( list.cluster_counts, list.cluster_offsets, num_i );
+        if ( list.cluster_neighbors.extent( 0 ) < (std::size_t)total )
+            Kokkos::realloc( list.cluster_neighbors, total * 1.1 );
+        search_clusters( bins, grid_min, max_radius, num_i, num_large, true );
+
+        // Atom pairs from the cluster pairs
+        search_atoms( x, N_local, false );
+        total = scan( list.counts, list.offsets, N_local );
+        if ( list.neighbors.extent( 0 ) < (std::size_t)total )
+            Kokkos::realloc( list.neighbors, total * 1.1 );
+        search_atoms( x, N_local, true );
+
+        this->update_capacity( list, N_local );
+        list.max_neighbors = this->max_neighbors;
+
+        if ( this->split_interior )
+            this->build_interior( list, N_local );
+    }
+
+    // Squared gap between the bounding boxes of clusters ci and cj
+    template <class t_bbox>
+    KOKKOS_INLINE_FUNCTION static T_X_FLOAT
+    gap_sq( const t_bbox bbox, const int ci, const int cj )
+    {
+        T_X_FLOAT rsq = 0.0;
+        for ( int d = 0; d < 3; d++ )
+        {
+            T_X_FLOAT gap = bbox( cj, d ) - bbox( ci, d + 3 );
+            if ( gap < 0.0 )
+                gap = bbox( ci, d ) - bbox( cj, d + 3 );
+            if ( gap > 0.0 )
+                rsq += gap * gap;
+        }
+        return rsq;
+    }
+
+    // j clusters with bounding boxes within the cutoff of each i cluster:
+    // clusters up to max_radius wide are searched in the bins within reach
+    // of the i cluster center (a reach that grows with the i cluster only),
+    // and the larger ones are all tested
+    void search_clusters( const Cabana::LinkedCellList<device_type> bins,
+                          const T_X_FLOAT grid_min[3],
+                          const T_X_FLOAT max_radius, const T_INT num_i,
+                          const T_INT num_large, const bool fill )
+    {
+        auto bbox_copy = bbox;
+        auto radius_copy = radius;
+        auto large_copy = large;
+        auto center = Cabana::slice<0>( centers );
+        auto counts = list.cluster_counts;
+        auto offsets = list.cluster_offsets;
+        auto neighbors = list.cluster_neighbors;
+        const T_X_FLOAT cutsq = neigh_cut * neigh_cut;
+        const T_X_FLOAT lo_x = grid_min[0];
+        const T_X_FLOAT lo_y = grid_min[1];
+        const T_X_FLOAT lo_z = grid_min[2];
+        const T_X_FLOAT dx = neigh_cut;
+        const int nx = bins.numBin( 0 );
+        const int ny = bins.numBin( 1 );
+        const int nz = bins.numBin( 2 );
+
+        Kokkos::parallel_for(
+            "NeighborCluster::search_clusters",
+            Kokkos::RangePolicy<exe_space>( 0, num_i ),
+            KOKKOS_LAMBDA( const int ci ) {
+                int ib = ( center( ci, 0 ) - lo_x ) / dx;
+                int jb = ( center( ci, 1 ) - lo_y ) / dx;
+                int kb = ( center( ci, 2 ) - lo_z ) / dx;
+                ib = ib < 0 ? 0 : ib >= nx ? nx - 1 : ib;
+                jb = jb < 0 ? 0 : jb >= ny ? ny - 1 : jb;
+                kb = kb < 0 ? 0 : kb >= nz ? nz - 1 : kb;
+
+                // Centers of clusters within the cutoff are at most
+                // cutoff + r_i + max_radius apart
+                const int reach =
+                    ( dx + radius_copy( ci ) + max_radius ) / dx + 1;
+                const int i_lo = ib - reach < 0 ? 0 : ib - reach;
+                const int j_lo = jb - reach < 0 ? 0 : jb - reach;
+                const int k_lo = kb - reach < 0 ? 0 : kb - reach;
+                const int i_hi = ib + reach >= nx ? nx - 1 : ib + reach;
+                const int j_hi = jb + reach >= ny ? ny - 1 : jb + reach;
+                const int k_hi = kb + reach >= nz ? nz - 1 : kb + reach;
+
+                T_INT count = 0;
+                for ( int i = i_lo; i <= i_hi; i++ )
+                    for ( int j = j_lo; j <= j_hi; j++ )
+                        for ( int k = k_lo; k <= k_hi; k++ )
+                        {
+                            const int begin = bins.binOffset( i, j, k );
+                            const int end = begin + bins.binSize( i, j, k );
+                            for ( int p = begin; p < end; p++ )
+                            {
+                                const int cj = bins.permutation( p );
+                                if ( radius_copy( cj ) > max_radius ||
+                                     gap_sq( bbox_copy, ci, cj ) >= cutsq )
+                                    continue;
+                                if ( fill )
+                                    neighbors( offsets( ci ) + count ) = cj;
+                                count++;
+                            }
+                        }
+                for ( int n = 0; n < num_large; n++ )
+                {
+                    const int cj = large_copy( n );
+                    if ( gap_sq( bbox_copy, ci, cj ) >= cutsq )
+                        continue;
+                    if ( fill )
+                        neighbors( offsets( ci ) + count ) = cj;
+                    count++;
+                }
+                if ( !fill )
+                    counts( ci ) = count;
+            } );
+    }
+
+    // Atom pairs within the cutoff from the j clusters of each atom's cluster
+    template <class t_x>
+    void search_atoms( const t_x x, const T_INT N_local, const bool fill )
+    {
+        const int size = t_neigh_list::size;
+        const T_INT N_total = list.num_total;
+        const bool half = half_neigh;
+        auto cluster_counts = list.cluster_counts;
+        auto cluster_offsets = list.cluster_offsets;
+        auto cluster_neighbors = list.cluster_neighbors;
+        auto counts = list.counts;
+        auto offsets = list.offsets;
+        auto neighbors = list.neighbors;
+        const T_X_FLOAT cutsq = neigh_cut * neigh_cut;
+
+        Kokkos::parallel_for(
+            "NeighborCluster::search_atoms",
+            Kokkos::RangePolicy<exe_space>( 0, N_local ),
+            KOKKOS_LAMBDA( const int i ) {
+                const int ci = i / size;
+                T_INT count = 0;
+                for ( int n = 0; n < cluster_counts( ci ); n++ )
+                {
+                    const int cj =
+                        cluster_neighbors( cluster_offsets( ci ) + n );
+                    const int end = ( cj + 1 ) * size < N_total
+                                        ? ( cj + 1 ) * size
+                                        : N_total;
+                    for ( int j = cj * size; j < end; j++ )
+                    {
+                        if ( j == i || ( half && j < i ) )
+                            continue;
+                        const T_X_FLOAT dx = x( i, 0 ) - x( j, 0 );
+                        const T_X_FLOAT dy = x( i, 1 ) - x( j, 1 );
+                        const T_X_FLOAT dz = x( i, 2 ) - x( j, 2 );
+                        if ( dx * dx + dy * dy + dz * dz < cutsq )
+                        {
+                            if ( fill )
+                                neighbors( offsets( i ) + count ) = j;
+                            count++;
+                        }
+                    }
+                }
+                if ( !fill )
+                    counts( i ) = count;
+            } );
+    }
+
+    // Exclusive prefix sum of counts into offsets; returns the total
+    T_INT scan( const t_view counts, const t_view offsets, const T_INT num )
+    {
+        T_INT total = 0;
+        Kokkos::parallel_scan(
+            "NeighborCluster::offsets",
+            Kokkos::RangePolicy<exe_space>( 0, num ),
+            KOKKOS_LAMBDA( const int i, T_INT &sum, const bool final ) {
+                if ( final )
+                    offsets( i ) = sum;
+                sum += counts( i );
+            },
+            total );
+        return total;
+    }
+
+    t_neigh_list &get() { return list; }
+
+    const char *name() override
+    {
+        return half_neigh ? "Neighbor:ClusterHalf" : "Neighbor:ClusterFull";
+    }
+
+  private:
+    t_neigh_list list;
+};
+
+#endif
@@ -15,6 +15,63 @@
 #include <Cabana_Core.hpp>
 
 #include <neighbor.h>
+#include <neighbor_cell.h>
+
+#include <type_traits>
+
+// Copy of a full tree list into the CSR of the cell lists. Half iteration
+// keeps the neighbors j > i only, so every ghost stays in the list as for the
+// Cabana Verlet lists.
+template <class t_exe, class t_full, class t_list>
+void tree_to_cell_list( const t_full &full, const T_INT N_local,
+                        const bool half, t_list &list )
+{
+    using t_traits = Cabana::NeighborList<t_full>;
+    if ( list.counts.extent( 0 ) < (std::size_t)N_local )
+    {
+        Kokkos::realloc( list.counts, N_local * 1.1 );
+        Kokkos::realloc( list.offsets, N_local * 1.1 );
+    }
+    auto counts = list.counts;
+    auto offsets = list.offsets;
+
+    Kokkos::parallel_for(
+        "NeighborTree::count", Kokkos::RangePolicy<t_exe>( 0, N_local ),
+        KOKKOS_LAMBDA( const int i ) {
+            const int num_n = t_traits::numNeighbor( full, i );
+            T_INT count = 0;
+            for ( int n = 0; n < num_n; n++ )
+                if ( !half || (int)t_traits::getNeighbor( full, i, n ) > i )
+                    count++;
+            counts( i ) = count;
+        } );
+
+    T_INT total = 0;
+    Kokkos::parallel_scan(
+        "NeighborTree::offsets", Kokkos::RangePolicy<t_exe>( 0, N_local ),
+        KOKKOS_LAMBDA( const int i, T_INT &sum, const bool final ) {
+            if ( final )
+                offsets( i ) = sum;
+            sum += counts( i );
+        },
+        total );
+
+    if ( list.neighbors.extent( 0 ) < (std::size_t)total )
+        Kokkos::realloc( list.neighbors, total * 1.1 );
+    auto neighbors = list.neighbors;
+    Kokkos::parallel_for(
+        "NeighborTree::fill", Kokkos::RangePolicy<t_exe>( 0, N_local ),
+        KOKKOS_LAMBDA( const int i ) {
+            const int num_n = t_traits::numNeighbor( full, i );
+            T_INT count = offsets( i );
+            for ( int n = 0; n < num_n; n++ )
+            {
+                const int j = t_traits::getNeighbor( full, i, n );
+                if ( !half || j > i )
+                    neighbors( count++ ) = j;
+            }
+        } );
+}
 
 template <class t_System, class t_iteration, class t_layout>
 class NeighborTree : public Neighbor<t_System>
@@ -27,34 +84,46 @@ class NeighborTree<t_System, t_iteration, Cabana::VerletLayoutCSR>
 {
     using device_type = typename t_System::device_type;
     using memory_space = typename t_System::memory_space;
+    using exe_space = typename t_System::execution_space;
 
   public:
     T_X_FLOAT neigh_cut;
     bool half_neigh;
-    T_INT max_neigh_guess;
 
+    // The tree search only finds full lists; half lists are filtered into
+    // the CSR of the cell lists
+    static constexpr bool is_half =
+        std::is_same<t_iteration, Cabana::HalfNeighborTag>::value;
+    using t_full_list =
+        Cabana::Experimental::CrsGraph<memory_space, Cabana::FullNeighborTag>;
     using t_neigh_list =
-        Cabana::Experimental::CrsGraph<memory_space, t_iteration>;
+        typename std::conditional<is_half, CellNeighborList<memory_space>,
+                                  t_full_list>::type;
 
     NeighborTree( T_X_FLOAT neigh_cut_, bool half_neigh_,
                   T_INT max_neigh_guess_ )
-        : Neighbor<t_System>( neigh_cut_, half_neigh_ )
+        : Neighbor<t_System>( neigh_cut_, half_neigh_, max_neigh_guess_ )
         , neigh_cut( neigh_cut_ )
         , half_neigh( half_neigh_ )
-        , max_neigh_guess( max_neigh_guess_ )
     {
     }
 
     void create( t_System *system ) override
     {
+        this->num_builds++;
         T_INT N_local = system->N_local;
 
         system->slice_x();
         auto x = system->x;
 
-        t_iteration tag;
-        list = Cabana::Experimental::makeNeighborList<device_type>(
-            tag, x, 0, N_local, neigh_cut, max_neigh_guess );
+        profile_push( "build" );
+        build( x, N_local, std::integral_constant<bool, is_half>() );
+        profile_pop();
+        this->update_capacity( list, N_local );
+        set_max_neighbors( std::integral_constant<bool, is_half>() );
+
+        if ( this->split_interior )
+            this->build_interior( list, N_local );
     }
 
     t_neigh_list &get() { return list; }
@@ -67,6 +136,29 @@ class NeighborTree<t_System, t_iteration, Cabana::VerletLayoutCSR>
 
   private:
     t_neigh_list list;
+
+    template <class t_x>
+    void build( const t_x &x, const T_INT N_local, std::false_type )
+    {
+        list = Cabana::Experimental::makeNeighborList<device_type>(
+            Cabana::FullNeighborTag(), x, 0, N_local, neigh_cut,
+            this->max_neigh_guess );
+    }
+
+    template <class t_x>
+    void build( const t_x &x, const T_INT N_local, std::true_type )
+    {
+        auto full = Cabana::Experimental::makeNeighborList<device_type>(
+            Cabana::FullNeighborTag(), x, 0, N_local, neigh_cut,
+            this->max_neigh_guess );
+        tree_to_cell_list<exe_space>( full, N_local, true, list );
+    }
+
+    void set_max_neighbors( std::false_type ) {}
+    void set_max_neighbors( std::true_type )
+    {
+        list.max_neighbors = this->max_neighbors;
+    }
 };
 
 template <class t_System, class t_iteration>
@@ -75,33 +167,45 @@ class NeighborTree<t_System, t_iteration, Cabana::VerletLayout2D>
 {
     using device_type = typename t_System::device_type;
     using memory_space = typename t_System::memory_space;
+    using exe_space = typename t_System::execution_space;
 
   public:
     T_X_FLOAT neigh_cut;
     bool half_neigh;
-    T_INT max_neigh_guess;
 
-    using t_neigh_list = Cabana::Experimental::Dense<memory_space, t_iteration>;
+    static constexpr bool is_half =
+        std::is_same<t_iteration, Cabana::HalfNeighborTag>::value;
+    using t_full_list =
+        Cabana::Experimental::Dense<memory_space, Cabana::FullNeighborTag>;
+    using t_neigh_list =
+        typename std::conditional<is_half, CellNeighborList<memory_space>,
+                                  t_full_list>::type;
 
     NeighborTree( T_X_FLOAT neigh_cut_, bool half_neigh_,
                   T_INT max_neigh_guess_ )
-        : Neighbor<t_System>( neigh_cut_, half_neigh_ )
+        : Neighbor<t_System>( neigh_cut_, half_neigh_, max_neigh_guess_ )
         , neigh_cut( neigh_cut_ )
         , half_neigh( half_neigh_ )
-        , max_neigh_guess( max_neigh_guess_ )
     {
+        this->dense_layout = !is_half;
     }
 
     void create( t_System *system ) override
     {
+        this->num_builds++;
         T_INT N_local = system->N_local;
 
         system->slice_x();
         auto x = system->x;
 
-        t_iteration tag;
-        list = Cabana::Experimental::make2DNeighborList<device_type>(
-            tag, x, 0, N_local, neigh_cut, max_neigh_guess );
+        profile_push( "build" );
+        build( x, N_local, std::integral_constant<bool, is_half>() );
+        profile_pop();
+        this->update_capacity( list, N_local );
+        set_max_neighbors( std::integral_constant<bool, is_half>() );
+
+        if ( this->split_interior )
+            this->build_interior( list, N_local );
     }
 
     t_neigh_list &get() { return list; }
@@ -114,6 +218,29 @@ class NeighborTree<t_System, t_iteration, Cabana::VerletLayout2D>
 
   private:
     t_neigh_list list;
+
+    template <class t_x>
+    void build( const t_x &x, const T_INT N_local, std::false_type )
+    {
+        list = Cabana::Experimental::make2DNeighborList<device_type>(
+            Cabana::FullNeighborTag(), x, 0, N_local, neigh_cut,
+            this->max_neigh_guess );
+    }
+
+    template <class t_x>
+    void build( const t_x &x, const T_INT N_local, std::true_type )
+    {
+        auto full = Cabana::Experimental::make2DNeighborList<device_type>(
+            Cabana::FullNeighborTag(), x, 0, N_local, neigh_cut,
+            this->max_neigh_guess );
+        tree_to_cell_list<exe_space>( full, N_local, true, list );
+    }
+
+    void set_max_neighbors( std::false_type ) {}
+    void set_max_neighbors( std::true_type )
+    {
+        list.max_neighbors = this->max_neighbors;
+    }
 };
 
 #endif
@@ -25,7 +25,6 @@ class NeighborVerlet : public Neighbor<t_System>
   public:
     T_X_FLOAT neigh_cut;
     bool half_neigh;
-    T_INT max_neigh_guess;
 
     using t_build = Cabana::TeamVectorOpTag;
     using t_neigh_list =
@@ -36,12 +35,14 @@ class NeighborVerlet : public Neighbor<t_System>
         : Neighbor<t_System>( neigh_cut_, half_neigh_, max_neigh_guess_ )
         , neigh_cut( neigh_cut_ )
         , half_neigh( half_neigh_ )
-        , max_neigh_guess( max_neigh_guess_ )
     {
+        this->dense_layout =
+            std::is_same<t_layout, Cabana::VerletLayout2D>::value;
     }
 
     void create( t_System *system ) override
     {
+        this->num_builds++;
         T_INT N_local = system->N_local;
 
         double grid_min[3] = {system->ghost_mesh_lo_x, system->ghost_mesh_lo_y,
@@ -52,13 +53,18 @@ class NeighborVerlet : public Neighbor<t_System>
         system->slice_x();
         auto x = system->x;
 
-        list = t_neigh_list( x, 0, N_local, neigh_cut, 1.0, grid_min, grid_max,
-                             max_neigh_guess );
-
-        T_INT current_max =
-            Cabana::NeighborList<t_neigh_list>::maxNeighbor( list );
-        if ( current_max > max_neigh_guess )
-            max_neigh_guess = current_max * 1.1;
+        // Cabana allocates new list storage on every build; the capacity
+        // tracked from the last build only sizes the 2D list so it rarely
+        // needs a second (resized) fill pass. NEIGH_CELL_CSR keeps its own
+        // grow-only storage instead.
+        profile_push( "build" );
+        list.build( x, 0, N_local, neigh_cut, 1.0, grid_min, grid_max,
+                    this->max_neigh_guess );
+        profile_pop();
+        this->update_capacity( list, N_local );
+
+        if ( this->split_interior )
+            this->build_interior( list, N_local );
     }
 
     t_neigh_list &get() { return list; }
@@ -0,0 +1,177 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#include <output.h>
+#include <profile.h>
+
+#include <Kokkos_Core.hpp>
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+struct ProfileTimer
+{
+    double total = 0.0;
+    double step = 0.0;
+    long calls = 0;
+};
+
+struct ProfileState
+{
+    bool enabled = false;
+    // Paths are '/' separated, so a parent sorts right before its children
+    std::map<std::string, ProfileTimer> timers;
+    std::vector<std::pair<std::string, Kokkos::Timer>> stack;
+    std::ofstream csv;
+};
+
+ProfileState &profile_state()
+{
+    static ProfileState state;
+    return state;
+}
+} // namespace
+
+void profile_enable( bool enable ) { profile_state().enabled = enable; }
+
+bool profile_enabled() { return profile_state().enabled; }
+
+void profile_push( const char *name )
+{
+    auto &state = profile_state();
+    if ( !state.enabled && !Kokkos::Profiling::profileLibraryLoaded() )
+        return;
+    Kokkos::Profiling::pushRegion( name );
+    if ( !state.enabled )
+        return;
+
+    Kokkos::fence();
+    std::string path = state.stack.empty()
+                           ? std::string( name )
+                           : state.stack.back().first + "/" + name;
+    state.stack.emplace_back( path, Kokkos::Timer() );
+}
+
+void profile_pop()
+{
+    auto &state = profile_state();
+    if ( state.enabled && !state.stack.empty() )
+    {
+        Kokkos::fence();
+        auto &top = state.stack.back();
+        double time = top.second.seconds();
+        auto &timer = state.timers[top.first];
+        timer.total += time;
+        timer.step += time;
+        timer.calls++;
+        state.stack.pop_back();
+    }
+
+    Kokkos::Profiling::popRegion();
+}
+
+void profile_reset()
+{
+    auto &state = profile_state();
+    state.timers.clear();
+    state.stack.clear();
+}
+
+void profile_csv( const std::string &file )
+{
+    int rank, size;
+    MPI_Comm_rank( MPI_COMM_WORLD, &rank );
+    MPI_Comm_size( MPI_COMM_WORLD, &size );
+
+    auto &state = profile_state();
+    std::string name = size > 1 ? file + "." + std::to_string( rank ) : file;
+    state.csv.open( name );
+    state.csv << "step,region,seconds,calls\n";
+    state.enabled = true;
+}
+
+void profile_step( int step )
+{
+    auto &state = profile_state();
+    if ( !state.csv.is_open() )
+        return;
+
+    for ( auto &t : state.timers )
+    {
+        if ( t.second.step > 0.0 )
+            state.csv << step << "," << t.first << "," << std::scientific
+                      << std::setprecision( 6 ) << t.second.step << ","
+                      << t.second.calls << "\n";
+        t.second.step = 0.0;
+    }
+}
+
+void profile_report( std::ofstream &out )
+{
+    auto &state = profile_state();
+    if ( !state.enabled )
+        return;
+    if ( state.csv.is_open() )
+        state.csv.close();
+
+    int rank, size;
+    MPI_Comm_rank( MPI_COMM_WORLD, &rank );
+    MPI_Comm_size( MPI_COMM_WORLD, &size );
+
+    // Ranks may not see the same regions (e.g. self only halo phases), so
+    // use the list from rank 0 and count missing regions as zero
+    std::string names;
+    for ( auto &t : state.timers )
+        names += t.first + "\n";
+    int length = names.size();
+    MPI_Bcast( &length, 1, MPI_INT, 0, MPI_COMM_WORLD );
+    names.resize( length );
+    MPI_Bcast( &names[0], length, MPI_CHAR, 0, MPI_COMM_WORLD );
+
+    std::vector<std::string> paths;
+    std::vector<double> local;
+    std::istringstream lines( names );
+    for ( std::string path; std::getline( lines, path ); )
+    {
+        auto t = state.timers.find( path );
+        paths.push_back( path );
+        local.push_back( t == state.timers.end() ? 0.0 : t->second.total );
+    }
+
+    int n = paths.size();
+    std::vector<double> min( n ), max( n ), sum( n );
+    MPI_Reduce( local.data(), min.data(), n, MPI_DOUBLE, MPI_MIN, 0,
+                MPI_COMM_WORLD );
+    MPI_Reduce( local.data(), max.data(), n, MPI_DOUBLE, MPI_MAX, 0,
+                MPI_COMM_WORLD );
+    MPI_Reduce( local.data(), sum.data(), n, MPI_DOUBLE, MPI_SUM, 0,
+                MPI_COMM_WORLD );
+
+    log( out, "\n#Timers (s) | Min Avg Max Max/Avg Calls | Region" );
+    for ( int i = 0; i < n; i++ )
+    {
+        double avg = sum[i] / size;
+        int depth = std::count( paths[i].begin(), paths[i].end(), '/' );
+        std::string leaf = paths[i].substr( paths[i].rfind( '/' ) + 1 );
+        log( out, std::fixed, std::setprecision( 4 ), min[i], " ", avg, " ",
+             max[i], " ", std::setprecision( 2 ),
+             avg > 0.0 ? max[i] / avg : 1.0, " ",
+             rank == 0 ? state.timers[paths[i]].calls : 0, " | ",
+             std::string( 2 * depth, ' ' ), leaf );
+    }
+}
@@ -0,0 +1,48 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <fstream>
+#include <string>
+
+// Named performance regions. Every region is a Kokkos Tools region; with
+// timers enabled it is also a wall clock timer nested under the enclosing
+// region, e.g. "Comm::update_halo_finish/phase 2".
+
+// Time regions, fencing at both ends so device work is attributed to the
+// region that queued it (this serializes otherwise queued kernels)
+void profile_enable( bool enable );
+bool profile_enabled();
+
+// No string is built unless timers or a Kokkos Tools library are active
+void profile_push( const char *name );
+void profile_pop();
+// Drop the accumulated timers (between runs in one process)
+void profile_reset();
+
+// Write the region times of every step to FILE (FILE.<rank> for more than
+// one rank)
+void profile_csv( const std::string &file );
+void profile_step( int step );
+
+// Min/avg/max over ranks of the regions seen on rank 0
+void profile_report( std::ofstream &out );
+
+class ProfileRegion
+{
+  public:
+    ProfileRegion( const char *name ) { profile_push( name ); }
+    ~ProfileRegion() { profile_pop(); }
+};
+
+#endif
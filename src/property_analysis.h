@@ -0,0 +1,50 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef PROPERTY_ANALYSIS_H
+#define PROPERTY_ANALYSIS_H
+
+#include <comm_mpi.h>
+#include <types.h>
+
+#include <string>
+
+// In-situ analysis ('compute' command): sampled on the device every
+// 'every' steps and accumulated in place, reduced over ranks and written
+// to 'file' only once at the end of the run.
+template <class t_System, class t_Neighbor>
+class Analysis
+{
+  protected:
+    Comm<t_System> *comm;
+
+  public:
+    std::string id, file;
+    int every;
+    int samples = 0;
+
+    Analysis( Comm<t_System> *comm_, const std::string id_,
+              const std::string file_, const int every_ )
+        : comm( comm_ )
+        , id( id_ )
+        , file( file_ )
+        , every( every_ )
+    {
+    }
+    virtual ~Analysis() {}
+
+    virtual void compute( t_System *, t_Neighbor *, const int step ) = 0;
+    // Collective: reduce the samples and write the file from rank 0
+    virtual void write( t_System * ) = 0;
+    virtual const char *name() = 0;
+};
+
+#endif
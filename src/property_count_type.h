@@ -0,0 +1,42 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef PROPERTY_COUNT_TYPE_H
+#define PROPERTY_COUNT_TYPE_H
+
+#include <Kokkos_Core.hpp>
+
+#include <property_analysis.h>
+#include <types.h>
+
+#include <vector>
+
+// Atoms per type (compute count/type atom) at every sample
+template <class t_System, class t_Neighbor>
+class CountType : public Analysis<t_System, t_Neighbor>
+{
+  private:
+    using memory_space = typename t_System::memory_space;
+
+    std::vector<int> steps;
+    std::vector<std::vector<T_FLOAT>> counts;
+
+  public:
+    CountType( Comm<t_System> *comm_, const std::string id_,
+               const std::string file_, const int every_ );
+
+    void compute( t_System *, t_Neighbor *, const int step ) override;
+    void write( t_System * ) override;
+    const char *name() override { return "Compute:CountType"; }
+};
+
+#include <property_count_type_impl.h>
+#endif
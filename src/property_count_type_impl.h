@@ -0,0 +1,67 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#include <fstream>
+
+template <class t_System, class t_Neighbor>
+CountType<t_System, t_Neighbor>::CountType( Comm<t_System> *comm_,
+                                            const std::string id_,
+                                            const std::string file_,
+                                            const int every_ )
+    : Analysis<t_System, t_Neighbor>( comm_, id_, file_, every_ )
+{
+}
+
+template <class t_System, class t_Neighbor>
+void CountType<t_System, t_Neighbor>::compute( t_System *system,
+                                               t_Neighbor *, const int step )
+{
+    system->slice_type();
+    auto type = system->type;
+    const int ntypes = system->ntypes;
+    Kokkos::View<T_FLOAT *, memory_space> count( "CountType::count",
+                                                 ntypes );
+    using exe_space = typename t_System::execution_space;
+    Kokkos::parallel_for(
+        "CountType::compute",
+        Kokkos::RangePolicy<exe_space>( 0, system->N_local ),
+        KOKKOS_LAMBDA( const T_INT i ) {
+            Kokkos::atomic_add( &count( type( i ) ), 1.0 );
+        } );
+    auto host_count =
+        Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(), count );
+    this->comm->reduce_float( host_count.data(), ntypes );
+
+    steps.push_back( step );
+    counts.emplace_back( host_count.data(), host_count.data() + ntypes );
+    this->samples++;
+}
+
+template <class t_System, class t_Neighbor>
+void CountType<t_System, t_Neighbor>::write( t_System *system )
+{
+    if ( this->comm->process_rank() != 0 )
+        return;
+
+    std::ofstream out( this->file );
+    out << "# " << this->id << ": " << this->samples << " samples\n"
+        << "# Timestep";
+    for ( int t = 1; t <= system->ntypes; t++ )
+        out << " type_" << t;
+    out << "\n";
+    for ( std::size_t s = 0; s < steps.size(); s++ )
+    {
+        out << steps[s];
+        for ( auto c : counts[s] )
+            out << " " << (long)c;
+        out << "\n";
+    }
+}
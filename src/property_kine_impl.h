@@ -54,6 +54,12 @@ KinE<t_System>::KinE( Comm<t_System> *comm_ )
 
 template <class t_System>
 T_V_FLOAT KinE<t_System>::compute( t_System *system )
+{
+    return compute( system, compute_mv2( system ) );
+}
+
+template <class t_System>
+T_V_FLOAT KinE<t_System>::compute_mv2( t_System *system )
 {
     system->slice_properties();
     v = system->v;
@@ -61,16 +67,20 @@ T_V_FLOAT KinE<t_System>::compute( t_System *system )
 
     mass = system->mass;
 
-    T_V_FLOAT KE;
+    T_V_FLOAT mv2;
     using exe_space = typename t_System::execution_space;
     Kokkos::parallel_reduce(
         Kokkos::RangePolicy<exe_space, Kokkos::IndexType<T_INT>>(
             0, system->N_local ),
-        *this, KE );
+        *this, mv2 );
+    return mv2;
+}
 
+template <class t_System>
+T_V_FLOAT KinE<t_System>::compute( t_System *system, T_V_FLOAT mv2 )
+{
     // Multiply by scaling factor (units based) to get to kinetic energy
     T_V_FLOAT factor = 0.5 * system->mvv2e;
-
-    comm->reduce_float( &KE, 1 );
-    return KE * factor;
+    comm->reduce_float( &mv2, 1 );
+    return mv2 * factor;
 }
@@ -0,0 +1,56 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef PROPERTY_MSD_H
+#define PROPERTY_MSD_H
+
+#include <Kokkos_Core.hpp>
+
+#include <atom_data.h>
+
+#include <property_analysis.h>
+#include <types.h>
+
+#include <array>
+#include <vector>
+
+// Mean squared displacement (compute msd) from the positions of the first
+// sample, keyed by atom id. Displacements are unwrapped between samples by
+// the minimum image, so atoms may move at most half a box per sample. The
+// reference, last wrapped and unwrapped positions stay with the owner of
+// every atom (AtomData, moved by System::migrate); only the sums are
+// reduced over ranks.
+template <class t_System, class t_Neighbor>
+class MSD : public Analysis<t_System, t_Neighbor>
+{
+  private:
+    using device_type = typename t_System::device_type;
+
+    // Reference (0-2), last wrapped (3-5) and unwrapped (6-8) position
+    AtomData<device_type, 9> positions;
+    t_System *system = nullptr;
+
+    std::vector<int> steps;
+    // x, y, z and total per sample
+    std::vector<std::array<T_FLOAT, 4>> values;
+
+  public:
+    MSD( Comm<t_System> *comm_, const std::string id_,
+         const std::string file_, const int every_ );
+    ~MSD();
+
+    void compute( t_System *, t_Neighbor *, const int step ) override;
+    void write( t_System * ) override;
+    const char *name() override { return "Compute:MSD"; }
+};
+
+#include <property_msd_impl.h>
+#endif
@@ -0,0 +1,121 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+template <class t_System, class t_Neighbor>
+MSD<t_System, t_Neighbor>::MSD( Comm<t_System> *comm_, const std::string id_,
+                                const std::string file_, const int every_ )
+    : Analysis<t_System, t_Neighbor>( comm_, id_, file_, every_ )
+{
+}
+
+template <class t_System, class t_Neighbor>
+MSD<t_System, t_Neighbor>::~MSD()
+{
+    if ( system == nullptr )
+        return;
+    auto &data = system->atom_data;
+    data.erase( std::remove( data.begin(), data.end(), &positions ),
+                data.end() );
+}
+
+template <class t_System, class t_Neighbor>
+void MSD<t_System, t_Neighbor>::compute( t_System *system_, t_Neighbor *,
+                                         const int step )
+{
+    using exe_space = typename t_System::execution_space;
+    system_->slice_x();
+    system_->slice_id();
+    auto x = system_->x;
+    auto id = system_->id;
+    const T_INT N_local = system_->N_local;
+    const bool first = this->samples == 0;
+    if ( first )
+    {
+        // The entries follow their atoms from now on
+        system = system_;
+        system->atom_data.push_back( &positions );
+        positions.entries.resize( N_local );
+        auto entry_id = Cabana::slice<0>( positions.entries );
+        Kokkos::parallel_for(
+            "MSD::add", Kokkos::RangePolicy<exe_space>( 0, N_local ),
+            KOKKOS_LAMBDA( const T_INT i ) { entry_id( i ) = id( i ); } );
+    }
+
+    const T_FLOAT prd[3] = {system_->period_x(), system_->global_mesh_y,
+                            system_->global_mesh_z};
+    auto map = positions.map_entries();
+    auto values_e = Cabana::slice<1>( positions.entries );
+    Kokkos::View<T_FLOAT[5], typename t_System::memory_space> sums(
+        "MSD::sums" );
+    Kokkos::parallel_for(
+        "MSD::compute", Kokkos::RangePolicy<exe_space>( 0, N_local ),
+        KOKKOS_LAMBDA( const T_INT i ) {
+            const auto m = map.find( id( i ) );
+            if ( !map.valid_at( m ) )
+                return;
+            const T_INT e = map.value_at( m );
+            T_FLOAT total = 0.0;
+            for ( int d = 0; d < 3; d++ )
+            {
+                if ( first )
+                {
+                    values_e( e, d ) = x( i, d );
+                    values_e( e, 6 + d ) = x( i, d );
+                }
+                else
+                {
+                    T_FLOAT step_d = x( i, d ) - values_e( e, 3 + d );
+                    if ( step_d > 0.5 * prd[d] )
+                        step_d -= prd[d];
+                    if ( step_d < -0.5 * prd[d] )
+                        step_d += prd[d];
+                    values_e( e, 6 + d ) += step_d;
+                }
+                values_e( e, 3 + d ) = x( i, d );
+
+                const T_FLOAT dx = values_e( e, 6 + d ) - values_e( e, d );
+                Kokkos::atomic_add( &sums( d ), dx * dx );
+                total += dx * dx;
+            }
+            Kokkos::atomic_add( &sums( 3 ), total );
+            Kokkos::atomic_add( &sums( 4 ), 1.0 );
+        } );
+    auto host_sums =
+        Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(), sums );
+    this->comm->reduce_float( host_sums.data(), 5 );
+
+    // Atoms without an entry (created after the first sample) are skipped
+    std::array<T_FLOAT, 4> msd;
+    for ( int d = 0; d < 4; d++ )
+        msd[d] = host_sums( 4 ) > 0 ? host_sums( d ) / host_sums( 4 ) : 0.0;
+    steps.push_back( step );
+    values.push_back( msd );
+    this->samples++;
+}
+
+template <class t_System, class t_Neighbor>
+void MSD<t_System, t_Neighbor>::write( t_System * )
+{
+    if ( this->comm->process_rank() != 0 )
+        return;
+
+    std::ofstream out( this->file );
+    out << "# " << this->id << ": " << this->samples << " samples\n"
+        << "# Timestep MSD_x MSD_y MSD_z MSD\n"
+        << std::scientific << std::setprecision( 6 );
+    for ( std::size_t s = 0; s < steps.size(); s++ )
+        out << steps[s] << " " << values[s][0] << " " << values[s][1] << " "
+            << values[s][2] << " " << values[s][3] << "\n";
+}
@@ -61,8 +61,11 @@ class PotE
   public:
     PotE( Comm<t_System> *comm_ );
 
-    T_F_FLOAT compute( t_System *, Force<t_System, t_Neighbor> *,
-                       t_Neighbor * );
+    T_FLOAT compute( t_System *, Force<t_System, t_Neighbor> *,
+                     t_Neighbor * );
+    // Energy of the local atoms, not reduced over ranks
+    T_FLOAT compute_local( t_System *, Force<t_System, t_Neighbor> *,
+                           t_Neighbor * );
 };
 
 #include <property_pote_impl.h>
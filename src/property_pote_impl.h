@@ -53,11 +53,26 @@ PotE<t_System, t_Neighbor>::PotE( Comm<t_System> *comm_ )
 }
 
 template <class t_System, class t_Neighbor>
-T_F_FLOAT PotE<t_System, t_Neighbor>::compute(
+T_FLOAT PotE<t_System, t_Neighbor>::compute(
     t_System *system, Force<t_System, t_Neighbor> *force, t_Neighbor *neighbor )
 {
-    T_F_FLOAT PE;
-    PE = force->compute_energy( system, neighbor );
+    T_FLOAT PE = compute_local( system, force, neighbor );
     comm->reduce_float( &PE, 1 );
     return PE;
 }
+
+template <class t_System, class t_Neighbor>
+T_FLOAT PotE<t_System, t_Neighbor>::compute_local(
+    t_System *system, Force<t_System, t_Neighbor> *force, t_Neighbor *neighbor )
+{
+    T_FLOAT PE;
+    // Reuse the energy from a fused thermo step force pass; otherwise
+    // thermo_energy only holds the kspace and bonded terms of the step
+    if ( force->thermo_valid )
+        PE = force->thermo_energy;
+    else
+        PE = force->compute_energy( system, neighbor ) + force->thermo_energy;
+    force->thermo_valid = false;
+    force->thermo_energy = 0.0;
+    return PE;
+}
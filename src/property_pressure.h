@@ -0,0 +1,36 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef PROPERTY_PRESSURE_H
+#define PROPERTY_PRESSURE_H
+
+#include <comm_mpi.h>
+#include <types.h>
+
+template <class t_System, class t_Neighbor>
+class Pressure
+{
+  private:
+    Comm<t_System> *comm;
+
+  public:
+    Pressure( Comm<t_System> *comm_ );
+
+    // Scalar pressure from the temperature and the virial of the last
+    // Force::compute_thermo
+    T_FLOAT compute( t_System *, T_V_FLOAT temperature,
+                     Force<t_System, t_Neighbor> * );
+    // From a virial already reduced over ranks
+    T_FLOAT compute( t_System *, T_V_FLOAT temperature, T_FLOAT virial );
+};
+
+#include <property_pressure_impl.h>
+#endif
@@ -0,0 +1,39 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+template <class t_System, class t_Neighbor>
+Pressure<t_System, t_Neighbor>::Pressure( Comm<t_System> *comm_ )
+    : comm( comm_ )
+{
+}
+
+template <class t_System, class t_Neighbor>
+T_FLOAT Pressure<t_System, t_Neighbor>::compute(
+    t_System *system, T_V_FLOAT temperature,
+    Force<t_System, t_Neighbor> *force )
+{
+    T_FLOAT virial = force->thermo_virial[0] + force->thermo_virial[1] +
+                     force->thermo_virial[2];
+    comm->reduce_float( &virial, 1 );
+    return compute( system, temperature, virial );
+}
+
+template <class t_System, class t_Neighbor>
+T_FLOAT Pressure<t_System, t_Neighbor>::compute( t_System *system,
+                                                 T_V_FLOAT temperature,
+                                                 T_FLOAT virial )
+{
+    T_INT dof = system->degrees_of_freedom();
+    T_FLOAT volume = system->volume();
+
+    return ( dof * system->boltz * temperature + virial ) / ( 3.0 * volume ) *
+           system->nktv2p;
+}
@@ -0,0 +1,45 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef PROPERTY_RDF_H
+#define PROPERTY_RDF_H
+
+#include <Cabana_Core.hpp>
+#include <Kokkos_Core.hpp>
+
+#include <property_analysis.h>
+#include <types.h>
+
+// Radial distribution function (compute rdf) from the current neighbor
+// list, up to the pair cutoff
+template <class t_System, class t_Neighbor>
+class RDF : public Analysis<t_System, t_Neighbor>
+{
+  private:
+    using memory_space = typename t_System::memory_space;
+
+    int nbins;
+    T_X_FLOAT cutoff;
+    // Pair counts per bin, summed over samples
+    Kokkos::View<T_FLOAT *, memory_space> hist;
+
+  public:
+    RDF( Comm<t_System> *comm_, const std::string id_,
+         const std::string file_, const int every_, const int nbins_,
+         const T_X_FLOAT cutoff_ );
+
+    void compute( t_System *, t_Neighbor *, const int step ) override;
+    void write( t_System * ) override;
+    const char *name() override { return "Compute:RDF"; }
+};
+
+#include <property_rdf_impl.h>
+#endif
@@ -0,0 +1,99 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+
+template <class t_System, class t_Neighbor>
+RDF<t_System, t_Neighbor>::RDF( Comm<t_System> *comm_, const std::string id_,
+                                const std::string file_, const int every_,
+                                const int nbins_, const T_X_FLOAT cutoff_ )
+    : Analysis<t_System, t_Neighbor>( comm_, id_, file_, every_ )
+    , nbins( nbins_ )
+    , cutoff( cutoff_ )
+    , hist( "RDF::hist", nbins_ )
+{
+}
+
+template <class t_System, class t_Neighbor>
+void RDF<t_System, t_Neighbor>::compute( t_System *system,
+                                         t_Neighbor *neighbor, const int )
+{
+    system->slice_x();
+    auto x = system->x;
+    auto hist_copy = hist;
+    auto neigh_list = neighbor->get();
+
+    // Full lists hold every pair from both atoms. Half lists hold local
+    // pairs once, but local-ghost pairs are also listed by the owner of the
+    // ghost (or from the periodic image), as in PairKernel::energy_half
+    const bool half_neigh = neighbor->half_neigh;
+    const T_INT N_local = system->N_local;
+    const T_X_FLOAT cutsq = cutoff * cutoff;
+    const T_X_FLOAT bins_per_length = nbins / cutoff;
+    const int nbins_copy = nbins;
+    auto bin_pair = KOKKOS_LAMBDA( const int i, const int j )
+    {
+        const T_X_FLOAT dx = x( i, 0 ) - x( j, 0 );
+        const T_X_FLOAT dy = x( i, 1 ) - x( j, 1 );
+        const T_X_FLOAT dz = x( i, 2 ) - x( j, 2 );
+        const T_X_FLOAT rsq = dx * dx + dy * dy + dz * dz;
+        if ( rsq < cutsq )
+        {
+            int bin = sqrt( rsq ) * bins_per_length;
+            if ( bin >= nbins_copy )
+                bin = nbins_copy - 1;
+            const T_FLOAT weight = half_neigh && j < N_local ? 2.0 : 1.0;
+            Kokkos::atomic_add( &hist_copy( bin ), weight );
+        }
+    };
+
+    using exe_space = typename t_System::execution_space;
+    Kokkos::RangePolicy<exe_space> policy( 0, system->N_local );
+    Cabana::neighbor_parallel_for( policy, bin_pair, neigh_list,
+                                   Cabana::FirstNeighborsTag(),
+                                   Cabana::SerialOpTag(), "RDF::compute" );
+    Kokkos::fence();
+    this->samples++;
+}
+
+template <class t_System, class t_Neighbor>
+void RDF<t_System, t_Neighbor>::write( t_System *system )
+{
+    auto host_hist =
+        Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(), hist );
+    this->comm->reduce_float( host_hist.data(), nbins );
+    if ( this->comm->process_rank() != 0 )
+        return;
+
+    // Normalized by the ideal gas count of every shell
+    const T_FLOAT density = system->N / system->volume();
+    const T_FLOAT dr = cutoff / nbins;
+    const T_FLOAT norm = this->samples > 0 ? 1.0 * system->N * this->samples
+                                           : 1.0;
+    std::ofstream out( this->file );
+    out << "# " << this->id << ": " << this->samples << " samples\n"
+        << "# Bin r g(r) coord(r)\n"
+        << std::scientific << std::setprecision( 6 );
+    T_FLOAT coord = 0.0;
+    for ( int b = 0; b < nbins; b++ )
+    {
+        const T_FLOAT r_lo = b * dr;
+        const T_FLOAT r_hi = r_lo + dr;
+        const T_FLOAT shell =
+            4.0 / 3.0 * M_PI * ( r_hi * r_hi * r_hi - r_lo * r_lo * r_lo );
+        const T_FLOAT count = host_hist( b ) / norm;
+        coord += count;
+        out << b + 1 << " " << r_lo + 0.5 * dr << " "
+            << count / ( density * shell ) << " " << coord << "\n";
+    }
+}
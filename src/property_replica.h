@@ -0,0 +1,61 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef PROPERTY_REPLICA_H
+#define PROPERTY_REPLICA_H
+
+#include <Kokkos_Core.hpp>
+
+#include <comm_mpi.h>
+#include <types.h>
+
+#include <vector>
+
+// Per replica atom count, temperature and kinetic energy (replica mode)
+template <class t_System>
+class ReplicaThermo
+{
+  private:
+    using device_type = typename t_System::device_type;
+
+    typename t_System::t_x x;
+    typename t_System::t_v v;
+    typename t_System::t_type type;
+    typename t_System::t_mass mass;
+    t_System s;
+
+    // m*v^2 and atom count of every replica
+    Kokkos::View<T_V_FLOAT * [2], device_type> sums;
+
+    Comm<t_System> *comm;
+
+  public:
+    std::vector<T_INT> natoms;
+    std::vector<T_V_FLOAT> temperature, kinetic_energy;
+
+    ReplicaThermo( Comm<t_System> *comm_, int replicas );
+
+    void compute( t_System * );
+
+    KOKKOS_INLINE_FUNCTION
+    void operator()( const T_INT &i ) const
+    {
+        const int r = s.replica_of( x( i, 0 ) );
+        Kokkos::atomic_add( &sums( r, 0 ),
+                            ( v( i, 0 ) * v( i, 0 ) + v( i, 1 ) * v( i, 1 ) +
+                              v( i, 2 ) * v( i, 2 ) ) *
+                                mass( type( i ) ) );
+        Kokkos::atomic_add( &sums( r, 1 ), 1.0 );
+    }
+};
+
+#include <property_replica_impl.h>
+#endif
@@ -0,0 +1,55 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+template <class t_System>
+ReplicaThermo<t_System>::ReplicaThermo( Comm<t_System> *comm_, int replicas )
+    : sums( "ReplicaThermo::sums", replicas )
+    , comm( comm_ )
+    , natoms( replicas )
+    , temperature( replicas )
+    , kinetic_energy( replicas )
+{
+}
+
+template <class t_System>
+void ReplicaThermo<t_System>::compute( t_System *system )
+{
+    system->slice_x();
+    system->slice_properties();
+    x = system->x;
+    v = system->v;
+    type = system->type;
+    mass = system->mass;
+    s = *system;
+
+    Kokkos::deep_copy( sums, 0.0 );
+    using exe_space = typename t_System::execution_space;
+    Kokkos::parallel_for(
+        "ReplicaThermo::compute",
+        Kokkos::RangePolicy<exe_space, Kokkos::IndexType<T_INT>>(
+            0, system->N_local ),
+        *this );
+    auto host_sums =
+        Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(), sums );
+    const int replicas = sums.extent( 0 );
+    comm->reduce_float( host_sums.data(), 2 * replicas );
+
+    // Multiply by scaling factors (units based), as for the whole system
+    for ( int r = 0; r < replicas; r++ )
+    {
+        natoms[r] = host_sums( r, 1 ) + 0.5;
+        T_INT dof = 3 * natoms[r] - 3;
+        kinetic_energy[r] = 0.5 * system->mvv2e * host_sums( r, 0 );
+        temperature[r] = dof > 0 ? host_sums( r, 0 ) * system->mvv2e /
+                                       ( 1.0 * dof * system->boltz )
+                                 : 0.0;
+    }
+}
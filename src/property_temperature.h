@@ -69,6 +69,8 @@ class Temperature
     Temperature( Comm<t_System> *comm_ );
 
     T_V_FLOAT compute( t_System * );
+    // From a local sum of m*v^2 already reduced by the integrator
+    T_V_FLOAT compute( t_System *, T_V_FLOAT mv2 );
 
     KOKKOS_INLINE_FUNCTION
     void operator()( const T_INT &i, T_V_FLOAT &T ) const
@@ -69,9 +69,19 @@ T_V_FLOAT Temperature<t_System>::compute( t_System *system )
         *this, T );
 
     // Multiply by scaling factor (units based) to get to temperature
-    T_INT dof = 3 * system->N - 3;
+    T_INT dof = system->degrees_of_freedom();
     T_V_FLOAT factor = system->mvv2e / ( 1.0 * dof * system->boltz );
 
     comm->reduce_float( &T, 1 );
     return T * factor;
 }
+
+template <class t_System>
+T_V_FLOAT Temperature<t_System>::compute( t_System *system, T_V_FLOAT mv2 )
+{
+    // Multiply by scaling factor (units based) to get to temperature
+    T_INT dof = system->degrees_of_freedom();
+    T_V_FLOAT factor = system->mvv2e / ( 1.0 * dof * system->boltz );
+    comm->reduce_float( &mv2, 1 );
+    return mv2 * factor;
+}
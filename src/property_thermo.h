@@ -0,0 +1,59 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef PROPERTY_THERMO_H
+#define PROPERTY_THERMO_H
+
+#include <comm_mpi.h>
+#include <property_kine.h>
+#include <property_pote.h>
+#include <property_pressure.h>
+#include <types.h>
+
+// Thermo output with one floating point reduction over ranks: the local
+// m*v^2, potential energy and virial are summed in a single MPI_Allreduce,
+// the atom count exactly in an integer one. With start() and finish() both
+// reductions run in the background, e.g. until the next step.
+template <class t_System, class t_Neighbor>
+class Thermo
+{
+  private:
+    Comm<t_System> *comm;
+    KinE<t_System> kine;
+    PotE<t_System, t_Neighbor> pote;
+    Pressure<t_System, t_Neighbor> pressure;
+
+    T_FLOAT sums[3];
+    T_INT count;
+    MPI_Request requests[2];
+    bool active;
+
+  public:
+    T_V_FLOAT temperature, kinetic_energy;
+    T_FLOAT potential_energy, press;
+    T_INT natoms;
+
+    Thermo( Comm<t_System> *comm_ );
+
+    void compute( t_System *, Force<t_System, t_Neighbor> *, t_Neighbor * );
+    // From a local sum of m*v^2 already computed by the integrator
+    void compute( t_System *, Force<t_System, t_Neighbor> *, t_Neighbor *,
+                  T_V_FLOAT mv2 );
+
+    void start( t_System *, Force<t_System, t_Neighbor> *, t_Neighbor * );
+    void start( t_System *, Force<t_System, t_Neighbor> *, t_Neighbor *,
+                T_V_FLOAT mv2 );
+    bool pending() const { return active; }
+    void finish( t_System * );
+};
+
+#include <property_thermo_impl.h>
+#endif
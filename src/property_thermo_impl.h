@@ -0,0 +1,78 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+template <class t_System, class t_Neighbor>
+Thermo<t_System, t_Neighbor>::Thermo( Comm<t_System> *comm_ )
+    : comm( comm_ )
+    , kine( comm_ )
+    , pote( comm_ )
+    , pressure( comm_ )
+    , active( false )
+{
+}
+
+template <class t_System, class t_Neighbor>
+void Thermo<t_System, t_Neighbor>::compute(
+    t_System *system, Force<t_System, t_Neighbor> *force, t_Neighbor *neighbor )
+{
+    start( system, force, neighbor );
+    finish( system );
+}
+
+template <class t_System, class t_Neighbor>
+void Thermo<t_System, t_Neighbor>::compute(
+    t_System *system, Force<t_System, t_Neighbor> *force, t_Neighbor *neighbor,
+    T_V_FLOAT mv2 )
+{
+    start( system, force, neighbor, mv2 );
+    finish( system );
+}
+
+template <class t_System, class t_Neighbor>
+void Thermo<t_System, t_Neighbor>::start(
+    t_System *system, Force<t_System, t_Neighbor> *force, t_Neighbor *neighbor )
+{
+    start( system, force, neighbor, kine.compute_mv2( system ) );
+}
+
+template <class t_System, class t_Neighbor>
+void Thermo<t_System, t_Neighbor>::start(
+    t_System *system, Force<t_System, t_Neighbor> *force, t_Neighbor *neighbor,
+    T_V_FLOAT mv2 )
+{
+    if ( active )
+        finish( system );
+
+    sums[0] = mv2;
+    sums[1] = pote.compute_local( system, force, neighbor );
+    sums[2] = force->thermo_virial[0] + force->thermo_virial[1] +
+              force->thermo_virial[2];
+    count = system->N_local;
+    comm->reduce_float_start( sums, 3, &requests[0] );
+    comm->reduce_int_start( &count, 1, &requests[1] );
+    active = true;
+}
+
+template <class t_System, class t_Neighbor>
+void Thermo<t_System, t_Neighbor>::finish( t_System *system )
+{
+    if ( !active )
+        return;
+    MPI_Waitall( 2, requests, MPI_STATUSES_IGNORE );
+    active = false;
+
+    natoms = count;
+    T_INT dof = system->degrees_of_freedom();
+    temperature = sums[0] * system->mvv2e / ( 1.0 * dof * system->boltz );
+    kinetic_energy = 0.5 * system->mvv2e * sums[0];
+    potential_energy = sums[1];
+    press = pressure.compute( system, temperature, sums[2] );
+}
@@ -40,61 +40,21 @@
 #include <Kokkos_Core.hpp>
 
 #include <comm_mpi.h>
+#include <restart.h>
+#include <topology.h>
 #include <types.h>
 
+#include <mpi.h>
+
+#include <array>
+#include <cctype>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <iostream>
 #include <string>
-
-void skip_empty( std::ifstream &file, std::string &line )
-{
-    // skip blank lines
-    while ( 1 )
-    {
-        std::getline( file, line );
-        if ( !line.empty() )
-            break;
-    }
-}
-
-std::string read_lammps_parse_keyword( std::ifstream &file, std::ofstream &err )
-{
-    // Read up to first non-blank line plus 1 following
-    std::string line;
-    std::string keyword = "";
-    while ( 1 )
-    {
-        // exit if end-of-file is encountered
-        if ( file.eof() )
-            break;
-        std::getline( file, line );
-        // get substring prior to # (ignore comments)
-        line = line.substr( 0, line.find( '#' ) );
-        // for non-blank lines, skip leading whitespaces and read word
-        std::size_t pos = line.find_first_not_of( " \r\t\n" );
-        if ( pos != std::string::npos )
-        {
-            keyword = line;
-            std::size_t end = keyword.find_last_not_of( " " ) + 1;
-            if ( end < line.length() )
-                keyword.erase( end );
-            if ( ( keyword.compare( "Atoms" ) == 0 ) ||
-                 ( keyword.compare( "Velocities" ) == 0 ) ||
-                 ( keyword.compare( "Masses" ) == 0 ) ||
-                 ( keyword.compare( "Pair Coeffs" ) == 0 ) )
-                return keyword;
-            else
-            {
-                log_err( err, "Unknown data file keyword: ", keyword.data() );
-                return keyword;
-            }
-        }
-        else
-            continue;
-    }
-    return keyword;
-}
+#include <unordered_map>
+#include <vector>
 
 template <class t_System>
 void read_lammps_header( std::ifstream &file, std::ofstream &err, t_System *s )
@@ -107,6 +67,10 @@ void read_lammps_header( std::ifstream &file, std::ofstream &err, t_System *s )
             "Could not read from data file. Please check for a valid file and "
             "ensure that file path is less than 32 characters." );
 
+    using t_topology = Topology<typename t_System::device_type>;
+    if ( s->has_topology() )
+        s->topology = std::make_shared<t_topology>();
+
     std::array<double, 3> low_corner;
     std::array<double, 3> high_corner;
     while ( 1 )
@@ -121,7 +85,7 @@ void read_lammps_header( std::ifstream &file, std::ofstream &err, t_System *s )
         // comment lines too)
         line = line.substr( 0, line.find( '#' ) );
 
-        int natoms, ntypes;
+        int natoms, ntypes, count;
         double xlo, xhi, ylo, yhi, zlo, zhi;
         const char *temp = line.data(); // convert to C-string for sscanf
                                         // utility
@@ -136,6 +100,27 @@ void read_lammps_header( std::ifstream &file, std::ofstream &err, t_System *s )
             std::sscanf( temp, "%i", &ntypes );
             s->ntypes = ntypes;
         }
+        else if ( line.find( "bonds" ) != std::string::npos ||
+                  line.find( "angles" ) != std::string::npos ||
+                  line.find( "bond types" ) != std::string::npos ||
+                  line.find( "angle types" ) != std::string::npos )
+        {
+            std::sscanf( temp, "%i", &count );
+            if ( !s->topology )
+            {
+                if ( count > 0 )
+                    log_err( err, "Bonds and angles in the data file need "
+                                  "a molecular atom_style" );
+            }
+            else if ( line.find( "bonds" ) != std::string::npos )
+                s->topology->nbonds = count;
+            else if ( line.find( "angles" ) != std::string::npos )
+                s->topology->nangles = count;
+            else if ( line.find( "bond types" ) != std::string::npos )
+                s->topology->nbondtypes = count;
+            else
+                s->topology->nangletypes = count;
+        }
         else if ( line.find( "xlo xhi" ) != std::string::npos )
         {
             std::sscanf( temp, "%lg %lg", &xlo, &xhi );
@@ -161,208 +146,295 @@ void read_lammps_header( std::ifstream &file, std::ofstream &err, t_System *s )
     s->create_domain( low_corner, high_corner );
 }
 
-template <class t_System, class t_HostSystem>
-void read_lammps_atoms( std::ifstream &file, t_System *s, t_HostSystem &host_s )
+// Section keyword of a (comment stripped, trimmed) line
+int read_lammps_section( const std::string &keyword )
 {
-    std::string line;
-
-    host_s.slice_all();
-    auto h_x = host_s.x;
-    auto h_id = host_s.id;
-    auto h_type = host_s.type;
-    auto h_q = host_s.q;
-
-    auto local_mesh_lo_x = s->local_mesh_lo_x;
-    auto local_mesh_lo_y = s->local_mesh_lo_y;
-    auto local_mesh_lo_z = s->local_mesh_lo_z;
-    auto local_mesh_hi_x = s->local_mesh_hi_x;
-    auto local_mesh_hi_y = s->local_mesh_hi_y;
-    auto local_mesh_hi_z = s->local_mesh_hi_z;
-
-    skip_empty( file, line );
-
-    T_INT id_tmp, type_tmp;
-    T_FLOAT x_tmp, y_tmp, z_tmp, q_tmp;
-    std::size_t count = 0;
-    for ( int n = 0; n < s->N; n++ )
-    {
-        // Resize if needed
-        if ( count >= h_x.size() - 1 )
-        {
-            host_s.resize( count * 2 );
-            host_s.slice_all();
-            h_x = host_s.x;
-            h_id = host_s.id;
-            h_type = host_s.type;
-            h_q = host_s.q;
-        }
-
-        // TODO: error if atom_style doesn't match data
-        const char *temp = line.data();
-        if ( s->atom_style == "atomic" )
-        {
-            std::sscanf( temp, "%i %i %lg %lg %lg", &id_tmp, &type_tmp, &x_tmp,
-                         &y_tmp, &z_tmp );
-            if ( ( x_tmp >= local_mesh_lo_x ) && ( y_tmp >= local_mesh_lo_y ) &&
-                 ( z_tmp >= local_mesh_lo_z ) && ( x_tmp < local_mesh_hi_x ) &&
-                 ( y_tmp < local_mesh_hi_y ) && ( z_tmp < local_mesh_hi_z ) )
-            {
-                h_id( count ) = id_tmp;
-                h_type( count ) = type_tmp - 1;
-                h_x( count, 0 ) = x_tmp;
-                h_x( count, 1 ) = y_tmp;
-                h_x( count, 2 ) = z_tmp;
-                h_q( count ) = 0;
-                count++;
-            }
-        }
-        if ( s->atom_style == "charge" )
-        {
-            std::sscanf( temp, "%i %i %lg %lg %lg %lg", &id_tmp, &type_tmp,
-                         &q_tmp, &x_tmp, &y_tmp, &z_tmp );
-            if ( ( x_tmp >= local_mesh_lo_x ) && ( y_tmp >= local_mesh_lo_y ) &&
-                 ( z_tmp >= local_mesh_lo_z ) && ( x_tmp < local_mesh_hi_x ) &&
-                 ( y_tmp < local_mesh_hi_y ) && ( z_tmp < local_mesh_hi_z ) )
-            {
-                h_id( count ) = id_tmp;
-                h_type( count ) = type_tmp - 1;
-                h_q( count ) = q_tmp;
-                h_x( count, 0 ) = x_tmp;
-                h_x( count, 1 ) = y_tmp;
-                h_x( count, 2 ) = z_tmp;
-                count++;
-            }
-        }
-        // getline pushed to the end of loop because line already stores the
-        // 1st non-blank line after exiting while loop
-        std::getline( file, line );
-    }
-    s->N_local = count;
-    host_s.resize( s->N_local );
-}
-
-template <class t_System, class t_HostSystem>
-void read_lammps_velocities( std::ifstream &file, t_System *s,
-                             t_HostSystem &host_s )
-{
-    std::string line;
-
-    host_s.slice_v();
-    host_s.slice_id();
-    auto h_v = host_s.v;
-    auto h_id = host_s.id;
-
-    skip_empty( file, line );
-
-    T_INT id_tmp;
-    T_FLOAT vx_tmp, vy_tmp, vz_tmp;
-    std::size_t count = 0;
-    for ( int n = 0; n < s->N; n++ )
-    {
-        const char *temp = line.data();
-        std::sscanf( temp, "%i %lg %lg %lg", &id_tmp, &vx_tmp, &vy_tmp,
-                     &vz_tmp );
-        // Only extract velocities on this rank (order matches positions)
-        if ( id_tmp == h_id( count ) )
-        {
-            h_v( count, 0 ) = vx_tmp;
-            h_v( count, 1 ) = vy_tmp;
-            h_v( count, 2 ) = vz_tmp;
-            count++;
-        }
-        std::getline( file, line );
-    }
+    if ( keyword.compare( "Atoms" ) == 0 )
+        return DATA_ATOMS;
+    if ( keyword.compare( "Velocities" ) == 0 )
+        return DATA_VELOCITIES;
+    if ( keyword.compare( "Masses" ) == 0 )
+        return DATA_MASSES;
+    if ( keyword.compare( "Pair Coeffs" ) == 0 )
+        return DATA_PAIR_COEFFS;
+    if ( keyword.compare( "Bonds" ) == 0 )
+        return DATA_BONDS;
+    if ( keyword.compare( "Angles" ) == 0 )
+        return DATA_ANGLES;
+    if ( keyword.compare( "Bond Coeffs" ) == 0 )
+        return DATA_BOND_COEFFS;
+    if ( keyword.compare( "Angle Coeffs" ) == 0 )
+        return DATA_ANGLE_COEFFS;
+    return DATA_NONE;
 }
 
-template <class t_System>
-void read_lammps_masses( std::ifstream &file, t_System *s )
+// Send each record to rank_of( record )
+template <class t_record, class t_rank_of>
+void exchange_records( std::vector<t_record> &records, int nprocs,
+                       t_rank_of rank_of )
 {
-    std::string line;
-    using t_mass = typename t_System::t_mass;
-    s->mass = t_mass( "System::mass", s->ntypes );
-
-    skip_empty( file, line );
-
-    T_INT type_tmp;
-    T_FLOAT m_tmp;
-    for ( int n = 0; n < s->ntypes; n++ )
+    std::vector<int> send_count( nprocs, 0 ), recv_count( nprocs );
+    for ( auto &r : records )
+        send_count[rank_of( r )]++;
+    MPI_Alltoall( send_count.data(), 1, MPI_INT, recv_count.data(), 1,
+                  MPI_INT, MPI_COMM_WORLD );
+
+    std::vector<int> send_displ( nprocs, 0 ), recv_displ( nprocs, 0 );
+    for ( int p = 1; p < nprocs; p++ )
     {
-        const char *temp = line.data();
-        std::sscanf( temp, "%i %lg", &type_tmp, &m_tmp );
-        using exe_space = typename t_System::execution_space;
-        Kokkos::View<T_V_FLOAT, exe_space> mass_one( s->mass, type_tmp - 1 );
-        Kokkos::deep_copy( mass_one, m_tmp );
-        std::getline( file, line );
+        send_displ[p] = send_displ[p - 1] + send_count[p - 1];
+        recv_displ[p] = recv_displ[p - 1] + recv_count[p - 1];
     }
+    std::vector<t_record> send( records.size() );
+    std::vector<int> offset( send_displ );
+    for ( auto &r : records )
+        send[offset[rank_of( r )]++] = r;
+
+    // Counted in records, so counts stay below 2^31 per rank pair
+    MPI_Datatype record_type;
+    MPI_Type_contiguous( sizeof( t_record ), MPI_BYTE, &record_type );
+    MPI_Type_commit( &record_type );
+    records.resize( recv_displ[nprocs - 1] + recv_count[nprocs - 1] );
+    MPI_Alltoallv( send.data(), send_count.data(), send_displ.data(),
+                   record_type, records.data(), recv_count.data(),
+                   recv_displ.data(), record_type, MPI_COMM_WORLD );
+    MPI_Type_free( &record_type );
 }
 
-template <class t_System>
-void read_lammps_pair( std::ifstream &file, t_System *s )
+// Send each record to rank (id % nprocs) so atoms and velocities meet
+inline void exchange_atom_records( std::vector<AtomRecord> &records,
+                                   int nprocs )
 {
-    // Parse through pair_coeff lines to avoid error, but ignore values
-    std::string line;
-    skip_empty( file, line );
-
-    for ( int n = 0; n < s->ntypes; n++ )
-        std::getline( file, line );
+    exchange_records( records, nprocs, [nprocs]( const AtomRecord &r ) {
+        return r.id % nprocs;
+    } );
 }
 
+// Every rank parses the lines starting in an equal byte range of the file
+// body; section keywords are shared so each line can be classified, and
+// atoms are then moved to their owning ranks
 template <class t_System>
 void read_lammps_data_file( InputFile<t_System> *input, t_System *s,
                             Comm<t_System> *comm )
 {
-    int atomflag = 0;
-    std::string keyword;
-    std::ifstream file( input->input_data_file );
+    std::ifstream file( input->input_data_file, std::ifstream::binary );
     std::ofstream out( input->output_file, std::ofstream::app );
     std::ofstream err( input->error_file, std::ofstream::app );
 
     read_lammps_header<t_System>( file, err, s );
+    long long body = file.tellg();
+    file.seekg( 0, std::ios::end );
+    long long size = file.tellg();
+
+    int rank = comm->process_rank();
+    int nprocs = comm->num_processes();
+    long long begin = body + ( size - body ) * rank / nprocs;
+    long long end = body + ( size - body ) * ( rank + 1 ) / nprocs;
+
+    // Read one byte early to know whether the range starts a line, and
+    // finish the last line
+    long long read_begin = ( begin > body ) ? begin - 1 : begin;
+    std::string chunk( end - read_begin, '\0' );
+    file.seekg( read_begin );
+    file.read( &chunk[0], chunk.size() );
+    if ( !chunk.empty() && chunk.back() != '\n' )
+    {
+        std::string tail;
+        std::getline( file, tail );
+        chunk += tail;
+    }
+    std::size_t pos = 0;
+    if ( begin > body )
+    {
+        pos = chunk.find( '\n' );
+        pos = ( pos == std::string::npos ) ? chunk.size() : pos + 1;
+    }
 
-    // Use a host mirror for reading from data file
-    System<Kokkos::Device<Kokkos::DefaultHostExecutionSpace, Kokkos::HostSpace>,
-           CabanaMD_LAYOUT>
-        host_system;
-    // Assume near load balance and resize as necessary
-    host_system.resize( s->N / comm->num_processes() );
+    // Split into non-blank lines, recording section keywords
+    std::vector<std::size_t> line_start;
+    std::vector<long long> key_offset;
+    std::vector<int> key_section;
+    while ( pos < chunk.size() )
+    {
+        std::size_t eol = chunk.find( '\n', pos );
+        if ( eol == std::string::npos )
+            eol = chunk.size();
+        std::size_t first = chunk.find_first_not_of( " \r\t", pos );
+        if ( first < eol && chunk[first] != '#' )
+        {
+            char c = chunk[first];
+            if ( std::isdigit( c ) || c == '-' || c == '+' || c == '.' )
+            {
+                line_start.push_back( first );
+            }
+            else
+            {
+                std::string keyword = chunk.substr( first, eol - first );
+                keyword = keyword.substr( 0, keyword.find( '#' ) );
+                keyword.erase( keyword.find_last_not_of( " \r\t" ) + 1 );
+                int section = read_lammps_section( keyword );
+                if ( section == DATA_NONE )
+                    log_err( err, "Unknown data file keyword: ", keyword );
+                key_offset.push_back( read_begin + first );
+                key_section.push_back( section );
+            }
+        }
+        pos = eol + 1;
+    }
 
-    // check that the next string is a valid section keyword
-    keyword = read_lammps_parse_keyword( file, err );
-    while ( keyword.length() )
+    // All section keywords, in file order
+    int num_keys = key_offset.size();
+    std::vector<int> key_counts( nprocs ), key_displs( nprocs, 0 );
+    MPI_Allgather( &num_keys, 1, MPI_INT, key_counts.data(), 1, MPI_INT,
+                   MPI_COMM_WORLD );
+    for ( int p = 1; p < nprocs; p++ )
+        key_displs[p] = key_displs[p - 1] + key_counts[p - 1];
+    int total_keys = key_displs[nprocs - 1] + key_counts[nprocs - 1];
+    std::vector<long long> all_offset( total_keys );
+    std::vector<int> all_section( total_keys );
+    MPI_Allgatherv( key_offset.data(), num_keys, MPI_LONG_LONG,
+                    all_offset.data(), key_counts.data(), key_displs.data(),
+                    MPI_LONG_LONG, MPI_COMM_WORLD );
+    MPI_Allgatherv( key_section.data(), num_keys, MPI_INT, all_section.data(),
+                    key_counts.data(), key_displs.data(), MPI_INT,
+                    MPI_COMM_WORLD );
+
+    bool has_masses = false, has_velocities = false, has_pair = false;
+    bool has_topology = false, has_topology_coeffs = false;
+    for ( int k = 0; k < total_keys; k++ )
+    {
+        has_masses |= all_section[k] == DATA_MASSES;
+        has_velocities |= all_section[k] == DATA_VELOCITIES;
+        has_pair |= all_section[k] == DATA_PAIR_COEFFS;
+        has_topology |= all_section[k] == DATA_BONDS ||
+                        all_section[k] == DATA_ANGLES;
+        has_topology_coeffs |= all_section[k] == DATA_BOND_COEFFS ||
+                               all_section[k] == DATA_ANGLE_COEFFS;
+    }
+    if ( has_topology && !s->topology )
+        log_err( err, "Bonds and angles in the data file need a molecular "
+                      "atom_style" );
+
+    // Parse without streams
+    // TODO: error if atom_style doesn't match data
+    bool charge = s->has_charge();
+    bool molecule = s->has_topology();
+    std::vector<AtomRecord> atoms, velocities;
+    std::vector<TopologyRecord> topology;
+    std::vector<double> mass( s->ntypes, 0.0 );
+    int k = 0;
+    int section = DATA_NONE;
+    for ( std::size_t l = 0; l < line_start.size(); l++ )
     {
-        if ( keyword.compare( "Atoms" ) == 0 )
+        long long offset = read_begin + line_start[l];
+        while ( k < total_keys && all_offset[k] < offset )
+            section = all_section[k++];
+
+        char *p = &chunk[line_start[l]];
+        AtomRecord r;
+        if ( section == DATA_ATOMS )
         {
-            read_lammps_atoms<t_System>( file, s, host_system );
-            atomflag = 1;
+            r.id = std::strtol( p, &p, 10 );
+            if ( molecule )
+                std::strtol( p, &p, 10 );
+            r.type = std::strtol( p, &p, 10 ) - 1;
+            r.q = charge ? std::strtod( p, &p ) : 0.0;
+            for ( int d = 0; d < 3; d++ )
+            {
+                r.x[d] = std::strtod( p, &p );
+                r.v[d] = 0.0;
+            }
+            atoms.push_back( r );
         }
-        else if ( keyword.compare( "Velocities" ) == 0 )
+        else if ( section == DATA_VELOCITIES )
         {
-            if ( atomflag == 0 )
-                log_err( err, "Must read Atoms before Velocities" );
-
-            read_lammps_velocities<t_System>( file, s, host_system );
+            r.id = std::strtol( p, &p, 10 );
+            for ( int d = 0; d < 3; d++ )
+                r.v[d] = std::strtod( p, &p );
+            velocities.push_back( r );
         }
-        else if ( keyword.compare( "Masses" ) == 0 )
+        else if ( section == DATA_BONDS || section == DATA_ANGLES )
         {
-            read_lammps_masses<t_System>( file, s );
+            // One copy for every atom of the interaction
+            TopologyRecord t;
+            t.size = ( section == DATA_BONDS ) ? 2 : 3;
+            std::strtol( p, &p, 10 );
+            t.type = std::strtol( p, &p, 10 ) - 1;
+            for ( int a = 0; a < t.size; a++ )
+                t.atoms[a] = std::strtol( p, &p, 10 );
+            for ( int a = 0; a < t.size; a++ )
+            {
+                t.owner = t.atoms[a];
+                topology.push_back( t );
+            }
         }
-        else if ( keyword.compare( "Pair Coeffs" ) == 0 )
+        else if ( section == DATA_MASSES )
         {
-            read_lammps_pair<t_System>( file, s );
-            log( err, "Warning: Ignoring potential parameters in data file. "
-                      "CabanaMD only reads pair_coeff in the input file." );
-            read_lammps_pair<t_System>( file, s );
+            int type = std::strtol( p, &p, 10 ) - 1;
+            if ( type >= 0 && type < s->ntypes )
+                mass[type] = std::strtod( p, &p );
         }
-        else
+        else if ( section == DATA_NONE )
         {
-            log_err( err, "Unknown identifier in data file: ", keyword );
+            log_err( err, "Data line outside of a section in data file" );
         }
+    }
 
-        keyword = read_lammps_parse_keyword( file, err );
+    if ( has_masses )
+    {
+        MPI_Allreduce( MPI_IN_PLACE, mass.data(), s->ntypes, MPI_DOUBLE,
+                       MPI_MAX, MPI_COMM_WORLD );
+        using t_mass = typename t_System::t_mass;
+        s->mass = t_mass( "System::mass", s->ntypes );
+        auto h_mass = Kokkos::create_mirror_view( s->mass );
+        for ( int t = 0; t < s->ntypes; t++ )
+            h_mass( t ) = mass[t];
+        Kokkos::deep_copy( s->mass, h_mass );
+    }
+    if ( has_pair || has_topology_coeffs )
+        log( err, "Warning: Ignoring potential parameters in data file. "
+                  "CabanaMD only reads pair_coeff, bond_coeff, and "
+                  "angle_coeff in the input file." );
+
+    // Velocities are matched to atoms by id on an intermediate rank
+    if ( has_velocities || has_topology )
+        exchange_atom_records( atoms, nprocs );
+    if ( has_velocities )
+    {
+        exchange_atom_records( velocities, nprocs );
+        std::unordered_map<T_INT, std::size_t> index;
+        for ( std::size_t i = 0; i < atoms.size(); i++ )
+            index[atoms[i].id] = i;
+        for ( auto &r : velocities )
+        {
+            auto it = index.find( r.id );
+            if ( it == index.end() )
+                log_err( err, "Velocity for unknown atom id: ", r.id );
+            else
+                for ( int d = 0; d < 3; d++ )
+                    atoms[it->second].v[d] = r.v[d];
+        }
     }
 
-    s->resize( s->N_local );
-    s->deep_copy( host_system );
+    auto &global_mesh = s->local_grid->globalGrid().globalMesh();
+    std::array<double, 3> low_corner, high_corner;
+    for ( int d = 0; d < 3; d++ )
+    {
+        low_corner[d] = global_mesh.lowCorner( d );
+        high_corner[d] = global_mesh.highCorner( d );
+    }
+
+    // Interaction copies meet their owner atoms on the intermediate rank
+    // and then move with them
+    if ( has_topology )
+    {
+        exchange_records( topology, nprocs,
+                          [nprocs]( const TopologyRecord &r ) {
+                              return r.owner % nprocs;
+                          } );
+        s->topology->add( topology );
+    }
+    migrate_atom_records( s, atoms, low_corner, high_corner );
 
     // check that correct # of atoms were created
     int natoms = s->N_local;
@@ -376,22 +448,28 @@ void read_lammps_data_file( InputFile<t_System> *input, t_System *s,
     {
         log( out, "Atoms: ", s->N, " ", s->N_local );
     }
+
+    if ( s->topology )
+    {
+        T_INT copies[2] = {(T_INT)s->topology->bonds.size(),
+                           (T_INT)s->topology->angles.size()};
+        comm->reduce_int( copies, 2 );
+        if ( copies[0] != 2 * s->topology->nbonds ||
+             copies[1] != 3 * s->topology->nangles )
+            log_err( err, "Bonds or angles of unknown atoms in data file." );
+        else
+            log( out, "Bonds: ", s->topology->nbonds,
+                 " Angles: ", s->topology->nangles );
+    }
 }
 
 template <class t_System>
-void write_data( t_System *s, std::string data_file )
+void write_data( t_System *s, std::string data_file,
+                 HostSystem<t_System> &host )
 {
     std::ofstream data( data_file );
 
-    System<Kokkos::Device<Kokkos::DefaultHostExecutionSpace, Kokkos::HostSpace>,
-           CabanaMD_LAYOUT>
-        host_s;
-    s->slice_x();
-    auto x = s->x;
-    host_s.resize( x.size() );
-    host_s.slice_x();
-    auto h_x = host_s.x;
-    host_s.deep_copy( *s );
+    auto host_s = host.get( s );
 
     log( data, "LAMMPS data file from CabanaMD\n" );
     log( data, s->N, " atoms" );
@@ -402,11 +480,10 @@ void write_data( t_System *s, std::string data_file )
     log( data, s->local_mesh_lo_z, " ", s->local_mesh_hi_z, " zlo zhi\n" );
     log( data, "Atoms # atomic\n" );
 
-    host_s.slice_all();
-    h_x = host_s.x;
-    auto h_id = host_s.id;
-    auto h_type = host_s.type;
-    auto h_v = host_s.v;
+    auto h_x = host_s->x;
+    auto h_id = host_s->id;
+    auto h_type = host_s->type;
+    auto h_v = host_s->v;
 
     for ( int n = 0; n < s->N_local; n++ )
     {
@@ -0,0 +1,315 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef RESTART_H
+#define RESTART_H
+
+#include <Cabana_Core.hpp>
+#include <Kokkos_Core.hpp>
+
+#include <comm_mpi.h>
+#include <output.h>
+#include <system.h>
+#include <types.h>
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Nose-Hoover chain state (fix nvt), so a restarted run continues the
+// thermostat instead of starting it from rest
+struct RestartThermostat
+{
+    int nose_hoover = 0;
+    double eta_dot = 0.0;
+    double eta_dotdot = 0.0;
+};
+
+// Binary restart file, independent of the rank count: a header, the
+// per type masses, then one fixed size record per atom sorted by id
+// (ids must be 1..N, so at most 2^31 - 1 atoms with T_INT ids). Written
+// with a collective MPI-IO file view; read back in equal contiguous chunks
+// and migrated to the owning ranks.
+struct RestartHeader
+{
+    char magic[8];
+    int version;
+    int ntypes;
+    int step;
+    int charge;
+    long long natoms;
+    double low_corner[3];
+    double high_corner[3];
+    RestartThermostat thermostat;
+};
+
+static const int restart_version = 2;
+
+// Atom data as stored in restart files and exchanged while reading input
+struct AtomRecord
+{
+    double x[3];
+    double v[3];
+    double q;
+    T_INT id;
+    T_INT type;
+};
+
+static const char restart_magic[8] = {'C', 'b', 'n', 'M', 'D', 'R', 'S', 'T'};
+
+// Fill the system from host atom records (any rank) and move every atom to
+// the rank owning its position in the freshly created, uniform domain
+template <class t_System>
+void migrate_atom_records( t_System *s, const std::vector<AtomRecord> &atoms,
+                           std::array<double, 3> low_corner,
+                           std::array<double, 3> high_corner )
+{
+    using device_type = typename t_System::device_type;
+
+    int nprocs;
+    MPI_Comm_size( MPI_COMM_WORLD, &nprocs );
+    T_INT n = atoms.size();
+
+    // Owning rank from the (uniform) block position of each rank
+    std::vector<int> block_pos( 3 * nprocs );
+    MPI_Allgather( s->rank_dim_pos.data(), 3, MPI_INT, block_pos.data(), 3,
+                   MPI_INT, MPI_COMM_WORLD );
+    auto &ranks_per_dim = s->ranks_per_dim;
+    std::vector<int> block_rank( nprocs );
+    for ( int r = 0; r < nprocs; r++ )
+        block_rank[( block_pos[3 * r] * ranks_per_dim[1] +
+                     block_pos[3 * r + 1] ) *
+                       ranks_per_dim[2] +
+                   block_pos[3 * r + 2]] = r;
+
+    using t_host_system = typename t_System::host_system_type;
+    t_host_system host_s;
+    host_s.resize( n );
+    host_s.slice_all();
+    auto h_x = host_s.x;
+    auto h_v = host_s.v;
+    auto h_f = host_s.f;
+    auto h_id = host_s.id;
+    auto h_type = host_s.type;
+    auto h_q = host_s.q;
+    Kokkos::View<int *, Kokkos::HostSpace> h_export( "AtomRecord::export", n );
+    for ( T_INT i = 0; i < n; i++ )
+    {
+        int block[3];
+        for ( int d = 0; d < 3; d++ )
+        {
+            h_x( i, d ) = atoms[i].x[d];
+            h_v( i, d ) = atoms[i].v[d];
+            h_f( i, d ) = 0.0;
+            double frac = ( atoms[i].x[d] - low_corner[d] ) /
+                          ( high_corner[d] - low_corner[d] );
+            block[d] = std::min( std::max( int( frac * ranks_per_dim[d] ), 0 ),
+                                 ranks_per_dim[d] - 1 );
+        }
+        h_q( i ) = atoms[i].q;
+        h_id( i ) = atoms[i].id;
+        h_type( i ) = atoms[i].type;
+        h_export( i ) =
+            block_rank[( block[0] * ranks_per_dim[1] + block[1] ) *
+                           ranks_per_dim[2] +
+                       block[2]];
+    }
+
+    s->resize( n );
+    s->deep_copy( host_s );
+    auto export_ranks = Kokkos::create_mirror_view_and_copy(
+        typename t_System::memory_space(), h_export );
+
+    // Ranks are arbitrary here, so let the distributor find its topology
+    auto distributor = std::make_shared<Cabana::Distributor<device_type>>(
+        MPI_COMM_WORLD, export_ranks );
+    s->migrate( distributor );
+    s->resize( distributor->totalNumImport() );
+    s->N_local = distributor->totalNumImport();
+    s->N_ghost = 0;
+}
+
+template <class t_System>
+void write_restart( t_System *s, std::string restart_file, int step,
+                    HostSystem<t_System> &host,
+                    RestartThermostat thermostat = RestartThermostat() )
+{
+    // Restarts hold atoms only; a molecular run would lose its topology
+    if ( s->has_topology() )
+        log_err( std::cerr, "write_restart does not store bonds and angles ",
+                 "(atom_style ", s->atom_style, "); use write_data" );
+
+    auto host_s = host.get( s );
+    auto h_x = host_s->x;
+    auto h_v = host_s->v;
+    auto h_id = host_s->id;
+    auto h_type = host_s->type;
+    auto h_q = host_s->q;
+
+    T_INT n = s->N_local;
+    std::vector<AtomRecord> atoms( n );
+    T_INT max_id = 0;
+    for ( T_INT i = 0; i < n; i++ )
+    {
+        for ( int d = 0; d < 3; d++ )
+        {
+            atoms[i].x[d] = h_x( i, d );
+            atoms[i].v[d] = h_v( i, d );
+        }
+        atoms[i].q = h_q( i );
+        atoms[i].id = h_id( i );
+        atoms[i].type = h_type( i );
+        max_id = std::max( max_id, atoms[i].id );
+    }
+    // File views need increasing displacements
+    std::sort( atoms.begin(), atoms.end(),
+               []( const AtomRecord &a, const AtomRecord &b ) {
+                   return a.id < b.id;
+               } );
+
+    MPI_Allreduce( MPI_IN_PLACE, &max_id, 1, MPI_INT, MPI_MAX,
+                   MPI_COMM_WORLD );
+    if ( max_id != s->N )
+        log_err( std::cerr, "write_restart requires atom ids 1 to N" );
+
+    RestartHeader header;
+    std::memcpy( header.magic, restart_magic, 8 );
+    header.version = restart_version;
+    header.ntypes = s->ntypes;
+    header.step = step;
+    header.charge = s->has_charge();
+    header.natoms = s->N;
+    header.thermostat = thermostat;
+    for ( int d = 0; d < 3; d++ )
+    {
+        header.low_corner[d] =
+            s->local_grid->globalGrid().globalMesh().lowCorner( d );
+        header.high_corner[d] =
+            s->local_grid->globalGrid().globalMesh().highCorner( d );
+    }
+
+    auto h_mass = Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(),
+                                                       s->mass );
+    std::vector<double> mass( s->ntypes );
+    for ( int t = 0; t < s->ntypes; t++ )
+        mass[t] = h_mass( t );
+
+    MPI_File file;
+    if ( MPI_File_open( MPI_COMM_WORLD, restart_file.c_str(),
+                        MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL,
+                        &file ) != MPI_SUCCESS )
+        log_err( std::cerr, "Cannot open restart file: ", restart_file );
+    MPI_File_set_size( file, 0 );
+
+    int rank;
+    MPI_Comm_rank( MPI_COMM_WORLD, &rank );
+    if ( rank == 0 )
+    {
+        MPI_File_write_at( file, 0, &header, sizeof( RestartHeader ),
+                           MPI_BYTE, MPI_STATUS_IGNORE );
+        MPI_File_write_at( file, sizeof( RestartHeader ), mass.data(),
+                           s->ntypes, MPI_DOUBLE, MPI_STATUS_IGNORE );
+    }
+
+    // Each atom record lands at its id (as a byte offset, which does not
+    // overflow int like a record index times the record size would)
+    MPI_Datatype record, filetype;
+    MPI_Type_contiguous( sizeof( AtomRecord ), MPI_BYTE, &record );
+    MPI_Type_commit( &record );
+    std::vector<MPI_Aint> displs( n );
+    for ( T_INT i = 0; i < n; i++ )
+        displs[i] = (MPI_Aint)( atoms[i].id - 1 ) * sizeof( AtomRecord );
+    MPI_Type_create_hindexed_block( n, 1, displs.data(), record, &filetype );
+    MPI_Type_commit( &filetype );
+
+    MPI_Offset data_offset =
+        sizeof( RestartHeader ) + s->ntypes * sizeof( double );
+    MPI_File_set_view( file, data_offset, record, filetype, "native",
+                       MPI_INFO_NULL );
+    MPI_File_write_all( file, atoms.data(), n, record, MPI_STATUS_IGNORE );
+    MPI_File_close( &file );
+
+    MPI_Type_free( &filetype );
+    MPI_Type_free( &record );
+}
+
+// Returns the step of the file; the thermostat state is stored in
+// thermostat when given
+template <class t_System>
+int read_restart( t_System *s, std::string restart_file,
+                  RestartThermostat *thermostat = nullptr )
+{
+    int rank, nprocs;
+    MPI_Comm_rank( MPI_COMM_WORLD, &rank );
+    MPI_Comm_size( MPI_COMM_WORLD, &nprocs );
+
+    MPI_File file;
+    if ( MPI_File_open( MPI_COMM_WORLD, restart_file.c_str(), MPI_MODE_RDONLY,
+                        MPI_INFO_NULL, &file ) != MPI_SUCCESS )
+        log_err( std::cerr, "Cannot open restart file: ", restart_file );
+
+    RestartHeader header;
+    MPI_File_read_at_all( file, 0, &header, sizeof( RestartHeader ), MPI_BYTE,
+                          MPI_STATUS_IGNORE );
+    if ( std::memcmp( header.magic, restart_magic, 8 ) != 0 ||
+         header.version != restart_version )
+        log_err( std::cerr, "Invalid restart file: ", restart_file );
+    if ( thermostat )
+        *thermostat = header.thermostat;
+
+    s->N = header.natoms;
+    s->ntypes = header.ntypes;
+    if ( header.charge )
+        s->atom_style = "charge";
+
+    std::vector<double> mass( s->ntypes );
+    MPI_File_read_at_all( file, sizeof( RestartHeader ), mass.data(),
+                          s->ntypes, MPI_DOUBLE, MPI_STATUS_IGNORE );
+    using t_mass = typename t_System::t_mass;
+    s->mass = t_mass( "System::mass", s->ntypes );
+    auto h_mass = Kokkos::create_mirror_view( s->mass );
+    for ( int t = 0; t < s->ntypes; t++ )
+        h_mass( t ) = mass[t];
+    Kokkos::deep_copy( s->mass, h_mass );
+
+    std::array<double, 3> low_corner, high_corner;
+    for ( int d = 0; d < 3; d++ )
+    {
+        low_corner[d] = header.low_corner[d];
+        high_corner[d] = header.high_corner[d];
+    }
+    s->create_domain( low_corner, high_corner );
+
+    // Equal contiguous chunk of records on each rank
+    MPI_Datatype record;
+    MPI_Type_contiguous( sizeof( AtomRecord ), MPI_BYTE, &record );
+    MPI_Type_commit( &record );
+    long long begin = header.natoms * rank / nprocs;
+    long long end = header.natoms * ( rank + 1 ) / nprocs;
+    T_INT n = end - begin;
+    std::vector<AtomRecord> atoms( n );
+    MPI_Offset data_offset =
+        sizeof( RestartHeader ) + s->ntypes * sizeof( double );
+    MPI_File_read_at_all( file, data_offset + begin * sizeof( AtomRecord ),
+                          atoms.data(), n, record, MPI_STATUS_IGNORE );
+    MPI_File_close( &file );
+    MPI_Type_free( &record );
+
+    migrate_atom_records( s, atoms, low_corner, high_corner );
+
+    return header.step;
+}
+
+#endif
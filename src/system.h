@@ -53,10 +53,16 @@
 #include <Cajita.hpp>
 #include <Kokkos_Core.hpp>
 
+#include <CabanaMD_config.hpp>
+#include <atom_data.h>
+#include <capacity.h>
+#include <decomposition.h>
+#include <topology.h>
 #include <types.h>
 
 #include <memory>
 #include <string>
+#include <vector>
 
 template <class t_device>
 class SystemCommon
@@ -74,6 +80,13 @@ class SystemCommon
     int ntypes;
     std::string atom_style;
 
+    // Incremented whenever the AoSoAs may reallocate (resize, migrate):
+    // slices taken at the same generation are still valid
+    T_INT slice_generation;
+
+    // AoSoA capacity across resizes; N_max follows the reserved capacity
+    CapacityPolicy capacity_policy;
+
     // Per Type Property
     // typedef typename t_device::array_layout layout;
     typedef Kokkos::View<T_V_FLOAT *, t_device> t_mass;
@@ -82,23 +95,38 @@ class SystemCommon
     t_mass mass;
 
     // Simulation total domain
-    T_X_FLOAT global_mesh_x, global_mesh_y, global_mesh_z;
+    double global_mesh_x, global_mesh_y, global_mesh_z;
 
     // Simulation sub domain (single MPI rank)
-    T_X_FLOAT local_mesh_x, local_mesh_y, local_mesh_z;
-    T_X_FLOAT local_mesh_lo_x, local_mesh_lo_y, local_mesh_lo_z;
-    T_X_FLOAT local_mesh_hi_x, local_mesh_hi_y, local_mesh_hi_z;
-    T_X_FLOAT ghost_mesh_lo_x, ghost_mesh_lo_y, ghost_mesh_lo_z;
-    T_X_FLOAT ghost_mesh_hi_x, ghost_mesh_hi_y, ghost_mesh_hi_z;
-    std::shared_ptr<Cajita::LocalGrid<Cajita::UniformMesh<T_X_FLOAT>>>
+    double local_mesh_x, local_mesh_y, local_mesh_z;
+    double local_mesh_lo_x, local_mesh_lo_y, local_mesh_lo_z;
+    double local_mesh_hi_x, local_mesh_hi_y, local_mesh_hi_z;
+    double ghost_mesh_lo_x, ghost_mesh_lo_y, ghost_mesh_lo_z;
+    double ghost_mesh_hi_x, ghost_mesh_hi_y, ghost_mesh_hi_z;
+    std::shared_ptr<Cajita::LocalGrid<Cajita::UniformMesh<double>>>
         local_grid;
 
     // Only needed for current comm
     std::array<int, 3> ranks_per_dim;
     std::array<int, 3> rank_dim_pos;
+    // DECOMPOSITION_UNIFORM or DECOMPOSITION_NODE (node blocks first)
+    int decomposition;
+    // MPI_COMM_WORLD rank of the sub domain at each offset (1 + i) * 9 +
+    // (1 + j) * 3 + 1 + k (the Cajita grid may order ranks differently)
+    std::array<int, 27> neighbor_ranks;
 
     // Units
-    T_FLOAT boltz, mvv2e, dt;
+    T_FLOAT boltz, mvv2e, nktv2p, qqrd2e, dt;
+
+    // Bonds and angles (molecular atom styles), moved by migrate
+    std::shared_ptr<Topology<t_device>> topology;
+    // Id keyed per atom data of analyses, also moved by migrate
+    std::vector<AtomDataBase<t_device> *> atom_data;
+
+    // Independent copies of a lattice system side by side along x, each with
+    // its own periodic box of replica_lx (replicas are replica_width apart)
+    int replicas;
+    double replica_lx, replica_width;
 
     SystemCommon()
     {
@@ -106,8 +134,12 @@ class SystemCommon
         N_max = 0;
         N_local = 0;
         N_ghost = 0;
+        slice_generation = 0;
         ntypes = 1;
         atom_style = "atomic";
+        decomposition = DECOMPOSITION_UNIFORM;
+        replicas = 1;
+        replica_lx = replica_width = 0.0;
 
         mass = t_mass( "System::mass", ntypes );
 
@@ -118,7 +150,8 @@ class SystemCommon
         ghost_mesh_hi_x = ghost_mesh_hi_y = ghost_mesh_hi_z = 0.0;
         local_mesh_x = local_mesh_y = local_mesh_z = 0.0;
 
-        mvv2e = boltz = dt = 0.0;
+        mvv2e = boltz = nktv2p = dt = 0.0;
+        qqrd2e = 1.0;
 
         mass = t_mass( "System::mass", ntypes );
     }
@@ -128,9 +161,22 @@ class SystemCommon
     void create_domain( std::array<double, 3> low_corner,
                         std::array<double, 3> high_corner )
     {
-        // Create the MPI partitions.
-        Cajita::UniformDimPartitioner partitioner;
-        ranks_per_dim = partitioner.ranksPerDimension( MPI_COMM_WORLD, {} );
+        // Create the MPI partitions. Replicas are never split along x.
+        Cajita::UniformDimPartitioner uniform;
+        ranks_per_dim = uniform.ranksPerDimension( MPI_COMM_WORLD, {} );
+        if ( replicas > 1 )
+        {
+            int size;
+            MPI_Comm_size( MPI_COMM_WORLD, &size );
+            ranks_per_dim = {1, 0, 0};
+            MPI_Dims_create( size, 3, ranks_per_dim.data() );
+            decomposition = DECOMPOSITION_UNIFORM;
+        }
+        MPI_Comm grid_comm = MPI_COMM_WORLD;
+        if ( decomposition == DECOMPOSITION_NODE &&
+             !node_decomposition( ranks_per_dim, grid_comm ) )
+            decomposition = DECOMPOSITION_UNIFORM;
+        Cajita::ManualPartitioner partitioner( ranks_per_dim );
 
         // Create global mesh of MPI partitions.
         auto global_mesh = Cajita::createUniformGlobalMesh(
@@ -143,7 +189,9 @@ class SystemCommon
         // Create the global grid.
         std::array<bool, 3> is_periodic = {true, true, true};
         auto global_grid = Cajita::createGlobalGrid(
-            MPI_COMM_WORLD, global_mesh, is_periodic, partitioner );
+            grid_comm, global_mesh, is_periodic, partitioner );
+        if ( grid_comm != MPI_COMM_WORLD )
+            MPI_Comm_free( &grid_comm );
 
         for ( int d = 0; d < 3; d++ )
         {
@@ -153,6 +201,24 @@ class SystemCommon
         // Create a local mesh
         int halo_width = 1;
         local_grid = Cajita::createLocalGrid( global_grid, halo_width );
+
+        MPI_Group grid_group, world_group;
+        MPI_Comm_group( global_grid->comm(), &grid_group );
+        MPI_Comm_group( MPI_COMM_WORLD, &world_group );
+        for ( int i = -1; i < 2; i++ )
+            for ( int j = -1; j < 2; j++ )
+                for ( int k = -1; k < 2; k++ )
+                {
+                    const int n = ( i + 1 ) * 9 + ( j + 1 ) * 3 + k + 1;
+                    const int grid_rank = local_grid->neighborRank( i, j, k );
+                    neighbor_ranks[n] = grid_rank;
+                    if ( grid_rank >= 0 )
+                        MPI_Group_translate_ranks( grid_group, 1, &grid_rank,
+                                                   world_group,
+                                                   &neighbor_ranks[n] );
+                }
+        MPI_Group_free( &grid_group );
+        MPI_Group_free( &world_group );
         auto local_mesh = Cajita::createLocalMesh<t_device>( *local_grid );
 
         local_mesh_lo_x = local_mesh.lowCorner( Cajita::Own(), 0 );
@@ -172,6 +238,90 @@ class SystemCommon
         local_mesh_z = local_mesh.extent( Cajita::Own(), 2 );
     }
 
+    // Replica holding position x (ghosts and drifted atoms included)
+    KOKKOS_INLINE_FUNCTION
+    int replica_of( const T_X_FLOAT x ) const
+    {
+        if ( replicas == 1 )
+            return 0;
+        int r = ( x + 0.5 * ( replica_width - replica_lx ) ) / replica_width;
+        return r < 0 ? 0 : ( r < replicas ? r : replicas - 1 );
+    }
+    // Periodic length along x seen by an atom
+    KOKKOS_INLINE_FUNCTION
+    double period_x() const
+    {
+        return replicas > 1 ? replica_lx : global_mesh_x;
+    }
+    // Momentum is conserved in every replica
+    T_INT degrees_of_freedom() const { return 3 * N - 3 * replicas; }
+    double volume() const
+    {
+        return replicas * period_x() * global_mesh_y * global_mesh_z;
+    }
+
+    bool has_charge() const
+    {
+        return atom_style == "charge" || atom_style == "full";
+    }
+    bool has_topology() const
+    {
+        return atom_style != "atomic" && atom_style != "charge";
+    }
+
+    // Topology copies and atom data follow their atoms (id of every
+    // exported atom)
+    template <class t_id>
+    void migrate_topology( const Cabana::Distributor<t_device> &distributor,
+                           const t_id id )
+    {
+        if ( topology )
+            topology->migrate( distributor, id );
+        if ( atom_data.empty() )
+            return;
+
+        const T_INT n = distributor.exportSize();
+        typename AtomDataBase<t_device>::t_ids ids( "System::migrate_ids",
+                                                    n );
+        Kokkos::parallel_for(
+            "System::migrate_ids",
+            Kokkos::RangePolicy<execution_space>( 0, n ),
+            KOKKOS_LAMBDA( const int i ) { ids( i ) = id( i ); } );
+        for ( auto data : atom_data )
+            data->migrate( distributor, ids );
+    }
+
+    int neighbor_rank( const int i, const int j, const int k ) const
+    {
+        return neighbor_ranks[( i + 1 ) * 9 + ( j + 1 ) * 3 + k + 1];
+    }
+
+    // Move this rank's sub domain (load balancing); the process grid and
+    // ghost padding are unchanged
+    void set_local_domain( std::array<double, 3> low_corner,
+                           std::array<double, 3> high_corner )
+    {
+        double ghost_x = local_mesh_lo_x - ghost_mesh_lo_x;
+        double ghost_y = local_mesh_lo_y - ghost_mesh_lo_y;
+        double ghost_z = local_mesh_lo_z - ghost_mesh_lo_z;
+
+        local_mesh_lo_x = low_corner[0];
+        local_mesh_lo_y = low_corner[1];
+        local_mesh_lo_z = low_corner[2];
+        local_mesh_hi_x = high_corner[0];
+        local_mesh_hi_y = high_corner[1];
+        local_mesh_hi_z = high_corner[2];
+        ghost_mesh_lo_x = local_mesh_lo_x - ghost_x;
+        ghost_mesh_lo_y = local_mesh_lo_y - ghost_y;
+        ghost_mesh_lo_z = local_mesh_lo_z - ghost_z;
+        ghost_mesh_hi_x = local_mesh_hi_x + ghost_x;
+        ghost_mesh_hi_y = local_mesh_hi_y + ghost_y;
+        ghost_mesh_hi_z = local_mesh_hi_z + ghost_z;
+        local_mesh_x = local_mesh_hi_x - local_mesh_lo_x;
+        local_mesh_y = local_mesh_hi_y - local_mesh_lo_y;
+        local_mesh_z = local_mesh_hi_z - local_mesh_lo_z;
+    }
+
     void slice_all()
     {
         slice_x();
@@ -209,13 +359,16 @@ class SystemCommon
     virtual void init() = 0;
     virtual void resize( T_INT N_new ) = 0;
     virtual void permute( Cabana::LinkedCellList<t_device> cell_list ) = 0;
+    virtual void permute( Cabana::BinningData<t_device> bin_data ) = 0;
     virtual void
     migrate( std::shared_ptr<Cabana::Distributor<t_device>> distributor ) = 0;
     virtual void gather( std::shared_ptr<Cabana::Halo<t_device>> halo ) = 0;
     virtual const char *name() { return "SystemNone"; }
 };
 
-template <class t_device, int layout>
+// vector_length 0 uses the configured CabanaMD_VECTORLENGTH_* per AoSoA,
+// otherwise all AoSoAs use vector_length (CabanaMD_RUNTIME_SYSTEMS)
+template <class t_device, int layout, int vector_length = 0>
 class System : public SystemCommon<t_device>
 {
   public:
@@ -223,4 +376,43 @@ class System : public SystemCommon<t_device>
 };
 
 #include <modules_system.h>
+
+// Host readable atom data for output. Where host code can read the system
+// memory (host builds, CUDA UVM) the slices are read in place; otherwise a
+// host mirror is allocated once and refreshed on every get().
+template <class t_System,
+          bool = Kokkos::SpaceAccessibility<
+              Kokkos::HostSpace, typename t_System::memory_space>::accessible>
+class HostSystem
+{
+  public:
+    using system_type = typename t_System::host_system_type;
+
+    system_type *get( t_System *system )
+    {
+        system->slice_x();
+        mirror.resize( system->x.size() );
+        mirror.deep_copy( *system );
+        mirror.slice_all();
+        return &mirror;
+    }
+
+  private:
+    system_type mirror;
+};
+
+template <class t_System>
+class HostSystem<t_System, true>
+{
+  public:
+    using system_type = t_System;
+
+    system_type *get( t_System *system )
+    {
+        // Device kernels writing the atoms must be complete
+        Kokkos::fence();
+        system->slice_all();
+        return system;
+    }
+};
 #endif
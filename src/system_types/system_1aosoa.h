@@ -16,33 +16,38 @@
 
 #include <system.h>
 
-template <class t_device>
-class System<t_device, 1> : public SystemCommon<t_device>
+template <class t_device, int vector_length>
+class System<t_device, 1, vector_length> : public SystemCommon<t_device>
 {
+    // Configured per AoSoA vector lengths, or one run time selected length
+    static constexpr int vl_0 =
+        vector_length > 0 ? vector_length : CabanaMD_VECTORLENGTH_0;
     using t_tuple = Cabana::MemberTypes<T_FLOAT[3], T_FLOAT[3], T_FLOAT[3],
                                         T_INT, T_INT, T_FLOAT>;
-    using AoSoA_1 =
-        typename Cabana::AoSoA<t_tuple, t_device, CabanaMD_VECTORLENGTH_0>;
+    using AoSoA_1 = typename Cabana::AoSoA<t_tuple, t_device, vl_0>;
     AoSoA_1 aosoa_0;
 
     using SystemCommon<t_device>::N_max;
+    using SystemCommon<t_device>::slice_generation;
+    using SystemCommon<t_device>::capacity_policy;
 
   public:
     using SystemCommon<t_device>::SystemCommon;
 
+    // Same layout on the host (restart, data files, correctness)
+    using host_system_type = System<
+        Kokkos::Device<Kokkos::DefaultHostExecutionSpace, Kokkos::HostSpace>,
+        1, vector_length>;
+    // Run time selected vector length, 0 for the configured lengths
+    static int selected_vector_length() { return vector_length; }
+
     // Per Particle Property
-    using t_x =
-        typename System<t_device, 1>::AoSoA_1::template member_slice_type<0>;
-    using t_v =
-        typename System<t_device, 1>::AoSoA_1::template member_slice_type<1>;
-    using t_f =
-        typename System<t_device, 1>::AoSoA_1::template member_slice_type<2>;
-    using t_type =
-        typename System<t_device, 1>::AoSoA_1::template member_slice_type<3>;
-    using t_id =
-        typename System<t_device, 1>::AoSoA_1::template member_slice_type<4>;
-    using t_q =
-        typename System<t_device, 1>::AoSoA_1::template member_slice_type<5>;
+    using t_x = typename AoSoA_1::template member_slice_type<0>;
+    using t_v = typename AoSoA_1::template member_slice_type<1>;
+    using t_f = typename AoSoA_1::template member_slice_type<2>;
+    using t_type = typename AoSoA_1::template member_slice_type<3>;
+    using t_id = typename AoSoA_1::template member_slice_type<4>;
+    using t_q = typename AoSoA_1::template member_slice_type<5>;
     t_x x;
     t_v v;
     t_f f;
@@ -50,15 +55,22 @@ class System<t_device, 1> : public SystemCommon<t_device>
     t_id id;
     t_q q;
 
-    void init() override { AoSoA_1 aosoa_0( "All", N_max ); }
+    void init() override { aosoa_0 = AoSoA_1( "System::All", N_max ); }
+
+    // Geometric capacity, only given back after the high-water mark decays
+    void reserve( T_INT N_new )
+    {
+        const std::size_t capacity =
+            capacity_policy.capacity( N_new, aosoa_0.capacity() );
+        set_capacity( aosoa_0, capacity );
+        N_max = aosoa_0.capacity();
+    }
 
     void resize( T_INT N_new ) override
     {
-        if ( N_new > N_max )
-        {
-            N_max = N_new; // Number of global Particles
-        }
-        // Grow/shrink, slice.size() needs to be accurate
+        slice_generation++;
+        // Shrinking keeps the storage; slice.size() needs to be accurate
+        reserve( N_new );
         aosoa_0.resize( N_new );
     }
 
@@ -80,9 +92,19 @@ class System<t_device, 1> : public SystemCommon<t_device>
         Cabana::permute( cell_list, aosoa_0 );
     }
 
+    void permute( Cabana::BinningData<t_device> bin_data ) override
+    {
+        Cabana::permute( bin_data, aosoa_0 );
+    }
+
     void migrate(
         std::shared_ptr<Cabana::Distributor<t_device>> distributor ) override
     {
+        slice_generation++;
+        slice_id();
+        this->migrate_topology( *distributor, id );
+        // Room for the imports, so the in place migrate does not reallocate
+        reserve( distributor->totalNumImport() );
         Cabana::migrate( *distributor, aosoa_0 );
     }
 
@@ -16,40 +16,46 @@
 
 #include <system.h>
 
-template <class t_device>
-class System<t_device, 2> : public SystemCommon<t_device>
+template <class t_device, int vector_length>
+class System<t_device, 2, vector_length> : public SystemCommon<t_device>
 {
+    // Configured per AoSoA vector lengths, or one run time selected length
+    static constexpr int vl_0 =
+        vector_length > 0 ? vector_length : CabanaMD_VECTORLENGTH_0;
+    static constexpr int vl_1 =
+        vector_length > 0 ? vector_length : CabanaMD_VECTORLENGTH_1;
     using t_tuple_0 = Cabana::MemberTypes<T_FLOAT[3], T_FLOAT[3], T_INT>;
     using t_tuple_1 = Cabana::MemberTypes<T_FLOAT[3], T_INT, T_FLOAT>;
-    using AoSoA_2_0 =
-        typename Cabana::AoSoA<t_tuple_0, t_device, CabanaMD_VECTORLENGTH_0>;
-    using AoSoA_2_1 =
-        typename Cabana::AoSoA<t_tuple_1, t_device, CabanaMD_VECTORLENGTH_1>;
+    using AoSoA_2_0 = typename Cabana::AoSoA<t_tuple_0, t_device, vl_0>;
+    using AoSoA_2_1 = typename Cabana::AoSoA<t_tuple_1, t_device, vl_1>;
     AoSoA_2_0 aosoa_0;
     AoSoA_2_1 aosoa_1;
 
     using SystemCommon<t_device>::N_max;
+    using SystemCommon<t_device>::slice_generation;
+    using SystemCommon<t_device>::capacity_policy;
     // using SystemCommon<t_device>::mass;
 
   public:
     using SystemCommon<t_device>::SystemCommon;
 
+    // Same layout on the host (restart, data files, correctness)
+    using host_system_type = System<
+        Kokkos::Device<Kokkos::DefaultHostExecutionSpace, Kokkos::HostSpace>,
+        2, vector_length>;
+    // Run time selected vector length, 0 for the configured lengths
+    static int selected_vector_length() { return vector_length; }
+
     using memory_space = typename t_device::memory_space;
     using execution_space = typename t_device::execution_space;
 
     // Per Particle Property
-    using t_x =
-        typename System<t_device, 2>::AoSoA_2_0::template member_slice_type<0>;
-    using t_v =
-        typename System<t_device, 2>::AoSoA_2_1::template member_slice_type<0>;
-    using t_f =
-        typename System<t_device, 2>::AoSoA_2_0::template member_slice_type<1>;
-    using t_type =
-        typename System<t_device, 2>::AoSoA_2_0::template member_slice_type<2>;
-    using t_id =
-        typename System<t_device, 2>::AoSoA_2_1::template member_slice_type<1>;
-    using t_q =
-        typename System<t_device, 2>::AoSoA_2_1::template member_slice_type<2>;
+    using t_x = typename AoSoA_2_0::template member_slice_type<0>;
+    using t_v = typename AoSoA_2_1::template member_slice_type<0>;
+    using t_f = typename AoSoA_2_0::template member_slice_type<1>;
+    using t_type = typename AoSoA_2_0::template member_slice_type<2>;
+    using t_id = typename AoSoA_2_1::template member_slice_type<1>;
+    using t_q = typename AoSoA_2_1::template member_slice_type<2>;
     t_x x;
     t_v v;
     t_f f;
@@ -59,17 +65,25 @@ class System<t_device, 2> : public SystemCommon<t_device>
 
     void init() override
     {
-        AoSoA_2_0 aosoa_0( "X,F,Type", N_max );
-        AoSoA_2_1 aosoa_1( "V,ID,Q", N_max );
+        aosoa_0 = AoSoA_2_0( "System::X,F,Type", N_max );
+        aosoa_1 = AoSoA_2_1( "System::V,ID,Q", N_max );
+    }
+
+    // Geometric capacity, only given back after the high-water mark decays
+    void reserve( T_INT N_new )
+    {
+        const std::size_t capacity =
+            capacity_policy.capacity( N_new, aosoa_0.capacity() );
+        set_capacity( aosoa_0, capacity );
+        set_capacity( aosoa_1, capacity );
+        N_max = aosoa_0.capacity();
     }
 
     void resize( T_INT N_new ) override
     {
-        if ( N_new > N_max )
-        {
-            N_max = N_new; // Number of global Particles
-        }
-        // Grow/shrink, slice.size() needs to be accurate
+        slice_generation++;
+        // Shrinking keeps the storage; slice.size() needs to be accurate
+        reserve( N_new );
         aosoa_0.resize( N_new );
         aosoa_1.resize( N_new );
     }
@@ -94,9 +108,20 @@ class System<t_device, 2> : public SystemCommon<t_device>
         Cabana::permute( linkedcell, aosoa_1 );
     }
 
+    void permute( Cabana::BinningData<t_device> bin_data ) override
+    {
+        Cabana::permute( bin_data, aosoa_0 );
+        Cabana::permute( bin_data, aosoa_1 );
+    }
+
     void migrate(
         std::shared_ptr<Cabana::Distributor<t_device>> distributor ) override
     {
+        slice_generation++;
+        slice_id();
+        this->migrate_topology( *distributor, id );
+        // Room for the imports, so the in place migrate does not reallocate
+        reserve( distributor->totalNumImport() );
         Cabana::migrate( *distributor, aosoa_0 );
         Cabana::migrate( *distributor, aosoa_1 );
     }
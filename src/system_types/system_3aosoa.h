@@ -0,0 +1,158 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef SYSTEM_AOSOA3_H
+#define SYSTEM_AOSOA3_H
+
+#include <CabanaMD_config.hpp>
+
+#include <system.h>
+
+// Grouped by the kernels that touch them: pair forces read {x, type},
+// integration adds {v, f} and only communication needs {id, q}
+template <class t_device, int vector_length>
+class System<t_device, 3, vector_length> : public SystemCommon<t_device>
+{
+    // Configured per AoSoA vector lengths, or one run time selected length
+    static constexpr int vl_0 =
+        vector_length > 0 ? vector_length : CabanaMD_VECTORLENGTH_0;
+    static constexpr int vl_1 =
+        vector_length > 0 ? vector_length : CabanaMD_VECTORLENGTH_1;
+    static constexpr int vl_2 =
+        vector_length > 0 ? vector_length : CabanaMD_VECTORLENGTH_2;
+    using t_tuple_0 = Cabana::MemberTypes<T_FLOAT[3], T_INT>;
+    using t_tuple_1 = Cabana::MemberTypes<T_FLOAT[3], T_FLOAT[3]>;
+    using t_tuple_2 = Cabana::MemberTypes<T_INT, T_FLOAT>;
+    using AoSoA_3_0 = typename Cabana::AoSoA<t_tuple_0, t_device, vl_0>;
+    using AoSoA_3_1 = typename Cabana::AoSoA<t_tuple_1, t_device, vl_1>;
+    using AoSoA_3_2 = typename Cabana::AoSoA<t_tuple_2, t_device, vl_2>;
+    AoSoA_3_0 aosoa_0;
+    AoSoA_3_1 aosoa_1;
+    AoSoA_3_2 aosoa_2;
+
+    using SystemCommon<t_device>::N_max;
+    using SystemCommon<t_device>::slice_generation;
+    using SystemCommon<t_device>::capacity_policy;
+
+  public:
+    using SystemCommon<t_device>::SystemCommon;
+
+    // Same layout on the host (restart, data files, correctness)
+    using host_system_type = System<
+        Kokkos::Device<Kokkos::DefaultHostExecutionSpace, Kokkos::HostSpace>,
+        3, vector_length>;
+    // Run time selected vector length, 0 for the configured lengths
+    static int selected_vector_length() { return vector_length; }
+
+    using memory_space = typename t_device::memory_space;
+    using execution_space = typename t_device::execution_space;
+
+    // Per Particle Property
+    using t_x = typename AoSoA_3_0::template member_slice_type<0>;
+    using t_v = typename AoSoA_3_1::template member_slice_type<0>;
+    using t_f = typename AoSoA_3_1::template member_slice_type<1>;
+    using t_type = typename AoSoA_3_0::template member_slice_type<1>;
+    using t_id = typename AoSoA_3_2::template member_slice_type<0>;
+    using t_q = typename AoSoA_3_2::template member_slice_type<1>;
+    t_x x;
+    t_v v;
+    t_f f;
+    t_type type;
+    t_id id;
+    t_q q;
+
+    void init() override
+    {
+        aosoa_0 = AoSoA_3_0( "System::X,Type", N_max );
+        aosoa_1 = AoSoA_3_1( "System::V,F", N_max );
+        aosoa_2 = AoSoA_3_2( "System::ID,Q", N_max );
+    }
+
+    // Geometric capacity, only given back after the high-water mark decays
+    void reserve( T_INT N_new )
+    {
+        const std::size_t capacity =
+            capacity_policy.capacity( N_new, aosoa_0.capacity() );
+        set_capacity( aosoa_0, capacity );
+        set_capacity( aosoa_1, capacity );
+        set_capacity( aosoa_2, capacity );
+        N_max = aosoa_0.capacity();
+    }
+
+    void resize( T_INT N_new ) override
+    {
+        slice_generation++;
+        // Shrinking keeps the storage; slice.size() needs to be accurate
+        reserve( N_new );
+        aosoa_0.resize( N_new );
+        aosoa_1.resize( N_new );
+        aosoa_2.resize( N_new );
+    }
+
+    template <class SrcSystem>
+    void deep_copy( SrcSystem src_system )
+    {
+        Cabana::deep_copy( aosoa_0, src_system.get_aosoa_x() );
+        Cabana::deep_copy( aosoa_1, src_system.get_aosoa_v() );
+        Cabana::deep_copy( aosoa_2, src_system.get_aosoa_id() );
+    }
+
+    void slice_x() override { x = Cabana::slice<0>( aosoa_0 ); }
+    void slice_v() override { v = Cabana::slice<0>( aosoa_1 ); }
+    void slice_f() override { f = Cabana::slice<1>( aosoa_1 ); }
+    void slice_type() override { type = Cabana::slice<1>( aosoa_0 ); }
+    void slice_id() override { id = Cabana::slice<0>( aosoa_2 ); }
+    void slice_q() override { q = Cabana::slice<1>( aosoa_2 ); }
+
+    void permute( Cabana::LinkedCellList<t_device> linkedcell ) override
+    {
+        Cabana::permute( linkedcell, aosoa_0 );
+        Cabana::permute( linkedcell, aosoa_1 );
+        Cabana::permute( linkedcell, aosoa_2 );
+    }
+
+    void permute( Cabana::BinningData<t_device> bin_data ) override
+    {
+        Cabana::permute( bin_data, aosoa_0 );
+        Cabana::permute( bin_data, aosoa_1 );
+        Cabana::permute( bin_data, aosoa_2 );
+    }
+
+    void migrate(
+        std::shared_ptr<Cabana::Distributor<t_device>> distributor ) override
+    {
+        slice_generation++;
+        slice_id();
+        this->migrate_topology( *distributor, id );
+        // Room for the imports, so the in place migrate does not reallocate
+        reserve( distributor->totalNumImport() );
+        Cabana::migrate( *distributor, aosoa_0 );
+        Cabana::migrate( *distributor, aosoa_1 );
+        Cabana::migrate( *distributor, aosoa_2 );
+    }
+
+    void gather( std::shared_ptr<Cabana::Halo<t_device>> halo ) override
+    {
+        Cabana::gather( *halo, aosoa_0 );
+        Cabana::gather( *halo, aosoa_1 );
+        Cabana::gather( *halo, aosoa_2 );
+    }
+
+    const char *name() override { return "System:3AoSoA"; }
+
+    AoSoA_3_0 get_aosoa_x() { return aosoa_0; }
+    AoSoA_3_0 get_aosoa_type() { return aosoa_0; }
+    AoSoA_3_1 get_aosoa_v() { return aosoa_1; }
+    AoSoA_3_1 get_aosoa_f() { return aosoa_1; }
+    AoSoA_3_2 get_aosoa_id() { return aosoa_2; }
+    AoSoA_3_2 get_aosoa_q() { return aosoa_2; }
+};
+#endif
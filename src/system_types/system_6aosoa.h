@@ -16,24 +16,31 @@
 
 #include <system.h>
 
-template <class t_device>
-class System<t_device, 6> : public SystemCommon<t_device>
+template <class t_device, int vector_length>
+class System<t_device, 6, vector_length> : public SystemCommon<t_device>
 {
+    // Configured per AoSoA vector lengths, or one run time selected length
+    static constexpr int vl_0 =
+        vector_length > 0 ? vector_length : CabanaMD_VECTORLENGTH_0;
+    static constexpr int vl_1 =
+        vector_length > 0 ? vector_length : CabanaMD_VECTORLENGTH_1;
+    static constexpr int vl_2 =
+        vector_length > 0 ? vector_length : CabanaMD_VECTORLENGTH_2;
+    static constexpr int vl_3 =
+        vector_length > 0 ? vector_length : CabanaMD_VECTORLENGTH_3;
+    static constexpr int vl_4 =
+        vector_length > 0 ? vector_length : CabanaMD_VECTORLENGTH_4;
+    static constexpr int vl_5 =
+        vector_length > 0 ? vector_length : CabanaMD_VECTORLENGTH_5;
     using t_tuple_x = Cabana::MemberTypes<T_FLOAT[3]>;
     using t_tuple_int = Cabana::MemberTypes<T_INT>;
     using t_tuple_fl = Cabana::MemberTypes<T_FLOAT>;
-    using AoSoA_x =
-        typename Cabana::AoSoA<t_tuple_x, t_device, CabanaMD_VECTORLENGTH_0>;
-    using AoSoA_v =
-        typename Cabana::AoSoA<t_tuple_x, t_device, CabanaMD_VECTORLENGTH_1>;
-    using AoSoA_f =
-        typename Cabana::AoSoA<t_tuple_x, t_device, CabanaMD_VECTORLENGTH_2>;
-    using AoSoA_id =
-        typename Cabana::AoSoA<t_tuple_int, t_device, CabanaMD_VECTORLENGTH_3>;
-    using AoSoA_type =
-        typename Cabana::AoSoA<t_tuple_int, t_device, CabanaMD_VECTORLENGTH_4>;
-    using AoSoA_q =
-        typename Cabana::AoSoA<t_tuple_fl, t_device, CabanaMD_VECTORLENGTH_5>;
+    using AoSoA_x = typename Cabana::AoSoA<t_tuple_x, t_device, vl_0>;
+    using AoSoA_v = typename Cabana::AoSoA<t_tuple_x, t_device, vl_1>;
+    using AoSoA_f = typename Cabana::AoSoA<t_tuple_x, t_device, vl_2>;
+    using AoSoA_id = typename Cabana::AoSoA<t_tuple_int, t_device, vl_3>;
+    using AoSoA_type = typename Cabana::AoSoA<t_tuple_int, t_device, vl_4>;
+    using AoSoA_q = typename Cabana::AoSoA<t_tuple_fl, t_device, vl_5>;
     AoSoA_x aosoa_x;
     AoSoA_v aosoa_v;
     AoSoA_f aosoa_f;
@@ -42,27 +49,30 @@ class System<t_device, 6> : public SystemCommon<t_device>
     AoSoA_q aosoa_q;
 
     using SystemCommon<t_device>::N_max;
+    using SystemCommon<t_device>::slice_generation;
+    using SystemCommon<t_device>::capacity_policy;
     // using SystemCommon<t_device>::mass;
 
   public:
     using SystemCommon<t_device>::SystemCommon;
 
+    // Same layout on the host (restart, data files, correctness)
+    using host_system_type = System<
+        Kokkos::Device<Kokkos::DefaultHostExecutionSpace, Kokkos::HostSpace>,
+        6, vector_length>;
+    // Run time selected vector length, 0 for the configured lengths
+    static int selected_vector_length() { return vector_length; }
+
     using memory_space = typename t_device::memory_space;
     using execution_space = typename t_device::execution_space;
 
     // Per Particle Property
-    using t_x =
-        typename System<t_device, 6>::AoSoA_x::template member_slice_type<0>;
-    using t_v =
-        typename System<t_device, 6>::AoSoA_v::template member_slice_type<0>;
-    using t_f =
-        typename System<t_device, 6>::AoSoA_f::template member_slice_type<0>;
-    using t_type =
-        typename System<t_device, 6>::AoSoA_type::template member_slice_type<0>;
-    using t_id =
-        typename System<t_device, 6>::AoSoA_id::template member_slice_type<0>;
-    using t_q =
-        typename System<t_device, 6>::AoSoA_q::template member_slice_type<0>;
+    using t_x = typename AoSoA_x::template member_slice_type<0>;
+    using t_v = typename AoSoA_v::template member_slice_type<0>;
+    using t_f = typename AoSoA_f::template member_slice_type<0>;
+    using t_type = typename AoSoA_type::template member_slice_type<0>;
+    using t_id = typename AoSoA_id::template member_slice_type<0>;
+    using t_q = typename AoSoA_q::template member_slice_type<0>;
 
     t_x x;
     t_v v;
@@ -73,21 +83,33 @@ class System<t_device, 6> : public SystemCommon<t_device>
 
     void init() override
     {
-        AoSoA_x aosoa_x( "X", N_max );
-        AoSoA_v aosoa_v( "V", N_max );
-        AoSoA_f aosoa_f( "F", N_max );
-        AoSoA_id aosoa_id( "ID", N_max );
-        AoSoA_type aosoa_type( "Type", N_max );
-        AoSoA_q aosoa_q( "Q", N_max );
+        aosoa_x = AoSoA_x( "System::X", N_max );
+        aosoa_v = AoSoA_v( "System::V", N_max );
+        aosoa_f = AoSoA_f( "System::F", N_max );
+        aosoa_id = AoSoA_id( "System::ID", N_max );
+        aosoa_type = AoSoA_type( "System::Type", N_max );
+        aosoa_q = AoSoA_q( "System::Q", N_max );
+    }
+
+    // Geometric capacity, only given back after the high-water mark decays
+    void reserve( T_INT N_new )
+    {
+        const std::size_t capacity =
+            capacity_policy.capacity( N_new, aosoa_x.capacity() );
+        set_capacity( aosoa_x, capacity );
+        set_capacity( aosoa_v, capacity );
+        set_capacity( aosoa_f, capacity );
+        set_capacity( aosoa_id, capacity );
+        set_capacity( aosoa_type, capacity );
+        set_capacity( aosoa_q, capacity );
+        N_max = aosoa_x.capacity();
     }
 
     void resize( T_INT N_new ) override
     {
-        if ( N_new > N_max )
-        {
-            N_max = N_new; // Number of global Particles
-        }
-        // Grow/shrink, slice.size() needs to be accurate
+        slice_generation++;
+        // Shrinking keeps the storage; slice.size() needs to be accurate
+        reserve( N_new );
         aosoa_x.resize( N_new );
         aosoa_v.resize( N_new );
         aosoa_f.resize( N_new );
@@ -124,9 +146,24 @@ class System<t_device, 6> : public SystemCommon<t_device>
         Cabana::permute( cell_list, aosoa_q );
     }
 
+    void permute( Cabana::BinningData<t_device> bin_data ) override
+    {
+        Cabana::permute( bin_data, aosoa_x );
+        Cabana::permute( bin_data, aosoa_v );
+        Cabana::permute( bin_data, aosoa_f );
+        Cabana::permute( bin_data, aosoa_type );
+        Cabana::permute( bin_data, aosoa_id );
+        Cabana::permute( bin_data, aosoa_q );
+    }
+
     void migrate(
         std::shared_ptr<Cabana::Distributor<t_device>> distributor ) override
     {
+        slice_generation++;
+        slice_id();
+        this->migrate_topology( *distributor, id );
+        // Room for the imports, so the in place migrate does not reallocate
+        reserve( distributor->totalNumImport() );
         Cabana::migrate( *distributor, aosoa_x );
         Cabana::migrate( *distributor, aosoa_v );
         Cabana::migrate( *distributor, aosoa_f );
@@ -14,17 +14,21 @@
 
 #include <CabanaMD_config.hpp>
 
+#include <capacity.h>
 #include <system_nnp.h>
 
+#include <vector>
+
 template <class t_device>
 class System_NNP<t_device, 1>
 {
     using t_tuple_NNP =
-        Cabana::MemberTypes<T_FLOAT[CabanaMD_MAXSYMMFUNC_NNP],
-                            T_FLOAT[CabanaMD_MAXSYMMFUNC_NNP], T_FLOAT>;
+        Cabana::MemberTypes<T_NNP_FLOAT[CabanaMD_MAXSYMMFUNC_NNP],
+                            T_NNP_FLOAT[CabanaMD_MAXSYMMFUNC_NNP], T_FLOAT>;
     using AoSoA_NNP_1 = typename Cabana::AoSoA<t_tuple_NNP, t_device,
                                                CabanaMD_VECTORLENGTH_NNP_0>;
     AoSoA_NNP_1 aosoa_0;
+    CapacityPolicy capacity_policy;
 
   public:
     using t_G =
@@ -40,10 +44,25 @@ class System_NNP<t_device, 1>
     t_dEdG dEdG;
     t_E E;
 
-    System_NNP<t_device, 1>() { AoSoA_NNP_1 aosoa_0( "All", 0 ); }
+    System_NNP<t_device, 1>()
+        : aosoa_0( "System_NNP::All", 0 )
+    {
+    }
     ~System_NNP<t_device, 1>() {}
 
-    void resize( T_INT N_new ) { aosoa_0.resize( N_new ); }
+    void resize( T_INT N_new )
+    {
+        set_capacity( aosoa_0,
+                      capacity_policy.capacity( N_new, aosoa_0.capacity() ) );
+        aosoa_0.resize( N_new );
+    }
+
+    // Fixed width rows; nothing depends on the element grouping
+    template <class t_order>
+    void arrange( const t_order, const std::vector<T_INT> &,
+                  const std::vector<T_INT> &, const std::vector<int> & )
+    {
+    }
 
     void slice_G() { G = Cabana::slice<0>( aosoa_0 ); }
     void slice_dEdG() { dEdG = Cabana::slice<1>( aosoa_0 ); }
@@ -14,13 +14,16 @@
 
 #include <CabanaMD_config.hpp>
 
+#include <capacity.h>
 #include <system_nnp.h>
 
+#include <vector>
+
 template <class t_device>
 class System_NNP<t_device, 3>
 {
     using t_tuple_NNP_SF =
-        Cabana::MemberTypes<T_FLOAT[CabanaMD_MAXSYMMFUNC_NNP]>;
+        Cabana::MemberTypes<T_NNP_FLOAT[CabanaMD_MAXSYMMFUNC_NNP]>;
     using t_tuple_NNP_fl = Cabana::MemberTypes<T_FLOAT>;
     using AoSoA_NNP_G = typename Cabana::AoSoA<t_tuple_NNP_SF, t_device,
                                                CabanaMD_VECTORLENGTH_NNP_0>;
@@ -31,6 +34,7 @@ class System_NNP<t_device, 3>
     AoSoA_NNP_G aosoa_G;
     AoSoA_NNP_dEdG aosoa_dEdG;
     AoSoA_NNP_E aosoa_E;
+    CapacityPolicy capacity_policy;
 
   public:
     using t_G =
@@ -47,20 +51,32 @@ class System_NNP<t_device, 3>
     t_E E;
 
     System_NNP<t_device, 3>()
+        : aosoa_G( "System_NNP::G", 0 )
+        , aosoa_dEdG( "System_NNP::dEdG", 0 )
+        , aosoa_E( "System_NNP::E", 0 )
     {
-        AoSoA_NNP_G aosoa_G( "G", 0 );
-        AoSoA_NNP_dEdG aosoa_dEdG( "dEdG", 0 );
-        AoSoA_NNP_E aosoa_E( "E", 0 );
     }
     ~System_NNP<t_device, 3>() {}
 
     void resize( T_INT N_new )
     {
+        const std::size_t capacity =
+            capacity_policy.capacity( N_new, aosoa_G.capacity() );
+        set_capacity( aosoa_G, capacity );
+        set_capacity( aosoa_dEdG, capacity );
+        set_capacity( aosoa_E, capacity );
         aosoa_G.resize( N_new );
         aosoa_dEdG.resize( N_new );
         aosoa_E.resize( N_new );
     }
 
+    // Fixed width rows; nothing depends on the element grouping
+    template <class t_order>
+    void arrange( const t_order, const std::vector<T_INT> &,
+                  const std::vector<T_INT> &, const std::vector<int> & )
+    {
+    }
+
     void slice_G() { G = Cabana::slice<0>( aosoa_G ); }
     void slice_dEdG() { dEdG = Cabana::slice<0>( aosoa_dEdG ); }
     void slice_E() { E = Cabana::slice<0>( aosoa_E ); }
@@ -0,0 +1,133 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef SYSTEM_NNP_COMPACT_H
+#define SYSTEM_NNP_COMPACT_H
+
+#include <CabanaMD_config.hpp>
+
+#include <system_nnp.h>
+
+#include <vector>
+
+// Per atom rows of a flat array, indexed like a G/dEdG slice. This is not a
+// Cabana::Slice; unit_test/tstNNP.hpp checks n2p2 gives the same energy and
+// forces with it as with the layout 1 AoSoA.
+template <class t_data, class t_offset>
+struct NNPCompactSlice
+{
+    using atomic_access_slice = NNPCompactSlice<
+        Kokkos::View<typename t_data::data_type, typename t_data::memory_space,
+                     Kokkos::MemoryTraits<Kokkos::Atomic>>,
+        t_offset>;
+
+    t_data data;
+    t_offset offset;
+
+    NNPCompactSlice() = default;
+    template <class t_src>
+    NNPCompactSlice( const t_src &src )
+        : data( src.data )
+        , offset( src.offset )
+    {
+    }
+    NNPCompactSlice( const t_data &data_, const t_offset &offset_ )
+        : data( data_ )
+        , offset( offset_ )
+    {
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    typename t_data::reference_type operator()( const int i,
+                                                const int k ) const
+    {
+        return data( offset( i ) + k );
+    }
+};
+
+// G and dEdG stored with each atom's own symmetry function count, sized at
+// run time from the model. Rows are laid out in element-grouped order, so
+// each element block is a dense (atoms x functions) matrix.
+template <class t_device>
+class System_NNP<t_device, 0>
+{
+    using memory_space = typename t_device::memory_space;
+    using t_data = Kokkos::View<T_NNP_FLOAT *, memory_space>;
+    using t_offset = Kokkos::View<T_INT *, memory_space>;
+
+    t_data data_G, data_dEdG;
+    t_offset offset;
+    Kokkos::View<T_FLOAT *, memory_space> data_E;
+
+  public:
+    using t_G = NNPCompactSlice<t_data, t_offset>;
+    using t_dEdG = NNPCompactSlice<t_data, t_offset>;
+    using t_E = Kokkos::View<T_FLOAT *, memory_space>;
+    t_G G;
+    t_dEdG dEdG;
+    t_E E;
+
+    System_NNP<t_device, 0>()
+        : data_G( "System_NNP::G", 0 )
+        , data_dEdG( "System_NNP::dEdG", 0 )
+        , offset( "System_NNP::offset", 0 )
+        , data_E( "System_NNP::E", 0 )
+    {
+    }
+    ~System_NNP<t_device, 0>() {}
+
+    void resize( T_INT N_new )
+    {
+        if ( data_E.extent( 0 ) < (std::size_t)N_new )
+        {
+            Kokkos::resize( data_E, N_new );
+            Kokkos::resize( offset, N_new );
+        }
+    }
+
+    // Row offsets from the element grouping: order lists the atoms of
+    // element e in [offsets[e], offsets[e] + counts[e]), each with
+    // widths[e] symmetry functions
+    template <class t_order>
+    void arrange( const t_order order, const std::vector<T_INT> &counts,
+                  const std::vector<T_INT> &offsets,
+                  const std::vector<int> &widths )
+    {
+        using exe_space = typename t_device::execution_space;
+        auto offset_copy = offset;
+        std::size_t size = 0;
+        for ( std::size_t e = 0; e < counts.size(); e++ )
+        {
+            const T_INT begin = offsets[e];
+            const T_INT base = size;
+            const int width = widths[e];
+            Kokkos::parallel_for(
+                "System_NNP::arrange",
+                Kokkos::RangePolicy<exe_space>( 0, counts[e] ),
+                KOKKOS_LAMBDA( const int a ) {
+                    offset_copy( order( begin + a ) ) = base + a * width;
+                } );
+            size += (std::size_t)counts[e] * width;
+        }
+        if ( data_G.extent( 0 ) < size )
+        {
+            Kokkos::realloc( data_G, size * 1.1 );
+            Kokkos::realloc( data_dEdG, size * 1.1 );
+        }
+    }
+
+    void slice_G() { G = t_G( data_G, offset ); }
+    void slice_dEdG() { dEdG = t_dEdG( data_dEdG, offset ); }
+    void slice_E() { E = data_E; }
+
+    const char *name() { return "NNPSystem:Compact"; }
+};
+#endif
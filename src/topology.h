@@ -0,0 +1,131 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <Cabana_Core.hpp>
+#include <Kokkos_Core.hpp>
+#include <Kokkos_UnorderedMap.hpp>
+
+#include <types.h>
+
+#include <mpi.h>
+
+#include <vector>
+
+// One bonded interaction from the data file, listed once for each atom it
+// involves (the owner)
+struct TopologyRecord
+{
+    T_INT owner;
+    T_INT atoms[3];
+    T_INT type;
+    // Number of atoms: 2 for bonds, 3 for angles
+    int size;
+};
+
+// Nearest periodic image of a separation along a dimension of length L;
+// ghost copies of an interaction atom may be any periodic image
+KOKKOS_INLINE_FUNCTION
+T_F_FLOAT minimum_image( T_F_FLOAT d, const T_F_FLOAT L )
+{
+    if ( d > 0.5 * L )
+        d -= L;
+    else if ( d < -0.5 * L )
+        d += L;
+    return d;
+}
+
+// Bonded interactions of num_atoms atoms. Every atom keeps its own copy of
+// each interaction it is part of, keyed by global id, so the copies move
+// with the atoms and each rank computes forces on its owned atoms only (no
+// reverse communication of ghost forces).
+template <class t_device, int num_atoms>
+class TopologyList
+{
+  public:
+    using memory_space = typename t_device::memory_space;
+    using exe_space = typename t_device::execution_space;
+    using t_map = Kokkos::UnorderedMap<T_INT, T_INT, t_device>;
+    using t_rank = Kokkos::View<int *, memory_space>;
+
+    // Owner id, ids of all atoms in the interaction, interaction type
+    using t_entries =
+        Cabana::AoSoA<Cabana::MemberTypes<T_INT, T_INT[num_atoms], T_INT>,
+                      t_device>;
+    t_entries entries;
+
+    // Compact rows per owned atom after resolve: interactions of atom i are
+    // offsets( i ) to offsets( i + 1 ), with the local or ghost index of
+    // every atom, the position of atom i among them, and the type
+    Kokkos::View<T_INT *, memory_space> offsets;
+    Kokkos::View<T_INT * [num_atoms], memory_space> index;
+    Kokkos::View<int *, memory_space> slot;
+    Kokkos::View<T_INT *, memory_space> type;
+
+    void add( const std::vector<TopologyRecord> &records );
+
+    // Send every copy to the new rank of its owner (atom_rank per old
+    // local index, owned ids in map)
+    void migrate( MPI_Comm comm, const std::vector<int> &neighbors,
+                  const t_rank atom_rank, const t_map map );
+
+    // Rebuild the rows; returns the number of atoms not found locally
+    T_INT resolve( const t_map map, const T_INT N_local );
+
+    std::size_t size() const { return entries.size(); }
+
+  private:
+    Kokkos::View<T_INT *, memory_space> cursor;
+};
+
+template <class t_device>
+class Topology
+{
+  public:
+    using memory_space = typename t_device::memory_space;
+    using exe_space = typename t_device::execution_space;
+    using t_map = Kokkos::UnorderedMap<T_INT, T_INT, t_device>;
+
+    // Global counts from the data file header
+    T_INT nbonds;
+    T_INT nangles;
+    int nbondtypes;
+    int nangletypes;
+    TopologyList<t_device, 2> bonds;
+    TopologyList<t_device, 3> angles;
+
+    Topology();
+
+    void add( const std::vector<TopologyRecord> &records );
+
+    // Called by System::migrate before the atoms move (id is the slice of
+    // all atoms handed to the distributor)
+    template <class t_id>
+    void migrate( const Cabana::Distributor<t_device> &distributor,
+                  const t_id id );
+
+    // Hash global ids to local indices (owned atoms first, then ghosts)
+    // once per exchange_halo; returns the number of interaction atoms
+    // missing from the ghosts
+    template <class t_id>
+    T_INT resolve( const t_id id, const T_INT N_local, const T_INT N_ghost );
+
+  private:
+    t_map map;
+
+    template <class t_id>
+    void map_ids( const t_id id, const T_INT begin, const T_INT end );
+};
+
+#include <topology_impl.h>
+#endif
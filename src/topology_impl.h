@@ -0,0 +1,217 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+template <class t_device, int num_atoms>
+void TopologyList<t_device, num_atoms>::add(
+    const std::vector<TopologyRecord> &records )
+{
+    auto host = Cabana::create_mirror_view_and_copy( Kokkos::HostSpace(),
+                                                     entries );
+    std::size_t n = host.size();
+    host.resize( n + records.size() );
+    auto h_owner = Cabana::slice<0>( host );
+    auto h_atoms = Cabana::slice<1>( host );
+    auto h_type = Cabana::slice<2>( host );
+    for ( auto &r : records )
+    {
+        h_owner( n ) = r.owner;
+        for ( int a = 0; a < num_atoms; a++ )
+            h_atoms( n, a ) = r.atoms[a];
+        h_type( n ) = r.type;
+        n++;
+    }
+    entries = Cabana::create_mirror_view_and_copy( memory_space(), host );
+}
+
+template <class t_device, int num_atoms>
+void TopologyList<t_device, num_atoms>::migrate(
+    MPI_Comm comm, const std::vector<int> &neighbors, const t_rank atom_rank,
+    const t_map map )
+{
+    auto owner = Cabana::slice<0>( entries );
+    t_rank export_rank( "TopologyList::export_rank", entries.size() );
+    Kokkos::parallel_for(
+        "TopologyList::export_rank",
+        Kokkos::RangePolicy<exe_space>( 0, entries.size() ),
+        KOKKOS_LAMBDA( const int e ) {
+            // Copies of removed atoms are removed too
+            const auto m = map.find( owner( e ) );
+            export_rank( e ) =
+                map.valid_at( m ) ? atom_rank( map.value_at( m ) ) : -1;
+        } );
+
+    Cabana::Distributor<t_device> distributor( comm, export_rank, neighbors );
+    Cabana::migrate( distributor, entries );
+}
+
+template <class t_device, int num_atoms>
+T_INT TopologyList<t_device, num_atoms>::resolve( const t_map map,
+                                                  const T_INT N_local )
+{
+    const std::size_t n = entries.size();
+    if ( offsets.extent( 0 ) < (std::size_t)N_local + 1 )
+    {
+        Kokkos::realloc( offsets, N_local + 1 );
+        Kokkos::realloc( cursor, N_local + 1 );
+    }
+    if ( index.extent( 0 ) < n )
+    {
+        Kokkos::realloc( index, n );
+        Kokkos::realloc( slot, n );
+        Kokkos::realloc( type, n );
+    }
+
+    // Count the copies of every owned atom, then offsets by a prefix sum
+    auto owner = Cabana::slice<0>( entries );
+    auto atoms = Cabana::slice<1>( entries );
+    auto entry_type = Cabana::slice<2>( entries );
+    auto offsets_copy = offsets;
+    auto cursor_copy = cursor;
+    auto index_copy = index;
+    auto slot_copy = slot;
+    auto type_copy = type;
+    Kokkos::deep_copy( offsets, 0 );
+    T_INT missing = 0;
+    Kokkos::parallel_reduce(
+        "TopologyList::count", Kokkos::RangePolicy<exe_space>( 0, n ),
+        KOKKOS_LAMBDA( const int e, T_INT &lost ) {
+            const auto m = map.find( owner( e ) );
+            const T_INT row = map.valid_at( m ) ? map.value_at( m ) : N_local;
+            if ( row < N_local )
+                Kokkos::atomic_increment( &offsets_copy( row + 1 ) );
+            else
+                lost++;
+        },
+        missing );
+    Kokkos::parallel_scan(
+        "TopologyList::offsets",
+        Kokkos::RangePolicy<exe_space>( 0, N_local + 1 ),
+        KOKKOS_LAMBDA( const int i, T_INT &sum, const bool final ) {
+            sum += offsets_copy( i );
+            if ( final )
+            {
+                offsets_copy( i ) = sum;
+                cursor_copy( i ) = sum;
+            }
+        } );
+
+    T_INT unresolved = 0;
+    Kokkos::parallel_reduce(
+        "TopologyList::fill", Kokkos::RangePolicy<exe_space>( 0, n ),
+        KOKKOS_LAMBDA( const int e, T_INT &lost ) {
+            const auto m = map.find( owner( e ) );
+            if ( !map.valid_at( m ) || map.value_at( m ) >= N_local )
+                return;
+            const T_INT row = map.value_at( m );
+            const T_INT p = Kokkos::atomic_fetch_add( &cursor_copy( row ), 1 );
+            for ( int a = 0; a < num_atoms; a++ )
+            {
+                const auto ma = map.find( atoms( e, a ) );
+                const bool found = map.valid_at( ma );
+                index_copy( p, a ) = found ? map.value_at( ma ) : -1;
+                if ( !found )
+                    lost++;
+                if ( atoms( e, a ) == owner( e ) )
+                    slot_copy( p ) = a;
+            }
+            type_copy( p ) = entry_type( e );
+        },
+        unresolved );
+
+    return missing + unresolved;
+}
+
+template <class t_device>
+Topology<t_device>::Topology()
+    : nbonds( 0 )
+    , nangles( 0 )
+    , nbondtypes( 0 )
+    , nangletypes( 0 )
+{
+}
+
+template <class t_device>
+void Topology<t_device>::add( const std::vector<TopologyRecord> &records )
+{
+    std::vector<TopologyRecord> bond_records, angle_records;
+    for ( auto &r : records )
+    {
+        if ( r.size == 2 )
+            bond_records.push_back( r );
+        else
+            angle_records.push_back( r );
+    }
+    bonds.add( bond_records );
+    angles.add( angle_records );
+}
+
+template <class t_device>
+template <class t_id>
+void Topology<t_device>::map_ids( const t_id id, const T_INT begin,
+                                  const T_INT end )
+{
+    // Ids already present keep the first (owned) index
+    auto map_copy = map;
+    Kokkos::parallel_for(
+        "Topology::map_ids", Kokkos::RangePolicy<exe_space>( begin, end ),
+        KOKKOS_LAMBDA( const int i ) { map_copy.insert( id( i ), i ); } );
+}
+
+template <class t_device>
+template <class t_id>
+void Topology<t_device>::migrate(
+    const Cabana::Distributor<t_device> &distributor, const t_id id )
+{
+    const T_INT n = distributor.exportSize();
+
+    // New rank of every atom from the export steering, grouped by neighbor
+    Kokkos::View<int *, memory_space> atom_rank( "Topology::atom_rank", n );
+    Kokkos::deep_copy( atom_rank, -1 );
+    auto steering = distributor.getExportSteering();
+    std::vector<int> neighbors( distributor.numNeighbor() );
+    std::size_t offset = 0;
+    for ( int k = 0; k < distributor.numNeighbor(); k++ )
+    {
+        const int rank = distributor.neighborRank( k );
+        neighbors[k] = rank;
+        Kokkos::parallel_for(
+            "Topology::atom_rank",
+            Kokkos::RangePolicy<exe_space>( offset,
+                                            offset +
+                                                distributor.numExport( k ) ),
+            KOKKOS_LAMBDA( const int e ) {
+                atom_rank( steering( e ) ) = rank;
+            } );
+        offset += distributor.numExport( k );
+    }
+
+    if ( map.capacity() < (std::size_t)n )
+        map.rehash( n );
+    map.clear();
+    map_ids( id, 0, n );
+
+    bonds.migrate( distributor.comm(), neighbors, atom_rank, map );
+    angles.migrate( distributor.comm(), neighbors, atom_rank, map );
+}
+
+template <class t_device>
+template <class t_id>
+T_INT Topology<t_device>::resolve( const t_id id, const T_INT N_local,
+                                   const T_INT N_ghost )
+{
+    if ( map.capacity() < (std::size_t)( N_local + N_ghost ) )
+        map.rehash( N_local + N_ghost );
+    map.clear();
+    map_ids( id, 0, N_local );
+    map_ids( id, N_local, N_local + N_ghost );
+
+    return bonds.resolve( map, N_local ) + angles.resolve( map, N_local );
+}
@@ -49,6 +49,8 @@
 #ifndef TYPES_H
 #define TYPES_H
 
+#include <CabanaMD_config.hpp>
+
 // Module Types etc
 // Units to be used
 enum
@@ -77,24 +79,72 @@ enum
 // Integrator Type
 enum
 {
-    INTEGRATOR_NVE
+    INTEGRATOR_NVE,
+    INTEGRATOR_RESPA
+};
+// Thermostat Type
+enum
+{
+    THERMOSTAT_NONE,
+    THERMOSTAT_NOSE_HOOVER,
+    THERMOSTAT_LANGEVIN
 };
 // Binning Type
 enum
 {
-    BINNING_LINKEDCELL
+    BINNING_LINKEDCELL,
+    BINNING_MORTON
 };
 // Comm Type
 enum
 {
-    COMM_MPI
+    COMM_MPI,
+    COMM_MPI_26
+};
+// GPU-aware MPI for halo buffers
+enum
+{
+    GPU_AWARE_AUTO,
+    GPU_AWARE_ON,
+    GPU_AWARE_OFF
+};
+// Domain decomposition Type
+enum
+{
+    DECOMPOSITION_UNIFORM,
+    DECOMPOSITION_NODE
 };
 // Force Type
 enum
 {
     FORCE_LJ,
     FORCE_SNAP,
-    FORCE_NNP
+    FORCE_NNP,
+    FORCE_TABLE,
+    FORCE_EAM
+};
+// Pair table interpolation Type
+enum
+{
+    TABLE_LINEAR,
+    TABLE_SPLINE
+};
+// Long range electrostatics Type
+enum
+{
+    KSPACE_NONE,
+    KSPACE_PPPM
+};
+// Bonded interaction Types
+enum
+{
+    BOND_NONE,
+    BOND_HARMONIC
+};
+enum
+{
+    ANGLE_NONE,
+    ANGLE_HARMONIC
 };
 // Force Iteration Type
 enum
@@ -116,13 +166,29 @@ enum
     NEIGH_VERLET_2D,
     NEIGH_VERLET_CSR,
     NEIGH_TREE_2D,
-    NEIGH_TREE_CSR
+    NEIGH_TREE_CSR,
+    NEIGH_CELL_CSR,
+    NEIGH_CLUSTER,
+    NEIGH_AUTO
 };
 // Input File Type
 enum
 {
     INPUT_LAMMPS
 };
+// LAMMPS data file section
+enum
+{
+    DATA_NONE,
+    DATA_ATOMS,
+    DATA_VELOCITIES,
+    DATA_MASSES,
+    DATA_PAIR_COEFFS,
+    DATA_BONDS,
+    DATA_ANGLES,
+    DATA_BOND_COEFFS,
+    DATA_ANGLE_COEFFS
+};
 
 // Macros to work around the fact that std::max/min is not available on GPUs
 #define MAX( a, b ) ( a > b ? a : b )
@@ -136,6 +202,17 @@ enum
 #ifndef T_FLOAT
 #define T_FLOAT double
 #endif
+
+// Mixed precision: positions and forces are stored and computed in float;
+// velocities, integration, and energy/virial reductions use T_FLOAT
+#ifdef CabanaMD_ENABLE_MIXED_PRECISION
+#ifndef T_X_FLOAT
+#define T_X_FLOAT float
+#endif
+#ifndef T_F_FLOAT
+#define T_F_FLOAT float
+#endif
+#endif
 #ifndef T_X_FLOAT
 #define T_X_FLOAT T_FLOAT
 #endif
@@ -146,4 +223,14 @@ enum
 #define T_F_FLOAT T_FLOAT
 #endif
 
+// NNP symmetry functions, their energy derivatives, and the network
+// activations; forces and energies are still accumulated in T_FLOAT
+#ifndef T_NNP_FLOAT
+#ifdef CabanaMD_ENABLE_NNP_FLOAT
+#define T_NNP_FLOAT float
+#else
+#define T_NNP_FLOAT T_FLOAT
+#endif
+#endif
+
 #endif // TYPES_H
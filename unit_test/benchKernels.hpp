@@ -0,0 +1,258 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#include <CabanaMD_config.hpp>
+
+#include <binning_cabana.h>
+#include <comm_mpi.h>
+#include <force_lj_cabana_neigh.h>
+#include <integrator_nve.h>
+#include <neighbor.h>
+#include <system.h>
+
+#include <Cabana_Core.hpp>
+#include <Kokkos_Core.hpp>
+#include <Kokkos_Random.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Benchmark
+{
+//---------------------------------------------------------------------------//
+// LJ FCC lattice at reduced density 0.8442 (the in.lj setup) with ghosts
+// and a neighbor list, ready for any kernel.
+template <class t_System, class t_Neighbor>
+struct Lattice
+{
+    const double lattice_constant = 1.6796;
+    const double force_cutoff = 2.5;
+    const double neigh_cutoff = 2.8;
+
+    std::unique_ptr<t_System> system;
+    std::unique_ptr<Comm<t_System>> comm;
+    std::unique_ptr<Binning<t_System>> binning;
+    std::unique_ptr<t_Neighbor> neighbor;
+
+    Lattice( const int cells, const bool half_neigh )
+    {
+        system.reset( new t_System );
+        system->init();
+
+        // Manually setup what would be done in input
+        system->dt = 0.005;
+        system->mvv2e = 1.0;
+        Kokkos::deep_copy( system->mass, 1.0 );
+
+        double box = lattice_constant * cells;
+        system->create_domain( {0.0, 0.0, 0.0}, {box, box, box} );
+
+        int num_atom = 4 * cells * cells * cells;
+        system->resize( num_atom );
+        system->N = num_atom;
+        system->N_local = num_atom;
+        system->N_ghost = 0;
+        system->slice_all();
+        auto x = system->x;
+        auto v = system->v;
+        auto f = system->f;
+        auto type = system->type;
+        auto id = system->id;
+
+        // FCC sites with random velocities
+        using PoolType = Kokkos::Random_XorShift64_Pool<TEST_EXECSPACE>;
+        using RandomType = Kokkos::Random_XorShift64<TEST_EXECSPACE>;
+        PoolType pool( 342343901 );
+        double a = lattice_constant;
+        auto lattice_op = KOKKOS_LAMBDA( const int p )
+        {
+            const int k = p % 4;
+            const int cell = p / 4;
+            const double basis[4][3] = {
+                {0.0, 0.0, 0.0}, {0.5, 0.5, 0.0}, {0.5, 0.0, 0.5},
+                {0.0, 0.5, 0.5}};
+            const int ijk[3] = {cell % cells, ( cell / cells ) % cells,
+                                cell / ( cells * cells )};
+            auto gen = pool.get_state();
+            for ( int d = 0; d < 3; ++d )
+            {
+                x( p, d ) = a * ( ijk[d] + basis[k][d] );
+                v( p, d ) =
+                    Kokkos::rand<RandomType, double>::draw( gen, -1.0, 1.0 );
+                f( p, d ) = 0.0;
+            }
+            type( p ) = 0;
+            id( p ) = p + 1;
+            pool.free_state( gen );
+        };
+        Kokkos::RangePolicy<TEST_EXECSPACE> exec_policy( 0, num_atom );
+        Kokkos::parallel_for( exec_policy, lattice_op );
+        Kokkos::fence();
+
+        comm.reset( new Comm<t_System>( system.get(), neigh_cutoff ) );
+        comm->create_domain_decomposition();
+        comm->exchange();
+
+        binning.reset( new Binning<t_System>( system.get() ) );
+        sort();
+        comm->exchange_halo();
+
+        neighbor.reset( new t_Neighbor( neigh_cutoff, half_neigh, 100 ) );
+        neighbor->binning = binning.get();
+        neighbor->create( system.get() );
+    }
+
+    ~Lattice() { comm->free_halo_plan(); }
+
+    void sort()
+    {
+        binning->create_binning( neigh_cutoff, neigh_cutoff, neigh_cutoff, 1,
+                                 true, false, true );
+    }
+
+    int64_t atoms( const benchmark::State &state ) const
+    {
+        return state.iterations() * system->N_local;
+    }
+};
+
+//---------------------------------------------------------------------------//
+// BENCHMARKS (atoms per second; argument: FCC cells per dimension)
+//---------------------------------------------------------------------------//
+template <class t_System, class t_Neighbor>
+void benchBinning( benchmark::State &state )
+{
+    Lattice<t_System, t_Neighbor> lattice( state.range( 0 ), false );
+    for ( auto _ : state )
+    {
+        lattice.sort();
+        Kokkos::fence();
+    }
+    state.SetItemsProcessed( lattice.atoms( state ) );
+}
+
+template <class t_System, class t_Neighbor>
+void benchNeighborCreate( benchmark::State &state )
+{
+    Lattice<t_System, t_Neighbor> lattice( state.range( 0 ), state.range( 1 ) );
+    for ( auto _ : state )
+    {
+        lattice.neighbor->create( lattice.system.get() );
+        Kokkos::fence();
+    }
+    state.SetItemsProcessed( lattice.atoms( state ) );
+}
+
+template <class t_System, class t_Neighbor, class t_parallel>
+void benchForceLJ( benchmark::State &state )
+{
+    Lattice<t_System, t_Neighbor> lattice( state.range( 0 ), state.range( 1 ) );
+    auto system = lattice.system.get();
+    ForceLJ<t_System, t_Neighbor, t_parallel> force( system );
+    force.init_coeff( {{"pair_coeff", "1", "1", "1.0", "1.0",
+                        std::to_string( lattice.force_cutoff )}} );
+    for ( auto _ : state )
+    {
+        system->slice_f();
+        Cabana::deep_copy( system->f, 0.0 );
+        force.compute( system, lattice.neighbor.get() );
+        Kokkos::fence();
+    }
+    state.SetItemsProcessed( lattice.atoms( state ) );
+}
+
+template <class t_System, class t_Neighbor>
+void benchUpdateHalo( benchmark::State &state )
+{
+    Lattice<t_System, t_Neighbor> lattice( state.range( 0 ), false );
+    for ( auto _ : state )
+    {
+        lattice.comm->update_halo();
+        Kokkos::fence();
+    }
+    state.SetItemsProcessed( lattice.atoms( state ) );
+}
+
+template <class t_System, class t_Neighbor>
+void benchIntegrator( benchmark::State &state )
+{
+    Lattice<t_System, t_Neighbor> lattice( state.range( 0 ), false );
+    auto system = lattice.system.get();
+    Integrator<t_System> integrator( system );
+    for ( auto _ : state )
+    {
+        integrator.initial_integrate( system );
+        integrator.final_integrate( system );
+        Kokkos::fence();
+    }
+    state.SetItemsProcessed( lattice.atoms( state ) );
+}
+
+//---------------------------------------------------------------------------//
+using DeviceType = Kokkos::Device<TEST_EXECSPACE, TEST_MEMSPACE>;
+#if ( CabanaMD_LAYOUT == 1 )
+using t_System = System<DeviceType, 1>;
+#elif ( CabanaMD_LAYOUT == 2 )
+using t_System = System<DeviceType, 2>;
+#elif ( CabanaMD_LAYOUT == 3 )
+using t_System = System<DeviceType, 3>;
+#elif ( CabanaMD_LAYOUT == 6 )
+using t_System = System<DeviceType, 6>;
+#endif
+using t_FullNeigh =
+    NeighborVerlet<t_System, Cabana::FullNeighborTag, Cabana::VerletLayout2D>;
+using t_HalfNeigh =
+    NeighborVerlet<t_System, Cabana::HalfNeighborTag, Cabana::VerletLayout2D>;
+
+// 4000 and 32000 atoms
+BENCHMARK_TEMPLATE( benchBinning, t_System, t_FullNeigh )
+    ->Arg( 10 )
+    ->Arg( 20 )
+    ->Unit( benchmark::kMillisecond );
+BENCHMARK_TEMPLATE( benchNeighborCreate, t_System, t_FullNeigh )
+    ->Args( {10, 0} )
+    ->Args( {20, 0} )
+    ->Unit( benchmark::kMillisecond );
+BENCHMARK_TEMPLATE( benchNeighborCreate, t_System, t_HalfNeigh )
+    ->Args( {10, 1} )
+    ->Args( {20, 1} )
+    ->Unit( benchmark::kMillisecond );
+BENCHMARK_TEMPLATE( benchForceLJ, t_System, t_FullNeigh, Cabana::SerialOpTag )
+    ->Args( {10, 0} )
+    ->Args( {20, 0} )
+    ->Unit( benchmark::kMillisecond );
+BENCHMARK_TEMPLATE( benchForceLJ, t_System, t_FullNeigh, Cabana::TeamOpTag )
+    ->Args( {10, 0} )
+    ->Args( {20, 0} )
+    ->Unit( benchmark::kMillisecond );
+BENCHMARK_TEMPLATE( benchForceLJ, t_System, t_HalfNeigh, Cabana::SerialOpTag )
+    ->Args( {10, 1} )
+    ->Args( {20, 1} )
+    ->Unit( benchmark::kMillisecond );
+BENCHMARK_TEMPLATE( benchForceLJ, t_System, t_HalfNeigh, Cabana::TeamOpTag )
+    ->Args( {10, 1} )
+    ->Args( {20, 1} )
+    ->Unit( benchmark::kMillisecond );
+BENCHMARK_TEMPLATE( benchUpdateHalo, t_System, t_FullNeigh )
+    ->Arg( 10 )
+    ->Arg( 20 )
+    ->Unit( benchmark::kMillisecond );
+BENCHMARK_TEMPLATE( benchIntegrator, t_System, t_FullNeigh )
+    ->Arg( 10 )
+    ->Arg( 20 )
+    ->Unit( benchmark::kMillisecond );
+
+//---------------------------------------------------------------------------//
+
+} // end namespace Benchmark
@@ -0,0 +1,143 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include <Kokkos_Core.hpp>
+
+#include <mpi.h>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+// Console output, keeping the items per second of every benchmark
+class BaselineReporter : public benchmark::ConsoleReporter
+{
+  public:
+    std::map<std::string, double> rates;
+
+    void ReportRuns( const std::vector<Run> &runs ) override
+    {
+        benchmark::ConsoleReporter::ReportRuns( runs );
+        for ( auto &run : runs )
+        {
+            auto rate = run.counters.find( "items_per_second" );
+            if ( rate != run.counters.end() )
+                rates[run.benchmark_name()] = rate->second.value;
+        }
+    }
+};
+
+// Write the rates as the new baseline (--record)
+int recordBaseline( const std::map<std::string, double> &rates,
+                    const std::string file )
+{
+    std::ofstream out( file );
+    for ( auto &rate : rates )
+        out << rate.first << " " << rate.second << "\n";
+    if ( !out )
+    {
+        std::cout << "Cannot write baseline " << file << std::endl;
+        return 1;
+    }
+    std::cout << "Recorded baseline " << file << std::endl;
+    return 0;
+}
+
+// Fail on any rate more than tolerance below its baseline, and on a
+// missing baseline
+int checkBaseline( const std::map<std::string, double> &rates,
+                   const std::string file, const double tolerance )
+{
+    std::ifstream in( file );
+    if ( !in )
+    {
+        std::cout << "No baseline " << file << " (run with --record to "
+                  << "write one)" << std::endl;
+        return 1;
+    }
+
+    std::map<std::string, double> baseline;
+    std::string name;
+    double value;
+    while ( in >> name >> value )
+        baseline[name] = value;
+
+    int regressions = 0;
+    for ( auto &rate : rates )
+    {
+        auto base = baseline.find( rate.first );
+        if ( base == baseline.end() )
+        {
+            std::cout << "No baseline for " << rate.first << std::endl;
+            regressions++;
+            continue;
+        }
+        double change = rate.second / base->second - 1.0;
+        if ( change < -tolerance )
+        {
+            std::cout << "Regression: " << rate.first << " "
+                      << 100.0 * change << "% (" << rate.second << " vs "
+                      << base->second << " items/s)" << std::endl;
+            regressions++;
+        }
+    }
+    return regressions > 0;
+}
+
+int main( int argc, char *argv[] )
+{
+    MPI_Init( &argc, &argv );
+    Kokkos::initialize( argc, argv );
+
+    // Baseline options are removed before Google Benchmark sees them
+    std::string baseline;
+    double tolerance = 0.1;
+    bool record = false;
+    int n = 1;
+    for ( int i = 1; i < argc; i++ )
+    {
+        if ( std::strncmp( argv[i], "--baseline=", 11 ) == 0 )
+            baseline = argv[i] + 11;
+        else if ( std::strcmp( argv[i], "--record" ) == 0 )
+            record = true;
+        else if ( std::strncmp( argv[i], "--tolerance=", 12 ) == 0 )
+            tolerance = std::stod( argv[i] + 12 );
+        else
+            argv[n++] = argv[i];
+    }
+    argc = n;
+
+    benchmark::Initialize( &argc, argv );
+    int return_val = 0;
+    if ( benchmark::ReportUnrecognizedArguments( argc, argv ) )
+        return_val = 1;
+    else
+    {
+        BaselineReporter reporter;
+        benchmark::RunSpecifiedBenchmarks( &reporter );
+        int rank;
+        MPI_Comm_rank( MPI_COMM_WORLD, &rank );
+        if ( rank == 0 && !baseline.empty() )
+            return_val =
+                record ? recordBaseline( reporter.rates, baseline )
+                       : checkBaseline( reporter.rates, baseline, tolerance );
+    }
+    MPI_Bcast( &return_val, 1, MPI_INT, 0, MPI_COMM_WORLD );
+
+    Kokkos::finalize();
+    MPI_Finalize();
+    return return_val;
+}
@@ -145,6 +145,8 @@ TEST( TEST_CATEGORY, reversibility_test )
     using t_System = System<DeviceType, 1>;
 #elif ( CabanaMD_LAYOUT == 2 )
     using t_System = System<DeviceType, 2>;
+#elif ( CabanaMD_LAYOUT == 3 )
+    using t_System = System<DeviceType, 3>;
 #elif ( CabanaMD_LAYOUT == 6 )
     using t_System = System<DeviceType, 6>;
 #endif
@@ -0,0 +1,380 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#include <CabanaMD_config.hpp>
+
+#include <force_nnp_cabana_neigh.h>
+#include <neighbor.h>
+#include <nnp_batch.h>
+#include <nnp_model.h>
+#include <system.h>
+#include <system_nnp_1aosoa.h>
+#include <system_nnp_compact.h>
+
+#include <Cabana_Core.hpp>
+#include <Kokkos_Core.hpp>
+#include <Kokkos_Random.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Test
+{
+//---------------------------------------------------------------------------//
+// Create a perturbed fcc Ni cluster in the middle of a large box, so no
+// ghost atoms are needed.
+template <class t_System>
+t_System createCluster( const int cells, const double lattice )
+{
+    t_System system;
+    system.init();
+
+    int num_atom = 4 * cells * cells * cells;
+    system.resize( num_atom );
+    system.N_local = num_atom;
+    system.N_ghost = 0;
+    system.N = num_atom;
+
+    double box = 4.0 * cells * lattice;
+    system.create_domain( {-box, -box, -box}, {box, box, box} );
+
+    system.slice_x();
+    system.slice_type();
+    auto x = system.x;
+    auto type = system.type;
+    using PoolType = Kokkos::Random_XorShift64_Pool<TEST_EXECSPACE>;
+    using RandomType = Kokkos::Random_XorShift64<TEST_EXECSPACE>;
+    PoolType pool( 342343901 );
+    auto create_op = KOKKOS_LAMBDA( const int p )
+    {
+        const double basis[4][3] = {
+            {0.0, 0.0, 0.0}, {0.5, 0.5, 0.0}, {0.5, 0.0, 0.5}, {0.0, 0.5, 0.5}};
+        int b = p % 4;
+        int c = p / 4;
+        int cell[3] = {c % cells, ( c / cells ) % cells, c / cells / cells};
+        auto gen = pool.get_state();
+        for ( int d = 0; d < 3; ++d )
+        {
+            double shift =
+                Kokkos::rand<RandomType, double>::draw( gen, -0.1, 0.1 );
+            x( p, d ) = ( cell[d] + basis[b][d] ) * lattice + shift;
+        }
+        pool.free_state( gen );
+        type( p ) = 0;
+    };
+    Kokkos::RangePolicy<TEST_EXECSPACE> exec_policy( 0, num_atom );
+    Kokkos::parallel_for( exec_policy, create_op );
+    Kokkos::fence();
+
+    return system;
+}
+
+//---------------------------------------------------------------------------//
+// Energy and forces of the example Ni model with one System_NNP layout and
+// optional pair_style keywords.
+template <class t_System, class t_System_NNP,
+          class t_iteration = Cabana::FullNeighborTag>
+double computeNNP( t_System &system, const double cutoff,
+                   Kokkos::View<double **, Kokkos::HostSpace> &forces,
+                   const std::vector<std::string> &options = {} )
+{
+    using t_Neigh =
+        NeighborVerlet<t_System, t_iteration, Cabana::VerletLayout2D>;
+    const bool half = std::is_same<t_iteration, Cabana::HalfNeighborTag>::value;
+    t_Neigh neighbor( cutoff, half, 100 );
+    neighbor.create( &system );
+
+    ForceNNP<t_System, t_System_NNP, t_Neigh, Cabana::SerialOpTag,
+             Cabana::SerialOpTag>
+        force( &system );
+    std::vector<std::string> words = {"pair_style", "nnp", "dir",
+                                      std::string( CabanaMD_NNP_TEST_DIR )};
+    words.insert( words.end(), options.begin(), options.end() );
+    force.init_coeff( {words} );
+
+    system.slice_force();
+    auto f = system.f;
+    Cabana::deep_copy( f, 0.0 );
+    force.compute( &system, &neighbor );
+    double energy = force.compute_energy( &system, &neighbor );
+
+    int num_atom = system.N_local;
+    Kokkos::View<double **, TEST_MEMSPACE> f_copy( "forces", num_atom, 3 );
+    Kokkos::parallel_for(
+        "copy forces", Kokkos::RangePolicy<TEST_EXECSPACE>( 0, num_atom ),
+        KOKKOS_LAMBDA( const int p ) {
+            for ( int d = 0; d < 3; ++d )
+                f_copy( p, d ) = f( p, d );
+        } );
+    Kokkos::fence();
+    forces = Kokkos::View<double **, Kokkos::HostSpace>( "forces_host",
+                                                         num_atom, 3 );
+    Kokkos::deep_copy( forces, f_copy );
+    return energy;
+}
+
+//---------------------------------------------------------------------------//
+// The compact storage is only indexed like a G/dEdG slice; n2p2 must give
+// the same energy and forces as with the fixed width AoSoA.
+template <class t_System>
+void testCompactLayout()
+{
+    double cutoff = 3.9;
+#ifdef CabanaMD_ENABLE_NNP_FLOAT
+    double tol = 1e-4;
+#else
+    double tol = 1e-10;
+#endif
+    using t_device = typename t_System::device_type;
+
+    t_System system = createCluster<t_System>( 3, 3.52 );
+    Kokkos::View<double **, Kokkos::HostSpace> f_aosoa, f_compact;
+    double e_aosoa =
+        computeNNP<t_System, System_NNP<t_device, 1>>( system, cutoff,
+                                                       f_aosoa );
+    double e_compact =
+        computeNNP<t_System, System_NNP<t_device, 0>>( system, cutoff,
+                                                       f_compact );
+
+    EXPECT_NEAR( e_compact, e_aosoa, tol * std::abs( e_aosoa ) );
+    double f_max = 0.0;
+    for ( std::size_t p = 0; p < f_aosoa.extent( 0 ); ++p )
+        for ( int d = 0; d < 3; ++d )
+            f_max = std::max( f_max, std::abs( f_aosoa( p, d ) ) );
+    EXPECT_GT( f_max, 0.0 );
+    for ( std::size_t p = 0; p < f_aosoa.extent( 0 ); ++p )
+        for ( int d = 0; d < 3; ++d )
+            EXPECT_NEAR( f_compact( p, d ), f_aosoa( p, d ), tol * f_max );
+}
+
+//---------------------------------------------------------------------------//
+// Energies (column 0) and dE/dG (columns 1...) of the local atoms from the
+// symmetry functions, by n2p2 or by the batched networks.
+template <class t_System_NNP, class t_Mode, class t_Batch, class t_x,
+          class t_type, class t_list>
+Kokkos::View<double **, Kokkos::HostSpace>
+evaluateNetwork( t_System_NNP &nnp, t_Mode &mode, t_Batch &batch, const t_x x,
+                 const t_type type, const t_list neigh_list,
+                 const int num_atom, const bool use_batch )
+{
+    auto widths = batch.input_widths();
+    int num_sf = *std::max_element( widths.begin(), widths.end() );
+    nnp.resize( num_atom );
+    nnp.arrange( batch.order, batch.counts, batch.offsets, widths );
+    nnp.slice_G();
+    nnp.slice_dEdG();
+    nnp.slice_E();
+    auto G = nnp.G;
+    typename t_System_NNP::t_G::atomic_access_slice G_a = G;
+    auto dEdG = nnp.dEdG;
+    auto E = nnp.E;
+    mode.calculateSymmetryFunctionGroups( x, type, G_a, neigh_list, num_atom,
+                                          Cabana::SerialOpTag(),
+                                          Cabana::SerialOpTag() );
+    if ( use_batch )
+        batch.compute( G, dEdG, E );
+    else
+        mode.calculateAtomicNeuralNetworks( type, G, dEdG, E, num_atom );
+
+    Kokkos::View<int *, TEST_MEMSPACE> d_widths( "widths", widths.size() );
+    auto h_widths = Kokkos::create_mirror_view( d_widths );
+    for ( std::size_t e = 0; e < widths.size(); ++e )
+        h_widths( e ) = widths[e];
+    Kokkos::deep_copy( d_widths, h_widths );
+    Kokkos::View<double **, TEST_MEMSPACE> result( "result", num_atom,
+                                                   num_sf + 1 );
+    Kokkos::parallel_for(
+        "copy network", Kokkos::RangePolicy<TEST_EXECSPACE>( 0, num_atom ),
+        KOKKOS_LAMBDA( const int p ) {
+            result( p, 0 ) = E( p );
+            for ( int k = 0; k < d_widths( type( p ) ); ++k )
+                result( p, k + 1 ) = dEdG( p, k );
+        } );
+    Kokkos::fence();
+    return Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(), result );
+}
+
+//---------------------------------------------------------------------------//
+// Per atom energies and dE/dG of one System_NNP layout, computed from the
+// same symmetry functions by n2p2 and by the in-tree batched networks.
+template <class t_System, class t_System_NNP>
+void testBatchNetwork()
+{
+    using t_device = typename t_System::device_type;
+    using t_Neigh = NeighborVerlet<t_System, Cabana::FullNeighborTag,
+                                   Cabana::VerletLayout2D>;
+    double cutoff = 3.9;
+#ifdef CabanaMD_ENABLE_NNP_FLOAT
+    double tol = 1e-4;
+#else
+    double tol = 1e-10;
+#endif
+
+    t_System system = createCluster<t_System>( 3, 3.52 );
+    t_Neigh neighbor( cutoff, false, 100 );
+    neighbor.create( &system );
+
+    // n2p2 set up as in the force
+    ForceNNP<t_System, t_System_NNP, t_Neigh, Cabana::SerialOpTag,
+             Cabana::SerialOpTag>
+        force( &system );
+    std::string dir( CabanaMD_NNP_TEST_DIR );
+    force.init_coeff( {{"pair_style", "nnp", "dir", dir}} );
+    auto mode = force.mode;
+
+    NNPModel model( dir );
+    model.read( "input.nn" );
+    NNPBatch<t_device> batch;
+    for ( auto &file : batch.weight_files( model.file( "input.nn" ) ) )
+        model.read( file );
+    batch.load( model );
+
+    int num_atom = system.N_local;
+    system.slice_x();
+    system.slice_type();
+    auto x = system.x;
+    auto type = system.type;
+    auto neigh_list = neighbor.get();
+    batch.group( type, num_atom );
+
+    t_System_NNP nnp_ref, nnp_batch;
+    auto ref = evaluateNetwork( nnp_ref, *mode, batch, x, type, neigh_list,
+                                num_atom, false );
+    auto out = evaluateNetwork( nnp_batch, *mode, batch, x, type, neigh_list,
+                                num_atom, true );
+    int num_sf = ref.extent( 1 ) - 1;
+
+    double e_max = 0.0;
+    double d_max = 0.0;
+    for ( int p = 0; p < num_atom; ++p )
+    {
+        e_max = std::max( e_max, std::abs( ref( p, 0 ) ) );
+        for ( int k = 1; k <= num_sf; ++k )
+            d_max = std::max( d_max, std::abs( ref( p, k ) ) );
+    }
+    EXPECT_GT( e_max, 0.0 );
+    EXPECT_GT( d_max, 0.0 );
+    for ( int p = 0; p < num_atom; ++p )
+    {
+        EXPECT_NEAR( out( p, 0 ), ref( p, 0 ), tol * e_max );
+        for ( int k = 1; k <= num_sf; ++k )
+            EXPECT_NEAR( out( p, k ), ref( p, k ), tol * d_max );
+    }
+}
+
+//---------------------------------------------------------------------------//
+// The in-tree symmetry functions and forces, with and without the radial
+// dG/dr cache and from full or half lists, must reproduce n2p2.
+template <class t_System>
+void testInTreeSymmetry()
+{
+    double cutoff = 3.9;
+#ifdef CabanaMD_ENABLE_NNP_FLOAT
+    double tol = 1e-4;
+#else
+    double tol = 1e-10;
+#endif
+    // n2p2 hardcodes its unit conversion to fewer digits
+    double tol_n2p2 = std::max( tol, 1e-6 );
+    using t_device = typename t_System::device_type;
+    using t_System_NNP = System_NNP<t_device, 1>;
+
+    t_System system = createCluster<t_System>( 3, 3.52 );
+    Kokkos::View<double **, Kokkos::HostSpace> f_n2p2, f_tree, f_cache;
+    double e_n2p2 =
+        computeNNP<t_System, t_System_NNP>( system, cutoff, f_n2p2 );
+    double e_tree = computeNNP<t_System, t_System_NNP>(
+        system, cutoff, f_tree, {"symmetry", "cabana"} );
+    double e_cache = computeNNP<t_System, t_System_NNP>(
+        system, cutoff, f_cache, {"cache", "64"} );
+    using t_half = Cabana::HalfNeighborTag;
+    Kokkos::View<double **, Kokkos::HostSpace> f_half, f_half_cache;
+    double e_half = computeNNP<t_System, t_System_NNP, t_half>(
+        system, cutoff, f_half, {"symmetry", "cabana"} );
+    double e_half_cache = computeNNP<t_System, t_System_NNP, t_half>(
+        system, cutoff, f_half_cache, {"cache", "64"} );
+
+    EXPECT_NEAR( e_tree, e_n2p2, tol_n2p2 * std::abs( e_n2p2 ) );
+    EXPECT_NEAR( e_cache, e_tree, tol * std::abs( e_tree ) );
+    EXPECT_NEAR( e_half, e_tree, tol * std::abs( e_tree ) );
+    EXPECT_NEAR( e_half_cache, e_tree, tol * std::abs( e_tree ) );
+    double f_max = 0.0;
+    for ( std::size_t p = 0; p < f_n2p2.extent( 0 ); ++p )
+        for ( int d = 0; d < 3; ++d )
+            f_max = std::max( f_max, std::abs( f_n2p2( p, d ) ) );
+    EXPECT_GT( f_max, 0.0 );
+    for ( std::size_t p = 0; p < f_n2p2.extent( 0 ); ++p )
+        for ( int d = 0; d < 3; ++d )
+        {
+            EXPECT_NEAR( f_tree( p, d ), f_n2p2( p, d ), tol_n2p2 * f_max );
+            EXPECT_NEAR( f_cache( p, d ), f_tree( p, d ), tol * f_max );
+            EXPECT_NEAR( f_half( p, d ), f_tree( p, d ), tol * f_max );
+            EXPECT_NEAR( f_half_cache( p, d ), f_tree( p, d ), tol * f_max );
+        }
+}
+
+//---------------------------------------------------------------------------//
+// TESTS
+//---------------------------------------------------------------------------//
+TEST( TEST_CATEGORY, nnp_compact_test )
+{
+    using DeviceType = Kokkos::Device<TEST_EXECSPACE, TEST_MEMSPACE>;
+#if ( CabanaMD_LAYOUT == 1 )
+    using t_System = System<DeviceType, 1>;
+#elif ( CabanaMD_LAYOUT == 2 )
+    using t_System = System<DeviceType, 2>;
+#elif ( CabanaMD_LAYOUT == 3 )
+    using t_System = System<DeviceType, 3>;
+#elif ( CabanaMD_LAYOUT == 6 )
+    using t_System = System<DeviceType, 6>;
+#endif
+    testCompactLayout<t_System>();
+}
+
+TEST( TEST_CATEGORY, nnp_batch_test )
+{
+    using DeviceType = Kokkos::Device<TEST_EXECSPACE, TEST_MEMSPACE>;
+#if ( CabanaMD_LAYOUT == 1 )
+    using t_System = System<DeviceType, 1>;
+#elif ( CabanaMD_LAYOUT == 2 )
+    using t_System = System<DeviceType, 2>;
+#elif ( CabanaMD_LAYOUT == 3 )
+    using t_System = System<DeviceType, 3>;
+#elif ( CabanaMD_LAYOUT == 6 )
+    using t_System = System<DeviceType, 6>;
+#endif
+    testBatchNetwork<t_System, System_NNP<DeviceType, 1>>();
+    testBatchNetwork<t_System, System_NNP<DeviceType, 0>>();
+}
+
+TEST( TEST_CATEGORY, nnp_in_tree_test )
+{
+    using DeviceType = Kokkos::Device<TEST_EXECSPACE, TEST_MEMSPACE>;
+#if ( CabanaMD_LAYOUT == 1 )
+    using t_System = System<DeviceType, 1>;
+#elif ( CabanaMD_LAYOUT == 2 )
+    using t_System = System<DeviceType, 2>;
+#elif ( CabanaMD_LAYOUT == 3 )
+    using t_System = System<DeviceType, 3>;
+#elif ( CabanaMD_LAYOUT == 6 )
+    using t_System = System<DeviceType, 6>;
+#endif
+    testInTreeSymmetry<t_System>();
+}
+
+//---------------------------------------------------------------------------//
+
+} // end namespace Test
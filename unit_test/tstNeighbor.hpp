@@ -11,7 +11,9 @@
 
 #include <CabanaMD_config.hpp>
 
+#include <comm_mpi.h>
 #include <neighbor.h>
+#include <property_rdf.h>
 #include <system.h>
 
 #include <Cabana_Core.hpp>
@@ -21,6 +23,9 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
 #include <vector>
 
 namespace Test
@@ -47,12 +52,35 @@ createTestListHostCopy( const TestNeighborList<KokkosMemorySpace> &test_list )
     return list_host;
 }
 
+//---------------------------------------------------------------------------//
+// Atoms with an entry in the list: the CSR lists of the cell based builds
+// only cover the local atoms.
+template <class ListType>
+int listedAtoms( const ListType &, const int, const int total_atoms )
+{
+    return total_atoms;
+}
+template <class MemorySpace>
+int listedAtoms( const CellNeighborList<MemorySpace> &, const int local_atoms,
+                 const int )
+{
+    return local_atoms;
+}
+template <class MemorySpace>
+int listedAtoms( const ClusterNeighborList<MemorySpace> &,
+                 const int local_atoms, const int )
+{
+    return local_atoms;
+}
+
 //---------------------------------------------------------------------------//
 // Copy into a host test list, extracted with the neighbor list interface.
 template <class ListType>
 TestNeighborList<typename TEST_EXECSPACE::array_layout, Kokkos::HostSpace>
-copyListToHost( const ListType &list, const int total_atoms, const int max_n )
+copyListToHost( const ListType &list, const int total_atoms, const int max_n,
+                const int local_atoms )
 {
+    const int listed = listedAtoms( list, local_atoms, total_atoms );
     TestNeighborList<TEST_MEMSPACE> list_host;
     list_host.counts =
         Kokkos::View<int *, TEST_MEMSPACE>( "counts", total_atoms );
@@ -62,7 +90,9 @@ copyListToHost( const ListType &list, const int total_atoms, const int max_n )
         "copy list", Kokkos::RangePolicy<TEST_EXECSPACE>( 0, total_atoms ),
         KOKKOS_LAMBDA( const int p ) {
             list_host.counts( p ) =
-                Cabana::NeighborList<ListType>::numNeighbor( list, p );
+                p < listed
+                    ? Cabana::NeighborList<ListType>::numNeighbor( list, p )
+                    : 0;
             for ( int n = 0; n < list_host.counts( p ); ++n )
                 list_host.neighbors( p, n ) =
                     Cabana::NeighborList<ListType>::getNeighbor( list, p, n );
@@ -152,8 +182,9 @@ void checkFullNeighborListPartialRange( const ListType &list,
     auto N2_list_host = createTestListHostCopy( N2_list );
 
     // Copy to a consistent list format on the host.
-    auto list_host = copyListToHost( list, N2_list.neighbors.extent( 0 ),
-                                     N2_list.neighbors.extent( 1 ) );
+    auto list_host =
+        copyListToHost( list, N2_list.neighbors.extent( 0 ),
+                        N2_list.neighbors.extent( 1 ), local_atoms );
 
     // Check the results.
     int total_atoms = position.size();
@@ -201,8 +232,9 @@ void checkHalfNeighborListPartialRange( const ListType &list,
     auto N2_list_host = createTestListHostCopy( N2_list );
 
     // Copy to a consistent list format on the host.
-    auto list_host = copyListToHost( list, N2_list.neighbors.extent( 0 ),
-                                     N2_list.neighbors.extent( 1 ) );
+    auto list_host =
+        copyListToHost( list, N2_list.neighbors.extent( 0 ),
+                        N2_list.neighbors.extent( 1 ), local_atoms );
 
     // Check that the full list is nearly twice the size of the half list.
     int total_atoms = position.size();
@@ -299,8 +331,14 @@ void testNeighborListPartialRange( bool half_neigh )
     t_System system =
         createAtoms<t_System>( num_atom, num_ghost, box_min, box_max );
 
+    // Sort the local atoms by bin as init does; the cell based lists are
+    // built from these bins.
+    Binning<t_System> binning( &system );
+    binning.create_binning( cutoff, cutoff, cutoff, 1, true, false, true );
+
     // Create the neighbor list.
     t_Neighbor neighbor( cutoff, half_neigh, 100 );
+    neighbor.binning = &binning;
     neighbor.create( &system );
 
     // Check the neighbor list.
@@ -316,6 +354,73 @@ void testNeighborListPartialRange( bool half_neigh )
                                            num_local );
 }
 
+//---------------------------------------------------------------------------//
+// g(r) column of an RDF file written by rank 0.
+std::vector<double> readRDF( const std::string &file )
+{
+    std::vector<double> g;
+    std::ifstream in( file );
+    std::string line;
+    while ( std::getline( in, line ) )
+    {
+        if ( line.empty() || line[0] == '#' )
+            continue;
+        std::istringstream words( line );
+        int bin;
+        double r, g_r;
+        words >> bin >> r >> g_r;
+        g.push_back( g_r );
+    }
+    return g;
+}
+
+// g(r) of the same atoms (with ghosts) from a half and a full list.
+template <class t_System>
+void testRDFHalfFull()
+{
+    int num_atom = 1e3;
+    int num_ghost = 200;
+    double cutoff = 2.32;
+    double box_min = -5.3 * cutoff;
+    double box_max = 4.7 * cutoff;
+    t_System system =
+        createAtoms<t_System>( num_atom, num_ghost, box_min, box_max );
+    system.N = num_atom - num_ghost;
+    Comm<t_System> comm( &system, cutoff );
+
+    using t_Half = NeighborVerlet<t_System, Cabana::HalfNeighborTag,
+                                  Cabana::VerletLayout2D>;
+    using t_Full = NeighborVerlet<t_System, Cabana::FullNeighborTag,
+                                  Cabana::VerletLayout2D>;
+    t_Half half( cutoff, true, 100 );
+    half.create( &system );
+    t_Full full( cutoff, false, 100 );
+    full.create( &system );
+
+    RDF<t_System, t_Half> rdf_half( &comm, "half", "rdf_half.txt", 1, 20,
+                                    cutoff );
+    RDF<t_System, t_Full> rdf_full( &comm, "full", "rdf_full.txt", 1, 20,
+                                    cutoff );
+    rdf_half.compute( &system, &half, 0 );
+    rdf_full.compute( &system, &full, 0 );
+    rdf_half.write( &system );
+    rdf_full.write( &system );
+
+    if ( comm.process_rank() != 0 )
+        return;
+    auto g_half = readRDF( "rdf_half.txt" );
+    auto g_full = readRDF( "rdf_full.txt" );
+    ASSERT_EQ( g_half.size(), 20u );
+    ASSERT_EQ( g_full.size(), 20u );
+    double g_max = 0.0;
+    for ( int b = 0; b < 20; ++b )
+    {
+        EXPECT_NEAR( g_half[b], g_full[b], 1e-10 * ( 1.0 + g_full[b] ) );
+        g_max = std::max( g_max, g_full[b] );
+    }
+    EXPECT_GT( g_max, 0.0 );
+}
+
 //---------------------------------------------------------------------------//
 // TESTS
 //---------------------------------------------------------------------------//
@@ -326,6 +431,8 @@ TEST( TEST_CATEGORY, verlet_full_test )
     using t_System = System<DeviceType, 1>;
 #elif ( CabanaMD_LAYOUT == 2 )
     using t_System = System<DeviceType, 2>;
+#elif ( CabanaMD_LAYOUT == 3 )
+    using t_System = System<DeviceType, 3>;
 #elif ( CabanaMD_LAYOUT == 6 )
     using t_System = System<DeviceType, 6>;
 #endif
@@ -344,8 +451,12 @@ TEST( TEST_CATEGORY, verlet_full_test )
         using t_Neigh = NeighborTree<t_System, Cabana::FullNeighborTag,
                                      Cabana::VerletLayoutCSR>;
         testNeighborListPartialRange<t_System, t_Neigh>( false );
+        testNeighborListPartialRange<t_System, NeighborAuto<t_System>>(
+            false );
 #endif
     }
+    testNeighborListPartialRange<t_System, NeighborCell<t_System>>( false );
+    testNeighborListPartialRange<t_System, NeighborCluster<t_System>>( false );
 }
 
 //---------------------------------------------------------------------------//
@@ -356,6 +467,8 @@ TEST( TEST_CATEGORY, verlet_half_test )
     using t_System = System<DeviceType, 1>;
 #elif ( CabanaMD_LAYOUT == 2 )
     using t_System = System<DeviceType, 2>;
+#elif ( CabanaMD_LAYOUT == 3 )
+    using t_System = System<DeviceType, 3>;
 #elif ( CabanaMD_LAYOUT == 6 )
     using t_System = System<DeviceType, 6>;
 #endif
@@ -374,8 +487,31 @@ TEST( TEST_CATEGORY, verlet_half_test )
         using t_Neigh = NeighborTree<t_System, Cabana::HalfNeighborTag,
                                      Cabana::VerletLayoutCSR>;
         testNeighborListPartialRange<t_System, t_Neigh>( true );
+        using t_Neigh2D = NeighborTree<t_System, Cabana::HalfNeighborTag,
+                                       Cabana::VerletLayout2D>;
+        testNeighborListPartialRange<t_System, t_Neigh2D>( true );
+        testNeighborListPartialRange<t_System, NeighborAuto<t_System>>(
+            true );
 #endif
     }
+    testNeighborListPartialRange<t_System, NeighborCell<t_System>>( true );
+    testNeighborListPartialRange<t_System, NeighborCluster<t_System>>( true );
+}
+
+//---------------------------------------------------------------------------//
+TEST( TEST_CATEGORY, rdf_half_full_test )
+{
+    using DeviceType = Kokkos::Device<TEST_EXECSPACE, TEST_MEMSPACE>;
+#if ( CabanaMD_LAYOUT == 1 )
+    using t_System = System<DeviceType, 1>;
+#elif ( CabanaMD_LAYOUT == 2 )
+    using t_System = System<DeviceType, 2>;
+#elif ( CabanaMD_LAYOUT == 3 )
+    using t_System = System<DeviceType, 3>;
+#elif ( CabanaMD_LAYOUT == 6 )
+    using t_System = System<DeviceType, 6>;
+#endif
+    testRDFHalfFull<t_System>();
 }
 
 //---------------------------------------------------------------------------//
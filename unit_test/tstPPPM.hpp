@@ -0,0 +1,300 @@
+/****************************************************************************
+ * Copyright (c) 2018-2020 by the Cabana authors                            *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Cabana library. Cabana is distributed under a   *
+ * BSD 3-clause license. For the licensing terms see the LICENSE file in    *
+ * the top-level directory.                                                 *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#include <CabanaMD_config.hpp>
+
+#include <Cabana_Core.hpp>
+#include <Kokkos_Core.hpp>
+
+#ifdef Cabana_ENABLE_HEFFTE
+#include <comm_mpi.h>
+#include <kspace_pppm.h>
+#include <neighbor.h>
+#include <system.h>
+
+#include <gtest/gtest.h>
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace Test
+{
+//---------------------------------------------------------------------------//
+// Rock salt sites (x, y, z, q) with unit charges and nearest neighbor
+// distance r0 in a periodic cube; displaced randomly by up to shift.
+std::vector<std::array<double, 4>> rockSalt( const int cells,
+                                             const double r0,
+                                             const double shift )
+{
+    const int n = 2 * cells;
+    const double box = n * r0;
+    std::mt19937 gen( 342343901 );
+    std::uniform_real_distribution<double> draw( -shift, shift );
+    std::vector<std::array<double, 4>> sites;
+    for ( int i = 0; i < n; ++i )
+        for ( int j = 0; j < n; ++j )
+            for ( int k = 0; k < n; ++k )
+            {
+                std::array<double, 4> site = {i * r0, j * r0, k * r0,
+                                              ( i + j + k ) % 2 ? -1.0 : 1.0};
+                for ( int d = 0; d < 3; ++d )
+                    site[d] = std::fmod( site[d] + draw( gen ) + box, box );
+                sites.push_back( site );
+            }
+    return sites;
+}
+
+//---------------------------------------------------------------------------//
+// Direct Ewald sum (qqrd2e = 1) of a neutral periodic cube, converged far
+// beyond the PPPM accuracy: energy, and forces per site.
+double ewaldReference( const std::vector<std::array<double, 4>> &sites,
+                       const double box,
+                       std::vector<std::array<double, 3>> &forces )
+{
+    const double alpha = 1.2;
+    const int kmax = 16;
+    const double pi = M_PI;
+    const double volume = box * box * box;
+    const int num_site = sites.size();
+    forces.assign( num_site, {0.0, 0.0, 0.0} );
+
+    // Real space: one image shell covers all erfc( alpha r ) > 1e-16
+    double energy = 0.0;
+    for ( int i = 0; i < num_site; ++i )
+    {
+        energy -= alpha / std::sqrt( pi ) * sites[i][3] * sites[i][3];
+        for ( int j = 0; j < num_site; ++j )
+            for ( int a = -1; a <= 1; ++a )
+                for ( int b = -1; b <= 1; ++b )
+                    for ( int c = -1; c <= 1; ++c )
+                    {
+                        if ( i == j && a == 0 && b == 0 && c == 0 )
+                            continue;
+                        const double dx[3] = {
+                            sites[i][0] - sites[j][0] - a * box,
+                            sites[i][1] - sites[j][1] - b * box,
+                            sites[i][2] - sites[j][2] - c * box};
+                        const double rsq =
+                            dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
+                        const double r = std::sqrt( rsq );
+                        const double qq = sites[i][3] * sites[j][3];
+                        energy += 0.5 * qq * std::erfc( alpha * r ) / r;
+                        const double fpair =
+                            qq *
+                            ( std::erfc( alpha * r ) / r +
+                              2.0 * alpha / std::sqrt( pi ) *
+                                  std::exp( -alpha * alpha * rsq ) ) /
+                            rsq;
+                        for ( int d = 0; d < 3; ++d )
+                            forces[i][d] += fpair * dx[d];
+                    }
+    }
+
+    // Reciprocal space
+    for ( int mx = -kmax; mx <= kmax; ++mx )
+        for ( int my = -kmax; my <= kmax; ++my )
+            for ( int mz = -kmax; mz <= kmax; ++mz )
+            {
+                if ( mx == 0 && my == 0 && mz == 0 )
+                    continue;
+                const double k[3] = {2.0 * pi * mx / box, 2.0 * pi * my / box,
+                                     2.0 * pi * mz / box};
+                const double ksq = k[0] * k[0] + k[1] * k[1] + k[2] * k[2];
+                const double a_k =
+                    std::exp( -ksq / ( 4.0 * alpha * alpha ) ) / ksq;
+                double s_re = 0.0;
+                double s_im = 0.0;
+                for ( const auto &site : sites )
+                {
+                    const double kr =
+                        k[0] * site[0] + k[1] * site[1] + k[2] * site[2];
+                    s_re += site[3] * std::cos( kr );
+                    s_im += site[3] * std::sin( kr );
+                }
+                energy += 2.0 * pi / volume * a_k *
+                          ( s_re * s_re + s_im * s_im );
+                for ( int i = 0; i < num_site; ++i )
+                {
+                    const double kr = k[0] * sites[i][0] +
+                                      k[1] * sites[i][1] + k[2] * sites[i][2];
+                    const double term =
+                        4.0 * pi / volume * sites[i][3] * a_k *
+                        ( std::sin( kr ) * s_re - std::cos( kr ) * s_im );
+                    for ( int d = 0; d < 3; ++d )
+                        forces[i][d] += term * k[d];
+                }
+            }
+    return energy;
+}
+
+//---------------------------------------------------------------------------//
+// Total PPPM energy, and forces of the owned atoms by site index.
+template <class t_System>
+double computePPPM( const std::vector<std::array<double, 4>> &sites,
+                    const double box, const double accuracy,
+                    const double cutoff,
+                    std::vector<std::array<double, 3>> &forces,
+                    std::vector<int> &owned )
+{
+    using t_Neigh = NeighborVerlet<t_System, Cabana::FullNeighborTag,
+                                   Cabana::VerletLayout2D>;
+
+    t_System system;
+    system.init();
+    system.atom_style = "charge";
+    system.create_domain( {0.0, 0.0, 0.0}, {box, box, box} );
+    system.N = sites.size();
+
+    // Sites of this rank's sub domain
+    const double lo[3] = {system.local_mesh_lo_x, system.local_mesh_lo_y,
+                          system.local_mesh_lo_z};
+    const double hi[3] = {system.local_mesh_hi_x, system.local_mesh_hi_y,
+                          system.local_mesh_hi_z};
+    owned.clear();
+    for ( std::size_t s = 0; s < sites.size(); ++s )
+    {
+        bool inside = true;
+        for ( int d = 0; d < 3; ++d )
+            inside = inside && sites[s][d] >= lo[d] && sites[s][d] < hi[d];
+        if ( inside )
+            owned.push_back( s );
+    }
+    const int num_atom = owned.size();
+    Kokkos::View<double * [4], Kokkos::HostSpace> h_sites( "sites",
+                                                           num_atom );
+    for ( int p = 0; p < num_atom; ++p )
+        for ( int d = 0; d < 4; ++d )
+            h_sites( p, d ) = sites[owned[p]][d];
+    auto d_sites =
+        Kokkos::create_mirror_view_and_copy( TEST_MEMSPACE(), h_sites );
+
+    system.resize( num_atom );
+    system.N_local = num_atom;
+    system.N_ghost = 0;
+    system.slice_all();
+    auto x = system.x;
+    auto q = system.q;
+    auto id = system.id;
+    auto type = system.type;
+    Kokkos::parallel_for(
+        "create sites", Kokkos::RangePolicy<TEST_EXECSPACE>( 0, num_atom ),
+        KOKKOS_LAMBDA( const int p ) {
+            for ( int d = 0; d < 3; ++d )
+                x( p, d ) = d_sites( p, d );
+            q( p ) = d_sites( p, 3 );
+            id( p ) = p + 1;
+            type( p ) = 0;
+        } );
+    Kokkos::fence();
+
+    Comm<t_System> comm( &system, cutoff );
+    comm.create_domain_decomposition();
+    comm.exchange_halo();
+    t_Neigh neighbor( cutoff, false, 100 );
+    neighbor.create( &system );
+
+    PPPM<t_System, t_Neigh> kspace( &system, &comm, accuracy, cutoff,
+                                    {0, 0, 0}, 0.0 );
+    system.slice_force();
+    Cabana::deep_copy( system.f, 0.0 );
+    kspace.compute_thermo( &system, &neighbor );
+
+    system.slice_force();
+    auto f = system.f;
+    Kokkos::View<double **, TEST_MEMSPACE> f_copy( "forces", num_atom, 3 );
+    Kokkos::parallel_for(
+        "copy forces", Kokkos::RangePolicy<TEST_EXECSPACE>( 0, num_atom ),
+        KOKKOS_LAMBDA( const int p ) {
+            for ( int d = 0; d < 3; ++d )
+                f_copy( p, d ) = f( p, d );
+        } );
+    auto h_f =
+        Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(), f_copy );
+    forces.resize( num_atom );
+    for ( int p = 0; p < num_atom; ++p )
+        for ( int d = 0; d < 3; ++d )
+            forces[p][d] = h_f( p, d );
+    comm.free_halo_plan();
+
+    double energy = kspace.energy;
+    MPI_Allreduce( MPI_IN_PLACE, &energy, 1, MPI_DOUBLE, MPI_SUM,
+                   MPI_COMM_WORLD );
+    return energy;
+}
+
+//---------------------------------------------------------------------------//
+// The ideal crystal has the Madelung energy and no forces; displaced ions
+// match a direct Ewald sum.
+template <class t_System>
+void testPPPM()
+{
+    const int cells = 2;
+    const double r0 = 2.0;
+    const double box = 2 * cells * r0;
+    const double accuracy = 1e-5;
+    const double cutoff = 3.5;
+    const double madelung = 1.747564594633182;
+
+    std::vector<std::array<double, 3>> forces;
+    std::vector<int> owned;
+    auto ideal = rockSalt( cells, r0, 0.0 );
+    double energy =
+        computePPPM<t_System>( ideal, box, accuracy, cutoff, forces, owned );
+    double expected = -0.5 * ideal.size() * madelung / r0;
+    EXPECT_NEAR( energy, expected, 1e-4 * std::abs( expected ) );
+    for ( const auto &force : forces )
+        for ( int d = 0; d < 3; ++d )
+            EXPECT_NEAR( force[d], 0.0, 10 * accuracy );
+
+    auto displaced = rockSalt( cells, r0, 0.2 );
+    std::vector<std::array<double, 3>> reference;
+    double energy_ref = ewaldReference( displaced, box, reference );
+    energy = computePPPM<t_System>( displaced, box, accuracy, cutoff, forces,
+                                    owned );
+    EXPECT_NEAR( energy, energy_ref, 1e-4 * std::abs( energy_ref ) );
+    double f_max = 0.0;
+    for ( const auto &force : reference )
+        for ( int d = 0; d < 3; ++d )
+            f_max = std::max( f_max, std::abs( force[d] ) );
+    EXPECT_GT( f_max, 100 * accuracy );
+    for ( std::size_t p = 0; p < owned.size(); ++p )
+        for ( int d = 0; d < 3; ++d )
+            EXPECT_NEAR( forces[p][d], reference[owned[p]][d],
+                         10 * accuracy );
+}
+
+//---------------------------------------------------------------------------//
+// TESTS
+//---------------------------------------------------------------------------//
+TEST( TEST_CATEGORY, pppm_ewald_test )
+{
+    using DeviceType = Kokkos::Device<TEST_EXECSPACE, TEST_MEMSPACE>;
+#if ( CabanaMD_LAYOUT == 1 )
+    using t_System = System<DeviceType, 1>;
+#elif ( CabanaMD_LAYOUT == 2 )
+    using t_System = System<DeviceType, 2>;
+#elif ( CabanaMD_LAYOUT == 3 )
+    using t_System = System<DeviceType, 3>;
+#elif ( CabanaMD_LAYOUT == 6 )
+    using t_System = System<DeviceType, 6>;
+#endif
+    testPPPM<t_System>();
+}
+
+//---------------------------------------------------------------------------//
+
+} // end namespace Test
+#endif